@@ -29,6 +29,9 @@
 Implements CososMainWindow class that contains the gcview UI.
 */
 
+#include <algorithm>
+#include <cmath>
+
 #include "CososMainWindow.h"
 
 /**
@@ -43,6 +46,30 @@ CososMainWindow::CososMainWindow(QWidget *parent)
 
 	setImage(ui.qwBlocks, GcViewDescriptor.getNullPixmap());
 	setImage(ui.qwHeapBlocks, GcViewDescriptor.getNullPixmap());
+
+	// Both maps are panned and zoomed together with the mouse.
+	ui.qwBlocks->setAlignment(Qt::AlignCenter);
+	ui.qwHeapBlocks->setAlignment(Qt::AlignCenter);
+
+	ui.qwBlocks->installEventFilter(this);
+	ui.qwHeapBlocks->installEventFilter(this);
+
+	_usageChecks.push_back(std::make_pair(ui.checkFree, std::vector<Usage>{ Usage::Free }));
+	_usageChecks.push_back(std::make_pair(ui.checkVirtualAlloc, std::vector<Usage>{ Usage::VirtualAlloc }));
+	_usageChecks.push_back(std::make_pair(ui.checkHeap, std::vector<Usage>{ Usage::Heap }));
+	_usageChecks.push_back(std::make_pair(ui.checkImage, std::vector<Usage>{ Usage::Image }));
+	_usageChecks.push_back(std::make_pair(ui.checkPageHeap, std::vector<Usage>{ Usage::PageHeap }));
+	_usageChecks.push_back(std::make_pair(ui.checkStack, std::vector<Usage>{ Usage::Stack, Usage::TEB, Usage::PEB, Usage::ProcessParameters, Usage::EnvironmentBlock }));
+	_usageChecks.push_back(std::make_pair(ui.checkUndefined, std::vector<Usage>{ Usage::Undefined }));
+	_usageChecks.push_back(std::make_pair(ui.checkGCHeap, std::vector<Usage>{ Usage::GCHeap }));
+	_usageChecks.push_back(std::make_pair(ui.checkGCLOHeap, std::vector<Usage>{ Usage::GCLOHeap }));
+
+	for (auto& check : _usageChecks)
+	{
+		connect(check.first, &QCheckBox::toggled, this, &CososMainWindow::updateLayers);
+	}
+
+	connect(ui.checkHilbert, &QCheckBox::toggled, this, &CososMainWindow::updateLayout);
 }
 
 /**
@@ -50,15 +77,6 @@ Destructs an instance of the CososMainWindow class.
 */
 CososMainWindow::~CososMainWindow()
 {
-	if (_lastBuffer1)
-	{
-		delete _lastBuffer1;
-	}
-
-	if (_lastBuffer2)
-	{
-		delete _lastBuffer2;
-	}
 }
 
 /**
@@ -72,53 +90,295 @@ void CososMainWindow::updateInfos()
 }
 
 /**
-Updates memory map images on the UI.
+Updates memory map images on the UI, only parts of the maps changed since the last update are rendered and repainted.
 */
 void CososMainWindow::updateImages()
 {
-	// TODO refactor lastBuffer variables.
+	std::vector<HeapMapRect> rects1;
+	std::vector<HeapMapRect> rects2;
+
+	GcViewDescriptor.updatePyramids(_pyramid1, _pyramid2, rects1, rects2);
 
-	if (_lastBuffer1)
+	auto pyramid = _pyramid1.get_level_count() != 0 ? &_pyramid1 : &_pyramid2;
+
+	if (_center.isNull() && pyramid->get_level_count() != 0)
 	{
-		delete _lastBuffer1;
+		_center = QPointF(pyramid->get_width(0) / 2.0, pyramid->get_height(0) / 2.0);
 	}
 
-	if (_lastBuffer2)
+	updateView(ui.qwBlocks, &_pyramid1, _viewport1, _pixmap1, rects1);
+	updateView(ui.qwHeapBlocks, &_pyramid2, _viewport2, _pixmap2, rects2);
+}
+
+/**
+Shows the usages checked on the UI, maps are composited again from the masks of the last update without rendering ranges.
+*/
+void CososMainWindow::updateLayers()
+{
+	for (auto& check : _usageChecks)
 	{
-		delete _lastBuffer2;
+		for (auto usage : check.second)
+		{
+			GcViewDescriptor.setUsageVisible(usage, check.first->isChecked());
+		}
 	}
 
-	auto buffers = GcViewDescriptor.getImageBuffers();
+	std::vector<HeapMapRect> rects1;
+	std::vector<HeapMapRect> rects2;
+
+	GcViewDescriptor.updateLayers(_pyramid1, _pyramid2, rects1, rects2);
+
+	updateView(ui.qwBlocks, &_pyramid1, _viewport1, _pixmap1, rects1);
+	updateView(ui.qwHeapBlocks, &_pyramid2, _viewport2, _pixmap2, rects2);
+}
+
+/**
+Lays out the maps along a Hilbert curve if it is checked on the UI, or in columns. Maps are rendered again.
+*/
+void CososMainWindow::updateLayout()
+{
+	GcViewDescriptor.setLayout(ui.checkHilbert->isChecked() ? HeapMapLayout::Hilbert : HeapMapLayout::Columns);
+
+	updateImages();
+}
+
+/**
+Gets the displayed size of a page of a map, fitting the whole map to the label at zoom 0.
+
+\param label The label.
+\param pyramid Pyramid of the map.
+*/
+double CososMainWindow::getScale(const QLabel* label, const HeapMapPyramid* pyramid) const
+{
+	auto fit = std::min((double) label->width() / pyramid->get_width(0), (double) label->height() / pyramid->get_height(0));
+
+	return fit * std::pow(2.0, _zoom);
+}
+
+/**
+Gets the part of a map shown on a label around the center, from the pyramid level closest to the zoom.
+
+\param label The label.
+\param pyramid Pyramid of the map.
+*/
+CososMainWindow::MapViewport CososMainWindow::getViewport(const QLabel* label, const HeapMapPyramid* pyramid) const
+{
+	auto scale = getScale(label, pyramid);
+	auto level = pyramid->select_level(scale);
+	auto levelScale = scale * (1 << level);
+
+	int levelWidth = pyramid->get_width(level);
+	int levelHeight = pyramid->get_height(level);
+
+	// Visible part of the level, in pixels of the level.
+	auto width = std::min(levelWidth, (int) std::ceil(label->width() / levelScale));
+	auto height = std::min(levelHeight, (int) std::ceil(label->height() / levelScale));
+
+	auto x = (int) (_center.x() / (1 << level) - width / 2.0);
+	auto y = (int) (_center.y() / (1 << level) - height / 2.0);
+
+	x = std::max(0, std::min(x, levelWidth - width));
+	y = std::max(0, std::min(y, levelHeight - height));
+
+	MapViewport viewport;
+
+	viewport.Level = level;
+	viewport.Source = QRect(x, y, width, height);
+	viewport.Size = QSize((int) (width * levelScale), (int) (height * levelScale));
+
+	return viewport;
+}
+
+/**
+Draws a part of a pyramid level, wrapping the level without copying it.
+
+\param painter Painter of the pixmap of the viewport.
+\param pyramid Pyramid of the map.
+\param viewport Viewport of the pixmap.
+\param source Part of the level to draw, in pixels of the level.
+\return Drawn rectangle of the pixmap.
+*/
+QRect CososMainWindow::drawLevel(QPainter& painter, const HeapMapPyramid* pyramid, const MapViewport& viewport, const QRect& source) const
+{
+	auto image = QImage(pyramid->get_pixels(viewport.Level), pyramid->get_width(viewport.Level), pyramid->get_height(viewport.Level), QImage::Format::Format_RGB32);
+
+	auto scaleX = (double) viewport.Size.width() / viewport.Source.width();
+	auto scaleY = (double) viewport.Size.height() / viewport.Source.height();
+
+	auto target = QRectF((source.x() - viewport.Source.x()) * scaleX, (source.y() - viewport.Source.y()) * scaleY, source.width() * scaleX, source.height() * scaleY);
+
+	painter.drawImage(target, image, QRectF(source));
+
+	return target.toAlignedRect();
+}
 
-	if (buffers.first)
+/**
+Updates both maps for the current zoom and center.
+*/
+void CososMainWindow::updateViews()
+{
+	updateView(ui.qwBlocks, &_pyramid1, _viewport1, _pixmap1);
+	updateView(ui.qwHeapBlocks, &_pyramid2, _viewport2, _pixmap2);
+}
+
+/**
+Shows the part of a map around the center, from the pyramid level closest to the zoom, without rasterizing ranges.
+
+\param label The label.
+\param pyramid Pyramid of the map, without levels if there is no map.
+\param viewport Receives the shown part of the map.
+\param pixmap Receives the pixmap of the shown part, null if there is no map.
+*/
+void CososMainWindow::updateView(QLabel* label, const HeapMapPyramid* pyramid, MapViewport& viewport, QPixmap& pixmap)
+{
+	viewport = pyramid->get_level_count() != 0 ? getViewport(label, pyramid) : MapViewport();
+
+	if (viewport.Size.isEmpty())
+	{
+		pixmap = QPixmap();
+
+		setImage(label, GcViewDescriptor.getNullPixmap());
+
+		return;
+	}
+
+	pixmap = QPixmap(viewport.Size);
+
+	QPainter painter(&pixmap);
+
+	drawLevel(painter, pyramid, viewport, viewport.Source);
+
+	painter.end();
+
+	setImage(label, pixmap);
+}
+
+/**
+Repaints changed rectangles of a map in the pixmap of its shown part and sets it on the label. The whole map is shown again if the label shows another part of it.
+
+\param label The label.
+\param pyramid Pyramid of the map, without levels if there is no map.
+\param viewport Shown part of the map, updated if the whole map is shown again.
+\param pixmap Pixmap of the shown part, changed rectangles are painted in it.
+\param rects Changed rectangles of the map, in pixels of level 0.
+*/
+void CososMainWindow::updateView(QLabel* label, const HeapMapPyramid* pyramid, MapViewport& viewport, QPixmap& pixmap, const std::vector<HeapMapRect>& rects)
+{
+	if (pyramid->get_level_count() == 0 || viewport.Size.isEmpty() || pixmap.isNull() || !(getViewport(label, pyramid) == viewport))
+	{
+		updateView(label, pyramid, viewport, pixmap);
+
+		return;
+	}
+
+	if (rects.empty())
+	{
+		return;
+	}
+
+	QPainter painter(&pixmap);
+
+	auto isDrawn = false;
+
+	for (auto& rect : rects)
 	{
-		auto image = QImage(buffers.first, 2048, 512, QImage::Format::Format_RGB32);
+		auto level = viewport.Level;
 
-		auto pixmap = QPixmap::fromImage(image);
+		auto source = QRect(QPoint(rect.X >> level, rect.Y >> level), QPoint((rect.X + rect.Width - 1) >> level, (rect.Y + rect.Height - 1) >> level)).intersected(viewport.Source);
 
-		setImage(ui.qwBlocks, pixmap);
+		if (!source.isEmpty())
+		{
+			drawLevel(painter, pyramid, viewport, source);
+
+			isDrawn = true;
+		}
 	}
-	else
+
+	painter.end();
+
+	// Only changed rectangles are drawn from the pyramid, the label copies the pixmap when it paints.
+	if (isDrawn)
+	{
+		setImage(label, pixmap);
+	}
+}
+
+/**
+Zooms maps with the mouse wheel around the cursor, pans them by dragging and resets them with a double click.
+
+\param watched Label of a map.
+\param event Event.
+*/
+bool CososMainWindow::eventFilter(QObject* watched, QEvent* event)
+{
+	auto label = qobject_cast<QLabel*>(watched);
+	auto pyramid = label == ui.qwBlocks ? &_pyramid1 : &_pyramid2;
+
+	if (!label || pyramid->get_level_count() == 0)
 	{
-		setImage(ui.qwBlocks, GcViewDescriptor.getNullPixmap());
+		return QMainWindow::eventFilter(watched, event);
 	}
 
-	_lastBuffer1 = buffers.first;
+	auto offset = [&](const QPoint& position)
+	{
+		return QPointF(position.x() - label->width() / 2.0, position.y() - label->height() / 2.0);
+	};
 
-	if (buffers.second)
+	switch (event->type())
 	{
-		auto image = QImage(buffers.second, 2048, 512, QImage::Format::Format_RGB32);
+	case QEvent::Wheel:
+	{
+		auto wheelEvent = static_cast<QWheelEvent*>(event);
+		auto minZoom = 1 - (int) pyramid->get_level_count();
+		auto zoom = std::max(minZoom, std::min(MAX_ZOOM, _zoom + (wheelEvent->angleDelta().y() > 0 ? 1 : -1)));
+
+		// Keep the page under the cursor in place.
+		auto cursor = offset(wheelEvent->pos());
+		auto page = _center + cursor / getScale(label, pyramid);
 
-		auto pixmap = QPixmap::fromImage(image);
+		_zoom = zoom;
+		_center = page - cursor / getScale(label, pyramid);
 
-		setImage(ui.qwHeapBlocks, pixmap);
+		break;
 	}
-	else
+	case QEvent::MouseButtonPress:
+		_dragPosition = static_cast<QMouseEvent*>(event)->pos();
+		_isDragging = true;
+
+		return true;
+	case QEvent::MouseMove:
 	{
-		setImage(ui.qwHeapBlocks, GcViewDescriptor.getNullPixmap());
+		if (!_isDragging)
+		{
+			return false;
+		}
+
+		auto position = static_cast<QMouseEvent*>(event)->pos();
+
+		_center -= QPointF(position - _dragPosition) / getScale(label, pyramid);
+		_dragPosition = position;
+
+		break;
 	}
+	case QEvent::MouseButtonRelease:
+		_isDragging = false;
+
+		return true;
+	case QEvent::MouseButtonDblClick:
+		_zoom = 0;
+		_center = QPointF(pyramid->get_width(0) / 2.0, pyramid->get_height(0) / 2.0);
+
+		break;
+	default:
+		return QMainWindow::eventFilter(watched, event);
+	}
+
+	_center.setX(std::max(0.0, std::min(_center.x(), (double) pyramid->get_width(0))));
+	_center.setY(std::max(0.0, std::min(_center.y(), (double) pyramid->get_height(0))));
+
+	updateViews();
 
-	_lastBuffer2 = buffers.second;
+	return true;
 }
 
 /**
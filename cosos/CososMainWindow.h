@@ -35,6 +35,9 @@ Defines the CososMainWindow class.
 #include <qstring.h>
 #include <QtWidgets/QMainWindow>
 #include <qevent.h>
+#include <qpainter.h>
+#include <qcheckbox.h>
+#include <vector>
 #include "ui_CososMainWindow.h"
 #include "memoryrange.h"
 #include "gcviewdescriptor.h"
@@ -57,12 +60,56 @@ public:
 public slots:
 	void updateImages();
 	void updateInfos();
+	void updateLayers();
+	void updateLayout();
+
+protected:
+	bool eventFilter(QObject* watched, QEvent* event) override;
 
 private:
+	static const int MAX_ZOOM = 6;
+
+	/**
+	Part of a pyramid level shown on a label, and its displayed size.
+	*/
+	struct MapViewport
+	{
+		size_t Level = 0;
+		QRect Source;
+		QSize Size;
+
+		bool operator==(const MapViewport& other) const
+		{
+			return Level == other.Level && Source == other.Source && Size == other.Size;
+		}
+	};
+
 	Ui::CososMainWindowClass ui;
 
-	void* _lastBuffer1 = nullptr;
-	void* _lastBuffer2 = nullptr;
+	// Check boxes showing usages, the stack check box shows usages drawn in the stack color.
+	std::vector<std::pair<QCheckBox*, std::vector<Usage>>> _usageChecks;
+
+	HeapMapPyramid _pyramid1;
+	HeapMapPyramid _pyramid2;
+
+	MapViewport _viewport1;
+	MapViewport _viewport2;
+
+	// Pixmaps of the shown parts of the maps, changed parts are painted in them and they are set on the labels again.
+	QPixmap _pixmap1;
+	QPixmap _pixmap2;
+
+	int _zoom = 0;
+	QPointF _center;
+	QPoint _dragPosition;
+	bool _isDragging = false;
+
+	double getScale(const QLabel* label, const HeapMapPyramid* pyramid) const;
+	void updateViews();
+	MapViewport getViewport(const QLabel* label, const HeapMapPyramid* pyramid) const;
+	QRect drawLevel(QPainter& painter, const HeapMapPyramid* pyramid, const MapViewport& viewport, const QRect& source) const;
+	void updateView(QLabel* label, const HeapMapPyramid* pyramid, MapViewport& viewport, QPixmap& pixmap);
+	void updateView(QLabel* label, const HeapMapPyramid* pyramid, MapViewport& viewport, QPixmap& pixmap, const std::vector<HeapMapRect>& rects);
 
 	void setImage(QLabel* label, const QPixmap& pixmap);
 	void setImage(QLabel* label, const QImage* image);
@@ -48,7 +48,22 @@ Implements Extension class that provides entry points to the debugging engine.
 #include "DbgEngLogger.h"
 #include "HtraceCommandParser.h"
 #include "DbgEngMemoryReader.h"
+#include "CachingMemoryReader.h"
+#include "MinidumpFile.h"
+#include "MinidumpMemoryReader.h"
+#include "MinidumpMemoryInfoParser.h"
+#include "MinidumpStackReader.h"
 #include "DumpHeapCommandParser.h"
+#include "GCHeapWalker.h"
+#include "ParallelGCHeapWalker.h"
+#include "MethodTableCache.h"
+#include "HeapStatistics.h"
+#include "ReferenceGraph.h"
+#include "DominatorTree.h"
+#include "GCRootsCommandParser.h"
+#include "ManagedStringReader.h"
+#include "ManagedObjectReader.h"
+#include "HeapScan.h"
 #include "SafeWaitHandleParser.h"
 
 //----------------------------------------------------------------------------
@@ -66,7 +81,26 @@ class EXT_CLASS : public ExtExtension
 {
 private:
 	QtMessagePump _messagePump;
+	MethodTableCache _methodTableCache;
+	GCHeapBoundaryIndex _gcHeapBoundaryIndex;
+	HeapScan _heapScan;
+	std::unique_ptr<HeapStatistics> _heapStatistics;
+	std::unique_ptr<ReferenceGraph> _referenceGraph;
+	std::unique_ptr<DominatorTree> _dominatorTree;
+	std::unique_ptr<IManagedObjectReader> _managedObjectReader;
+	std::unique_ptr<MinidumpFile> _targetDump;
+	std::unique_ptr<MinidumpMemoryReader> _dumpMemoryReader;
+	std::unique_ptr<DbgEngMemoryReader> _dbgEngMemoryReader;
+	std::unique_ptr<CachingMemoryReader> _cachingMemoryReader;
+	ULONG _methodTableCacheProcessId = 0;
+	ULONG _managedObjectReaderProcessId = 0;
+
+	IMemoryReader* OpenMemoryReader(PDEBUG_CLIENT debug_client, PDEBUG_CONTROL debug_control, ILogger* logger, bool& is_dump);
 	std::string ExecuteCommand(PDEBUG_CLIENT debug_client, PDEBUG_CONTROL debug_control, const std::string& command);
+	void AttachMethodTableCache(PDEBUG_CLIENT debug_client, IDebuggerCommandExecutor* executor, IMemoryReader* memory_reader, ILogger* logger);
+	const IManagedObjectReader* GetManagedObjectReader(PDEBUG_CLIENT debug_client, PDEBUG_CONTROL debug_control, ILogger* logger);
+	bool RunHeapScan(IDebuggerCommandExecutor* executor, IMemoryReader* memory_reader, bool is_dump, ILogger* logger);
+	bool BuildReferenceGraph(IDebuggerCommandExecutor* executor, IMemoryReader* memory_reader, bool is_dump, ILogger* logger);
 
 public:
 	~EXT_CLASS();
@@ -77,6 +111,9 @@ public:
 	EXT_COMMAND_METHOD(gcview);
 	EXT_COMMAND_METHOD(waitingforobjects);
 	EXT_COMMAND_METHOD(threadnames);
+	EXT_COMMAND_METHOD(heapstat);
+	EXT_COMMAND_METHOD(referrers);
+	EXT_COMMAND_METHOD(retained);
 };
 
 // EXT_DECLARE_GLOBALS must be used to instantiate
@@ -129,12 +166,308 @@ void EXT_CLASS::Uninitialize()
 	this->Release();
 }
 
+/**
+Prepares the MethodTable cache for a command, clearing it, known heap boundaries, heap statistics, the reference graph, its dominator tree and heap scan queries when the current process changes.
+
+\param debug_client Debug client.
+\param executor Debugger command executor.
+\param memory_reader Memory reader.
+\param logger Logger.
+*/
+void EXT_CLASS::AttachMethodTableCache(PDEBUG_CLIENT debug_client, IDebuggerCommandExecutor* executor, IMemoryReader* memory_reader, ILogger* logger)
+{
+	PDEBUG_SYSTEM_OBJECTS debug_system_objects;
+
+	ULONG process_id = 0;
+
+	if (debug_client->QueryInterface(__uuidof(IDebugSystemObjects), (void **) &debug_system_objects) == S_OK)
+	{
+		debug_system_objects->GetCurrentProcessSystemId(&process_id);
+
+		debug_system_objects->Release();
+	}
+
+	if (process_id != _methodTableCacheProcessId)
+	{
+		_methodTableCache.clear();
+		_gcHeapBoundaryIndex.clear();
+		_heapStatistics.reset();
+		_dominatorTree.reset();
+		_referenceGraph.reset();
+		_heapScan.clear();
+
+		_methodTableCacheProcessId = process_id;
+	}
+
+	_methodTableCache.attach(executor, memory_reader, logger);
+}
+
+/**
+Largest width and height of saved gcview images.
+*/
+static const int MaxImageSize = 16384;
+
+// Types found by commands of this extension, one heap walk answers all of them.
+static const char* HeapScanTypeNames[] = { "System.Threading.Thread", "Microsoft.Win32.SafeHandles.SafeWaitHandle" };
+
+/**
+Answers queries of the heap scan shared by commands, walking the GC heap only if there are queries not answered for the current heap.
+Answers are reused only for dump targets, live targets may have allocated objects without changing segments. Call AttachMethodTableCache first.
+
+\param executor Debugger command executor.
+\param memory_reader Memory reader.
+\param is_dump true if memory is read from the dump file, so answers and boundaries of previous walks are valid.
+\param logger Logger.
+\return false if the heap cannot be walked.
+*/
+bool EXT_CLASS::RunHeapScan(IDebuggerCommandExecutor* executor, IMemoryReader* memory_reader, bool is_dump, ILogger* logger)
+{
+	_heapScan.attach(&_methodTableCache, logger);
+
+	for (auto type_name : HeapScanTypeNames)
+	{
+		_heapScan.add_query(type_name);
+	}
+
+	auto eeheap_parser = EEHeapCommandParser(executor, logger);
+	auto eeheap_output = eeheap_parser.execute();
+
+	if (!eeheap_output.has_ranges())
+	{
+		return false;
+	}
+
+	// Answers and boundaries of a live target are stale once it runs.
+	if (!is_dump)
+	{
+		_heapScan.invalidate();
+		_gcHeapBoundaryIndex.clear();
+	}
+
+	return _heapScan.run(eeheap_output.get_ranges(), memory_reader, &_gcHeapBoundaryIndex);
+}
+
+/**
+Builds the reference graph of the GC heap, reusing the graph of the previous call for dump targets if segments did not change.
+Live targets are walked again, references and roots may have changed without changing segments. A new graph drops the dominator tree of the previous one.
+Call AttachMethodTableCache first.
+
+\param executor Debugger command executor.
+\param memory_reader Memory reader.
+\param is_dump true if memory is read from the dump file, so the graph and boundaries of previous walks are valid.
+\param logger Logger.
+\return false if GC heap segments cannot be found.
+*/
+bool EXT_CLASS::BuildReferenceGraph(IDebuggerCommandExecutor* executor, IMemoryReader* memory_reader, bool is_dump, ILogger* logger)
+{
+	auto eeheap_parser = EEHeapCommandParser(executor, logger);
+	auto eeheap_output = eeheap_parser.execute();
+
+	if (!eeheap_output.has_ranges())
+	{
+		dprintf("Cannot find GC heap segments, check if SOS is loaded.\n");
+
+		return false;
+	}
+
+	if (is_dump && _referenceGraph && _referenceGraph->matches(eeheap_output.get_ranges()))
+	{
+		dprintf("Using reference graph of the previous walk.\n");
+
+		return true;
+	}
+
+	if (!is_dump)
+	{
+		_gcHeapBoundaryIndex.clear();
+	}
+
+	ParallelGCHeapWalker walker(eeheap_output.get_ranges(), memory_reader, &_methodTableCache, &_gcHeapBoundaryIndex, logger);
+
+	_dominatorTree.reset();
+	_referenceGraph.reset(new ReferenceGraph(eeheap_output.get_ranges()));
+
+	try
+	{
+		if (!_referenceGraph->build(walker, &_methodTableCache))
+		{
+			dprintf("Heap walk did not complete, reference graph is partial.\n");
+		}
+	}
+	catch (std::bad_alloc&)
+	{
+		_referenceGraph.reset();
+
+		dprintf("Not enough memory for the reference graph of this heap.\n");
+
+		return false;
+	}
+
+	dprintf("Reference graph has %Iu objects, %Iu references in %Iu bytes.\n", _referenceGraph->get_node_count(), _referenceGraph->get_edge_count(), _referenceGraph->memory_size());
+
+	return true;
+}
+
+/**
+Selects the managed object layouts of the current process from its runtime module, once per process.
+
+\param debug_client Debug client.
+\param debug_control Debug control.
+\param logger Logger.
+\return nullptr for 64-bit processes, objects are read with 32-bit addresses.
+*/
+const IManagedObjectReader* EXT_CLASS::GetManagedObjectReader(PDEBUG_CLIENT debug_client, PDEBUG_CONTROL debug_control, ILogger* logger)
+{
+	PDEBUG_SYSTEM_OBJECTS debug_system_objects;
+	PDEBUG_SYMBOLS debug_symbols;
+
+	ULONG process_id = 0;
+
+	if (debug_client->QueryInterface(__uuidof(IDebugSystemObjects), (void **) &debug_system_objects) == S_OK)
+	{
+		debug_system_objects->GetCurrentProcessSystemId(&process_id);
+
+		debug_system_objects->Release();
+	}
+
+	if (_managedObjectReader && process_id == _managedObjectReaderProcessId)
+	{
+		return _managedObjectReader.get();
+	}
+
+	auto version = ClrVersion::Unknown;
+
+	if (debug_client->QueryInterface(__uuidof(IDebugSymbols), (void **) &debug_symbols) == S_OK)
+	{
+		const char* runtime_module_names[] = { "clr", "mscorwks", "mscorsvr" };
+
+		for (auto name : runtime_module_names)
+		{
+			if (debug_symbols->GetModuleByModuleName(name, 0, nullptr, nullptr) == S_OK)
+			{
+				version = IManagedObjectReader::find_version(name);
+
+				break;
+			}
+		}
+
+		debug_symbols->Release();
+	}
+
+	ULONG processor_type = IMAGE_FILE_MACHINE_I386;
+
+	debug_control->GetEffectiveProcessorType(&processor_type);
+
+	if (processor_type == IMAGE_FILE_MACHINE_AMD64)
+	{
+		logger->Log("Managed objects of 64-bit processes are not supported.\n");
+
+		return nullptr;
+	}
+
+	if (version == ClrVersion::Unknown)
+	{
+		logger->Log("Cannot find the CLR module, using CLR 4 object layouts.\n");
+	}
+
+	_managedObjectReader = IManagedObjectReader::create(version);
+	_managedObjectReaderProcessId = process_id;
+
+	return _managedObjectReader.get();
+}
+
+/**
+Memory-maps the dump file of the current target, if the target is a user mode dump.
+
+\param debug_client Debug client.
+\param debug_control Debug control.
+\param dump Minidump file to open.
+*/
+static bool OpenTargetDump(PDEBUG_CLIENT debug_client, PDEBUG_CONTROL debug_control, MinidumpFile& dump)
+{
+	ULONG debuggee_class = 0;
+	ULONG debuggee_qualifier = 0;
+
+	if (debug_control->GetDebuggeeType(&debuggee_class, &debuggee_qualifier) != S_OK)
+	{
+		return false;
+	}
+
+	if (debuggee_class != DEBUG_CLASS_USER_WINDOWS || (debuggee_qualifier != DEBUG_USER_WINDOWS_SMALL_DUMP && debuggee_qualifier != DEBUG_USER_WINDOWS_DUMP))
+	{
+		return false;
+	}
+
+	PDEBUG_CLIENT4 debug_client4;
+
+	if (debug_client->QueryInterface(__uuidof(IDebugClient4), (void **) &debug_client4) != S_OK)
+	{
+		return false;
+	}
+
+	char dump_filename[MAX_PATH];
+	ULONG dump_filename_size = 0;
+	ULONG64 dump_handle = 0;
+	ULONG dump_type = 0;
+
+	auto result = debug_client4->GetDumpFile(0, dump_filename, sizeof(dump_filename), &dump_filename_size, &dump_handle, &dump_type);
+
+	debug_client4->Release();
+
+	if (result != S_OK)
+	{
+		return false;
+	}
+
+	return dump.open(dump_filename);
+}
+
+/**
+Opens the memory readers of the current target for a command, replacing the readers of the previous command.
+Dump targets are read directly from the mapped file, others through the engine with a page cache.
+
+\param debug_client Debug client.
+\param debug_control Debug control.
+\param logger Logger.
+\param is_dump Set to true if memory is read from the dump file.
+\return Selected memory reader, valid until the next call.
+*/
+IMemoryReader* EXT_CLASS::OpenMemoryReader(PDEBUG_CLIENT debug_client, PDEBUG_CONTROL debug_control, ILogger* logger, bool& is_dump)
+{
+	_cachingMemoryReader.reset();
+	_dbgEngMemoryReader.reset();
+	_dumpMemoryReader.reset();
+	_targetDump.reset(new MinidumpFile(logger));
+
+	auto is_dump_mapped = OpenTargetDump(debug_client, debug_control, *_targetDump);
+
+	_dumpMemoryReader.reset(new MinidumpMemoryReader(*_targetDump));
+	_dbgEngMemoryReader.reset(new DbgEngMemoryReader());
+	_cachingMemoryReader.reset(new CachingMemoryReader(_dbgEngMemoryReader.get()));
+
+	is_dump = is_dump_mapped && _dumpMemoryReader->has_memory();
+
+	if (is_dump)
+	{
+		return _dumpMemoryReader.get();
+	}
+
+	return _cachingMemoryReader.get();
+}
+
 /**
 Implements gcview command of this extension.
 */
 EXT_COMMAND(gcview,
 	"Graphically shows the native and CLR heap memory layout of a process (requires Qt 5.5).",
 	"{;x,o;;Bitmap file name without extension (optional)}" // Arguments: https://msdn.microsoft.com/en-us/library/windows/hardware/ff553340(v=vs.85).aspx
+	"{ppm;b,o;ppm;Save binary PPM images instead of PNG images.}"
+	"{width;ed,o,d=2048;width;Width of saved images, sizes other than 2048x512 aggregate usages under each pixel.}"
+	"{height;ed,o,d=512;height;Height of saved images.}"
+	"{blend;b,o;blend;Blend colors of usages under each pixel by their bytes.}"
+	"{dominant;b,o;dominant;Color each pixel by the usage with the most bytes under it.}"
+	"{hilbert;b,o;hilbert;Lay out pixels along a Hilbert curve instead of columns.}"
+	"{svg;b,o;svg;Save SVG images of merged ranges with address tooltips.}"
 	)
 {
 	PDEBUG_CLIENT DebugClient;
@@ -165,9 +498,27 @@ EXT_COMMAND(gcview,
 
 	dprintf("Reading addresses...\n");
 
-	// Get address map.
-	auto addressCommandParser = AddressCommandParser(executor, logger);
-	auto addressCommandOutput = addressCommandParser.execute();
+	bool is_dump = false;
+
+	auto memory_reader = OpenMemoryReader(DebugClient, DebugControl, logger, is_dump);
+
+	const unsigned char* memory_info_stream;
+	unsigned long memory_info_stream_size;
+
+	// Get address map, from the dump file directly if it has memory info.
+	AddressCommandOutput addressCommandOutput;
+
+	if (_targetDump->is_open() && _targetDump->find_stream(MinidumpFile::MEMORY_INFO_LIST_STREAM, memory_info_stream, memory_info_stream_size))
+	{
+		auto minidumpMemoryInfoParser = MinidumpMemoryInfoParser(*_targetDump, is_dump ? memory_reader : nullptr, logger);
+		addressCommandOutput = minidumpMemoryInfoParser.execute();
+	}
+
+	if (!addressCommandOutput.has_ranges())
+	{
+		auto addressCommandParser = AddressCommandParser(executor, logger);
+		addressCommandOutput = addressCommandParser.execute();
+	}
 
 	if (!addressCommandOutput.has_ranges())
 	{
@@ -232,12 +583,51 @@ EXT_COMMAND(gcview,
 	}
 	else
 	{
-		auto nativeFilename = std::string(filename) + ".png";
-		auto gcFilename = std::string(filename) + "-gc.png";
+		auto format = this->HasArg("ppm") ? ImageFormat::Ppm : ImageFormat::Png;
+		auto is_svg = this->HasArg("svg");
+		auto extension = is_svg ? ".svg" : format == ImageFormat::Ppm ? ".ppm" : ".png";
+
+		auto nativeFilename = std::string(filename) + extension;
+		auto gcFilename = std::string(filename) + "-gc" + extension;
+
+		auto width = this->GetArgU64("width");
+		auto height = this->GetArgU64("height");
+
+		GcViewDescriptor descriptor;
+
+		descriptor._ranges = addresses;
+		descriptor._gcRanges = heapAddresses;
+
+		if (width == 0 || height == 0 || width > MaxImageSize || height > MaxImageSize)
+		{
+			dprintf("Image width and height must be between 1 and %d.\n", MaxImageSize);
+		}
+		else
+		{
+			descriptor.setImageSize((unsigned int) width, (unsigned int) height);
 
-		GcViewDescriptor::saveImages(addresses, heapAddresses, nativeFilename.c_str(), gcFilename.c_str());
+			if (this->HasArg("blend"))
+			{
+				descriptor.setAggregation(HeapMapAggregation::Blend);
+			}
+			else if (this->HasArg("dominant"))
+			{
+				descriptor.setAggregation(HeapMapAggregation::Dominant);
+			}
 
-		dprintf("gcview images saved.\n");
+			if (this->HasArg("hilbert") && !descriptor.setLayout(HeapMapLayout::Hilbert))
+			{
+				dprintf("Hilbert layout requires the shorter image side to be a power of two dividing the longer side.\n");
+			}
+			else if (is_svg ? descriptor.saveSvgs(nativeFilename.c_str(), gcFilename.c_str()) : descriptor.saveImages(nativeFilename.c_str(), gcFilename.c_str(), format))
+			{
+				dprintf("gcview images saved.\n");
+			}
+			else
+			{
+				dprintf("Cannot save gcview images.\n");
+			}
+		}
 	}
 
 	DebugClient->SetOutputCallbacks(nullptr);
@@ -280,29 +670,47 @@ EXT_COMMAND(waitingforobjects,
 	IDebuggerCommandExecutor *executor = &DbgEngCommandExecutor(DebugClient, DebugControl);
 	ILogger *logger = &DbgEngLogger();
 
-	// Get stack traces.
-	std::string stackTracesOutput;
+	bool is_dump = false;
 
-	if (!executor->ExecuteCommand("~*e ?@@c++(@$teb->ClientId.UniqueThread); kv 1;", stackTracesOutput))
-	{
-		dprintf("Cannot get stack traces.\n");
+	IMemoryReader *memory_reader = OpenMemoryReader(DebugClient, DebugControl, logger, is_dump);
 
-		DebugClient->SetOutputCallbacks(nullptr);
+	auto wap = WaitApiStackParser(memory_reader, logger);
 
-		DebugControl->Release();
-		DebugClient->Release();
+	auto handles = std::vector<std::pair<unsigned long, unsigned long>>();
+	auto waited_upon_others = std::vector<std::tuple<unsigned long, unsigned long, std::string>>();
 
-		return;
+	// Get top stack frames from the dump threads, or from stack traces.
+	auto top_frames = std::vector<PartialStackFrame>();
+
+	if (is_dump)
+	{
+		auto stack_reader = MinidumpStackReader(*_targetDump, memory_reader, logger);
+
+		top_frames = stack_reader.get_top_frames();
 	}
 
-	IMemoryReader *memory_reader = &DbgEngMemoryReader();
+	if (!top_frames.empty())
+	{
+		wap.GetHandlesAndAddresses(top_frames, handles, waited_upon_others);
+	}
+	else
+	{
+		std::string stackTracesOutput;
 
-	auto wap = WaitApiStackParser(memory_reader, logger);
+		if (!executor->ExecuteCommand("~*e ?@@c++(@$teb->ClientId.UniqueThread); kv 1;", stackTracesOutput))
+		{
+			dprintf("Cannot get stack traces.\n");
 
-	auto handles = std::vector<std::pair<unsigned long, unsigned long>>();
-	auto waited_upon_others = std::vector<std::tuple<unsigned long, unsigned long, std::string>>();
+			DebugClient->SetOutputCallbacks(nullptr);
+
+			DebugControl->Release();
+			DebugClient->Release();
 
-	wap.GetHandlesAndAddresses(stackTracesOutput, handles, waited_upon_others);
+			return;
+		}
+
+		wap.GetHandlesAndAddresses(stackTracesOutput, handles, waited_upon_others);
+	}
 
 	// Save wait graph.
 	bool save_graph = this->HasArg("dot");
@@ -323,15 +731,35 @@ EXT_COMMAND(waitingforobjects,
 		dot_file << "digraph {\n";
 	}
 
-	// TODO need to find MethodTable of SafeWaitHandle and pass it to DumpHeap.
-	// Find SafeWaitHandle objects in the heap.
-	auto dumpheap = DumpHeapCommandParser(executor, logger);
-	auto dumpheap_output = dumpheap.execute("Microsoft.Win32.SafeHandles.SafeWaitHandle");
+	// Find SafeWaitHandle objects with the heap scan shared by commands, or with !dumpheap.
+	auto object_reader = GetManagedObjectReader(DebugClient, DebugControl, logger);
 
-	auto swh_parser = SafeWaitHandleParser(memory_reader, logger);
-	auto swh_output = swh_parser.execute(dumpheap_output);
+	std::shared_ptr<std::map<unsigned long, unsigned long>> handle_address;
 
-	auto handle_address = swh_output.get_handle_addresses();
+	if (object_reader)
+	{
+		AttachMethodTableCache(DebugClient, executor, memory_reader, logger);
+
+		auto swh_query = _heapScan.add_query("Microsoft.Win32.SafeHandles.SafeWaitHandle");
+
+		auto dumpheap_output = DumpHeapCommandOutput();
+
+		if (RunHeapScan(executor, memory_reader, is_dump, logger) && !_heapScan.get_query(swh_query).MethodTables.empty())
+		{
+			dumpheap_output = DumpHeapCommandOutput(_heapScan.get_query(swh_query).Addresses);
+		}
+		else
+		{
+			auto dumpheap = DumpHeapCommandParser(executor, logger);
+
+			dumpheap_output = dumpheap.execute("Microsoft.Win32.SafeHandles.SafeWaitHandle");
+		}
+
+		auto swh_parser = SafeWaitHandleParser(memory_reader, logger, object_reader);
+		auto swh_output = swh_parser.execute(dumpheap_output);
+
+		handle_address = swh_output.get_handle_addresses();
+	}
 
 	// WaitOnAddress and waiting on handles are exclusive.
 	for (auto waited_upon_value : waited_upon_others)
@@ -473,7 +901,23 @@ EXT_COMMAND(threadnames,
 	IDebuggerCommandExecutor *executor = &DbgEngCommandExecutor(DebugClient, DebugControl);
 	ILogger *logger = &DbgEngLogger();
 
-	IMemoryReader *memory_reader = &DbgEngMemoryReader();
+	bool is_dump = false;
+
+	IMemoryReader *memory_reader = OpenMemoryReader(DebugClient, DebugControl, logger, is_dump);
+
+	auto object_reader = GetManagedObjectReader(DebugClient, DebugControl, logger);
+
+	if (!object_reader)
+	{
+		DebugClient->SetOutputCallbacks(nullptr);
+
+		DebugControl->Release();
+		DebugClient->Release();
+
+		return;
+	}
+
+	AttachMethodTableCache(DebugClient, executor, memory_reader, logger);
 
 	auto dhp = DumpHeapCommandParser(executor, logger);
 
@@ -506,9 +950,14 @@ EXT_COMMAND(threadnames,
 	}
 	else
 	{
-		auto method_tables_output = dhp.find_method_tables("System.Threading.Thread");
+		method_tables = _methodTableCache.find_method_tables("System.Threading.Thread");
 
-		method_tables = *method_tables_output.get_method_tables();
+		if (method_tables.size() == 0)
+		{
+			auto method_tables_output = dhp.find_method_tables("System.Threading.Thread");
+
+			method_tables = *method_tables_output.get_method_tables();
+		}
 
 		if (method_tables.size() == 0)
 		{
@@ -523,60 +972,484 @@ EXT_COMMAND(threadnames,
 		}
 	}
 
-	auto thread_id_name = std::vector<std::pair<unsigned long, unsigned long>>();
-
-#pragma push_macro("ReadMemory")
-#undef ReadMemory
-	for (auto mt : method_tables)
-	{
-		auto addresses = dhp.execute_by_mt(mt);
+	// Find Thread objects with the heap scan shared by commands, or one !dumpheap per MethodTable.
+	auto thread_query = _heapScan.add_query("System.Threading.Thread", method_tables);
 
-		if (!addresses.has_addresses())
-		{
-			continue;
-		}
+	CompressedAddressSet thread_set;
 
-		for (auto address : *addresses.get_addresses())
+	if (RunHeapScan(executor, memory_reader, is_dump, logger))
+	{
+		thread_set = _heapScan.get_query(thread_query).Addresses;
+	}
+	else
+	{
+		for (auto mt : method_tables)
 		{
-			unsigned long thread_name_address = 0;
-
-			unsigned long bytes_read = 0;
+			auto addresses = dhp.execute_by_mt(mt);
 
-			// read memory.
-			memory_reader->ReadMemory(address + 0xc, &thread_name_address, sizeof(unsigned long), &bytes_read);
-
-			if (bytes_read && thread_name_address)
+			if (addresses.has_addresses())
 			{
-				// read Id and address.
-				unsigned long managed_thread_id = 0;
-
-				bytes_read = 0;
+				thread_set = CompressedAddressSet::unite(thread_set, addresses.get_addresses());
+			}
+		}
+	}
 
-				memory_reader->ReadMemory(address + 0x28, &managed_thread_id, sizeof(unsigned long), &bytes_read);
+	auto thread_addresses = thread_set.to_vector();
 
-				if (bytes_read && managed_thread_id)
-				{
-					unsigned long thread_name_address_string = 0;
+	auto thread_id_name = std::vector<std::pair<unsigned long, unsigned long>>();
 
-					bytes_read = 0;
+	// Read name and id fields of all Thread objects with one vectored read, at offsets of the target runtime.
+	std::vector<ManagedThreadFields> fields;
 
-					auto str_ptr = thread_name_address + 0x8;
+	object_reader->read_threads(memory_reader, thread_addresses, fields);
 
-					// We have an ID and a name.
-					thread_id_name.push_back(std::make_pair(managed_thread_id, str_ptr));
-				}
-			}
+	for (auto& field : fields)
+	{
+		if (field.IsRead && field.Name && field.ManagedThreadId)
+		{
+			// We have an ID and a name.
+			thread_id_name.push_back(std::make_pair(static_cast<unsigned long>(field.ManagedThreadId), static_cast<unsigned long>(field.Name)));
 		}
 	}
-#pragma pop_macro("ReadMemory")
 
 	std::sort(thread_id_name.begin(), thread_id_name.end(), [](std::pair<unsigned long, unsigned long> a, std::pair<unsigned long, unsigned long> b){ return a.first < b.first; });
 
-	dprintf(" CLR TID Name\n");
+	// Read all names at once instead of one engine read per %mu.
+	std::vector<unsigned long> name_addresses;
 
 	for (auto pair : thread_id_name)
 	{
-		dprintf("%8d %mu\n", pair.first, pair.second);
+		name_addresses.push_back(pair.second);
+	}
+
+	// Names are kept as UTF-16, narrow output would be shown in the ANSI code page.
+	auto names = ManagedStringReader(memory_reader, logger).read_wide(name_addresses);
+
+	dprintf(" CLR TID Name\n");
+
+	for (size_t i = 0; i < thread_id_name.size(); i++)
+	{
+		this->Out(L"%8d %ws\n", thread_id_name[i].first, reinterpret_cast<const wchar_t*>(names.get(i)));
+	}
+
+	DebugClient->SetOutputCallbacks(nullptr);
+
+	DebugControl->Release();
+	DebugClient->Release();
+}
+
+/**
+Implements heapstat command of this extension.
+*/
+EXT_COMMAND(heapstat,
+	"Lists object counts and total sizes per type from one walk of the GC heap, later calls on dump targets filter the same walk until the heap changes.",
+	"{sort;s,o;sort;Sort by count or bytes, default is bytes.}"
+	"{top;ed,o,d=20;top;Number of types to list, 0 for all.}"
+	"{type;s,o;type;Type name prefix.}"
+	"{gen;ed,o;gen;Generation 0, 1, 2 or 3 for the large object heap.}"
+	"{segment;x,o;segment;An address in the segment.}"
+	)
+{
+	PDEBUG_CLIENT DebugClient;
+	PDEBUG_CONTROL DebugControl;
+
+	DebugCreate(__uuidof(IDebugClient), (void **) &DebugClient);
+
+	DebugClient->QueryInterface(__uuidof(IDebugControl), (void **) &DebugControl);
+
+	ExtensionApis.nSize = sizeof(ExtensionApis);
+	DebugControl->GetWindbgExtensionApis64(&ExtensionApis);
+
+	g_OutputCb.Reset();
+
+	// Install output callbacks.
+	if ((DebugClient->SetOutputCallbacks((PDEBUG_OUTPUT_CALLBACKS) &g_OutputCb)) != S_OK)
+	{
+		dprintf("Error while installing OutputCallback.\n\n");
+
+		DebugControl->Release();
+		DebugClient->Release();
+
+		return;
+	}
+
+	HeapStatQuery query;
+
+	query.Top = (size_t) this->GetArgU64("top");
+
+	if (this->HasArg("sort"))
+	{
+		auto sort = std::string(this->GetArgStr("sort"));
+
+		if (sort == "count")
+		{
+			query.Sort = HeapStatSort::Count;
+		}
+		else if (sort != "bytes")
+		{
+			dprintf("sort parameter must be count or bytes.\n");
+
+			DebugClient->SetOutputCallbacks(nullptr);
+
+			DebugControl->Release();
+			DebugClient->Release();
+
+			return;
+		}
+	}
+
+	if (this->HasArg("type"))
+	{
+		query.TypePrefix = this->GetArgStr("type");
+	}
+
+	if (this->HasArg("gen"))
+	{
+		auto generation = this->GetArgU64("gen");
+
+		if (generation > HeapStatistics::LARGE_OBJECT_GENERATION)
+		{
+			dprintf("gen parameter must be 0, 1, 2 or 3.\n");
+
+			DebugClient->SetOutputCallbacks(nullptr);
+
+			DebugControl->Release();
+			DebugClient->Release();
+
+			return;
+		}
+
+		query.Generation = (int) generation;
+	}
+
+	if (this->HasArg("segment"))
+	{
+		query.Segment = (unsigned long) this->GetArgU64("segment");
+	}
+
+	IDebuggerCommandExecutor *executor = &DbgEngCommandExecutor(DebugClient, DebugControl);
+	ILogger *logger = &DbgEngLogger();
+
+	bool is_dump = false;
+
+	IMemoryReader *memory_reader = OpenMemoryReader(DebugClient, DebugControl, logger, is_dump);
+
+	AttachMethodTableCache(DebugClient, executor, memory_reader, logger);
+
+	auto eeheap_parser = EEHeapCommandParser(executor, logger);
+	auto eeheap_output = eeheap_parser.execute();
+
+	if (!eeheap_output.has_ranges())
+	{
+		dprintf("Cannot find GC heap segments, check if SOS is loaded.\n");
+
+		DebugClient->SetOutputCallbacks(nullptr);
+
+		DebugControl->Release();
+		DebugClient->Release();
+
+		return;
+	}
+
+	// Walk again only if segments or generations changed since the last walk, live targets may allocate without changing them.
+	if (is_dump && _heapStatistics && _heapStatistics->matches(eeheap_output.get_ranges(), eeheap_output.get_generation_starts()))
+	{
+		dprintf("Using heap statistics of the previous walk.\n");
+	}
+	else
+	{
+		if (!is_dump)
+		{
+			_gcHeapBoundaryIndex.clear();
+		}
+
+		ParallelGCHeapWalker walker(eeheap_output.get_ranges(), memory_reader, &_methodTableCache, &_gcHeapBoundaryIndex, logger);
+
+		_heapStatistics.reset(new HeapStatistics(eeheap_output.get_ranges(), eeheap_output.get_generation_starts()));
+
+		if (!_heapStatistics->collect(walker))
+		{
+			dprintf("Heap walk did not complete, statistics are partial.\n");
+		}
+	}
+
+	auto result = _heapStatistics->query(query, &_methodTableCache);
+
+	dprintf("      MT        Count    TotalSize Class Name\n");
+
+	for (auto& row : result.Rows)
+	{
+		dprintf("%08x %12I64u %12I64u %s\n", row.MethodTable, row.Count, row.Bytes, row.Name.c_str());
+	}
+
+	dprintf("Total %I64u objects, %I64u bytes in %Iu types.\n", result.Count, result.Bytes, result.Types);
+
+	DebugClient->SetOutputCallbacks(nullptr);
+
+	DebugControl->Release();
+	DebugClient->Release();
+}
+
+/**
+Implements referrers command of this extension.
+*/
+EXT_COMMAND(referrers,
+	"Lists objects referencing an object and objects it references, from a reference graph built with one walk of the GC heap, kept for dump targets until the heap changes.",
+	"{;x,o;address;An address in the object.}"
+	"{save;s,o;file;Saves the reference graph to a binary file.}"
+	)
+{
+	PDEBUG_CLIENT DebugClient;
+	PDEBUG_CONTROL DebugControl;
+
+	DebugCreate(__uuidof(IDebugClient), (void **) &DebugClient);
+
+	DebugClient->QueryInterface(__uuidof(IDebugControl), (void **) &DebugControl);
+
+	ExtensionApis.nSize = sizeof(ExtensionApis);
+	DebugControl->GetWindbgExtensionApis64(&ExtensionApis);
+
+	g_OutputCb.Reset();
+
+	// Install output callbacks.
+	if ((DebugClient->SetOutputCallbacks((PDEBUG_OUTPUT_CALLBACKS) &g_OutputCb)) != S_OK)
+	{
+		dprintf("Error while installing OutputCallback.\n\n");
+
+		DebugControl->Release();
+		DebugClient->Release();
+
+		return;
+	}
+
+	if (!this->HasUnnamedArg(0) && !this->HasArg("save"))
+	{
+		dprintf("An object address or the save parameter is required.\n");
+
+		DebugClient->SetOutputCallbacks(nullptr);
+
+		DebugControl->Release();
+		DebugClient->Release();
+
+		return;
+	}
+
+	IDebuggerCommandExecutor *executor = &DbgEngCommandExecutor(DebugClient, DebugControl);
+	ILogger *logger = &DbgEngLogger();
+
+	bool is_dump = false;
+
+	IMemoryReader *memory_reader = OpenMemoryReader(DebugClient, DebugControl, logger, is_dump);
+
+	AttachMethodTableCache(DebugClient, executor, memory_reader, logger);
+
+	if (!BuildReferenceGraph(executor, memory_reader, is_dump, logger))
+	{
+		DebugClient->SetOutputCallbacks(nullptr);
+
+		DebugControl->Release();
+		DebugClient->Release();
+
+		return;
+	}
+
+	if (this->HasArg("save"))
+	{
+		auto path = std::string(this->GetArgStr("save"));
+
+		if (_referenceGraph->save(path))
+		{
+			dprintf("Reference graph saved to %s\n", path.c_str());
+		}
+		else
+		{
+			dprintf("Cannot write %s\n", path.c_str());
+		}
+	}
+
+	if (this->HasUnnamedArg(0))
+	{
+		auto node = _referenceGraph->find_node((unsigned long) this->GetUnnamedArgU64(0));
+
+		if (node == ReferenceGraph::NOT_FOUND)
+		{
+			dprintf("Address is not in an object on the GC heap.\n");
+		}
+		else
+		{
+			auto print = [&](const char* title, const ReferenceNodeRange& nodes)
+			{
+				std::vector<unsigned long> method_tables;
+
+				for (auto other : nodes)
+				{
+					method_tables.push_back(_referenceGraph->get_method_table(other));
+				}
+
+				_methodTableCache.load_names(method_tables);
+
+				dprintf("%s (%Iu):\n", title, nodes.size());
+
+				for (auto other : nodes)
+				{
+					auto method_table = _referenceGraph->get_method_table(other);
+
+					dprintf("  %08x %08x %8u %s\n", _referenceGraph->get_address(other), method_table, _referenceGraph->get_size(other), _methodTableCache.get_name(method_table).c_str());
+				}
+			};
+
+			auto method_table = _referenceGraph->get_method_table(node);
+
+			dprintf("Object %08x %s\n", _referenceGraph->get_address(node), _methodTableCache.get_name(method_table).c_str());
+
+			print("Referenced by", _referenceGraph->get_referrers(node));
+			print("References", _referenceGraph->get_references(node));
+		}
+	}
+
+	DebugClient->SetOutputCallbacks(nullptr);
+
+	DebugControl->Release();
+	DebugClient->Release();
+}
+
+/**
+Implements retained command of this extension.
+*/
+EXT_COMMAND(retained,
+	"Lists types or objects retaining the most memory, from the dominator tree of the reference graph rooted at strong handles and stack objects.",
+	"{top;ed,o,d=20;top;Number of rows to list, 0 for all.}"
+	"{objects;b,o;objects;List objects instead of types.}"
+	)
+{
+	PDEBUG_CLIENT DebugClient;
+	PDEBUG_CONTROL DebugControl;
+
+	DebugCreate(__uuidof(IDebugClient), (void **) &DebugClient);
+
+	DebugClient->QueryInterface(__uuidof(IDebugControl), (void **) &DebugControl);
+
+	ExtensionApis.nSize = sizeof(ExtensionApis);
+	DebugControl->GetWindbgExtensionApis64(&ExtensionApis);
+
+	g_OutputCb.Reset();
+
+	// Install output callbacks.
+	if ((DebugClient->SetOutputCallbacks((PDEBUG_OUTPUT_CALLBACKS) &g_OutputCb)) != S_OK)
+	{
+		dprintf("Error while installing OutputCallback.\n\n");
+
+		DebugControl->Release();
+		DebugClient->Release();
+
+		return;
+	}
+
+	auto top = (size_t) this->GetArgU64("top");
+
+	IDebuggerCommandExecutor *executor = &DbgEngCommandExecutor(DebugClient, DebugControl);
+	ILogger *logger = &DbgEngLogger();
+
+	bool is_dump = false;
+
+	IMemoryReader *memory_reader = OpenMemoryReader(DebugClient, DebugControl, logger, is_dump);
+
+	AttachMethodTableCache(DebugClient, executor, memory_reader, logger);
+
+	if (!BuildReferenceGraph(executor, memory_reader, is_dump, logger))
+	{
+		DebugClient->SetOutputCallbacks(nullptr);
+
+		DebugControl->Release();
+		DebugClient->Release();
+
+		return;
+	}
+
+	if (!_dominatorTree)
+	{
+		auto roots_parser = GCRootsCommandParser(executor, logger);
+		auto roots = roots_parser.execute();
+
+		// A 32-bit debugger cannot address the working arrays of large heaps, refuse instead of failing halfway.
+		MEMORYSTATUSEX memory_status;
+
+		memory_status.dwLength = sizeof(memory_status);
+
+		auto needed = DominatorTree::get_build_memory_size(_referenceGraph->get_node_count());
+
+		if (GlobalMemoryStatusEx(&memory_status) && needed > memory_status.ullAvailVirtual)
+		{
+			dprintf("Dominator tree of %Iu objects needs %Iu MB, only %I64u MB of address space are free. Use a debugger with more address space or a smaller dump.\n", _referenceGraph->get_node_count(), needed >> 20, memory_status.ullAvailVirtual >> 20);
+
+			DebugClient->SetOutputCallbacks(nullptr);
+
+			DebugControl->Release();
+			DebugClient->Release();
+
+			return;
+		}
+
+		_dominatorTree.reset(new DominatorTree());
+
+		if (!_dominatorTree->build(*_referenceGraph, roots))
+		{
+			_dominatorTree.reset();
+
+			dprintf("Cannot build the dominator tree of %Iu objects, the graph is empty or its working arrays do not fit in memory.\n", _referenceGraph->get_node_count());
+
+			DebugClient->SetOutputCallbacks(nullptr);
+
+			DebugControl->Release();
+			DebugClient->Release();
+
+			return;
+		}
+
+		dprintf("Dominator tree has %Iu roots in %Iu bytes, %Iu objects are not reachable from roots and rooted separately.\n", _dominatorTree->get_root_count(), _dominatorTree->memory_size(), _dominatorTree->get_unrooted_count());
+	}
+
+	if (this->HasArg("objects"))
+	{
+		auto nodes = _dominatorTree->get_top_objects(top);
+
+		std::vector<unsigned long> method_tables;
+
+		for (auto node : nodes)
+		{
+			method_tables.push_back(_referenceGraph->get_method_table(node));
+		}
+
+		_methodTableCache.load_names(method_tables);
+
+		dprintf("  Object       MT     Size  RetainedSize Class Name\n");
+
+		for (auto node : nodes)
+		{
+			auto method_table = _referenceGraph->get_method_table(node);
+
+			dprintf("%08x %08x %8u %13I64u %s\n", _referenceGraph->get_address(node), method_table, _referenceGraph->get_size(node), _dominatorTree->get_retained_size(node), _methodTableCache.get_name(method_table).c_str());
+		}
+	}
+	else
+	{
+		auto rows = _dominatorTree->get_top_types(top);
+
+		std::vector<unsigned long> method_tables;
+
+		for (auto& row : rows)
+		{
+			method_tables.push_back(row.MethodTable);
+		}
+
+		_methodTableCache.load_names(method_tables);
+
+		dprintf("      MT        Count    TotalSize  RetainedSize Class Name\n");
+
+		for (auto& row : rows)
+		{
+			dprintf("%08x %12I64u %12I64u %13I64u %s\n", row.MethodTable, row.Count, row.Bytes, row.RetainedBytes, _methodTableCache.get_name(row.MethodTable).c_str());
+		}
 	}
 
 	DebugClient->SetOutputCallbacks(nullptr);
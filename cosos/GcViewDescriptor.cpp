@@ -29,282 +29,605 @@
 Implements GcViewDescriptor class that can render a combined view of native and CLR heap snapshots.
 */
 
+#include <algorithm>
+
 #include "GcViewDescriptor.h"
 
 /**
-Gets an empty pixmap.
+Image buffers of all descriptors, released buffers are reused by the next render.
+*/
+static ImageBufferPool BufferPool;
+
+/**
+Gets an empty pixmap, created once per descriptor.
 */
 const QPixmap GcViewDescriptor::getNullPixmap()
 {
-	auto whiteImage = new QImage(IMAGE_WIDTH, IMAGE_HEIGHT, QImage::Format::Format_ARGB32);
+	if (_nullPixmap.isNull())
+	{
+		QImage whiteImage(_imageWidth, _imageHeight, QImage::Format::Format_ARGB32);
 
-	whiteImage->fill(Qt::GlobalColor::white);
+		whiteImage.fill(Qt::GlobalColor::white);
 
-	auto pixmap = QPixmap::fromImage(*whiteImage);
+		_nullPixmap = QPixmap::fromImage(whiteImage);
+	}
 
-	return pixmap;
+	return _nullPixmap;
 }
 
 /**
-Saves png images for native and gc heap ranges.
+Saves images for native and gc heap ranges, without Qt.
 
 \param ranges Native ranges.
 \param gcRanges CLR GC ranges.
-\param filename Native png filename.
-\param gcFilename CLR GC png filename.
+\param filename Native image filename.
+\param gcFilename CLR GC image filename.
+\param format Image format.
+\return false if an image cannot be written.
 */
-void GcViewDescriptor::saveImages(RangeList ranges, RangeList gcRanges, const char* filename, const char* gcFilename)
+bool GcViewDescriptor::saveImages(RangeList ranges, RangeList gcRanges, const char* filename, const char* gcFilename, ImageFormat format)
 {
 	GcViewDescriptor descriptor;
 
 	descriptor._ranges = ranges;
 	descriptor._gcRanges = gcRanges;
 
-	descriptor.saveImages(filename, gcFilename);
+	return descriptor.saveImages(filename, gcFilename, format);
 }
 
 /**
-Saves png images for native and gc heap ranges.
+Saves images for native and gc heap ranges, without Qt.
 
-\param filename Native png filename.
-\param gcFilename CLR GC png filename.
+\param filename Native image filename.
+\param gcFilename CLR GC image filename.
+\param format Image format.
+\return false if an image cannot be written.
 */
-void GcViewDescriptor::saveImages(const char* filename, const char* gcFilename)
+bool GcViewDescriptor::saveImages(const char* filename, const char* gcFilename, ImageFormat format)
 {
-	auto buffers = getImageBuffers();
+	ImageBuffer image;
+	ImageBuffer gcImage;
+
+	getImageBuffers(image, gcImage);
+
+	auto is_saved = true;
 
 	if (filename)
 	{
-		if (buffers.first == nullptr)
-		{
-			getNullPixmap().save(filename);
-		}
-		else
-		{
-			auto image = QImage(buffers.first, 2048, 512, QImage::Format::Format_RGB32);
+		is_saved = saveImage(image, filename, format) && is_saved;
+	}
+
+	if (gcFilename)
+	{
+		is_saved = saveImage(gcImage, gcFilename, format) && is_saved;
+	}
 
-			image.save(filename, "png");
+	return is_saved;
+}
 
-			delete buffers.first;
-		}
+/**
+Saves SVG images of merged native and GC ranges with address tooltips, without rendering pages. Images have one unit per page in columns of IMAGE_HEIGHT pages,
+scaled to the size of the maps.
+
+\param filename Native image filename.
+\param gcFilename CLR GC image filename.
+\return false if an image cannot be written.
+*/
+bool GcViewDescriptor::saveSvgs(const char* filename, const char* gcFilename) const
+{
+	HeapMapSvgExporter exporter(IMAGE_WIDTH, IMAGE_HEIGHT);
+
+	auto is_saved = true;
+
+	if (filename)
+	{
+		exporter.add_layer(_ranges);
+
+		is_saved = exporter.save(filename, _imageWidth, _imageHeight) && is_saved;
 	}
 
 	if (gcFilename)
 	{
-		if (buffers.second == nullptr)
-		{
-			getNullPixmap().save(gcFilename);
-		}
-		else
-		{
-			auto image = QImage(buffers.second, 2048, 512, QImage::Format::Format_RGB32);
+		exporter.clear_layers();
+		exporter.add_layer(_ranges, true);
+		exporter.add_layer(_gcRanges);
 
-			image.save(gcFilename, "png");
+		is_saved = exporter.save(gcFilename, _imageWidth, _imageHeight) && is_saved;
+	}
 
-			delete buffers.second;
-		}
+	return is_saved;
+}
+
+/**
+Saves an image buffer, or a white image if the buffer is empty.
+
+\param buffer Image buffer.
+\param filename Image filename.
+\param format Image format.
+*/
+bool GcViewDescriptor::saveImage(const ImageBuffer& buffer, const char* filename, ImageFormat format) const
+{
+	if (buffer.empty())
+	{
+		auto whiteImage = BufferPool.acquire(_imageWidth, _imageHeight);
+
+		std::fill_n(reinterpret_cast<unsigned int*>(whiteImage.data()), (size_t) _imageWidth * _imageHeight, 0xFFFFFFFF);
+
+		return HeapMapImageExporter::save(whiteImage.data(), _imageWidth, _imageHeight, filename, format);
 	}
+
+	return HeapMapImageExporter::save(buffer.data(), buffer.get_width(), buffer.get_height(), filename, format);
 }
 
 /**
-Creates and returns image buffers.
+Renders image buffers taken from the buffer pool. Ranges of visible usages are drawn once for each map, the GC map over a monochrome native map,
+without the masks the window keeps to show and hide usages.
+Rasterizers of the descriptor are reused, so repeated renders do not allocate pages or pixels.
+
+\param image Receives the native map, empty if there are no native ranges.
+\param gcImage Receives the GC map, empty if there are no GC ranges.
+\return false if there are no ranges.
 */
-const std::pair<unsigned char*, unsigned char*> GcViewDescriptor::getImageBuffers()
+bool GcViewDescriptor::getImageBuffers(ImageBuffer& image, ImageBuffer& gcImage)
 {
-	unsigned char* image = nullptr;
-	unsigned char* gcImage = nullptr;
+	image.reset();
+	gcImage.reset();
 
 	if (_ranges == nullptr && _gcRanges == nullptr)
 	{
-		return std::make_pair(nullptr, nullptr);
+		return false;
 	}
-	else if (_ranges == nullptr && _gcRanges != nullptr)
+
+	if (isAggregated())
 	{
-		image = createImage(_gcRanges);
+		getAggregatedImageBuffers(image, gcImage);
 
-		return std::make_pair(nullptr, image);
+		return true;
 	}
-	else if (_ranges != nullptr && _gcRanges == nullptr)
+
+	setVisibleUsages(_rasterizer);
+
+	_rasterizer.set_curve(_curve);
+
+	if (_ranges != nullptr)
 	{
-		image = createImage(_ranges);
+		_rasterizer.clear();
+		_rasterizer.draw(_ranges);
+
+		image = BufferPool.acquire(_imageWidth, _imageHeight);
 
-		return std::make_pair(image, nullptr);
+		_rasterizer.copy_to(image.data());
 	}
-	else
+
+	if (_gcRanges != nullptr)
 	{
-		image = createImage(_ranges);
+		_rasterizer.clear();
+		_rasterizer.draw(_ranges, true);
+		_rasterizer.draw(_gcRanges);
 
-		gcImage = createImage(_ranges, _gcRanges);
+		gcImage = BufferPool.acquire(_imageWidth, _imageHeight);
 
-		return std::make_pair(image, gcImage);
+		_rasterizer.copy_to(gcImage.data());
 	}
+
+	return true;
 }
 
 /**
-Creates image buffer for native and gc heap ranges.
+Renders aggregated image buffers, each pixel shows the bytes of usages it covers.
 
-\param ranges Native ranges.
-\param gcRanges CLR GC ranges.
+\param image Receives the native map, empty if there are no native ranges.
+\param gcImage Receives the GC map, empty if there are no GC ranges.
 */
-unsigned char* GcViewDescriptor::createImage(RangeList ranges, RangeList gcRanges)
+void GcViewDescriptor::getAggregatedImageBuffers(ImageBuffer& image, ImageBuffer& gcImage)
 {
-	auto buffer = createImage(ranges, true);
+	if (_ranges != nullptr)
+	{
+		HeapMapAggregator aggregator(_imageWidth, _imageHeight, _aggregation);
+
+		setVisibleUsages(aggregator);
+
+		aggregator.set_curve(_curve);
+		aggregator.add_layer(_ranges);
+
+		image = BufferPool.acquire(_imageWidth, _imageHeight);
+
+		aggregator.render(image.data());
+	}
+
+	if (_gcRanges != nullptr)
+	{
+		HeapMapAggregator aggregator(_imageWidth, _imageHeight, _aggregation);
+
+		setVisibleUsages(aggregator);
+
+		aggregator.set_curve(_curve);
+
+		if (_ranges != nullptr)
+		{
+			aggregator.add_layer(_ranges, true);
+		}
+
+		aggregator.add_layer(_gcRanges);
 
-	drawImage(buffer, gcRanges);
+		gcImage = BufferPool.acquire(_imageWidth, _imageHeight);
 
-	return buffer;
+		aggregator.render(gcImage.data());
+	}
 }
 
 /**
-Creates image buffer for native and gc heap ranges.
+Sets size of the maps, maps of IMAGE_WIDTH x IMAGE_HEIGHT pixels are not aggregated unless an aggregation is set.
 
-\param ranges Native ranges.
-\param isMonochrome True if to be drawn as monochrome.
+\param width Width of the maps in pixels.
+\param height Height of the maps in pixels.
 */
-unsigned char* GcViewDescriptor::createImage(RangeList ranges, bool isMonochrome)
+void GcViewDescriptor::setImageSize(unsigned int width, unsigned int height)
 {
-	auto buffer = new unsigned char[4 * IMAGE_WIDTH * IMAGE_HEIGHT];
+	if (width == _imageWidth && height == _imageHeight)
+	{
+		return;
+	}
+
+	_imageWidth = width;
+	_imageHeight = height;
+
+	HeapMapCompositor compositor(width, height);
 
-	memset(buffer, 0x80, 4 * IMAGE_WIDTH * IMAGE_HEIGHT);
+	setVisibleUsages(compositor);
 
-	drawImage(buffer, ranges, isMonochrome);
+	_rasterizer = HeapMapRasterizer(width, height);
+	_gcRasterizer = HeapMapRasterizer(width, height);
+	_compositor = compositor;
+	_nullPixmap = QPixmap();
 
-	return buffer;
+	if (!HeapMapHilbertCurve::is_supported(width, height))
+	{
+		_layout = HeapMapLayout::Columns;
+	}
+
+	updateCurve();
+	resetImages();
 }
 
 /**
-Draws native and gc heap ranges to an image buffer.
+Sets how usages under a pixel are combined, maps are aggregated after an aggregation is set.
 
-\param buffer Image buffer.
-\param ranges Native ranges.
-\param isMonochrome True if to be drawn as monochrome.
+\param aggregation Dominant usage or blended usage colors.
 */
-void GcViewDescriptor::drawImage(unsigned char* buffer, RangeList ranges, bool isMonochrome)
+void GcViewDescriptor::setAggregation(HeapMapAggregation aggregation)
 {
-	const unsigned int PAGE_SIZE = 4096;
+	_isAggregated = true;
+	_aggregation = aggregation;
+
+	resetImages();
+}
 
-	if (ranges == nullptr || ranges->size() == 0)
+/**
+Lays out pixels of the maps in columns or along a Hilbert curve.
+
+\param layout Layout of the maps.
+\return false if the maps cannot be laid out along a Hilbert curve, the layout is not changed.
+*/
+bool GcViewDescriptor::setLayout(HeapMapLayout layout)
+{
+	if (layout == HeapMapLayout::Hilbert && !HeapMapHilbertCurve::is_supported(_imageWidth, _imageHeight))
 	{
-		return;
+		return false;
 	}
 
-	for (auto mr : *ranges)
+	if (layout != _layout)
 	{
-		unsigned int x = mr.Address / PAGE_SIZE / IMAGE_HEIGHT;
-		unsigned int y = (mr.Address / PAGE_SIZE) % IMAGE_HEIGHT;
+		_layout = layout;
+
+		updateCurve();
+		resetImages();
+	}
 
-		QRgb c;
+	return true;
+}
+
+/**
+Creates the Hilbert curve of the layout once for the size of the maps, shared by the compositor and aggregators.
+*/
+void GcViewDescriptor::updateCurve()
+{
+	_curve = _layout == HeapMapLayout::Hilbert ? std::make_shared<const HeapMapHilbertCurve>(_imageWidth, _imageHeight) : nullptr;
+
+	_compositor.set_curve(_curve);
+}
 
-		if (isMonochrome && mr.Usage != Usage::Free)
+/**
+Shows or hides ranges of a usage on both maps, maps are composited again with updateLayers.
+
+\param usage Usage.
+\param is_visible True to show ranges of the usage.
+*/
+void GcViewDescriptor::setUsageVisible(Usage usage, bool is_visible)
+{
+	_compositor.set_visible(usage, is_visible);
+}
+
+/**
+Checks if ranges of a usage are shown.
+
+\param usage Usage.
+*/
+bool GcViewDescriptor::isUsageVisible(Usage usage) const
+{
+	return _compositor.is_visible(usage);
+}
+
+/**
+Checks if pixels of the maps aggregate usages instead of showing a single page.
+*/
+bool GcViewDescriptor::isAggregated() const
+{
+	return _isAggregated || (unsigned long long) _imageWidth * _imageHeight * HeapMapRasterizer::PAGE_SIZE != HeapMapAggregator::ADDRESS_SPACE_SIZE;
+}
+
+/**
+Drops maps of the last update, the next update renders whole maps.
+*/
+void GcViewDescriptor::resetImages()
+{
+	_image.reset();
+	_gcImage.reset();
+	_spans.clear();
+	_gcSpans.clear();
+}
+
+/**
+Updates multi-resolution pyramids of the native and GC maps for changed ranges, from one page per pixel to one pixel for the whole address space. The maps of the last update are kept with their final pixels as spans of pages,
+only columns where spans of the last and the current ranges differ are composited from masks of visible usages, and only pyramid pixels covering them are computed again.
+Masks are kept between updates, so an update renders only pages of changed ranges to masks and showing or hiding usages with updateLayers does not render ranges.
+Ranges lists must not be changed after they are set, a new list is set for each snapshot.
+
+\param pyramid Native map pyramid of the last update, cleared if there are no native ranges.
+\param gcPyramid GC map pyramid of the last update, cleared if there are no GC ranges.
+\param rects Receives changed rectangles of the native map.
+\param gcRects Receives changed rectangles of the GC map.
+*/
+void GcViewDescriptor::updatePyramids(HeapMapPyramid& pyramid, HeapMapPyramid& gcPyramid, std::vector<HeapMapRect>& rects, std::vector<HeapMapRect>& gcRects)
+{
+	rects.clear();
+	gcRects.clear();
+
+	if (isAggregated())
+	{
+		// Aggregated pixels have no spans to compare, maps are rendered again.
+		_compositor.clear();
+
+		getImageBuffers(_image, _gcImage);
+
+		if (!_image.empty())
 		{
-			c = getColor(mr.State, Usage::Undefined);
+			rects.push_back(HeapMapRect(0, 0, _imageWidth, _imageHeight));
 		}
-		else
+
+		if (!_gcImage.empty())
 		{
-			c = getColor(mr.State, mr.Usage);
+			gcRects.push_back(HeapMapRect(0, 0, _imageWidth, _imageHeight));
 		}
+	}
+	else
+	{
+		_rasterizer.clear_layers();
+		_gcRasterizer.clear_layers();
 
-		if (mr.Size > PAGE_SIZE)
+		std::shared_ptr<const HeapMapRangeIndex> index;
+
+		if (_ranges != nullptr)
 		{
-			unsigned int numPages = mr.Size / PAGE_SIZE;
+			index = std::make_shared<const HeapMapRangeIndex>(_ranges);
+
+			_rasterizer.add_layer(index);
 
-			for (int pos = 0; pos < numPages; pos++)
+			getChangedRects(_rasterizer, _image, _spans, rects);
+		}
+		else
+		{
+			_image.reset();
+			_spans.clear();
+		}
+
+		if (_gcRanges != nullptr)
+		{
+			if (index)
 			{
-				if (y == IMAGE_HEIGHT)
-				{
-					y = 0;
-					x++;
-				}
-
-				// TODO check input.
-				if (x > IMAGE_WIDTH)
-				{
-					continue;
-				}
-
-				if (y > IMAGE_HEIGHT)
-				{
-					continue;
-				}
-
-				buffer[4 * (y * IMAGE_WIDTH + x)] = qRed(c);
-				buffer[4 * (y * IMAGE_WIDTH + x) + 1] = qGreen(c);
-				buffer[4 * (y * IMAGE_WIDTH + x) + 2] = qBlue(c);
-
-				y++;
+				_gcRasterizer.add_layer(index, true);
 			}
+
+			_gcRasterizer.add_layer(_gcRanges);
+
+			getChangedRects(_gcRasterizer, _gcImage, _gcSpans, gcRects);
+		}
+		else
+		{
+			_gcImage.reset();
+			_gcSpans.clear();
+		}
+
+		// Layers keep the ranges alive, release them until the next update.
+		_rasterizer.clear_layers();
+		_gcRasterizer.clear_layers();
+
+		updateMasks();
+
+		compositeImages(_image, _gcImage, rects, gcRects);
+
+		// Changed columns are spans of pages along a Hilbert curve, pixels of the maps are in squares of the curve.
+		if (_curve)
+		{
+			getCurveRects(rects);
+			getCurveRects(gcRects);
 		}
 	}
+
+	updateLevels(pyramid, gcPyramid, rects, gcRects);
 }
 
 /**
-Gets the color for the specified state and usage.
+Composites the maps of the last update again from the masks of their usages, after usages are shown or hidden. Ranges are not rendered again,
+unless the maps are aggregated or have no masks.
 
-\param state State.
-\param usage Usage.
+\param pyramid Native map pyramid of the last update.
+\param gcPyramid GC map pyramid of the last update.
+\param rects Receives changed rectangles of the native map.
+\param gcRects Receives changed rectangles of the GC map.
 */
-QRgb GcViewDescriptor::getColor(State state, Usage usage)
+void GcViewDescriptor::updateLayers(HeapMapPyramid& pyramid, HeapMapPyramid& gcPyramid, std::vector<HeapMapRect>& rects, std::vector<HeapMapRect>& gcRects)
 {
-	if (state == State::Undefined)
-		return QRgb(0x808080);
-	if (usage == Usage::Free)
-		return QRgb(0xFFFFFF);
+	if (isAggregated() || _compositor.get_layer_count() == 0)
+	{
+		resetImages();
+
+		updatePyramids(pyramid, gcPyramid, rects, gcRects);
+
+		return;
+	}
 
-	if (usage == Usage::EnvironmentBlock || usage == Usage::PEB || usage == Usage::ProcessParameters || usage == Usage::TEB || usage == Usage::Stack)
+	rects.clear();
+	gcRects.clear();
+
+	if (!_image.empty())
 	{
-		if (state == State::Commit)
-			return QRgb(0x800080);
-		else
-			return QRgb(0xFFC0CB);
+		rects.push_back(HeapMapRect(0, 0, _imageWidth, _imageHeight));
 	}
 
-	if (usage == Usage::Heap)
+	if (!_gcImage.empty())
 	{
-		if (state == State::Commit)
-			return QRgb(0x0000FF);
-		else
-			return QRgb(0xADD8E6);
+		gcRects.push_back(HeapMapRect(0, 0, _imageWidth, _imageHeight));
 	}
 
-	if (usage == Usage::Image)
+	compositeImages(_image, _gcImage, rects, gcRects);
+
+	updateLevels(pyramid, gcPyramid, rects, gcRects);
+}
+
+/**
+Updates pyramid levels for changed rectangles of the maps, pyramids of maps without images are cleared.
+
+\param pyramid Native map pyramid.
+\param gcPyramid GC map pyramid.
+\param rects Changed rectangles of the native map.
+\param gcRects Changed rectangles of the GC map.
+*/
+void GcViewDescriptor::updateLevels(HeapMapPyramid& pyramid, HeapMapPyramid& gcPyramid, const std::vector<HeapMapRect>& rects, const std::vector<HeapMapRect>& gcRects) const
+{
+	if (_image.empty())
 	{
-		if (state == State::Commit)
-			return QRgb(0x8B0000);
-		else
-			return QRgb(0XFF0000);
+		pyramid.clear();
+	}
+	else
+	{
+		pyramid.update(_image.data(), _image.get_width(), _image.get_height(), rects);
 	}
 
-	if (usage == Usage::VirtualAlloc)
+	if (_gcImage.empty())
 	{
-		if (state == State::Commit)
-			return QRgb(0x008000);
-		else
-			return QRgb(0xADFF2F);
+		gcPyramid.clear();
 	}
+	else
+	{
+		gcPyramid.update(_gcImage.data(), _gcImage.get_width(), _gcImage.get_height(), gcRects);
+	}
+}
 
-	if (usage == Usage::PageHeap)
+/**
+Renders the native ranges and the GC ranges to masks of their usages. Native masks are rendered once and composited to both maps.
+Masks of the last update are kept, only pages of ranges that changed since then are rendered again.
+*/
+void GcViewDescriptor::updateMasks()
+{
+	if (_compositor.get_layer_count() == 0)
 	{
-		if (state == State::Commit)
-			return QRgb(0x000000);
-		else
-			return QRgb(0x2F4F4F);
+		_compositor.add_layer(_ranges);
+		_compositor.add_layer(_gcRanges);
 	}
+	else
+	{
+		_compositor.update_layer(NATIVE_LAYER, _ranges);
+		_compositor.update_layer(GC_LAYER, _gcRanges);
+	}
+}
 
-	if (usage == Usage::GCHeap)
+/**
+Composites rectangles of the native map and the GC map, drawn over a monochrome native map, from the masks of visible usages.
+
+\param image Native map, not composited if empty.
+\param gcImage GC map, not composited if empty.
+\param rects Rectangles of the native map to composite.
+\param gcRects Rectangles of the GC map to composite.
+*/
+void GcViewDescriptor::compositeImages(ImageBuffer& image, ImageBuffer& gcImage, const std::vector<HeapMapRect>& rects, const std::vector<HeapMapRect>& gcRects) const
+{
+	std::vector<HeapMapComposition> maps;
+
+	if (!image.empty())
 	{
-		if (state == State::Commit)
-			return QRgb(0x00FF7F);
-		else
-			return QRgb(0xADFF2F);
+		maps.push_back(HeapMapComposition(image.data(), _imageWidth, _imageHeight));
+
+		maps.back().add_layer(NATIVE_LAYER);
+		maps.back().Rects = rects;
 	}
 
-	if (usage == Usage::GCLOHeap)
+	if (!gcImage.empty())
 	{
-		if (state == State::Commit)
-			return QRgb(0x006400);
-		else
-			return QRgb(0x32CD32);
+		maps.push_back(HeapMapComposition(gcImage.data(), _imageWidth, _imageHeight));
+
+		maps.back().add_layer(NATIVE_LAYER, true);
+		maps.back().add_layer(GC_LAYER);
+		maps.back().Rects = gcRects;
 	}
 
-	return QRgb(0x808080);
+	_compositor.composite_parallel(maps);
+}
+
+/**
+Replaces changed rectangles of columns with the squares of the Hilbert curve covering their pages, from the first row of the first column to the last row of the last column.
+
+\param rects Changed rectangles of columns, receives the squares.
+*/
+void GcViewDescriptor::getCurveRects(std::vector<HeapMapRect>& rects) const
+{
+	std::vector<HeapMapRect> columns;
+
+	columns.swap(rects);
+
+	for (auto& column : columns)
+	{
+		auto firstPage = (unsigned long) column.X * _imageHeight + column.Y;
+		auto endPage = (unsigned long) (column.X + column.Width - 1) * _imageHeight + column.Y + column.Height;
+
+		_curve->get_rects(firstPage, endPage, rects);
+	}
 }
+
+/**
+Gets changed rectangles of a map from spans of its layers, the whole map changes if it has no image from the last update.
+
+\param rasterizer Rasterizer with the layers of the map.
+\param image Image of the map from the last update, acquired if empty.
+\param spans Spans of the last update, replaced by the current spans.
+\param rects Receives changed rectangles.
+*/
+void GcViewDescriptor::getChangedRects(const HeapMapRasterizer& rasterizer, ImageBuffer& image, std::vector<HeapMapSpan>& spans, std::vector<HeapMapRect>& rects)
+{
+	std::vector<HeapMapSpan> current;
+
+	rasterizer.get_spans(current);
+
+	if (image.empty())
+	{
+		image = BufferPool.acquire(rasterizer.get_width(), rasterizer.get_height());
+
+		rects.assign(1, HeapMapRect(0, 0, rasterizer.get_width(), rasterizer.get_height()));
+	}
+	else
+	{
+		rasterizer.get_changed_rects(spans, current, rects);
+	}
+
+	spans.swap(current);
+}
\ No newline at end of file
@@ -39,11 +39,21 @@ Defines the GcViewDescriptor class.
 #include <qpixmap.h>
 
 #include "MemoryRange.h"
+#include "HeapMapRasterizer.h"
+#include "HeapMapPyramid.h"
+#include "ImageBufferPool.h"
+#include "HeapMapImageExporter.h"
+#include "HeapMapAggregator.h"
+#include "HeapMapCompositor.h"
+#include "HeapMapHilbertCurve.h"
+#include "HeapMapSvgExporter.h"
 
 /**
 \class GcViewDescriptor
 
 Represents renderable heap information.
+Maps of IMAGE_WIDTH x IMAGE_HEIGHT pixels have one pixel per page, maps of other sizes or with an aggregation set count the bytes of usages under each pixel.
+Pixels are laid out in columns, or along a Hilbert curve for maps with a power of two side.
 */
 class GcViewDescriptor
 {
@@ -51,13 +61,50 @@ private:
 	static const int IMAGE_WIDTH = 2048;
 	static const int IMAGE_HEIGHT = 512;
 
-	static unsigned char* createImage(RangeList ranges, RangeList gcRanges);
-	static unsigned char* createImage(RangeList ranges, bool isMonochrome = false);
-	static void drawImage(unsigned char* image, RangeList ranges, bool isMonochrome = false);
-
-	void updateImages();
+	// Layers of the compositor, the native layer is also composited in monochrome under the GC layer.
+	static const unsigned int NATIVE_LAYER = 0;
+	static const unsigned int GC_LAYER = 1;
+
+	unsigned int _imageWidth = IMAGE_WIDTH;
+	unsigned int _imageHeight = IMAGE_HEIGHT;
+	bool _isAggregated = false;
+	HeapMapAggregation _aggregation = HeapMapAggregation::Dominant;
+	HeapMapLayout _layout = HeapMapLayout::Columns;
+	std::shared_ptr<const HeapMapHilbertCurve> _curve;
+
+	HeapMapRasterizer _rasterizer;
+	HeapMapRasterizer _gcRasterizer;
+	HeapMapCompositor _compositor;
+	QPixmap _nullPixmap;
+
+	ImageBuffer _image;
+	ImageBuffer _gcImage;
+	std::vector<HeapMapSpan> _spans;
+	std::vector<HeapMapSpan> _gcSpans;
+
+	static void getChangedRects(const HeapMapRasterizer& rasterizer, ImageBuffer& image, std::vector<HeapMapSpan>& spans, std::vector<HeapMapRect>& rects);
+
+	bool saveImage(const ImageBuffer& buffer, const char* filename, ImageFormat format) const;
+	void getAggregatedImageBuffers(ImageBuffer& image, ImageBuffer& gcImage);
+	void resetImages();
+	void updateCurve();
+	void updateMasks();
+
+	/**
+	Copies visibility of usages to a rasterizer, a compositor or an aggregator.
+	*/
+	template<typename Renderer>
+	void setVisibleUsages(Renderer& renderer) const
+	{
+		for (unsigned int usage = 0; usage <= (unsigned int) Usage::GCLOHeap; usage++)
+		{
+			renderer.set_visible((Usage) usage, _compositor.is_visible((Usage) usage));
+		}
+	}
 
-	static QRgb getColor(State state, Usage usage);
+	void getCurveRects(std::vector<HeapMapRect>& rects) const;
+	void compositeImages(ImageBuffer& image, ImageBuffer& gcImage, const std::vector<HeapMapRect>& rects, const std::vector<HeapMapRect>& gcRects) const;
+	void updateLevels(HeapMapPyramid& pyramid, HeapMapPyramid& gcPyramid, const std::vector<HeapMapRect>& rects, const std::vector<HeapMapRect>& gcRects) const;
 
 public:
 	std::string _freeblockinfo;
@@ -67,14 +114,31 @@ public:
 	RangeList _ranges = nullptr;
 	RangeList _gcRanges = nullptr;
 
-	void saveImages(const char* filename, const char* gcFilename);
-	static void saveImages(RangeList ranges, RangeList gcRanges, const char* filename, const char* gcFilename);
+	bool saveImages(const char* filename, const char* gcFilename, ImageFormat format = ImageFormat::Png);
+	static bool saveImages(RangeList ranges, RangeList gcRanges, const char* filename, const char* gcFilename, ImageFormat format = ImageFormat::Png);
+	bool saveSvgs(const char* filename, const char* gcFilename) const;
+
+	void setImageSize(unsigned int width, unsigned int height);
+	void setAggregation(HeapMapAggregation aggregation);
+	bool isAggregated() const;
+
+	bool setLayout(HeapMapLayout layout);
+	HeapMapLayout getLayout() const { return _layout; }
+
+	void setUsageVisible(Usage usage, bool is_visible);
+	bool isUsageVisible(Usage usage) const;
+
+	unsigned int getImageWidth() const { return _imageWidth; }
+	unsigned int getImageHeight() const { return _imageHeight; }
 
-	const std::pair<unsigned char*, unsigned char*> GcViewDescriptor::getImageBuffers();
+	bool getImageBuffers(ImageBuffer& image, ImageBuffer& gcImage);
+	void updatePyramids(HeapMapPyramid& pyramid, HeapMapPyramid& gcPyramid, std::vector<HeapMapRect>& rects, std::vector<HeapMapRect>& gcRects);
+	void updateLayers(HeapMapPyramid& pyramid, HeapMapPyramid& gcPyramid, std::vector<HeapMapRect>& rects, std::vector<HeapMapRect>& gcRects);
 
 	const QPixmap getNullPixmap();
 
 	GcViewDescriptor()
+		: _rasterizer(IMAGE_WIDTH, IMAGE_HEIGHT), _gcRasterizer(IMAGE_WIDTH, IMAGE_HEIGHT), _compositor(IMAGE_WIDTH, IMAGE_HEIGHT)
 	{
 	}
 };
@@ -33,6 +33,7 @@ Implements WaitApiStackParser for stack trace outputs calling kernel wait APIs.
 #include "WaitApiStackParser.h"
 
 const int OBJECT_COUNT_1 = 101;
+const unsigned long MAX_WAIT_OBJECT_COUNT = 64;
 
 std::map<std::string, std::pair<unsigned long, unsigned long>> WaitApiStackParser::_symbol_object = {
 	/* symbol_name, count_arg_number, address_arg_number */
@@ -282,51 +283,77 @@ Parses objectDescriptors and fills handles and addresses vectors.
 /// <param name="addresses">The addresses.</param>
 void WaitApiStackParser::GetHandlesAndAddresses(const std::vector<const KernelObjectDescriptor>* objectDescriptors, std::vector<std::pair<unsigned long, unsigned long>>& handles, std::vector<std::tuple<unsigned long, unsigned long, std::string>>& others)
 {
-	for (auto descriptor : *objectDescriptors)
+	// Handle arrays of all threads are read with a single vectored read.
+	std::vector<std::vector<unsigned long>> handle_arrays(objectDescriptors->size());
+
+	std::vector<MemoryReadRequest> requests;
+
+	for (size_t i = 0; i < objectDescriptors->size(); i++)
 	{
-		if (!descriptor.is_handle())
+		auto descriptor = objectDescriptors->at(i);
+
+		if (!descriptor.is_handle() || !descriptor.is_value_address())
 		{
-			others.push_back(std::make_tuple(descriptor.get_thread_id(), descriptor.get_value(), descriptor.get_name()));
+			continue;
+		}
+
+		unsigned long count = descriptor.get_count();
+
+		if (count == 0)
+		{
+			_logger->Log("Multiple object count is zero in thread %x\n", descriptor.get_thread_id());
 
 			continue;
 		}
 
-		if (descriptor.is_value_address())
+		if (count == KernelObjectDescriptor::VALUE_NOT_FOUND)
 		{
-			unsigned long count = descriptor.get_count();
+			_logger->Log("Multiple object count value not found in thread %x\n", descriptor.get_thread_id());
 
-			if (count == 0)
-			{
-				_logger->Log("Multiple object count is zero in thread %x\n", descriptor.get_thread_id());
+			continue;
+		}
 
-				continue;
-			}
+		if (count > MAX_WAIT_OBJECT_COUNT)
+		{
+			_logger->Log("Multiple object count %x is too large in thread %x\n", count, descriptor.get_thread_id());
 
-			if (count == KernelObjectDescriptor::VALUE_NOT_FOUND)
-			{
-				_logger->Log("Multiple object count value not found in thread %x\n", descriptor.get_thread_id());
+			continue;
+		}
 
-				continue;
-			}
+		handle_arrays[i].resize(count);
 
-			auto handle_addresses = new unsigned long[count];
+		requests.push_back(MemoryReadRequest(descriptor.get_value(), sizeof(unsigned long) * count, handle_arrays[i].data()));
+	}
 
-			memset(handle_addresses, 0xFFFFFFFF, count);
+	_memory_reader->ReadMany(requests);
+
+	auto request = requests.begin();
+
+	for (size_t i = 0; i < objectDescriptors->size(); i++)
+	{
+		auto descriptor = objectDescriptors->at(i);
+
+		if (!descriptor.is_handle())
+		{
+			others.push_back(std::make_tuple(descriptor.get_thread_id(), descriptor.get_value(), descriptor.get_name()));
 
-			unsigned long bytes_read = 0;
+			continue;
+		}
 
-			// read memory.
-			_memory_reader->ReadMemory(descriptor.get_value(), handle_addresses, sizeof(unsigned long) * count, &bytes_read);
+		if (descriptor.is_value_address())
+		{
+			if (handle_arrays[i].empty())
+			{
+				continue;
+			}
 
-			if (bytes_read)
+			if ((request++)->succeeded)
 			{
-				for (int i = 0; i < count; i++)
+				for (auto handle : handle_arrays[i])
 				{
-					handles.push_back(std::make_pair(descriptor.get_thread_id(), handle_addresses[i]));
+					handles.push_back(std::make_pair(descriptor.get_thread_id(), handle));
 				}
 			}
-
-			delete handle_addresses;
 		}
 		else
 		{
@@ -352,5 +379,35 @@ void WaitApiStackParser::GetHandlesAndAddresses(const std::string& command_outpu
 
 	GetHandlesAndAddresses(objectDescriptors, handles, others);
 
+	delete objectDescriptors;
+}
+
+/**
+Parses objectDescriptors and fills handles and addresses vectors.
+
+\param top_frames Top stack frames of all threads, with thread ids.
+\param handles Parsed handles.
+\param addresses Parsed addresses.
+*/
+void WaitApiStackParser::GetHandlesAndAddresses(const std::vector<PartialStackFrame>& top_frames, std::vector<std::pair<unsigned long, unsigned long>>& handles, std::vector<std::tuple<unsigned long, unsigned long, std::string>>& others)
+{
+	auto objectDescriptors = new std::vector<const KernelObjectDescriptor>();
+
+	for (auto& stackFrame : top_frames)
+	{
+		auto objectDescriptor = ParseObjectDescriptor(stackFrame);
+
+		if (objectDescriptor.get_value() == KernelObjectDescriptor::VALUE_NOT_FOUND)
+		{
+			continue;
+		}
+
+		objectDescriptor.set_thread_id(stackFrame.thread_id);
+
+		objectDescriptors->push_back(objectDescriptor);
+	}
+
+	GetHandlesAndAddresses(objectDescriptors, handles, others);
+
 	delete objectDescriptors;
 }
\ No newline at end of file
@@ -40,29 +40,7 @@ Defines the WaitApiStackParser class.
 
 #include "IMemoryReader.h"
 #include "ILogger.h"
-
-/**
-\class PartialStackFrame
-
-Represents an ChildEBP, return address and first three arguments of a stack frame.
-*/
-class PartialStackFrame
-{
-	// 13 12f2e5b8 7071b7ad 12f2e5f8 8e188ec4 12f2e804 clr!MethodDescCallSite::CallTargetWorker+0x152 (FPO: [Non-Fpo])
-
-public:
-	bool _is_valid = true;
-
-	unsigned long child_ebp;
-	unsigned long ret_address;
-	unsigned long arg1;
-	unsigned long arg2;
-	unsigned long arg3;
-	std::string symbol_name;
-	unsigned long symbol_offset;
-
-	bool isValid() { return _is_valid; }
-};
+#include "PartialStackFrame.h"
 
 /**
 \class KernelObjectDescriptor
@@ -128,6 +106,7 @@ private:
 
 public:
 	void GetHandlesAndAddresses(const std::string& command_output, std::vector<std::pair<unsigned long, unsigned long>>& handles, std::vector<std::tuple<unsigned long, unsigned long, std::string>>& others);
+	void GetHandlesAndAddresses(const std::vector<PartialStackFrame>& top_frames, std::vector<std::pair<unsigned long, unsigned long>>& handles, std::vector<std::tuple<unsigned long, unsigned long, std::string>>& others);
 
 	WaitApiStackParser(IMemoryReader *memory_reader, ILogger *logger)
 		: _memory_reader(memory_reader), _logger(logger)
@@ -0,0 +1,66 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file FakeHeap.h
+
+Defines the FakeHeap class.
+*/
+
+#ifndef __FAKEHEAP_H__
+
+#define __FAKEHEAP_H__
+
+#include <map>
+
+#include "IMemoryReader.h"
+
+/**
+\class FakeHeap
+
+Represents sparse target memory holding x86 CLR method tables and objects.
+*/
+class FakeHeap : public IMemoryReader
+{
+private:
+	std::map<unsigned long, unsigned char> _bytes;
+
+public:
+	unsigned long _reads = 0;
+	bool _is_thread_safe = false;
+
+	void write_u8(unsigned long address, unsigned char value);
+	void write_u16(unsigned long address, unsigned short value);
+	void write_u32(unsigned long address, unsigned long value);
+
+	void add_method_table(unsigned long method_table, unsigned long base_size, unsigned long component_size, unsigned long parent_method_table = 0);
+	unsigned long add_object(unsigned long address, unsigned long method_table, unsigned long base_size, unsigned long component_size, unsigned long component_count);
+
+	virtual unsigned long ReadMemory(unsigned long offset, void *lpBuffer, unsigned long cb, unsigned long* lpcbBytesRead) override;
+
+	virtual bool IsThreadSafe() override { return _is_thread_safe; }
+};
+
+#endif // #ifndef __FAKEHEAP_H__
\ No newline at end of file
@@ -0,0 +1,65 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file FakeMemoryReader.h
+
+Defines the FakeMemoryReader class.
+*/
+
+#ifndef __FAKEMEMORYREADER_H__
+
+#define __FAKEMEMORYREADER_H__
+
+#include <functional>
+
+#include "IMemoryReader.h"
+
+/**
+\class FakeMemoryReader
+
+Represents a memory reader that invokes a lambda and counts the reads.
+*/
+class FakeMemoryReader : public IMemoryReader
+{
+public:
+	typedef std::function<unsigned long(unsigned long, void*, unsigned long, unsigned long*)> ReadLambda;
+
+private:
+	ReadLambda _read_lambda;
+
+public:
+	unsigned long _reads = 0;
+
+	FakeMemoryReader(ReadLambda read_lambda)
+		: _read_lambda(read_lambda)
+	{
+
+	}
+
+	virtual unsigned long ReadMemory(unsigned long offset, void *lpBuffer, unsigned long cb, unsigned long* lpcbBytesRead) override;
+};
+
+#endif // #ifndef __FAKEMEMORYREADER_H__
\ No newline at end of file
@@ -0,0 +1,74 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file FakeMinidump.h
+
+Defines the FakeMinidump class.
+*/
+
+#ifndef __FAKEMINIDUMP_H__
+
+#define __FAKEMINIDUMP_H__
+
+#include <vector>
+#include <utility>
+
+/**
+\class FakeMinidump
+
+Builds minidump file contents in memory.
+*/
+class FakeMinidump
+{
+private:
+	static const unsigned long DIRECTORY_RVA = 32;
+	static const unsigned long MAX_STREAMS = 16;
+	static const unsigned long DATA_RVA = DIRECTORY_RVA + 12 * MAX_STREAMS;
+
+	bool _is_memory64;
+	unsigned long _stream_count = 0;
+
+	std::vector<std::pair<unsigned long long, std::vector<unsigned char>>> _memory;
+
+	void add_directory_entry(unsigned long type, unsigned long size, unsigned long rva);
+
+public:
+	std::vector<unsigned char> _data;
+
+	FakeMinidump(bool is_memory64 = true);
+
+	unsigned long add_blob(const std::vector<unsigned char>& bytes);
+	void add_stream(unsigned long type, const std::vector<unsigned char>& bytes);
+	void add_memory(unsigned long long address, const std::vector<unsigned char>& bytes);
+
+	const std::vector<unsigned char>& build();
+
+	static void append_u16(std::vector<unsigned char>& bytes, unsigned short value);
+	static void append_u32(std::vector<unsigned char>& bytes, unsigned long value);
+	static void append_u64(std::vector<unsigned char>& bytes, unsigned long long value);
+};
+
+#endif // #ifndef __FAKEMINIDUMP_H__
\ No newline at end of file
@@ -0,0 +1,62 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+/**
+\file FakeRanges.h
+
+Defines the FakeRanges class.
+*/
+
+#ifndef __FAKERANGES_H__
+
+#define __FAKERANGES_H__
+
+#include <vector>
+
+#include "MemoryRange.h"
+
+/**
+\class FakeRanges
+
+Creates memory ranges for heap map tests from a seeded linear congruential generator, so the same seed gives the same ranges.
+*/
+class FakeRanges
+{
+private:
+	unsigned int _seed;
+
+public:
+	explicit FakeRanges(unsigned int seed)
+		: _seed(seed)
+	{
+
+	}
+
+	unsigned int next();
+
+	RangeList create_overlapping(size_t count, const std::vector<Usage>& usages);
+	RangeList create_consecutive(size_t count, const std::vector<Usage>& usages, unsigned int max_pages, unsigned int max_gap_pages, bool is_page_aligned);
+};
+
+#endif // #ifndef __FAKERANGES_H__
\ No newline at end of file
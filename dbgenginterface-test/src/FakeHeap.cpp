@@ -0,0 +1,116 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file FakeHeap.cpp
+
+Implements FakeHeap class that serves reads from sparse target memory.
+*/
+
+#include "FakeHeap.h"
+
+void FakeHeap::write_u8(unsigned long address, unsigned char value)
+{
+	_bytes[address] = value;
+}
+
+void FakeHeap::write_u16(unsigned long address, unsigned short value)
+{
+	write_u8(address, value & 0xFF);
+	write_u8(address + 1, (value >> 8) & 0xFF);
+}
+
+void FakeHeap::write_u32(unsigned long address, unsigned long value)
+{
+	write_u16(address, value & 0xFFFF);
+	write_u16(address + 2, (value >> 16) & 0xFFFF);
+}
+
+/**
+Writes flags, base size and parent of a method table.
+
+\param method_table Address of the method table.
+\param base_size Base size of instances.
+\param component_size Size of array elements or characters, zero for other types.
+\param parent_method_table Address of the parent method table.
+*/
+void FakeHeap::add_method_table(unsigned long method_table, unsigned long base_size, unsigned long component_size, unsigned long parent_method_table)
+{
+	write_u32(method_table, component_size != 0 ? 0x80000000 | component_size : 0);
+	write_u32(method_table + 4, base_size);
+	write_u32(method_table + 8, 0);
+	write_u32(method_table + 0xc, 0);
+	write_u32(method_table + 0x10, parent_method_table);
+}
+
+/**
+Writes the method table pointer and component count of an object, and zeroes its fields.
+
+\return Size of the object aligned to pointer size.
+*/
+unsigned long FakeHeap::add_object(unsigned long address, unsigned long method_table, unsigned long base_size, unsigned long component_size, unsigned long component_count)
+{
+	auto size = (base_size + component_size * component_count + 3) & ~3UL;
+
+	for (unsigned long i = 0; i < size; i += 4)
+	{
+		write_u32(address + i, 0);
+	}
+
+	write_u32(address, method_table);
+	write_u32(address + 4, component_count);
+
+	return size;
+}
+
+/**
+Copies written bytes, stops at the first byte that is not written.
+
+\param offset Address to read from.
+\param lpBuffer Buffer to copy the memory to.
+\param cb Number of bytes to read.
+\param lpcbBytesRead Number of bytes read.
+*/
+unsigned long FakeHeap::ReadMemory(unsigned long offset, void *lpBuffer, unsigned long cb, unsigned long* lpcbBytesRead)
+{
+	// Reads are not counted when shared by threads.
+	if (!_is_thread_safe)
+	{
+		_reads++;
+	}
+
+	auto buffer = static_cast<unsigned char*>(lpBuffer);
+
+	unsigned long count = 0;
+
+	for (auto it = _bytes.find(offset); count < cb && it != _bytes.end() && it->first == offset + count; ++it)
+	{
+		buffer[count++] = it->second;
+	}
+
+	*lpcbBytesRead = count;
+
+	return count == cb;
+}
\ No newline at end of file
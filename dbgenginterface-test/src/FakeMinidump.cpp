@@ -0,0 +1,196 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file FakeMinidump.cpp
+
+Implements FakeMinidump class that builds minidump file contents in memory.
+*/
+
+#include <algorithm>
+
+#include "FakeMinidump.h"
+
+/**
+Constructs an instance of the FakeMinidump class with a header and an empty stream directory.
+
+\param is_memory64 True to store memory in a Memory64ListStream, false for a MemoryListStream.
+*/
+FakeMinidump::FakeMinidump(bool is_memory64)
+	: _is_memory64(is_memory64), _data(DATA_RVA)
+{
+	_data[0] = 'M';
+	_data[1] = 'D';
+	_data[2] = 'M';
+	_data[3] = 'P';
+}
+
+/**
+Appends bytes to the file.
+
+\param bytes Bytes to append.
+\return File offset of the bytes.
+*/
+unsigned long FakeMinidump::add_blob(const std::vector<unsigned char>& bytes)
+{
+	auto rva = static_cast<unsigned long>(_data.size());
+
+	_data.insert(_data.end(), bytes.begin(), bytes.end());
+
+	return rva;
+}
+
+/**
+Appends a stream and adds it to the stream directory.
+
+\param type Stream type.
+\param bytes Stream data.
+*/
+void FakeMinidump::add_stream(unsigned long type, const std::vector<unsigned char>& bytes)
+{
+	auto rva = add_blob(bytes);
+
+	add_directory_entry(type, static_cast<unsigned long>(bytes.size()), rva);
+}
+
+/**
+Adds a range of target memory, written to the file by build.
+
+\param address Target address.
+\param bytes Memory contents.
+*/
+void FakeMinidump::add_memory(unsigned long long address, const std::vector<unsigned char>& bytes)
+{
+	_memory.push_back(std::make_pair(address, bytes));
+}
+
+/**
+Writes the memory list stream and the header.
+*/
+const std::vector<unsigned char>& FakeMinidump::build()
+{
+	std::vector<unsigned char> stream;
+
+	if (_is_memory64)
+	{
+		append_u64(stream, _memory.size());
+
+		// BaseRva follows the descriptors.
+		append_u64(stream, _data.size() + 16 + 16 * _memory.size());
+
+		for (auto& memory : _memory)
+		{
+			append_u64(stream, memory.first);
+			append_u64(stream, memory.second.size());
+		}
+
+		add_stream(9, stream);
+
+		for (auto& memory : _memory)
+		{
+			add_blob(memory.second);
+		}
+	}
+	else
+	{
+		append_u32(stream, static_cast<unsigned long>(_memory.size()));
+
+		auto rva = _data.size() + 4 + 16 * _memory.size();
+
+		for (auto& memory : _memory)
+		{
+			append_u64(stream, memory.first);
+			append_u32(stream, static_cast<unsigned long>(memory.second.size()));
+			append_u32(stream, static_cast<unsigned long>(rva));
+
+			rva += memory.second.size();
+		}
+
+		add_stream(5, stream);
+
+		for (auto& memory : _memory)
+		{
+			add_blob(memory.second);
+		}
+	}
+
+	std::vector<unsigned char> header;
+
+	append_u32(header, 0x504d444d);
+	append_u32(header, 0xa793);
+	append_u32(header, _stream_count);
+	append_u32(header, DIRECTORY_RVA);
+
+	std::copy(header.begin(), header.end(), _data.begin());
+
+	return _data;
+}
+
+/**
+Writes an entry to the stream directory.
+
+\param type Stream type.
+\param size Stream size.
+\param rva File offset of the stream.
+*/
+void FakeMinidump::add_directory_entry(unsigned long type, unsigned long size, unsigned long rva)
+{
+	std::vector<unsigned char> entry;
+
+	append_u32(entry, type);
+	append_u32(entry, size);
+	append_u32(entry, rva);
+
+	std::copy(entry.begin(), entry.end(), _data.begin() + DIRECTORY_RVA + 12 * _stream_count);
+
+	_stream_count++;
+}
+
+/**
+Appends a little endian 16 bit value.
+*/
+void FakeMinidump::append_u16(std::vector<unsigned char>& bytes, unsigned short value)
+{
+	bytes.push_back(value & 0xFF);
+	bytes.push_back((value >> 8) & 0xFF);
+}
+
+/**
+Appends a little endian 32 bit value.
+*/
+void FakeMinidump::append_u32(std::vector<unsigned char>& bytes, unsigned long value)
+{
+	append_u16(bytes, value & 0xFFFF);
+	append_u16(bytes, (value >> 16) & 0xFFFF);
+}
+
+/**
+Appends a little endian 64 bit value.
+*/
+void FakeMinidump::append_u64(std::vector<unsigned char>& bytes, unsigned long long value)
+{
+	append_u32(bytes, value & 0xFFFFFFFF);
+	append_u32(bytes, (value >> 32) & 0xFFFFFFFF);
+}
\ No newline at end of file
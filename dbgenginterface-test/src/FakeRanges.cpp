@@ -0,0 +1,107 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+/**
+\file FakeRanges.cpp
+
+Implements FakeRanges class that creates memory ranges for heap map tests.
+*/
+
+#include <algorithm>
+
+#include "FakeRanges.h"
+
+static const unsigned long long ADDRESS_SPACE_SIZE = 0x100000000ULL;
+static const unsigned long PAGE_SIZE = 4096;
+
+/**
+Returns the next 24 bits of the generator.
+*/
+unsigned int FakeRanges::next()
+{
+	_seed = _seed * 1103515245 + 12345;
+
+	return _seed >> 8;
+}
+
+/**
+Creates ranges of random sizes, usages and states over the whole address space, overlapping each other.
+
+\param count Number of ranges.
+\param usages Usages to pick from.
+*/
+RangeList FakeRanges::create_overlapping(size_t count, const std::vector<Usage>& usages)
+{
+	auto ranges = new std::vector<const MemoryRange>();
+
+	State states[] = { State::Commit, State::Reserve, State::Undefined };
+
+	for (size_t i = 0; i < count; i++)
+	{
+		auto address = (unsigned long) (next() << 8);
+		auto size = (unsigned long) (next() % 8 == 0 ? next() % (64 * 1024 * 1024) : next() % (5 * PAGE_SIZE));
+
+		ranges->push_back(MemoryRange(address, std::min(size, 0xFFFFFFFFUL - address), states[next() % 3], usages[next() % usages.size()]));
+	}
+
+	return RangeList(ranges);
+}
+
+/**
+Creates ranges in ascending order that start at page boundaries, stopping at the end of the address space.
+
+\param count Number of ranges.
+\param usages Usages to pick from.
+\param max_pages Largest range size in pages.
+\param max_gap_pages Largest number of pages between ranges.
+\param is_page_aligned false to end ranges before the end of their last page.
+*/
+RangeList FakeRanges::create_consecutive(size_t count, const std::vector<Usage>& usages, unsigned int max_pages, unsigned int max_gap_pages, bool is_page_aligned)
+{
+	auto ranges = new std::vector<const MemoryRange>();
+
+	State states[] = { State::Commit, State::Reserve, State::Undefined };
+
+	unsigned long long address = 0;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		address += PAGE_SIZE * (next() % (max_gap_pages + 1));
+
+		unsigned long long size = PAGE_SIZE * (1 + next() % max_pages) - (is_page_aligned ? 0 : next() % PAGE_SIZE);
+
+		size = std::min(size, ADDRESS_SPACE_SIZE - std::min(address, ADDRESS_SPACE_SIZE));
+
+		if (size == 0)
+		{
+			break;
+		}
+
+		ranges->push_back(MemoryRange((unsigned long) address, (unsigned long) size, states[next() % 3], usages[next() % usages.size()]));
+
+		address = (address + size + PAGE_SIZE - 1) & ~(unsigned long long) (PAGE_SIZE - 1);
+	}
+
+	return RangeList(ranges);
+}
\ No newline at end of file
@@ -0,0 +1,182 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file CachingMemoryReaderTest.cpp
+
+Implements CachingMemoryReaderTest class defines unit tests for CachingMemoryReader class.
+*/
+
+#include "..\stdafx.h"
+
+#include "CachingMemoryReader.h"
+#include "FakeMemoryReader.h"
+
+/**
+Creates a reader whose readable memory is [0x10000, 0x20000) and each byte is the low byte of its address.
+*/
+static FakeMemoryReader* CreateFakeMemoryReader()
+{
+	return new FakeMemoryReader(FakeMemoryReader::ReadLambda([](unsigned long offset, void* buffer, unsigned long cb, unsigned long* read)
+	{
+		unsigned long count = 0;
+
+		for (; count < cb; count++)
+		{
+			auto address = offset + count;
+
+			if (address < 0x10000 || address >= 0x20000)
+			{
+				break;
+			}
+
+			static_cast<unsigned char*>(buffer)[count] = address & 0xFF;
+		}
+
+		*read = count;
+
+		return count == cb;
+	}));
+}
+
+TEST(CachingMemoryReader, SmallReadsOnSamePage)
+{
+	auto fake = CreateFakeMemoryReader();
+
+	auto reader = CachingMemoryReader(fake, 16, 0);
+
+	for (unsigned long address = 0x10004; address < 0x10100; address += 0x10)
+	{
+		unsigned long value = 0;
+		unsigned long read = 0;
+
+		EXPECT_TRUE(reader.ReadMemory(address, &value, sizeof(value), &read) != 0);
+		EXPECT_EQ(read, sizeof(value));
+		EXPECT_EQ(value & 0xFF, address & 0xFF);
+	}
+
+	EXPECT_EQ(fake->_reads, 1);
+	EXPECT_EQ(reader.get_engine_reads(), 1);
+	EXPECT_EQ(reader.get_misses(), 1);
+	EXPECT_EQ(reader.get_hits(), 15);
+
+	delete fake;
+}
+
+TEST(CachingMemoryReader, ReadSpanningPages)
+{
+	auto fake = CreateFakeMemoryReader();
+
+	auto reader = CachingMemoryReader(fake, 16, 0);
+
+	unsigned char buffer[0x2000];
+	unsigned long read = 0;
+
+	EXPECT_TRUE(reader.ReadMemory(0x10800, buffer, sizeof(buffer), &read) != 0);
+	EXPECT_EQ(read, sizeof(buffer));
+	EXPECT_EQ(buffer[0], 0x00);
+	EXPECT_EQ(buffer[0x1FFF], 0xFF);
+
+	// Three pages fetched with one read.
+	EXPECT_EQ(fake->_reads, 1);
+	EXPECT_EQ(reader.get_cached_pages(), 3);
+
+	delete fake;
+}
+
+TEST(CachingMemoryReader, SequentialReadAhead)
+{
+	auto fake = CreateFakeMemoryReader();
+
+	auto reader = CachingMemoryReader(fake, 64, 4);
+
+	for (unsigned long address = 0x10000; address < 0x16000; address += 0x100)
+	{
+		unsigned long value = 0;
+		unsigned long read = 0;
+
+		reader.ReadMemory(address, &value, sizeof(value), &read);
+
+		EXPECT_EQ(read, sizeof(value));
+	}
+
+	// Page 0x10000, page 0x11000 with four pages read-ahead, then page 0x16000 is not needed.
+	EXPECT_EQ(fake->_reads, 2);
+	EXPECT_EQ(reader.get_cached_pages(), 6);
+
+	delete fake;
+}
+
+TEST(CachingMemoryReader, LeastRecentlyUsedEviction)
+{
+	auto fake = CreateFakeMemoryReader();
+
+	auto reader = CachingMemoryReader(fake, 2, 0);
+
+	unsigned long value = 0;
+	unsigned long read = 0;
+
+	reader.ReadMemory(0x10000, &value, sizeof(value), &read);
+	reader.ReadMemory(0x13000, &value, sizeof(value), &read);
+	reader.ReadMemory(0x10000, &value, sizeof(value), &read);
+	reader.ReadMemory(0x15000, &value, sizeof(value), &read);
+
+	EXPECT_EQ(fake->_reads, 3);
+	EXPECT_EQ(reader.get_cached_pages(), 2);
+
+	// 0x13000 was evicted, 0x10000 was kept.
+	reader.ReadMemory(0x10000, &value, sizeof(value), &read);
+	EXPECT_EQ(fake->_reads, 3);
+
+	reader.ReadMemory(0x13000, &value, sizeof(value), &read);
+	EXPECT_EQ(fake->_reads, 4);
+
+	delete fake;
+}
+
+TEST(CachingMemoryReader, PartiallyReadableMemory)
+{
+	auto fake = CreateFakeMemoryReader();
+
+	auto reader = CachingMemoryReader(fake, 16, 0);
+
+	unsigned char buffer[0x20];
+	unsigned long read = 0;
+
+	EXPECT_FALSE(reader.ReadMemory(0x1FFF0, buffer, sizeof(buffer), &read) != 0);
+	EXPECT_EQ(read, 0x10);
+
+	EXPECT_FALSE(reader.ReadMemory(0x20000, buffer, sizeof(buffer), &read) != 0);
+	EXPECT_EQ(read, 0);
+
+	// Unreadable page is remembered.
+	auto reads = fake->_reads;
+
+	EXPECT_FALSE(reader.ReadMemory(0x20010, buffer, sizeof(buffer), &read) != 0);
+	EXPECT_EQ(read, 0);
+	EXPECT_EQ(fake->_reads, reads);
+
+	delete fake;
+}
\ No newline at end of file
@@ -0,0 +1,160 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file CompressedAddressSetTest.cpp
+
+Implements CompressedAddressSetTest class defines unit tests for CompressedAddressSet and CompressedAddressSetBuilder classes.
+*/
+
+#include "..\stdafx.h"
+
+#include <random>
+#include <set>
+
+#include "CompressedAddressSet.h"
+
+/**
+Creates addresses of objects of random sizes, some far apart.
+*/
+static std::vector<unsigned long> CreateAddresses(std::mt19937& random, unsigned long start, size_t count)
+{
+	std::vector<unsigned long> addresses;
+
+	auto address = start;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		addresses.push_back(address);
+
+		address += 12 + 4 * (random() % 16);
+
+		if (random() % 100 == 0)
+		{
+			address += random() % 0x100000;
+		}
+	}
+
+	return addresses;
+}
+
+TEST(CompressedAddressSet, SameAsSortedVector)
+{
+	std::mt19937 random(1);
+
+	auto addresses = CreateAddresses(random, 0x02851000, 10000);
+
+	CompressedAddressSet set(addresses);
+
+	EXPECT_EQ(set.size(), addresses.size());
+	EXPECT_TRUE(set.to_vector() == addresses);
+
+	// Most differences take one byte.
+	EXPECT_LT(set.memory_size(), addresses.size() * sizeof(unsigned long) / 2);
+
+	for (size_t i = 0; i < addresses.size(); i += 97)
+	{
+		EXPECT_EQ(set.select(i), addresses[i]);
+		EXPECT_EQ(set.rank(addresses[i]), i);
+		EXPECT_EQ(set.rank(addresses[i] + 1), i + 1);
+		EXPECT_TRUE(set.contains(addresses[i]));
+		EXPECT_FALSE(set.contains(addresses[i] + 1));
+	}
+
+	EXPECT_EQ(set.rank(0), 0);
+	EXPECT_EQ(set.rank(0xffffffff), addresses.size());
+	EXPECT_TRUE(set.lower_bound(addresses.back() + 1) == set.end());
+	EXPECT_EQ(*set.lower_bound(addresses[500] - 1), addresses[500]);
+
+	CompressedAddressSet empty;
+
+	EXPECT_TRUE(empty.empty());
+	EXPECT_TRUE(empty.begin() == empty.end());
+	EXPECT_FALSE(empty.contains(0));
+	EXPECT_EQ(empty.rank(0x1000), 0);
+}
+
+TEST(CompressedAddressSet, IntersectAndUnite)
+{
+	std::mt19937 random(2);
+
+	auto a = CreateAddresses(random, 0x1000, 5000);
+
+	std::vector<unsigned long> b;
+
+	for (size_t i = 0; i < a.size(); i += 3)
+	{
+		b.push_back(a[i]);
+		b.push_back(a[i] + 4);
+	}
+
+	std::set<unsigned long> a_set(a.begin(), a.end());
+	std::set<unsigned long> b_set(b.begin(), b.end());
+
+	std::vector<unsigned long> expected_intersection;
+	std::vector<unsigned long> expected_union;
+
+	std::set_intersection(a_set.begin(), a_set.end(), b_set.begin(), b_set.end(), std::back_inserter(expected_intersection));
+	std::set_union(a_set.begin(), a_set.end(), b_set.begin(), b_set.end(), std::back_inserter(expected_union));
+
+	auto compressed_a = CompressedAddressSet(a);
+	auto compressed_b = CompressedAddressSet(b);
+
+	EXPECT_TRUE(CompressedAddressSet::intersect(compressed_a, compressed_b).to_vector() == expected_intersection);
+	EXPECT_TRUE(CompressedAddressSet::intersect(compressed_b, compressed_a).to_vector() == expected_intersection);
+	EXPECT_TRUE(CompressedAddressSet::unite(compressed_a, compressed_b).to_vector() == expected_union);
+	EXPECT_TRUE(CompressedAddressSet::unite(compressed_a, CompressedAddressSet()).to_vector() == a);
+	EXPECT_TRUE(CompressedAddressSet::intersect(compressed_a, CompressedAddressSet()).empty());
+}
+
+TEST(CompressedAddressSet, BuildsFromRuns)
+{
+	std::mt19937 random(3);
+
+	// Segments are listed out of address order.
+	auto first = CreateAddresses(random, 0x47981000, 1000);
+	auto second = CreateAddresses(random, 0x02851000, 300);
+	auto third = CreateAddresses(random, 0x29731000, 1);
+
+	CompressedAddressSetBuilder builder;
+
+	std::vector<unsigned long> all;
+
+	for (auto run : { &first, &second, &third })
+	{
+		for (auto address : *run)
+		{
+			builder.add(address);
+			all.push_back(address);
+		}
+	}
+
+	builder.add(third.back());
+
+	std::sort(all.begin(), all.end());
+
+	EXPECT_TRUE(builder.build().to_vector() == all);
+	EXPECT_TRUE(builder.build().empty());
+}
\ No newline at end of file
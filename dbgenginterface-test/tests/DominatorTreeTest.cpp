@@ -0,0 +1,282 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file DominatorTreeTest.cpp
+
+Implements DominatorTreeTest class defines unit tests for DominatorTree class.
+*/
+
+#include "..\stdafx.h"
+
+#include <deque>
+
+#include "DominatorTree.h"
+#include "FakeHeap.h"
+#include "FakeLogger.h"
+
+static const unsigned long MT_ARRAY = 0x5100;
+static const unsigned long MT_OTHER_ARRAY = 0x5200;
+static const unsigned long HEAP_START = 0x100000;
+
+static void AddArrayMethodTable(FakeHeap& heap, unsigned long method_table)
+{
+	heap.add_method_table(method_table, 12, 4);
+	heap.write_u32(method_table, MethodTableCache::HAS_COMPONENT_SIZE_FLAG | GCDesc::CONTAINS_POINTERS_FLAG | 4);
+	heap.write_u32(method_table - 4, 1);
+	heap.write_u32(method_table - 12, (unsigned long) -12);
+	heap.write_u32(method_table - 8, 8);
+}
+
+/**
+Creates an object array for each node, referencing the arrays of its edges.
+*/
+static RangeList CreateHeap(FakeHeap& heap, const std::vector<std::vector<unsigned int>>& edges, const std::vector<unsigned long>& method_tables, std::vector<unsigned long>& addresses)
+{
+	AddArrayMethodTable(heap, MT_ARRAY);
+	AddArrayMethodTable(heap, MT_OTHER_ARRAY);
+
+	auto address = HEAP_START;
+
+	for (size_t i = 0; i < edges.size(); i++)
+	{
+		addresses.push_back(address);
+
+		address += heap.add_object(address, method_tables[i], 12, 4, edges[i].size());
+	}
+
+	for (size_t i = 0; i < edges.size(); i++)
+	{
+		for (size_t j = 0; j < edges[i].size(); j++)
+		{
+			heap.write_u32(addresses[i] + 8 + 4 * j, addresses[edges[i][j]]);
+		}
+	}
+
+	auto ranges = new std::vector<const MemoryRange>();
+
+	ranges->push_back(MemoryRange(HEAP_START, address - HEAP_START, State::Commit, Usage::GCHeap));
+
+	return RangeList(ranges);
+}
+
+static bool BuildGraph(FakeHeap& heap, RangeList segments, ReferenceGraph& graph, FakeLogger* logger)
+{
+	MethodTableCache method_tables;
+
+	method_tables.attach(nullptr, &heap, logger);
+
+	ParallelGCHeapWalker walker(segments, &heap, &method_tables, nullptr, logger);
+
+	return graph.build(walker, &method_tables);
+}
+
+TEST(DominatorTree, SmallGraph)
+{
+	auto logger = new FakeLogger();
+
+	FakeHeap heap;
+
+	// Node 7 is not reachable from roots and has no referrers, so it is rooted and node 6 is dominated by the virtual root.
+	std::vector<std::vector<unsigned int>> edges = { { 1, 2 }, { 3 }, { 3, 4 }, { 5 }, { 5 }, { 6, 1 }, {}, { 6 } };
+	std::vector<unsigned long> method_tables = { MT_ARRAY, MT_ARRAY, MT_OTHER_ARRAY, MT_ARRAY, MT_OTHER_ARRAY, MT_ARRAY, MT_ARRAY, MT_ARRAY };
+	std::vector<unsigned long> addresses;
+
+	auto segments = CreateHeap(heap, edges, method_tables, addresses);
+
+	ReferenceGraph graph(segments);
+
+	EXPECT_TRUE(BuildGraph(heap, segments, graph, logger));
+
+	DominatorTree tree;
+
+	EXPECT_TRUE(tree.build(graph, std::vector<unsigned long>({ addresses[0], 0x1000 })));
+	EXPECT_EQ(tree.size(), 8);
+	EXPECT_EQ(tree.get_root_count(), 1);
+	EXPECT_EQ(tree.get_unrooted_count(), 1);
+
+	// Immediate dominators and retained sizes, 8 bytes per node.
+	EXPECT_LE(tree.memory_size(), 8 * (tree.size() + 1));
+	EXPECT_GE(DominatorTree::get_build_memory_size(graph.get_node_count()), tree.memory_size());
+
+	unsigned int expected_idoms[] = { DominatorTree::ROOT, 0, 0, 0, 2, 0, DominatorTree::ROOT, DominatorTree::ROOT };
+
+	for (unsigned int node = 0; node < 8; node++)
+	{
+		EXPECT_EQ(tree.get_idom(node), expected_idoms[node]);
+	}
+
+	// Arrays with 2, 1, 2, 1, 1, 2, 0, 1 elements.
+	unsigned long long expected_retained[] = { 20 + 16 + 20 + 16 + 16 + 20, 16, 20 + 16, 16, 16, 20, 12, 16 };
+
+	for (unsigned int node = 0; node < 8; node++)
+	{
+		EXPECT_EQ(tree.get_retained_size(node), expected_retained[node]);
+	}
+
+	EXPECT_EQ(tree.get_top_objects(2), std::vector<unsigned int>({ 0, 2 }));
+
+	auto types = tree.get_top_types(0);
+
+	EXPECT_EQ(types.size(), 2);
+	EXPECT_EQ(types[0].MethodTable, MT_ARRAY);
+	EXPECT_EQ(types[0].Count, 6);
+	EXPECT_EQ(types[0].Bytes, 20 + 16 + 16 + 20 + 12 + 16);
+	EXPECT_EQ(types[0].RetainedBytes, expected_retained[0] + 12 + 16);
+	EXPECT_EQ(types[1].MethodTable, MT_OTHER_ARRAY);
+	EXPECT_EQ(types[1].Count, 2);
+	EXPECT_EQ(types[1].Bytes, 20 + 16);
+	EXPECT_EQ(types[1].RetainedBytes, 20 + 16);
+
+	EXPECT_EQ(logger->_logs.size(), 0);
+
+	delete logger;
+}
+
+/**
+Finds nodes reachable from roots without passing a removed node.
+*/
+static std::vector<bool> Reachable(const std::vector<std::vector<unsigned int>>& edges, const std::vector<unsigned int>& roots, unsigned int removed)
+{
+	std::vector<bool> is_reached(edges.size(), false);
+	std::deque<unsigned int> queue;
+
+	for (auto root : roots)
+	{
+		if (root != removed && !is_reached[root])
+		{
+			is_reached[root] = true;
+			queue.push_back(root);
+		}
+	}
+
+	while (!queue.empty())
+	{
+		auto node = queue.front();
+
+		queue.pop_front();
+
+		for (auto target : edges[node])
+		{
+			if (target != removed && !is_reached[target])
+			{
+				is_reached[target] = true;
+				queue.push_back(target);
+			}
+		}
+	}
+
+	return is_reached;
+}
+
+TEST(DominatorTree, SameAsBruteForce)
+{
+	auto logger = new FakeLogger();
+
+	FakeHeap heap;
+
+	const unsigned int node_count = 150;
+
+	std::vector<std::vector<unsigned int>> edges(node_count);
+	std::vector<unsigned long> method_tables(node_count, MT_ARRAY);
+	std::vector<unsigned long> addresses;
+
+	unsigned int seed = 12345;
+
+	auto next = [&](unsigned int range)
+	{
+		seed = seed * 1103515245 + 12345;
+
+		return (seed >> 16) % range;
+	};
+
+	// Every node is reachable from node 0 or 1, extra edges make cycles and joins.
+	for (unsigned int i = 2; i < node_count; i++)
+	{
+		edges[next(i)].push_back(i);
+	}
+
+	for (unsigned int i = 0; i < 2 * node_count; i++)
+	{
+		edges[next(node_count)].push_back(next(node_count));
+	}
+
+	auto segments = CreateHeap(heap, edges, method_tables, addresses);
+
+	ReferenceGraph graph(segments);
+
+	EXPECT_TRUE(BuildGraph(heap, segments, graph, logger));
+
+	DominatorTree tree;
+
+	EXPECT_TRUE(tree.build(graph, std::vector<unsigned long>({ addresses[1], addresses[0] })));
+	EXPECT_EQ(tree.get_root_count(), 2);
+	EXPECT_EQ(tree.get_unrooted_count(), 0);
+
+	std::vector<unsigned int> roots = { 0, 1 };
+
+	// Dominators of a node are the nodes whose removal makes it unreachable.
+	std::vector<std::vector<unsigned int>> dominators(node_count);
+
+	for (unsigned int removed = 0; removed < node_count; removed++)
+	{
+		auto is_reached = Reachable(edges, roots, removed);
+
+		unsigned long long retained = 0;
+
+		for (unsigned int node = 0; node < node_count; node++)
+		{
+			if (!is_reached[node])
+			{
+				retained += graph.get_size(node);
+
+				if (node != removed)
+				{
+					dominators[node].push_back(removed);
+				}
+			}
+		}
+
+		EXPECT_EQ(tree.get_retained_size(removed), retained);
+	}
+
+	// The immediate dominator is the strict dominator with the most dominators.
+	for (unsigned int node = 0; node < node_count; node++)
+	{
+		auto idom = DominatorTree::ROOT;
+
+		for (auto dominator : dominators[node])
+		{
+			if (idom == DominatorTree::ROOT || dominators[dominator].size() > dominators[idom].size())
+			{
+				idom = dominator;
+			}
+		}
+
+		EXPECT_EQ(tree.get_idom(node), idom);
+	}
+
+	delete logger;
+}
\ No newline at end of file
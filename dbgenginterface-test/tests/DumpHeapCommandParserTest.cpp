@@ -0,0 +1,89 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+/**
+\file DumpHeapCommandParserTest.cpp
+
+Implements DumpHeapCommandParserTest class defines unit tests for DumpHeapCommandParser class.
+*/
+
+#include "..\stdafx.h"
+
+#include "DumpHeapCommandParser.h"
+#include "FakeDebuggerCommandExecutor.h"
+#include "FakeLogger.h"
+
+TEST(DumpHeapCommandParser, CannotRunCommand)
+{
+	IDebuggerCommandExecutor *executor = new FakeDebuggerCommandExecutor(FakeDebuggerCommandExecutor::OutputLambda([&](const std::string& command, std::string& output)
+	{
+		output = "abc";
+
+		return false;
+	}));
+
+	auto logger = new FakeLogger();
+
+	auto parser = DumpHeapCommandParser(executor, logger);
+
+	auto output = parser.execute("System.Threading.Thread");
+
+	EXPECT_FALSE(output.has_addresses());
+	EXPECT_EQ(logger->_logs.size(), 1);
+
+	delete executor;
+	delete logger;
+}
+
+TEST(DumpHeapCommandParser, AddressesAreSorted)
+{
+	IDebuggerCommandExecutor *executor = new FakeDebuggerCommandExecutor(FakeDebuggerCommandExecutor::OutputLambda([&](const std::string& command, std::string& output)
+	{
+		EXPECT_EQ(command, "!dumpheap -short -mt 7a5c1234");
+
+		output = "02a51020\n"
+			"02a51000\n"
+			"short\n"
+			"xyzxyzxy\n"
+			"03b00000\n";
+
+		return true;
+	}));
+
+	auto logger = new FakeLogger();
+
+	auto parser = DumpHeapCommandParser(executor, logger);
+
+	auto output = parser.execute_by_mt(0x7a5c1234);
+
+	EXPECT_TRUE(output.has_addresses());
+
+	auto addresses = output.get_addresses().to_vector();
+
+	EXPECT_EQ(addresses, std::vector<unsigned long>({ 0x02a51000, 0x02a51020, 0x03b00000 }));
+	EXPECT_EQ(logger->_logs.size(), 1);
+
+	delete executor;
+	delete logger;
+}
\ No newline at end of file
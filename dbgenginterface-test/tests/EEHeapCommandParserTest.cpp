@@ -144,6 +144,82 @@ GC Heap Size:    Size: 0x12161d2c (303439148) bytes.)";
 	EXPECT_EQ(ranges->at(21).State, State::Commit);
 	EXPECT_EQ(ranges->at(21).Usage, Usage::GCLOHeap);
 
+	auto generation_starts = output.get_generation_starts();
+
+	EXPECT_EQ(generation_starts.size(), 3);
+	EXPECT_EQ(generation_starts[0].first, 0);
+	EXPECT_EQ(generation_starts[0].second, 0x3def26f8);
+	EXPECT_EQ(generation_starts[1].first, 1);
+	EXPECT_EQ(generation_starts[1].second, 0x3de57a5c);
+	EXPECT_EQ(generation_starts[2].first, 2);
+	EXPECT_EQ(generation_starts[2].second, 0x02851000);
+
+	delete executor;
+	delete logger;
+}
+
+TEST(EEHeapCommandParser, ServerGCOutput)
+{
+	IDebuggerCommandExecutor *executor = new FakeDebuggerCommandExecutor(FakeDebuggerCommandExecutor::OutputLambda([&](const std::string& command, std::string& output)
+	{
+		output = R"(Number of GC Heaps: 2
+------------------------------
+Heap 0 (0068a0f8)
+generation 0 starts at 0x02a31018
+generation 1 starts at 0x02a3100c
+generation 2 starts at 0x02a31000
+ephemeral segment allocation context: none
+ segment     begin allocated  size
+02a30000  02a31000  02a3f000  0xe000(57344)
+Large object heap starts at 0x0aa31000
+ segment     begin allocated  size
+0aa30000  0aa31000  0aa35000  0x4000(16384)
+Heap Size:               Size: 0x12000 (73728) bytes.
+------------------------------
+Heap 1 (006c0f18)
+generation 0 starts at 0x06a31018
+generation 1 starts at 0x06a3100c
+generation 2 starts at 0x06a31000
+ephemeral segment allocation context: none
+ segment     begin allocated  size
+06a30000  06a31000  06a33000  0x2000(8192)
+Large object heap starts at 0x0ba31000
+ segment     begin allocated  size
+0ba30000  0ba31000  0ba31010  0x10(16)
+Heap Size:               Size: 0x2010 (8208) bytes.
+------------------------------
+GC Heap Size:            Size: 0x14010 (81936) bytes.)";
+
+		return true;
+	}));
+
+	auto logger = new FakeLogger();
+
+	auto parser = EEHeapCommandParser(executor, logger);
+
+	auto output = parser.execute();
+
+	EXPECT_TRUE(output.has_ranges());
+	EXPECT_EQ(logger->_logs.size(), 0);
+
+	auto ranges = output.get_ranges();
+
+	ASSERT_EQ(ranges->size(), 4);
+
+	EXPECT_EQ(ranges->at(1).Address, 0x0aa31000);
+	EXPECT_EQ(ranges->at(1).Size, 0x4000);
+	EXPECT_EQ(ranges->at(1).Usage, Usage::GCLOHeap);
+
+	EXPECT_EQ(ranges->at(2).Address, 0x06a31000);
+	EXPECT_EQ(ranges->at(2).Size, 0x2000);
+	EXPECT_EQ(ranges->at(2).Usage, Usage::GCHeap);
+
+	auto generation_starts = output.get_generation_starts();
+
+	ASSERT_EQ(generation_starts.size(), 6);
+	EXPECT_EQ(generation_starts[3].first, 0);
+	EXPECT_EQ(generation_starts[3].second, 0x06a31018);
+
 	delete executor;
 	delete logger;
 }
\ No newline at end of file
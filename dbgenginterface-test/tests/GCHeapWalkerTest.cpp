@@ -0,0 +1,167 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file GCHeapWalkerTest.cpp
+
+Implements GCHeapWalkerTest class defines unit tests for GCHeapWalker class.
+*/
+
+#include "..\stdafx.h"
+
+#include "GCHeapWalker.h"
+#include "FakeHeap.h"
+#include "FakeLogger.h"
+
+/**
+Creates a small object heap segment at 0x10000 and a large object heap segment at 0x20000.
+*/
+static RangeList CreateHeap(FakeHeap& heap)
+{
+	heap.add_method_table(0x5000, 12, 0);
+	heap.add_method_table(0x5100, 14, 2);
+	heap.add_method_table(0x5200, 12, 4);
+
+	auto address = 0x10000UL;
+
+	address += heap.add_object(address, 0x5000, 12, 0, 0);
+	address += heap.add_object(address, 0x5100, 14, 2, 3);
+
+	// Unused allocation context.
+	heap.write_u32(address, 0);
+	heap.write_u32(address + 4, 0);
+	address += 8;
+
+	address += heap.add_object(address, 0x5200, 12, 4, 2);
+
+	auto ranges = new std::vector<const MemoryRange>();
+
+	ranges->push_back(MemoryRange(0x10000, address - 0x10000, State::Commit, Usage::GCHeap));
+
+	address = 0x20000;
+
+	address += heap.add_object(address, 0x5200, 12, 4, 4);
+
+	// Large objects are 8 byte aligned.
+	heap.write_u32(address, 0);
+	address += 4;
+
+	address += heap.add_object(address, 0x5000 | 1, 12, 0, 0);
+
+	ranges->push_back(MemoryRange(0x20000, address - 0x20000, State::Commit, Usage::GCLOHeap));
+
+	return RangeList(ranges);
+}
+
+TEST(GCHeapWalker, WalkSegments)
+{
+	auto logger = new FakeLogger();
+
+	FakeHeap heap;
+	MethodTableCache method_tables;
+
+	method_tables.attach(nullptr, &heap, logger);
+
+	auto walker = GCHeapWalker(CreateHeap(heap), &heap, &method_tables, logger);
+
+	std::vector<GCHeapObject> objects;
+
+	EXPECT_TRUE(walker.walk([&](const GCHeapObject& object){ objects.push_back(object); return true; }));
+
+	ASSERT_EQ(objects.size(), 5);
+
+	EXPECT_EQ(objects[0].Address, 0x10000);
+	EXPECT_EQ(objects[0].MethodTable, 0x5000);
+	EXPECT_EQ(objects[0].Size, 12);
+
+	EXPECT_EQ(objects[1].Address, 0x1000c);
+	EXPECT_EQ(objects[1].MethodTable, 0x5100);
+	EXPECT_EQ(objects[1].Size, 20);
+
+	EXPECT_EQ(objects[2].Address, 0x10028);
+	EXPECT_EQ(objects[2].Size, 20);
+
+	EXPECT_EQ(objects[3].Address, 0x20000);
+	EXPECT_EQ(objects[3].Size, 28);
+
+	// Marked MethodTable pointer.
+	EXPECT_EQ(objects[4].Address, 0x20020);
+	EXPECT_EQ(objects[4].MethodTable, 0x5000);
+
+	EXPECT_EQ(walker.get_objects(), 5);
+	EXPECT_EQ(walker.get_gap_bytes(), 8);
+	EXPECT_EQ(logger->_logs.size(), 0);
+
+	// Method tables are read once, segments with one window read each.
+	EXPECT_EQ(heap._reads, 5);
+
+	delete logger;
+}
+
+TEST(GCHeapWalker, StopWalk)
+{
+	auto logger = new FakeLogger();
+
+	FakeHeap heap;
+	MethodTableCache method_tables;
+
+	method_tables.attach(nullptr, &heap, logger);
+
+	auto walker = GCHeapWalker(CreateHeap(heap), &heap, &method_tables, logger);
+
+	unsigned long count = 0;
+
+	EXPECT_TRUE(walker.walk([&](const GCHeapObject& object){ return ++count < 2; }));
+	EXPECT_EQ(count, 2);
+
+	delete logger;
+}
+
+TEST(GCHeapWalker, InvalidMethodTable)
+{
+	auto logger = new FakeLogger();
+
+	FakeHeap heap;
+
+	auto segments = CreateHeap(heap);
+
+	heap.write_u32(0x1000c, 0x6000);
+
+	MethodTableCache method_tables;
+
+	method_tables.attach(nullptr, &heap, logger);
+
+	auto walker = GCHeapWalker(segments, &heap, &method_tables, logger);
+
+	unsigned long count = 0;
+
+	EXPECT_FALSE(walker.walk([&](const GCHeapObject& object){ count++; return true; }));
+
+	// Walk continues with the next segment.
+	EXPECT_EQ(count, 3);
+	EXPECT_EQ(logger->_logs.size(), 1);
+
+	delete logger;
+}
\ No newline at end of file
@@ -0,0 +1,105 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file GCRootsCommandParserTest.cpp
+
+Implements GCRootsCommandParserTest class defines unit tests for GCRootsCommandParser class.
+*/
+
+#include "..\stdafx.h"
+
+#include "GCRootsCommandParser.h"
+#include "FakeDebuggerCommandExecutor.h"
+#include "FakeLogger.h"
+
+TEST(GCRootsCommandParser, CannotRunCommand)
+{
+	IDebuggerCommandExecutor *executor = new FakeDebuggerCommandExecutor(FakeDebuggerCommandExecutor::OutputLambda([&](const std::string& command, std::string& output)
+	{
+		return false;
+	}));
+
+	auto logger = new FakeLogger();
+
+	auto parser = GCRootsCommandParser(executor, logger);
+
+	EXPECT_TRUE(parser.execute().empty());
+	EXPECT_EQ(logger->_logs.size(), 2);
+
+	delete executor;
+	delete logger;
+}
+
+TEST(GCRootsCommandParser, ValidOutput)
+{
+	IDebuggerCommandExecutor *executor = new FakeDebuggerCommandExecutor(FakeDebuggerCommandExecutor::OutputLambda([&](const std::string& command, std::string& output)
+	{
+		if (command == "!gchandles")
+		{
+			output = R"(          Handle Type                  Object     Size     Data Type
+003f11e4 WeakShort           02bd3d8c       96          System.Threading.Thread
+003f11f8 Strong              02a41234       84          System.OutOfMemoryException
+003f13fc Pinned              03a45678     4096          System.Object[]
+003f14a0 Dependent           02a41240       12          System.Object
+
+Statistics:
+      MT    Count    TotalSize Class Name
+79330a00        1           84 System.OutOfMemoryException
+Total 4 objects
+
+Handles:
+    Strong Handles:       1
+    Pinned Handles:       1
+)";
+		}
+		else
+		{
+			output = R"(OS Thread Id: 0x1a2c (0)
+ESP/REG  Object   Name
+eax      02a41234 System.OutOfMemoryException
+0012f3c4 02a41300 System.String    hello
+0012f3d0 02a41300 System.String    hello
+OS Thread Id: 0x1b30 (1)
+ESP/REG  Object   Name
+0313f0a8 02a41400 System.Threading.ThreadHelper
+)";
+		}
+
+		return true;
+	}));
+
+	auto logger = new FakeLogger();
+
+	auto parser = GCRootsCommandParser(executor, logger);
+
+	auto roots = parser.execute();
+
+	EXPECT_EQ(roots, std::vector<unsigned long>({ 0x02a41234, 0x02a41300, 0x02a41400, 0x03a45678 }));
+	EXPECT_EQ(logger->_logs.size(), 0);
+
+	delete executor;
+	delete logger;
+}
\ No newline at end of file
@@ -0,0 +1,254 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file HeapMapAggregatorTest.cpp
+
+Implements HeapMapAggregatorTest class defines unit tests for HeapMapAggregator class.
+*/
+
+#include "..\stdafx.h"
+
+#include <chrono>
+
+#include "HeapMapAggregator.h"
+#include "HeapMapRasterizer.h"
+#include "FakeRanges.h"
+
+static const std::vector<Usage> PAGE_USAGES = { Usage::VirtualAlloc, Usage::Free, Usage::Image, Usage::Stack, Usage::Heap, Usage::GCHeap };
+
+TEST(HeapMapAggregator, SameAsRasterizerForPages)
+{
+	const unsigned int WIDTH = 2048;
+	const unsigned int HEIGHT = 512;
+
+	auto ranges = FakeRanges(3).create_consecutive(50000, PAGE_USAGES, 64, 0, true);
+
+	HeapMapRasterizer rasterizer(WIDTH, HEIGHT);
+	HeapMapAggregator aggregator(WIDTH, HEIGHT);
+
+	rasterizer.draw(ranges);
+	aggregator.add_layer(ranges);
+
+	std::vector<unsigned char> expected(4 * WIDTH * HEIGHT);
+	std::vector<unsigned char> buffer(4 * WIDTH * HEIGHT);
+
+	rasterizer.copy_to(expected.data());
+	aggregator.render(buffer.data());
+
+	EXPECT_TRUE(buffer == expected);
+}
+
+TEST(HeapMapAggregator, DominantUsage)
+{
+	// Two pixels of 2 GB each, in one column.
+	HeapMapAggregator aggregator(1, 2);
+
+	auto ranges = new std::vector<const MemoryRange>();
+
+	ranges->push_back(MemoryRange(0x00000000, 0x10000000, State::Commit, Usage::Heap));
+	ranges->push_back(MemoryRange(0x10000000, 0x20000000, State::Commit, Usage::Image));
+	ranges->push_back(MemoryRange(0x30000000, 0x08000000, State::Commit, Usage::Heap));
+
+	// Crosses into the second pixel.
+	ranges->push_back(MemoryRange(0x7FFF0000, 0x00020000, State::Commit, Usage::Stack));
+
+	auto gcRanges = new std::vector<const MemoryRange>();
+
+	// Same bytes as the native ranges under them, later layers win ties.
+	gcRanges->push_back(MemoryRange(0x90000000, 0x00010000, State::Commit, Usage::GCHeap));
+
+	aggregator.add_layer(RangeList(ranges));
+	aggregator.add_layer(RangeList(new std::vector<const MemoryRange>(1, MemoryRange(0x90000000, 0x00010000, State::Commit, Usage::Heap))), true);
+	aggregator.add_layer(RangeList(gcRanges));
+
+	std::vector<unsigned int> pixels(2);
+
+	aggregator.render(reinterpret_cast<unsigned char*>(pixels.data()));
+
+	EXPECT_EQ(pixels[0], HeapMapRasterizer::to_pixel(HeapMapRasterizer::get_color(State::Commit, Usage::Image)));
+	EXPECT_EQ(pixels[1], HeapMapRasterizer::to_pixel(HeapMapRasterizer::get_color(State::Commit, Usage::GCHeap)));
+}
+
+TEST(HeapMapAggregator, Blend)
+{
+	HeapMapAggregator aggregator(2, 1, HeapMapAggregation::Blend);
+
+	auto ranges = new std::vector<const MemoryRange>();
+
+	// Half of the first pixel is committed heap, the rest is background.
+	ranges->push_back(MemoryRange(0x00000000, 0x40000000, State::Commit, Usage::Heap));
+
+	// A quarter of the second pixel is free, three quarters are committed images.
+	ranges->push_back(MemoryRange(0x80000000, 0x20000000, State::Free, Usage::Free));
+	ranges->push_back(MemoryRange(0xA0000000, 0x60000000, State::Commit, Usage::Image));
+
+	aggregator.add_layer(RangeList(ranges));
+
+	std::vector<unsigned int> pixels(2);
+
+	aggregator.render(reinterpret_cast<unsigned char*>(pixels.data()));
+
+	// 0x808080 and 0x0000FF.
+	EXPECT_EQ(pixels[0], HeapMapRasterizer::to_pixel(0x4040BF));
+
+	// 0xFFFFFF and 0x8B0000.
+	EXPECT_EQ(pixels[1], HeapMapRasterizer::to_pixel(0xA83F3F));
+}
+
+TEST(HeapMapAggregator, UnevenPixels)
+{
+	const unsigned int WIDTH = 7;
+	const unsigned int HEIGHT = 3;
+
+	auto ranges = new std::vector<const MemoryRange>();
+
+	unsigned int seed = 99;
+
+	for (int i = 0; i < 200; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+
+		auto address = seed & 0xFFFFFF00;
+
+		seed = seed * 1103515245 + 12345;
+
+		auto size = std::min<unsigned long>((seed >> 4) % 0x20000000, 0xFFFFFFFF - address);
+
+		ranges->push_back(MemoryRange(address, size, State::Commit, i % 3 == 0 ? Usage::Heap : i % 3 == 1 ? Usage::Image : Usage::Stack));
+	}
+
+	HeapMapAggregator aggregator(WIDTH, HEIGHT);
+
+	aggregator.add_layer(RangeList(ranges));
+
+	std::vector<unsigned int> pixels(WIDTH * HEIGHT);
+
+	aggregator.render(reinterpret_cast<unsigned char*>(pixels.data()));
+
+	// Count bytes of each usage under each pixel range by range.
+	for (unsigned int pixel = 0; pixel < WIDTH * HEIGHT; pixel++)
+	{
+		auto start = aggregator.get_pixel_address(pixel);
+		auto end = aggregator.get_pixel_address(pixel + 1);
+
+		EXPECT_EQ(aggregator.get_pixel(start), pixel);
+		EXPECT_EQ(aggregator.get_pixel(end - 1), pixel);
+
+		unsigned long long bytes[3] = { 0, 0, 0 };
+
+		for (size_t i = 0; i < ranges->size(); i++)
+		{
+			auto& range = (*ranges)[i];
+
+			auto overlap_start = std::max<unsigned long long>(start, range.Address);
+			auto overlap_end = std::min<unsigned long long>(end, (unsigned long long) range.Address + range.Size);
+
+			if (overlap_start < overlap_end)
+			{
+				bytes[i % 3] += overlap_end - overlap_start;
+			}
+		}
+
+		Usage usages[] = { Usage::Heap, Usage::Image, Usage::Stack };
+
+		// Later usages win ties, as groups are counted in usage order.
+		auto dominant = std::max_element(bytes, bytes + 3) - bytes;
+
+		for (int i = 0; i < 3; i++)
+		{
+			if (bytes[i] == bytes[dominant] && (int) usages[i] > (int) usages[dominant])
+			{
+				dominant = i;
+			}
+		}
+
+		auto expected = bytes[dominant] == 0
+			? HeapMapRasterizer::BACKGROUND
+			: HeapMapRasterizer::to_pixel(HeapMapRasterizer::get_color(State::Commit, usages[dominant]));
+
+		EXPECT_EQ(pixels[(pixel % HEIGHT) * WIDTH + pixel / HEIGHT], expected) << "pixel " << pixel;
+	}
+}
+
+TEST(HeapMapAggregator, HiddenUsages)
+{
+	const unsigned int WIDTH = 1000;
+	const unsigned int HEIGHT = 300;
+
+	auto ranges = FakeRanges(5).create_consecutive(50000, PAGE_USAGES, 64, 0, true);
+	auto visible = new std::vector<const MemoryRange>();
+
+	for (auto& range : *ranges)
+	{
+		if (range.Usage != Usage::Heap)
+		{
+			visible->push_back(range);
+		}
+	}
+
+	HeapMapAggregator aggregator(WIDTH, HEIGHT, HeapMapAggregation::Blend);
+	HeapMapAggregator expectedAggregator(WIDTH, HEIGHT, HeapMapAggregation::Blend);
+
+	aggregator.add_layer(ranges);
+	aggregator.set_visible(Usage::Heap, false);
+
+	expectedAggregator.add_layer(RangeList(visible));
+
+	EXPECT_FALSE(aggregator.is_visible(Usage::Heap));
+	EXPECT_TRUE(aggregator.is_visible(Usage::Image));
+
+	std::vector<unsigned char> expected(4 * WIDTH * HEIGHT);
+	std::vector<unsigned char> buffer(4 * WIDTH * HEIGHT);
+
+	expectedAggregator.render(expected.data());
+	aggregator.render(buffer.data());
+
+	EXPECT_TRUE(buffer == expected);
+}
+
+TEST(HeapMapAggregator, DISABLED_Benchmark)
+{
+	auto ranges = FakeRanges(7).create_consecutive(1000000, PAGE_USAGES, 2, 0, true);
+
+	unsigned int sizes[][2] = { { 2048, 512 }, { 1000, 300 } };
+
+	for (auto& size : sizes)
+	{
+		HeapMapAggregator aggregator(size[0], size[1], HeapMapAggregation::Blend);
+
+		aggregator.add_layer(ranges);
+
+		std::vector<unsigned char> buffer(4 * size[0] * size[1]);
+
+		auto start = std::chrono::high_resolution_clock::now();
+
+		aggregator.render(buffer.data());
+
+		auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+		RecordProperty("Microseconds" + std::to_string(size[0]) + "x" + std::to_string(size[1]), (int) elapsed);
+	}
+}
\ No newline at end of file
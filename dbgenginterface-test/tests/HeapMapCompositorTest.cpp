@@ -0,0 +1,317 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file HeapMapCompositorTest.cpp
+
+Implements HeapMapCompositorTest class defines unit tests and a benchmark for HeapMapCompositor class.
+*/
+
+#include "..\stdafx.h"
+
+#include <chrono>
+
+#include "HeapMapCompositor.h"
+#include "HeapMapRasterizer.h"
+#include "FakeRanges.h"
+
+static const unsigned int WIDTH = 2048;
+static const unsigned int HEIGHT = 512;
+
+/**
+Renders the native map and the GC map with a compositor and with rasterizers drawing the usages visible in the compositor.
+*/
+static void ExpectSameAsRasterizer(HeapMapCompositor& compositor, RangeList ranges, RangeList gcRanges)
+{
+	HeapMapRasterizer rasterizer(WIDTH, HEIGHT);
+	HeapMapRasterizer gcRasterizer(WIDTH, HEIGHT);
+
+	for (unsigned int usage = 0; usage <= (unsigned int) Usage::GCLOHeap; usage++)
+	{
+		rasterizer.set_visible((Usage) usage, compositor.is_visible((Usage) usage));
+		gcRasterizer.set_visible((Usage) usage, compositor.is_visible((Usage) usage));
+	}
+
+	rasterizer.draw(ranges);
+	gcRasterizer.draw(ranges, true);
+	gcRasterizer.draw(gcRanges);
+
+	std::vector<unsigned char> expected(4 * WIDTH * HEIGHT);
+	std::vector<unsigned char> gcExpected(4 * WIDTH * HEIGHT);
+
+	rasterizer.copy_to(expected.data());
+	gcRasterizer.copy_to(gcExpected.data());
+
+	std::vector<unsigned char> buffer(4 * WIDTH * HEIGHT);
+	std::vector<unsigned char> gcBuffer(4 * WIDTH * HEIGHT);
+
+	std::vector<HeapMapComposition> maps;
+
+	maps.push_back(HeapMapComposition(buffer.data(), WIDTH, HEIGHT));
+	maps.push_back(HeapMapComposition(gcBuffer.data(), WIDTH, HEIGHT));
+
+	maps[0].add_layer(0);
+	maps[1].add_layer(0, true);
+	maps[1].add_layer(1);
+
+	compositor.composite_parallel(maps, 4);
+
+	EXPECT_TRUE(buffer == expected);
+	EXPECT_TRUE(gcBuffer == gcExpected);
+}
+
+TEST(HeapMapCompositor, SameAsRasterizer)
+{
+	auto ranges = FakeRanges(5).create_consecutive(100000, { Usage::VirtualAlloc, Usage::Free, Usage::Image, Usage::Stack, Usage::TEB, Usage::Heap, Usage::PageHeap }, 64, 3, false);
+	auto gcRanges = FakeRanges(9).create_consecutive(20000, { Usage::GCHeap, Usage::GCLOHeap }, 64, 3, false);
+
+	HeapMapCompositor compositor(WIDTH, HEIGHT);
+
+	// Masks are filled on several threads even on a single processor.
+	EXPECT_EQ(0, compositor.add_layer(ranges, 4));
+	EXPECT_EQ(1, compositor.add_layer(gcRanges, 4));
+
+	ExpectSameAsRasterizer(compositor, ranges, gcRanges);
+}
+
+TEST(HeapMapCompositor, HiddenUsages)
+{
+	auto ranges = FakeRanges(11).create_consecutive(100000, { Usage::VirtualAlloc, Usage::Free, Usage::Image, Usage::Stack, Usage::Heap }, 64, 3, false);
+	auto gcRanges = FakeRanges(13).create_consecutive(20000, { Usage::GCHeap, Usage::GCLOHeap }, 64, 3, false);
+
+	HeapMapCompositor compositor(WIDTH, HEIGHT);
+
+	compositor.add_layer(ranges);
+	compositor.add_layer(gcRanges);
+
+	compositor.set_visible(Usage::Heap, false);
+	compositor.set_visible(Usage::GCLOHeap, false);
+
+	EXPECT_FALSE(compositor.is_visible(Usage::Heap));
+	EXPECT_TRUE(compositor.is_visible(Usage::Image));
+
+	ExpectSameAsRasterizer(compositor, ranges, gcRanges);
+
+	compositor.set_visible(Usage::Heap, true);
+	compositor.set_visible(Usage::Free, false);
+
+	ExpectSameAsRasterizer(compositor, ranges, gcRanges);
+}
+
+TEST(HeapMapCompositor, OverlappingRangesInRangeOrder)
+{
+	std::vector<Usage> usages = { Usage::VirtualAlloc, Usage::Free, Usage::Image, Usage::Stack, Usage::Heap, Usage::PageHeap, Usage::GCHeap, Usage::GCLOHeap };
+
+	auto ranges = FakeRanges(29).create_overlapping(20000, usages);
+	auto gcRanges = FakeRanges(31).create_overlapping(3000, usages);
+
+	HeapMapCompositor compositor(WIDTH, HEIGHT);
+
+	compositor.add_layer(ranges);
+	compositor.add_layer(gcRanges);
+
+	ExpectSameAsRasterizer(compositor, ranges, gcRanges);
+
+	// Hidden ranges uncover the ranges drawn before them.
+	compositor.set_visible(Usage::Heap, false);
+	compositor.set_visible(Usage::GCHeap, false);
+
+	ExpectSameAsRasterizer(compositor, ranges, gcRanges);
+}
+
+TEST(HeapMapCompositor, OverlappingRangesOnOnePage)
+{
+	auto ranges = new std::vector<const MemoryRange>();
+
+	// Image is drawn over heap, then stack over both and heap again over all of them on the second page.
+	ranges->push_back(MemoryRange(0x0000, 0x3000, State::Commit, Usage::Heap));
+	ranges->push_back(MemoryRange(0x0000, 0x2000, State::Commit, Usage::Image));
+	ranges->push_back(MemoryRange(0x1000, 0x2000, State::Commit, Usage::Stack));
+	ranges->push_back(MemoryRange(0x1000, 0x1000, State::Commit, Usage::Heap));
+
+	HeapMapCompositor compositor(4, 1);
+
+	compositor.add_layer(RangeList(ranges));
+
+	std::vector<unsigned int> pixels(4);
+
+	HeapMapComposition map(reinterpret_cast<unsigned char*>(pixels.data()), 4, 1);
+
+	map.add_layer(0);
+
+	auto heap = HeapMapRasterizer::to_pixel(HeapMapRasterizer::get_color(State::Commit, Usage::Heap));
+	auto image = HeapMapRasterizer::to_pixel(HeapMapRasterizer::get_color(State::Commit, Usage::Image));
+	auto stack = HeapMapRasterizer::to_pixel(HeapMapRasterizer::get_color(State::Commit, Usage::Stack));
+
+	compositor.composite(map);
+
+	EXPECT_EQ(pixels, std::vector<unsigned int>({ image, heap, stack, HeapMapRasterizer::BACKGROUND }));
+
+	compositor.set_visible(Usage::Heap, false);
+	compositor.composite(map);
+
+	EXPECT_EQ(pixels, std::vector<unsigned int>({ image, stack, stack, HeapMapRasterizer::BACKGROUND }));
+
+	compositor.set_visible(Usage::Stack, false);
+	compositor.composite(map);
+
+	EXPECT_EQ(pixels, std::vector<unsigned int>({ image, image, HeapMapRasterizer::BACKGROUND, HeapMapRasterizer::BACKGROUND }));
+}
+
+TEST(HeapMapCompositor, UpdatedLayersSameAsAdded)
+{
+	auto ranges = FakeRanges(37).create_consecutive(100000, { Usage::VirtualAlloc, Usage::Free, Usage::Image, Usage::Heap }, 64, 3, false);
+	auto gcRanges = FakeRanges(41).create_consecutive(20000, { Usage::GCHeap }, 64, 3, false);
+
+	HeapMapCompositor compositor(WIDTH, HEIGHT);
+
+	compositor.add_layer(ranges);
+	compositor.add_layer(gcRanges);
+
+	auto mask_count = compositor.get_mask_count();
+
+	// Same ranges in another list change no masks.
+	compositor.update_layer(0, RangeList(new std::vector<const MemoryRange>(*ranges)));
+
+	EXPECT_EQ(mask_count, compositor.get_mask_count());
+
+	ExpectSameAsRasterizer(compositor, ranges, gcRanges);
+
+	// Remove, shrink and change ranges, add ranges of a new usage and past the last range of a usage.
+	auto changed = new std::vector<const MemoryRange>(*ranges);
+
+	changed->erase(changed->begin() + 100);
+	(*changed)[1000] = MemoryRange((*changed)[1000].Address, 0x1000, (*changed)[1000].State, (*changed)[1000].Usage);
+	(*changed)[2000] = MemoryRange((*changed)[2000].Address, (*changed)[2000].Size, State::Commit, Usage::Stack);
+	(*changed)[3000] = MemoryRange((*changed)[3000].Address, (*changed)[3000].Size, (*changed)[3000].State, (*changed)[3000].Usage == Usage::Heap ? Usage::Image : Usage::Heap);
+
+	auto gcChanged = new std::vector<const MemoryRange>(gcRanges->begin(), gcRanges->end() - 10);
+
+	gcChanged->push_back(MemoryRange(0xFFFF0000, 0x8000, State::Commit, Usage::GCHeap));
+
+	ranges = RangeList(changed);
+	gcRanges = RangeList(gcChanged);
+
+	compositor.update_layer(0, ranges);
+	compositor.update_layer(1, gcRanges);
+
+	ExpectSameAsRasterizer(compositor, ranges, gcRanges);
+
+	compositor.set_visible(Usage::Image, false);
+
+	ExpectSameAsRasterizer(compositor, ranges, gcRanges);
+
+	// Overlapping ranges render the layer again.
+	gcRanges = FakeRanges(43).create_overlapping(3000, { Usage::GCHeap, Usage::GCLOHeap });
+
+	compositor.update_layer(1, gcRanges);
+
+	ExpectSameAsRasterizer(compositor, ranges, gcRanges);
+
+	compositor.update_layer(1, nullptr);
+
+	ExpectSameAsRasterizer(compositor, ranges, RangeList(new std::vector<const MemoryRange>()));
+
+	EXPECT_EQ(2, compositor.get_layer_count());
+}
+
+TEST(HeapMapCompositor, RectsKeepOtherColumns)
+{
+	auto ranges = FakeRanges(17).create_consecutive(50000, { Usage::VirtualAlloc, Usage::Image, Usage::Heap }, 64, 3, false);
+
+	HeapMapCompositor compositor(WIDTH, HEIGHT);
+
+	compositor.add_layer(ranges);
+
+	std::vector<unsigned int> buffer(WIDTH * HEIGHT, 0x12345678);
+
+	HeapMapComposition map(reinterpret_cast<unsigned char*>(buffer.data()), WIDTH, HEIGHT);
+
+	map.add_layer(0);
+	map.Rects.assign(1, HeapMapRect(100, 0, 3, HEIGHT));
+
+	compositor.composite(map);
+
+	std::vector<unsigned int> expected(WIDTH * HEIGHT);
+
+	HeapMapRasterizer rasterizer(WIDTH, HEIGHT);
+
+	rasterizer.draw(ranges);
+	rasterizer.copy_to(reinterpret_cast<unsigned char*>(expected.data()));
+
+	for (unsigned int y = 0; y < HEIGHT; y++)
+	{
+		for (unsigned int x = 0; x < WIDTH; x++)
+		{
+			auto pixel = (size_t) y * WIDTH + x;
+
+			EXPECT_EQ(x >= 100 && x < 103 ? expected[pixel] : 0x12345678u, buffer[pixel]) << x << ", " << y;
+		}
+	}
+}
+
+TEST(HeapMapCompositor, DISABLED_Benchmark)
+{
+	auto ranges = FakeRanges(19).create_consecutive(200000, { Usage::VirtualAlloc, Usage::Free, Usage::Image, Usage::Stack, Usage::TEB, Usage::Heap, Usage::PageHeap }, 64, 3, false);
+	auto gcRanges = FakeRanges(23).create_consecutive(50000, { Usage::GCHeap, Usage::GCLOHeap }, 64, 3, false);
+
+	HeapMapCompositor compositor(WIDTH, HEIGHT);
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	compositor.add_layer(ranges);
+	compositor.add_layer(gcRanges);
+
+	auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+	RecordProperty("MaskMicroseconds", (int) elapsed);
+
+	std::vector<unsigned char> buffer(4 * WIDTH * HEIGHT);
+	std::vector<unsigned char> gcBuffer(4 * WIDTH * HEIGHT);
+
+	std::vector<HeapMapComposition> maps;
+
+	maps.push_back(HeapMapComposition(buffer.data(), WIDTH, HEIGHT));
+	maps.push_back(HeapMapComposition(gcBuffer.data(), WIDTH, HEIGHT));
+
+	maps[0].add_layer(0);
+	maps[1].add_layer(0, true);
+	maps[1].add_layer(1);
+
+	const int TOGGLES = 10;
+
+	start = std::chrono::high_resolution_clock::now();
+
+	for (int i = 0; i < TOGGLES; i++)
+	{
+		compositor.set_visible(Usage::Heap, i % 2 == 1);
+
+		compositor.composite_parallel(maps);
+	}
+
+	elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count() / TOGGLES;
+
+	RecordProperty("Microseconds", (int) elapsed);
+}
\ No newline at end of file
@@ -0,0 +1,250 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file HeapMapHilbertCurveTest.cpp
+
+Implements HeapMapHilbertCurveTest class defines unit tests and a benchmark for HeapMapHilbertCurve class.
+*/
+
+#include "..\stdafx.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+
+#include "HeapMapHilbertCurve.h"
+#include "HeapMapCompositor.h"
+
+/**
+Gets the position of an index on a Hilbert curve one bit pair at a time, rotating the lower levels.
+*/
+static void GetReferencePosition(unsigned int side, unsigned long index, unsigned int& x, unsigned int& y)
+{
+	x = 0;
+	y = 0;
+
+	for (unsigned int s = 1; s < side; s *= 2)
+	{
+		unsigned int rx = 1 & (index / 2);
+		unsigned int ry = 1 & (index ^ rx);
+
+		if (ry == 0)
+		{
+			if (rx == 1)
+			{
+				x = s - 1 - x;
+				y = s - 1 - y;
+			}
+
+			std::swap(x, y);
+		}
+
+		x += s * rx;
+		y += s * ry;
+		index /= 4;
+	}
+}
+
+TEST(HeapMapHilbertCurve, SameAsReference)
+{
+	for (unsigned int order = 0; order <= 7; order++)
+	{
+		auto side = 1u << order;
+
+		for (unsigned long index = 0; index < side * side; index++)
+		{
+			unsigned int x, y, expectedX, expectedY;
+
+			HeapMapHilbertCurve::get_position(order, index, x, y);
+			GetReferencePosition(side, index, expectedX, expectedY);
+
+			ASSERT_EQ(expectedX, x) << order << ", " << index;
+			ASSERT_EQ(expectedY, y) << order << ", " << index;
+		}
+	}
+}
+
+TEST(HeapMapHilbertCurve, Supported)
+{
+	EXPECT_TRUE(HeapMapHilbertCurve::is_supported(2048, 512));
+	EXPECT_TRUE(HeapMapHilbertCurve::is_supported(512, 2048));
+	EXPECT_TRUE(HeapMapHilbertCurve::is_supported(1024, 1024));
+	EXPECT_TRUE(HeapMapHilbertCurve::is_supported(3072, 1024));
+	EXPECT_FALSE(HeapMapHilbertCurve::is_supported(1000, 300));
+	EXPECT_FALSE(HeapMapHilbertCurve::is_supported(2048, 768));
+	EXPECT_FALSE(HeapMapHilbertCurve::is_supported(0, 512));
+}
+
+TEST(HeapMapHilbertCurve, Continuous)
+{
+	unsigned int sizes[][2] = { { 2048, 512 }, { 512, 2048 }, { 64, 64 }, { 96, 32 } };
+
+	for (auto& size : sizes)
+	{
+		HeapMapHilbertCurve curve(size[0], size[1]);
+
+		std::vector<bool> is_used((size_t) size[0] * size[1]);
+
+		for (size_t index = 0; index < is_used.size(); index++)
+		{
+			auto offset = curve.get_offset(index);
+
+			ASSERT_LT(offset, is_used.size());
+			ASSERT_FALSE(is_used[offset]);
+
+			is_used[offset] = true;
+
+			if (index != 0)
+			{
+				auto previous = curve.get_offset(index - 1);
+
+				auto dx = std::abs((int) (offset % size[0]) - (int) (previous % size[0]));
+				auto dy = std::abs((int) (offset / size[0]) - (int) (previous / size[0]));
+
+				ASSERT_EQ(1, dx + dy) << size[0] << "x" << size[1] << ", " << index;
+			}
+		}
+	}
+}
+
+TEST(HeapMapHilbertCurve, RectsCoverSpans)
+{
+	unsigned int sizes[][2] = { { 256, 64 }, { 64, 256 }, { 96, 32 } };
+	unsigned long spans[][2] = { { 0, 1 }, { 5, 6 }, { 64, 128 }, { 3, 4097 }, { 1000, 12288 } };
+
+	for (auto& size : sizes)
+	{
+		HeapMapHilbertCurve curve(size[0], size[1]);
+
+		for (auto& span : spans)
+		{
+			auto end_index = std::min(span[1], (unsigned long) size[0] * size[1]);
+
+			std::vector<HeapMapRect> rects;
+
+			curve.get_rects(span[0], end_index, rects);
+
+			std::vector<unsigned int> covered((size_t) size[0] * size[1]);
+
+			for (auto& rect : rects)
+			{
+				for (auto y = rect.Y; y < rect.Y + rect.Height; y++)
+				{
+					for (auto x = rect.X; x < rect.X + rect.Width; x++)
+					{
+						ASSERT_LT(y * size[0] + x, covered.size());
+
+						covered[y * size[0] + x]++;
+					}
+				}
+			}
+
+			// Squares cover exactly the pixels of the span, once each.
+			for (size_t index = 0; index < covered.size(); index++)
+			{
+				auto is_in_span = index >= span[0] && index < end_index;
+
+				ASSERT_EQ(is_in_span ? 1u : 0u, covered[curve.get_offset(index)]) << size[0] << "x" << size[1] << ", " << span[0] << "-" << end_index << ", " << index;
+			}
+		}
+	}
+}
+
+TEST(HeapMapHilbertCurve, CompositorSameAsColumns)
+{
+	const unsigned int WIDTH = 2048;
+	const unsigned int HEIGHT = 512;
+
+	auto ranges = new std::vector<const MemoryRange>();
+
+	for (unsigned long i = 0; i < 4096; i++)
+	{
+		ranges->push_back(MemoryRange(i * 0x100000, 0x1000 * (1 + i % 200), i % 3 == 0 ? State::Commit : State::Reserve, i % 5 == 0 ? Usage::Heap : Usage::Image));
+	}
+
+	auto list = RangeList(ranges);
+
+	HeapMapCompositor compositor(WIDTH, HEIGHT);
+
+	compositor.add_layer(list);
+
+	std::vector<unsigned int> columns(WIDTH * HEIGHT);
+	std::vector<unsigned int> hilbert(WIDTH * HEIGHT);
+
+	HeapMapComposition columnMap(reinterpret_cast<unsigned char*>(columns.data()), WIDTH, HEIGHT);
+	HeapMapComposition hilbertMap(reinterpret_cast<unsigned char*>(hilbert.data()), WIDTH, HEIGHT);
+
+	columnMap.add_layer(0);
+	hilbertMap.add_layer(0);
+
+	compositor.composite(columnMap);
+
+	auto curve = std::make_shared<const HeapMapHilbertCurve>(WIDTH, HEIGHT);
+
+	compositor.set_curve(curve);
+	compositor.composite(hilbertMap);
+
+	for (size_t page = 0; page < columns.size(); page++)
+	{
+		ASSERT_EQ(columns[(page % HEIGHT) * WIDTH + page / HEIGHT], hilbert[curve->get_offset(page)]) << page;
+	}
+
+	// Saved images are drawn by a rasterizer along the same curve.
+	HeapMapRasterizer rasterizer(WIDTH, HEIGHT);
+
+	std::vector<unsigned int> drawn(WIDTH * HEIGHT);
+
+	rasterizer.set_curve(curve);
+	rasterizer.draw(list);
+	rasterizer.copy_to(reinterpret_cast<unsigned char*>(drawn.data()));
+
+	EXPECT_TRUE(drawn == hilbert);
+}
+
+TEST(HeapMapHilbertCurve, DISABLED_Benchmark)
+{
+	const unsigned int WIDTH = 2048;
+	const unsigned int HEIGHT = 512;
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	HeapMapHilbertCurve curve(WIDTH, HEIGHT);
+
+	auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+	RecordProperty("LayoutMicroseconds", (int) elapsed);
+
+	std::vector<unsigned int> pixels(WIDTH * HEIGHT, 0x80FF0000);
+	std::vector<unsigned char> buffer(4 * WIDTH * HEIGHT);
+
+	start = std::chrono::high_resolution_clock::now();
+
+	curve.copy_to(pixels.data(), 0, WIDTH * HEIGHT, buffer.data());
+
+	elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+	RecordProperty("Microseconds", (int) elapsed);
+}
\ No newline at end of file
@@ -0,0 +1,430 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file HeapMapImageExporterTest.cpp
+
+Implements HeapMapImageExporterTest class defines unit tests for HeapMapImageExporter and DeflateEncoder classes.
+*/
+
+#include "..\stdafx.h"
+
+#include <chrono>
+#include <sstream>
+
+#include "HeapMapImageExporter.h"
+#include "HeapMapRasterizer.h"
+#include "DeflateEncoder.h"
+
+/**
+Reference decoder for deflate streams with stored and fixed Huffman blocks, reading bits one at a time.
+*/
+class FixedInflater
+{
+private:
+	const std::vector<unsigned char>& _input;
+	size_t _position;
+	unsigned int _bit = 0;
+
+	unsigned int read_bits(unsigned int count)
+	{
+		unsigned int value = 0;
+
+		for (unsigned int i = 0; i < count; i++, _bit++)
+		{
+			value |= ((_input.at(_position + _bit / 8) >> (_bit % 8)) & 1) << i;
+		}
+
+		return value;
+	}
+
+	unsigned int read_code(unsigned int count)
+	{
+		unsigned int code = 0;
+
+		for (unsigned int i = 0; i < count; i++)
+		{
+			code = (code << 1) | read_bits(1);
+		}
+
+		return code;
+	}
+
+	unsigned int read_symbol()
+	{
+		auto code = read_code(7);
+
+		if (code < 0x18)
+		{
+			return 256 + code;
+		}
+
+		code = (code << 1) | read_bits(1);
+
+		if (code < 0xC0)
+		{
+			return code - 0x30;
+		}
+
+		if (code < 0xC8)
+		{
+			return 280 + code - 0xC0;
+		}
+
+		code = (code << 1) | read_bits(1);
+
+		return 144 + code - 0x190;
+	}
+
+public:
+	FixedInflater(const std::vector<unsigned char>& input, size_t position)
+		: _input(input), _position(position)
+	{
+
+	}
+
+	size_t get_position() const { return _position + (_bit + 7) / 8; }
+
+	bool inflate(std::vector<unsigned char>& output)
+	{
+		static const unsigned int LENGTHS[] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+		static const unsigned int LENGTH_BITS[] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+		static const unsigned int DISTANCES[] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+		static const unsigned int DISTANCE_BITS[] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+		for (;;)
+		{
+			auto is_final = read_bits(1);
+			auto type = read_bits(2);
+
+			if (type == 0)
+			{
+				_bit = (_bit + 7) / 8 * 8;
+
+				auto length = read_bits(16);
+				auto complement = read_bits(16);
+
+				if ((length ^ 0xFFFF) != complement)
+				{
+					return false;
+				}
+
+				for (unsigned int i = 0; i < length; i++)
+				{
+					output.push_back(static_cast<unsigned char>(read_bits(8)));
+				}
+			}
+			else if (type == 1)
+			{
+				for (auto symbol = read_symbol(); symbol != 256; symbol = read_symbol())
+				{
+					if (symbol < 256)
+					{
+						output.push_back(static_cast<unsigned char>(symbol));
+
+						continue;
+					}
+
+					auto length = LENGTHS[symbol - 257] + read_bits(LENGTH_BITS[symbol - 257]);
+					auto distance_code = read_code(5);
+					auto distance = DISTANCES[distance_code] + read_bits(DISTANCE_BITS[distance_code]);
+
+					if (distance > output.size())
+					{
+						return false;
+					}
+
+					for (unsigned int i = 0; i < length; i++)
+					{
+						output.push_back(output[output.size() - distance]);
+					}
+				}
+			}
+			else
+			{
+				return false;
+			}
+
+			if (is_final)
+			{
+				return true;
+			}
+		}
+	}
+};
+
+static unsigned int ReadU32(const std::vector<unsigned char>& data, size_t position)
+{
+	return (data.at(position) << 24) | (data.at(position + 1) << 16) | (data.at(position + 2) << 8) | data.at(position + 3);
+}
+
+/**
+Decodes a PNG image written by HeapMapImageExporter, checking chunk checksums, to 32-bit pixels.
+*/
+static bool DecodePng(const std::string& png, std::vector<unsigned int>& pixels, unsigned int& width, unsigned int& height)
+{
+	std::vector<unsigned char> data(png.begin(), png.end());
+	std::vector<unsigned char> compressed;
+
+	if (data.size() < 8 || data[0] != 0x89 || data[1] != 'P')
+	{
+		return false;
+	}
+
+	for (size_t position = 8; position < data.size();)
+	{
+		auto size = ReadU32(data, position);
+		auto type = std::string(data.begin() + position + 4, data.begin() + position + 8);
+		auto crc = HeapMapImageExporter::crc32(&data[position + 4], size + 4);
+
+		if (crc != ReadU32(data, position + 8 + size))
+		{
+			return false;
+		}
+
+		if (type == "IHDR")
+		{
+			width = ReadU32(data, position + 8);
+			height = ReadU32(data, position + 12);
+		}
+		else if (type == "IDAT")
+		{
+			compressed.insert(compressed.end(), data.begin() + position + 8, data.begin() + position + 8 + size);
+		}
+
+		position += 12 + size;
+	}
+
+	if (compressed.size() < 6 || (compressed[0] * 256 + compressed[1]) % 31 != 0)
+	{
+		return false;
+	}
+
+	std::vector<unsigned char> filtered;
+
+	FixedInflater inflater(compressed, 2);
+
+	if (!inflater.inflate(filtered) || filtered.size() != (size_t) (width * 3 + 1) * height)
+	{
+		return false;
+	}
+
+	if (ReadU32(compressed, inflater.get_position()) != DeflateEncoder::adler32(filtered.data(), filtered.size()))
+	{
+		return false;
+	}
+
+	auto stride = width * 3 + 1;
+
+	pixels.clear();
+
+	for (unsigned int y = 0; y < height; y++)
+	{
+		auto line = &filtered[y * stride];
+
+		if (line[0] != 1)
+		{
+			return false;
+		}
+
+		for (unsigned int i = 4; i < stride; i++)
+		{
+			line[i] += line[i - 3];
+		}
+
+		for (unsigned int x = 0; x < width; x++)
+		{
+			pixels.push_back(line[1 + x * 3 + 2] | (line[1 + x * 3 + 1] << 8) | (line[1 + x * 3] << 16) | 0x80000000);
+		}
+	}
+
+	return true;
+}
+
+/**
+Creates a heap map like pixels, with runs of colors and repeated rows.
+*/
+static std::vector<unsigned int> CreatePixels(unsigned int width, unsigned int height)
+{
+	std::vector<unsigned int> pixels((size_t) width * height);
+
+	unsigned int seed = 12345;
+
+	for (unsigned int y = 0; y < height; y++)
+	{
+		for (unsigned int x = 0; x < width; x++)
+		{
+			if (y % 4 == 3)
+			{
+				pixels[y * width + x] = pixels[(y - 1) * width + x];
+
+				continue;
+			}
+
+			if (x == 0 || (seed = seed * 1103515245 + 12345) % 16 == 0)
+			{
+				seed = seed * 1103515245 + 12345;
+			}
+
+			pixels[y * width + x] = ((seed >> 8) & 0xFFFFFF) | 0x80000000;
+		}
+	}
+
+	return pixels;
+}
+
+TEST(DeflateEncoder, Adler32)
+{
+	std::string text = "Wikipedia";
+
+	auto data = reinterpret_cast<const unsigned char*>(text.data());
+
+	EXPECT_EQ(DeflateEncoder::adler32(data, text.size()), 0x11E60398);
+
+	auto first = DeflateEncoder::adler32(data, 4);
+	auto second = DeflateEncoder::adler32(data + 4, text.size() - 4);
+
+	EXPECT_EQ(DeflateEncoder::adler32_combine(first, second, text.size() - 4), 0x11E60398);
+	EXPECT_EQ(DeflateEncoder::adler32_combine(1, second, text.size() - 4), second);
+}
+
+TEST(DeflateEncoder, Roundtrip)
+{
+	std::vector<unsigned char> data;
+
+	for (unsigned int i = 0; i < 5000; i++)
+	{
+		data.push_back(static_cast<unsigned char>(i < 1000 ? 0 : i < 3000 ? i % 7 : i * 31));
+	}
+
+	std::vector<unsigned char> compressed;
+
+	DeflateEncoder encoder(compressed);
+
+	encoder.add_distance(1);
+	encoder.add_distance(7);
+
+	// Two flushed parts, the second matching into the first.
+	encoder.write(data.data(), 2500, 0);
+	encoder.flush();
+	encoder.write(data.data() + 2500, data.size() - 2500, 2500);
+	encoder.finish();
+
+	EXPECT_LT(compressed.size(), data.size());
+
+	std::vector<unsigned char> output;
+
+	FixedInflater inflater(compressed, 0);
+
+	ASSERT_TRUE(inflater.inflate(output));
+	EXPECT_EQ(output, data);
+	EXPECT_EQ(inflater.get_position(), compressed.size());
+}
+
+TEST(HeapMapImageExporter, Crc32)
+{
+	std::string text = "123456789";
+
+	EXPECT_EQ(HeapMapImageExporter::crc32(reinterpret_cast<const unsigned char*>(text.data()), text.size()), 0xCBF43926);
+}
+
+TEST(HeapMapImageExporter, PngRoundtrip)
+{
+	const unsigned int WIDTH = 100;
+	const unsigned int HEIGHT = 70;
+
+	auto pixels = CreatePixels(WIDTH, HEIGHT);
+
+	for (unsigned int threads = 1; threads <= 3; threads++)
+	{
+		std::ostringstream stream;
+
+		ASSERT_TRUE(HeapMapImageExporter::write_png(stream, reinterpret_cast<const unsigned char*>(pixels.data()), WIDTH, HEIGHT, threads));
+
+		std::vector<unsigned int> decoded;
+		unsigned int width = 0;
+		unsigned int height = 0;
+
+		ASSERT_TRUE(DecodePng(stream.str(), decoded, width, height));
+
+		EXPECT_EQ(width, WIDTH);
+		EXPECT_EQ(height, HEIGHT);
+		EXPECT_EQ(decoded, pixels);
+	}
+}
+
+TEST(HeapMapImageExporter, Ppm)
+{
+	// Blue in the lowest byte, as QImage::Format_RGB32 reads pixels.
+	std::vector<unsigned int> pixels = { 0x80FF0000, 0x8000FF00, 0x800000FF, 0x80102030 };
+
+	std::ostringstream stream;
+
+	ASSERT_TRUE(HeapMapImageExporter::write_ppm(stream, reinterpret_cast<const unsigned char*>(pixels.data()), 2, 2));
+
+	auto expected = std::string("P6\n2 2\n255\n") + std::string("\xFF\x00\x00\x00\xFF\x00\x00\x00\xFF\x10\x20\x30", 12);
+
+	EXPECT_EQ(stream.str(), expected);
+}
+
+TEST(HeapMapImageExporter, SameColorsAsSvg)
+{
+	// SVG images fill heap ranges with #0000FF and image ranges with #8B0000.
+	std::vector<unsigned int> pixels = { HeapMapRasterizer::to_pixel(HeapMapRasterizer::get_color(State::Commit, Usage::Heap)), HeapMapRasterizer::to_pixel(HeapMapRasterizer::get_color(State::Commit, Usage::Image)) };
+
+	std::ostringstream stream;
+
+	ASSERT_TRUE(HeapMapImageExporter::write_ppm(stream, reinterpret_cast<const unsigned char*>(pixels.data()), 2, 1));
+
+	auto expected = std::string("P6\n2 1\n255\n") + std::string("\x00\x00\xFF\x8B\x00\x00", 6);
+
+	EXPECT_EQ(stream.str(), expected);
+}
+
+TEST(HeapMapImageExporter, EmptyMap)
+{
+	std::ostringstream stream;
+
+	EXPECT_FALSE(HeapMapImageExporter::write_png(stream, nullptr, 0, 0));
+	EXPECT_FALSE(HeapMapImageExporter::write_ppm(stream, nullptr, 0, 0));
+}
+
+TEST(HeapMapImageExporter, DISABLED_Benchmark)
+{
+	const unsigned int WIDTH = 2048;
+	const unsigned int HEIGHT = 512;
+
+	auto pixels = CreatePixels(WIDTH, HEIGHT);
+
+	std::ostringstream stream;
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	ASSERT_TRUE(HeapMapImageExporter::write_png(stream, reinterpret_cast<const unsigned char*>(pixels.data()), WIDTH, HEIGHT));
+
+	auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+	RecordProperty("Microseconds", (int) elapsed);
+}
\ No newline at end of file
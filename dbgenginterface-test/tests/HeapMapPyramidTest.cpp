@@ -0,0 +1,286 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file HeapMapPyramidTest.cpp
+
+Implements HeapMapPyramidTest class defines unit tests for HeapMapPyramid class.
+*/
+
+#include "..\stdafx.h"
+
+#include "HeapMapPyramid.h"
+
+TEST(HeapMapPyramid, Empty)
+{
+	HeapMapPyramid pyramid;
+
+	pyramid.build(nullptr, 0, 0);
+
+	EXPECT_EQ(pyramid.get_level_count(), 0);
+}
+
+TEST(HeapMapPyramid, DominantClasses)
+{
+	const unsigned int A = HeapMapRasterizer::to_pixel(HeapMapRasterizer::get_color(State::Commit, Usage::Heap));
+	const unsigned int B = HeapMapRasterizer::to_pixel(HeapMapRasterizer::get_color(State::Commit, Usage::VirtualAlloc));
+	const unsigned int C = HeapMapRasterizer::to_pixel(HeapMapRasterizer::get_color(State::Reserve, Usage::Image));
+
+	// Left half is mostly A, right half is mostly B with a column of C.
+	std::vector<unsigned int> pixels = {
+		A, A, A, B, B, B, C, B,
+		A, A, A, A, B, B, C, B,
+		A, B, A, A, B, B, C, B,
+		A, A, C, A, B, B, C, C,
+	};
+
+	HeapMapPyramid pyramid;
+
+	pyramid.build(reinterpret_cast<const unsigned char*>(pixels.data()), 8, 4);
+
+	EXPECT_EQ(pyramid.get_level_count(), 4);
+
+	EXPECT_EQ(pyramid.get_width(1), 4);
+	EXPECT_EQ(pyramid.get_height(1), 2);
+	EXPECT_EQ(pyramid.get_width(3), 1);
+	EXPECT_EQ(pyramid.get_height(3), 1);
+
+	EXPECT_EQ(pyramid.get_pixel(0, 3, 0), B);
+	EXPECT_EQ(pyramid.get_pixel(1, 0, 0), A);
+	EXPECT_EQ(pyramid.get_pixel(1, 1, 0), A);
+	EXPECT_EQ(pyramid.get_pixel(1, 2, 0), B);
+	EXPECT_EQ(pyramid.get_pixel(1, 3, 1), C);
+
+	// 2x2 blocks with two pages each are resolved to the first state and usage, C is a color of the free state.
+	EXPECT_EQ(pyramid.get_pixel(1, 3, 0), C);
+
+	EXPECT_EQ(pyramid.get_pixel(2, 0, 0), A);
+	EXPECT_EQ(pyramid.get_pixel(2, 1, 0), B);
+
+	// Whole map has 13 A, 13 B and 6 C pages, B is before A in usage order.
+	EXPECT_EQ(pyramid.get_pixel(3, 0, 0), B);
+	EXPECT_FALSE(pyramid.is_averaged());
+
+	EXPECT_EQ(pyramid.select_level(1.0), 0);
+	EXPECT_EQ(pyramid.select_level(0.5), 1);
+	EXPECT_EQ(pyramid.select_level(0.3), 1);
+	EXPECT_EQ(pyramid.select_level(0.25), 2);
+	EXPECT_EQ(pyramid.select_level(0.01), 3);
+}
+
+TEST(HeapMapPyramid, BlendedColorsAreAveraged)
+{
+	const unsigned int A = HeapMapRasterizer::to_pixel(HeapMapRasterizer::get_color(State::Commit, Usage::Heap));
+
+	std::vector<unsigned int> pixels = {
+		0x80102030, 0x80304050, A, A,
+		0x80506070, 0x80708090, A, A,
+	};
+
+	HeapMapPyramid pyramid;
+
+	pyramid.build(reinterpret_cast<const unsigned char*>(pixels.data()), 4, 2);
+
+	EXPECT_TRUE(pyramid.is_averaged());
+	EXPECT_EQ(pyramid.get_pixel(1, 0, 0), 0x80405060);
+	EXPECT_EQ(pyramid.get_pixel(1, 1, 0), A);
+	EXPECT_EQ(pyramid.get_pixel(2, 0, 0), 0x802028AF);
+
+	// Updating a part with state and usage colors keeps averages, updating the whole map classes pixels again.
+	std::vector<HeapMapRect> rects(1, HeapMapRect(0, 0, 1, 1));
+
+	pixels[0] = A;
+
+	pyramid.update(reinterpret_cast<const unsigned char*>(pixels.data()), 4, 2, rects);
+
+	EXPECT_TRUE(pyramid.is_averaged());
+
+	std::fill(pixels.begin(), pixels.end(), A);
+
+	rects.assign(1, HeapMapRect(0, 0, 4, 2));
+
+	pyramid.update(reinterpret_cast<const unsigned char*>(pixels.data()), 4, 2, rects);
+
+	EXPECT_FALSE(pyramid.is_averaged());
+	EXPECT_EQ(pyramid.get_pixel(2, 0, 0), A);
+}
+
+TEST(HeapMapPyramid, OddSizes)
+{
+	std::vector<unsigned int> pixels(5 * 3, 0x80808080);
+
+	pixels[14] = 0x80FFFFFF;
+
+	HeapMapPyramid pyramid;
+
+	pyramid.build(reinterpret_cast<const unsigned char*>(pixels.data()), 5, 3);
+
+	EXPECT_EQ(pyramid.get_level_count(), 4);
+	EXPECT_EQ(pyramid.get_width(1), 3);
+	EXPECT_EQ(pyramid.get_height(1), 2);
+	EXPECT_EQ(pyramid.get_pixel(1, 2, 1), 0x80FFFFFF);
+	EXPECT_EQ(pyramid.get_width(2), 2);
+	EXPECT_EQ(pyramid.get_height(2), 1);
+	EXPECT_EQ(pyramid.get_pixel(2, 1, 0), 0x80808080);
+}
+
+TEST(HeapMapPyramid, RebuildReusesLevels)
+{
+	std::vector<unsigned int> pixels(8 * 4, 0x80808080);
+
+	HeapMapPyramid pyramid;
+
+	pyramid.build(reinterpret_cast<const unsigned char*>(pixels.data()), 8, 4);
+
+	auto level0 = pyramid.get_pixels(0);
+	auto level1 = pyramid.get_pixels(1);
+
+	pixels[0] = 0x80FFFFFF;
+
+	pyramid.build(reinterpret_cast<const unsigned char*>(pixels.data()), 8, 4);
+
+	EXPECT_EQ(pyramid.get_level_count(), 4);
+	EXPECT_EQ(pyramid.get_pixels(0), level0);
+	EXPECT_EQ(pyramid.get_pixels(1), level1);
+	EXPECT_EQ(pyramid.get_pixel(0, 0, 0), 0x80FFFFFF);
+
+	// Smaller maps have fewer levels.
+	pyramid.build(reinterpret_cast<const unsigned char*>(pixels.data()), 2, 2);
+
+	EXPECT_EQ(pyramid.get_level_count(), 2);
+	EXPECT_EQ(pyramid.get_width(0), 2);
+	EXPECT_EQ(pyramid.get_pixel(1, 0, 0), 0x80808080);
+
+	pyramid.clear();
+
+	EXPECT_EQ(pyramid.get_level_count(), 0);
+}
+
+TEST(HeapMapPyramid, UpdateSameAsBuild)
+{
+	const unsigned int A = HeapMapRasterizer::to_pixel(HeapMapRasterizer::get_color(State::Commit, Usage::Heap));
+	const unsigned int B = HeapMapRasterizer::to_pixel(HeapMapRasterizer::get_color(State::Commit, Usage::VirtualAlloc));
+	const unsigned int C = HeapMapRasterizer::to_pixel(HeapMapRasterizer::get_color(State::Reserve, Usage::Image));
+
+	const unsigned int WIDTH = 37;
+	const unsigned int HEIGHT = 21;
+
+	std::vector<unsigned int> pixels(WIDTH * HEIGHT);
+
+	for (unsigned int i = 0; i < pixels.size(); i++)
+	{
+		pixels[i] = (i / 5) % 3 == 0 ? A : (i / 7) % 2 == 0 ? B : C;
+	}
+
+	HeapMapPyramid pyramid;
+
+	pyramid.build(reinterpret_cast<const unsigned char*>(pixels.data()), WIDTH, HEIGHT);
+
+	for (unsigned int y = 5; y < 12; y++)
+	{
+		for (unsigned int x = 9; x < 30; x++)
+		{
+			pixels[y * WIDTH + x] = C;
+		}
+	}
+
+	pixels[WIDTH * HEIGHT - 1] = A;
+
+	std::vector<HeapMapRect> rects;
+
+	rects.push_back(HeapMapRect(9, 5, 21, 7));
+	rects.push_back(HeapMapRect(WIDTH - 1, HEIGHT - 1, 5, 5));
+
+	pyramid.update(reinterpret_cast<const unsigned char*>(pixels.data()), WIDTH, HEIGHT, rects);
+
+	HeapMapPyramid expected;
+
+	expected.build(reinterpret_cast<const unsigned char*>(pixels.data()), WIDTH, HEIGHT);
+
+	ASSERT_EQ(pyramid.get_level_count(), expected.get_level_count());
+
+	for (size_t level = 0; level < expected.get_level_count(); level++)
+	{
+		for (unsigned int y = 0; y < expected.get_height(level); y++)
+		{
+			for (unsigned int x = 0; x < expected.get_width(level); x++)
+			{
+				EXPECT_EQ(pyramid.get_pixel(level, x, y), expected.get_pixel(level, x, y)) << "level " << level << " at " << x << ", " << y;
+			}
+		}
+	}
+}
+
+TEST(HeapMapPyramid, RepeatedUpdatesSameAsBuild)
+{
+	const unsigned int WIDTH = 128;
+	const unsigned int HEIGHT = 64;
+
+	std::vector<unsigned int> classes;
+
+	for (auto usage : { Usage::Heap, Usage::Image, Usage::Stack, Usage::Free })
+	{
+		classes.push_back(HeapMapRasterizer::to_pixel(HeapMapRasterizer::get_color(State::Commit, usage)));
+	}
+
+	std::vector<unsigned int> pixels(WIDTH * HEIGHT);
+
+	for (unsigned int i = 0; i < pixels.size(); i++)
+	{
+		pixels[i] = classes[(i / 3 + i / WIDTH) % classes.size()];
+	}
+
+	HeapMapPyramid pyramid;
+
+	pyramid.build(reinterpret_cast<const unsigned char*>(pixels.data()), WIDTH, HEIGHT);
+
+	// Counts kept by each update are used by the next one.
+	for (unsigned int i = 0; i < 200; i++)
+	{
+		auto x = (i * 37) % WIDTH;
+		auto y = (i * 11) % HEIGHT;
+
+		for (unsigned int dy = 0; dy < 3 && y + dy < HEIGHT; dy++)
+		{
+			for (unsigned int dx = 0; dx < 5 && x + dx < WIDTH; dx++)
+			{
+				pixels[(y + dy) * WIDTH + x + dx] = classes[i % classes.size()];
+			}
+		}
+
+		pyramid.update(reinterpret_cast<const unsigned char*>(pixels.data()), WIDTH, HEIGHT, std::vector<HeapMapRect>(1, HeapMapRect(x, y, 5, 3)));
+	}
+
+	HeapMapPyramid expected;
+
+	expected.build(reinterpret_cast<const unsigned char*>(pixels.data()), WIDTH, HEIGHT);
+
+	for (size_t level = 0; level < expected.get_level_count(); level++)
+	{
+		auto size = (size_t) expected.get_width(level) * expected.get_height(level) * 4;
+
+		EXPECT_EQ(0, memcmp(pyramid.get_pixels(level), expected.get_pixels(level), size)) << "level " << level;
+	}
+}
\ No newline at end of file
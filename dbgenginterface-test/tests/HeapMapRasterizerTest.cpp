@@ -0,0 +1,346 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file HeapMapRasterizerTest.cpp
+
+Implements HeapMapRasterizerTest class defines unit tests and a timed check for HeapMapRasterizer class.
+*/
+
+#include "..\stdafx.h"
+
+#include <chrono>
+
+#include "HeapMapRasterizer.h"
+#include "FakeRanges.h"
+
+static const unsigned int WIDTH = 2048;
+static const unsigned int HEIGHT = 512;
+
+static const std::vector<Usage> ALL_USAGES = { Usage::VirtualAlloc, Usage::Free, Usage::Image, Usage::Stack, Usage::Heap, Usage::PageHeap, Usage::GCHeap, Usage::GCLOHeap };
+
+/**
+Draws ranges page by page like the original gcview renderer, drawing ranges of a page or less as one page, with blue in the lowest byte.
+*/
+static void DrawReference(unsigned char* buffer, RangeList ranges, bool isMonochrome)
+{
+	const unsigned int PAGE_SIZE = 4096;
+
+	for (auto mr : *ranges)
+	{
+		unsigned int x = mr.Address / PAGE_SIZE / HEIGHT;
+		unsigned int y = (mr.Address / PAGE_SIZE) % HEIGHT;
+
+		auto c = HeapMapRasterizer::get_color(mr.State, isMonochrome && mr.Usage != Usage::Free ? Usage::Undefined : mr.Usage);
+
+		unsigned int numPages = mr.Size > PAGE_SIZE ? mr.Size / PAGE_SIZE : (mr.Size > 0 ? 1 : 0);
+
+		for (unsigned int pos = 0; pos < numPages; pos++)
+		{
+			if (y == HEIGHT)
+			{
+				y = 0;
+				x++;
+			}
+
+			if (x >= WIDTH)
+			{
+				continue;
+			}
+
+			buffer[4 * (y * WIDTH + x)] = c & 0xFF;
+			buffer[4 * (y * WIDTH + x) + 1] = (c >> 8) & 0xFF;
+			buffer[4 * (y * WIDTH + x) + 2] = (c >> 16) & 0xFF;
+
+			y++;
+		}
+	}
+}
+
+TEST(HeapMapRasterizer, Colors)
+{
+	EXPECT_EQ(HeapMapRasterizer::get_color(State::Commit, Usage::Heap), 0x0000FF);
+	EXPECT_EQ(HeapMapRasterizer::get_color(State::Undefined, Usage::Heap), 0x808080);
+	EXPECT_EQ(HeapMapRasterizer::to_pixel(0x123456), 0x80123456);
+}
+
+TEST(HeapMapRasterizer, SubPageRanges)
+{
+	HeapMapRasterizer rasterizer(4, 2);
+
+	auto ranges = new std::vector<const MemoryRange>();
+
+	ranges->push_back(MemoryRange(0x1000, 0x1000, State::Commit, Usage::Heap));
+	ranges->push_back(MemoryRange(0x2800, 0x10, State::Commit, Usage::Image));
+	ranges->push_back(MemoryRange(0x5000, 0, State::Commit, Usage::Image));
+	ranges->push_back(MemoryRange(0x6000, 0x3000, State::Commit, Usage::Stack));
+
+	rasterizer.draw(RangeList(ranges));
+
+	std::vector<unsigned int> pixels(8);
+
+	rasterizer.copy_to(reinterpret_cast<unsigned char*>(pixels.data()));
+
+	auto heap = HeapMapRasterizer::to_pixel(0x0000FF);
+	auto image = HeapMapRasterizer::to_pixel(0x8B0000);
+	auto stack = HeapMapRasterizer::to_pixel(0x800080);
+	auto none = HeapMapRasterizer::BACKGROUND;
+
+	// Pages 0 and 1 are in the first column, rows then columns in the buffer. Pages past the map are clipped.
+	EXPECT_EQ(pixels, std::vector<unsigned int>({ none, image, none, stack, heap, none, none, stack }));
+}
+
+TEST(HeapMapRasterizer, RangeIndexFind)
+{
+	auto ranges = new std::vector<const MemoryRange>();
+
+	ranges->push_back(MemoryRange(0x8000, 0x2000, State::Commit, Usage::Heap));
+	ranges->push_back(MemoryRange(0x0000, 0x10000, State::Commit, Usage::Image));
+	ranges->push_back(MemoryRange(0x3000, 0, State::Commit, Usage::Image));
+	ranges->push_back(MemoryRange(0x4000, 0x1000, State::Commit, Usage::Stack));
+
+	HeapMapRangeIndex index((RangeList(ranges)));
+
+	EXPECT_EQ(index.size(), 3);
+
+	std::vector<unsigned int> indexes;
+
+	// Ranges without pages are not found, found ranges are in list order.
+	index.find(3, 9, indexes);
+
+	EXPECT_EQ(indexes, std::vector<unsigned int>({ 0, 1, 3 }));
+
+	index.find(5, 8, indexes);
+
+	EXPECT_EQ(indexes, std::vector<unsigned int>({ 1 }));
+
+	index.find(16, 20, indexes);
+
+	EXPECT_TRUE(indexes.empty());
+}
+
+TEST(HeapMapRasterizer, SameAsPageByPage)
+{
+	auto ranges = FakeRanges(7).create_overlapping(20000, ALL_USAGES);
+	auto gcRanges = FakeRanges(11).create_overlapping(2000, ALL_USAGES);
+
+	std::vector<unsigned char> expected(4 * WIDTH * HEIGHT, 0x80);
+
+	DrawReference(expected.data(), ranges, true);
+	DrawReference(expected.data(), gcRanges, false);
+
+	HeapMapRasterizer rasterizer(WIDTH, HEIGHT);
+
+	rasterizer.draw(ranges, true);
+	rasterizer.draw(gcRanges);
+
+	std::vector<unsigned char> buffer(4 * WIDTH * HEIGHT);
+
+	rasterizer.copy_to(buffer.data());
+
+	EXPECT_TRUE(buffer == expected);
+}
+
+TEST(HeapMapRasterizer, SpansSameAsDraw)
+{
+	auto ranges = FakeRanges(7).create_overlapping(5000, ALL_USAGES);
+	auto gcRanges = FakeRanges(17).create_overlapping(1000, ALL_USAGES);
+
+	HeapMapRasterizer rasterizer(WIDTH, HEIGHT);
+
+	rasterizer.add_layer(ranges, true);
+	rasterizer.add_layer(gcRanges);
+
+	rasterizer.draw(ranges, true);
+	rasterizer.draw(gcRanges);
+
+	std::vector<unsigned char> buffer(4 * WIDTH * HEIGHT);
+
+	rasterizer.copy_to(buffer.data());
+
+	std::vector<HeapMapSpan> spans;
+
+	rasterizer.get_spans(spans);
+
+	std::vector<unsigned int> pages(WIDTH * HEIGHT, HeapMapRasterizer::BACKGROUND);
+
+	for (size_t i = 0; i < spans.size(); i++)
+	{
+		if (i > 0)
+		{
+			EXPECT_LE(spans[i - 1].EndPage, spans[i].FirstPage);
+		}
+
+		for (auto page = spans[i].FirstPage; page < spans[i].EndPage && page < pages.size(); page++)
+		{
+			pages[page] = spans[i].Pixel;
+		}
+	}
+
+	auto pixels = reinterpret_cast<const unsigned int*>(buffer.data());
+	size_t mismatches = 0;
+
+	for (unsigned int page = 0; page < WIDTH * HEIGHT; page++)
+	{
+		if (pixels[(page % HEIGHT) * WIDTH + page / HEIGHT] != pages[page])
+		{
+			mismatches++;
+		}
+	}
+
+	EXPECT_EQ(mismatches, 0);
+}
+
+TEST(HeapMapRasterizer, ChangedRects)
+{
+	auto oldRanges = FakeRanges(11).create_overlapping(3000, ALL_USAGES);
+	auto newRanges = RangeList(new std::vector<const MemoryRange>(*oldRanges));
+
+	HeapMapRasterizer rasterizer(WIDTH, HEIGHT);
+
+	rasterizer.add_layer(oldRanges);
+
+	std::vector<HeapMapSpan> oldSpans;
+	std::vector<HeapMapSpan> newSpans;
+	std::vector<HeapMapRect> rects;
+
+	rasterizer.get_spans(oldSpans);
+
+	// Same ranges in another list change nothing.
+	rasterizer.clear_layers();
+	rasterizer.add_layer(newRanges);
+	rasterizer.get_spans(newSpans);
+	rasterizer.get_changed_rects(oldSpans, newSpans, rects);
+
+	EXPECT_TRUE(rects.empty());
+
+	HeapMapRasterizer old_rasterizer(WIDTH, HEIGHT);
+
+	old_rasterizer.draw(oldRanges);
+
+	std::vector<unsigned int> buffer(WIDTH * HEIGHT);
+
+	old_rasterizer.copy_to(reinterpret_cast<unsigned char*>(buffer.data()));
+
+	// Change a few ranges, pixels outside the changed rectangles must stay the same.
+	auto ranges = new std::vector<const MemoryRange>(*oldRanges);
+
+	ranges->erase(ranges->begin() + 100);
+	ranges->insert(ranges->begin() + 1000, MemoryRange(0x20000000, 0x3000, State::Commit, Usage::Stack));
+	(*ranges)[2000] = MemoryRange((*ranges)[2000].Address, (*ranges)[2000].Size, State::Commit, (*ranges)[2000].Usage == Usage::Heap ? Usage::Image : Usage::Heap);
+
+	newRanges = RangeList(ranges);
+
+	rasterizer.clear_layers();
+	rasterizer.add_layer(newRanges);
+	rasterizer.get_spans(newSpans);
+	rasterizer.get_changed_rects(oldSpans, newSpans, rects);
+
+	ASSERT_FALSE(rects.empty());
+
+	unsigned int area = 0;
+
+	for (size_t i = 0; i < rects.size(); i++)
+	{
+		if (i > 0)
+		{
+			EXPECT_LT(rects[i - 1].X + rects[i - 1].Width, rects[i].X);
+		}
+
+		area += rects[i].Width * rects[i].Height;
+	}
+
+	EXPECT_LT(area, WIDTH * HEIGHT / 2);
+
+	HeapMapRasterizer expected_rasterizer(WIDTH, HEIGHT);
+
+	expected_rasterizer.draw(newRanges);
+
+	std::vector<unsigned int> expected(WIDTH * HEIGHT);
+
+	expected_rasterizer.copy_to(reinterpret_cast<unsigned char*>(expected.data()));
+
+	for (auto& rect : rects)
+	{
+		for (auto y = rect.Y; y < rect.Y + rect.Height; y++)
+		{
+			std::copy_n(&expected[y * WIDTH + rect.X], rect.Width, &buffer[y * WIDTH + rect.X]);
+		}
+	}
+
+	EXPECT_TRUE(buffer == expected);
+}
+
+TEST(HeapMapRasterizer, ChangedRectsInColumn)
+{
+	HeapMapRasterizer rasterizer(WIDTH, HEIGHT);
+
+	std::vector<HeapMapSpan> oldSpans;
+	std::vector<HeapMapSpan> newSpans;
+	std::vector<HeapMapRect> rects;
+
+	oldSpans.push_back(HeapMapSpan(HEIGHT + 10, HEIGHT + 20, 1));
+	newSpans.push_back(HeapMapSpan(HEIGHT + 10, HEIGHT + 15, 1));
+	newSpans.push_back(HeapMapSpan(HEIGHT + 15, HEIGHT + 30, 2));
+
+	rasterizer.get_changed_rects(oldSpans, newSpans, rects);
+
+	ASSERT_EQ(rects.size(), 1);
+	EXPECT_EQ(rects[0], HeapMapRect(1, 15, 1, 15));
+
+	// Changes over columns take whole columns, changes past the map are clipped.
+	newSpans.push_back(HeapMapSpan(3 * HEIGHT + 5, 4 * HEIGHT + 1, 3));
+	newSpans.push_back(HeapMapSpan(WIDTH * HEIGHT - 1, WIDTH * HEIGHT + 100, 3));
+
+	rasterizer.get_changed_rects(oldSpans, newSpans, rects);
+
+	ASSERT_EQ(rects.size(), 3);
+	EXPECT_EQ(rects[0], HeapMapRect(1, 15, 1, 15));
+	EXPECT_EQ(rects[1], HeapMapRect(3, 0, 2, HEIGHT));
+	EXPECT_EQ(rects[2], HeapMapRect(WIDTH - 1, HEIGHT - 1, 1, 1));
+}
+
+/**
+Draws a million ranges and copies the map. One core draws them in about 20 ms with optimizations, the check allows 50 times that for debug builds and slow machines.
+*/
+TEST(HeapMapRasterizer, Benchmark)
+{
+	auto ranges = FakeRanges(3).create_consecutive(1000000, { Usage::VirtualAlloc, Usage::Heap }, 1, 0, true);
+
+	HeapMapRasterizer rasterizer(WIDTH, HEIGHT);
+
+	std::vector<unsigned char> buffer(4 * WIDTH * HEIGHT);
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	rasterizer.draw(ranges);
+	rasterizer.copy_to(buffer.data());
+
+	auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+	RecordProperty("Microseconds", (int) elapsed);
+
+	EXPECT_LT(elapsed, 1000000);
+}
\ No newline at end of file
@@ -0,0 +1,174 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file HeapMapSvgExporterTest.cpp
+
+Implements HeapMapSvgExporterTest class defines unit tests and a benchmark for HeapMapSvgExporter class.
+*/
+
+#include "..\stdafx.h"
+
+#include <chrono>
+#include <sstream>
+
+#include "HeapMapSvgExporter.h"
+#include "HeapMapRasterizer.h"
+#include "FakeRanges.h"
+
+static const unsigned int WIDTH = 2048;
+static const unsigned int HEIGHT = 512;
+
+/**
+Paints the rectangles of an SVG image written by the exporter to a row-major buffer of HeapMapRasterizer pixels.
+*/
+static void Paint(const std::string& svg, std::vector<unsigned int>& pixels, size_t& rect_count)
+{
+	std::istringstream lines(svg);
+	std::string line;
+
+	unsigned int groupColor = 0;
+
+	rect_count = 0;
+
+	while (std::getline(lines, line))
+	{
+		unsigned int x, y, width, height, color;
+
+		if (sscanf(line.c_str(), "<g fill=\"#%x\"", &color) == 1)
+		{
+			groupColor = color;
+		}
+		else if (sscanf(line.c_str(), "<rect x=\"%u\" y=\"%u\" width=\"%u\" height=\"%u\"", &x, &y, &width, &height) == 4)
+		{
+			auto fill = line.find("fill=\"#");
+
+			if (fill == std::string::npos || sscanf(line.c_str() + fill, "fill=\"#%x\"", &color) != 1)
+			{
+				color = groupColor;
+			}
+
+			for (auto row = y; row < y + height; row++)
+			{
+				for (auto column = x; column < x + width; column++)
+				{
+					pixels[row * WIDTH + column] = HeapMapRasterizer::to_pixel(color);
+				}
+			}
+
+			rect_count++;
+		}
+	}
+}
+
+TEST(HeapMapSvgExporter, SameAsRasterizer)
+{
+	auto ranges = FakeRanges(3).create_consecutive(100000, { Usage::VirtualAlloc, Usage::Free, Usage::Image, Usage::Heap }, 8, 0, true);
+
+	auto gcList = new std::vector<const MemoryRange>();
+
+	for (unsigned long i = 0; i < 1000; i++)
+	{
+		gcList->push_back(MemoryRange(i * 0x400000 + 0x3000, 0x100000 + i * 0x1000, i % 2 == 0 ? State::Commit : State::Reserve, i % 3 == 0 ? Usage::GCLOHeap : Usage::GCHeap));
+	}
+
+	RangeList gcRanges(gcList);
+
+	HeapMapSvgExporter exporter(WIDTH, HEIGHT);
+	HeapMapRasterizer rasterizer(WIDTH, HEIGHT);
+
+	exporter.add_layer(ranges, true);
+	exporter.add_layer(gcRanges);
+
+	rasterizer.draw(ranges, true);
+	rasterizer.draw(gcRanges);
+
+	std::ostringstream stream;
+
+	EXPECT_TRUE(exporter.write(stream));
+
+	std::vector<unsigned int> expected(WIDTH * HEIGHT);
+	std::vector<unsigned int> pixels(WIDTH * HEIGHT);
+
+	rasterizer.copy_to(reinterpret_cast<unsigned char*>(expected.data()));
+
+	size_t rect_count;
+
+	Paint(stream.str(), pixels, rect_count);
+
+	EXPECT_TRUE(pixels == expected);
+
+	// Contiguous ranges of the same state are merged in the monochrome layer.
+	EXPECT_LT(rect_count, ranges->size());
+}
+
+TEST(HeapMapSvgExporter, MergedRuns)
+{
+	auto ranges = new std::vector<const MemoryRange>();
+
+	ranges->push_back(MemoryRange(0x1000, 0x1000, State::Commit, Usage::Heap));
+	ranges->push_back(MemoryRange(0x2000, 0x3000, State::Commit, Usage::Heap));
+	ranges->push_back(MemoryRange(0x5000, 0x1000, State::Commit, Usage::Image));
+	ranges->push_back(MemoryRange(HEIGHT * 0x1000 - 0x2000, HEIGHT * 0x1000 * 3, State::Reserve, Usage::Heap));
+
+	HeapMapSvgExporter exporter(WIDTH, HEIGHT);
+
+	exporter.add_layer(RangeList(ranges));
+
+	std::ostringstream stream;
+
+	EXPECT_TRUE(exporter.write(stream, 1024, 256));
+
+	auto svg = stream.str();
+
+	EXPECT_NE(std::string::npos, svg.find("width=\"1024\" height=\"256\" viewBox=\"0 0 2048 512\""));
+	EXPECT_NE(std::string::npos, svg.find("<rect x=\"0\" y=\"1\" width=\"1\" height=\"4\" fill=\"#0000FF\"><title>Heap, Commit: 0x00001000-0x00005000</title></rect>\n"));
+	EXPECT_NE(std::string::npos, svg.find("<rect x=\"0\" y=\"5\" width=\"1\" height=\"1\" fill=\"#8B0000\"><title>Image, Commit: 0x00005000-0x00006000</title></rect>\n"));
+	EXPECT_NE(std::string::npos, svg.find(
+		"<g fill=\"#ADD8E6\"><title>Heap, Reserve: 0x001FE000-0x007FE000</title>\n"
+		"<rect x=\"0\" y=\"510\" width=\"1\" height=\"2\"/>\n"
+		"<rect x=\"1\" y=\"0\" width=\"2\" height=\"512\"/>\n"
+		"<rect x=\"3\" y=\"0\" width=\"1\" height=\"510\"/>\n"
+		"</g>\n"));
+}
+
+TEST(HeapMapSvgExporter, DISABLED_Benchmark)
+{
+	auto ranges = FakeRanges(5).create_consecutive(200000, { Usage::VirtualAlloc, Usage::Free, Usage::Image, Usage::Heap }, 8, 0, true);
+
+	HeapMapSvgExporter exporter(WIDTH, HEIGHT);
+
+	exporter.add_layer(ranges);
+
+	std::ostringstream stream;
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	exporter.write(stream);
+
+	auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+	RecordProperty("Microseconds", (int) elapsed);
+}
\ No newline at end of file
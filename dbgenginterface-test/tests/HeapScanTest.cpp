@@ -0,0 +1,156 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file HeapScanTest.cpp
+
+Implements HeapScanTest class defines unit tests for HeapScan class.
+*/
+
+#include "..\stdafx.h"
+
+#include "HeapScan.h"
+#include "FakeDebuggerCommandExecutor.h"
+#include "FakeHeap.h"
+#include "FakeLogger.h"
+
+/**
+Creates a segment of Thread (5000), SafeWaitHandle (5100) and other (5200) objects.
+*/
+static RangeList CreateHeap(FakeHeap& heap, unsigned long count)
+{
+	heap.add_method_table(0x5000, 0x34, 0);
+	heap.add_method_table(0x5100, 0x14, 0);
+	heap.add_method_table(0x5200, 12, 0);
+
+	auto address = 0x100000UL;
+
+	for (unsigned long i = 0; i < count; i++)
+	{
+		address += heap.add_object(address, 0x5000 + 0x100 * (i % 3), i % 3 == 0 ? 0x34 : i % 3 == 1 ? 0x14 : 12, 0, 0);
+	}
+
+	auto ranges = new std::vector<const MemoryRange>();
+
+	ranges->push_back(MemoryRange(0x100000, address - 0x100000, State::Commit, Usage::GCHeap));
+
+	return RangeList(ranges);
+}
+
+TEST(HeapScan, AnswersQueriesWithOneWalk)
+{
+	auto logger = new FakeLogger();
+
+	std::vector<std::string> commands;
+
+	auto executor = new FakeDebuggerCommandExecutor(FakeDebuggerCommandExecutor::OutputLambda([&](const std::string& command, std::string& output)
+	{
+		commands.push_back(command);
+
+		if (command == "!name2ee *!Microsoft.Win32.SafeHandles.SafeWaitHandle")
+		{
+			output = "Module:      72a51000\n"
+				"Assembly:    mscorlib.dll\n"
+				"Token:       02000130\n"
+				"MethodTable: 5100\n"
+				"EEClass:     200\n"
+				"Name:        Microsoft.Win32.SafeHandles.SafeWaitHandle\n";
+		}
+
+		return true;
+	}));
+
+	FakeHeap heap;
+
+	auto segments = CreateHeap(heap, 30);
+
+	MethodTableCache method_tables;
+
+	method_tables.attach(executor, &heap, logger);
+
+	HeapScan scan;
+
+	scan.attach(&method_tables, logger);
+
+	auto threads = scan.add_query("System.Threading.Thread", std::vector<unsigned long>(1, 0x5000));
+	auto handles = scan.add_query("Microsoft.Win32.SafeHandles.SafeWaitHandle");
+	auto missing = scan.add_query("Missing.Type");
+
+	EXPECT_EQ(scan.add_query("Thread", std::vector<unsigned long>(2, 0x5000)), threads);
+	EXPECT_EQ(scan.add_query("Microsoft.Win32.SafeHandles.SafeWaitHandle"), handles);
+	EXPECT_EQ(scan.size(), 3);
+
+	EXPECT_TRUE(scan.run(segments, &heap, nullptr));
+	EXPECT_EQ(scan.get_walks(), 1);
+
+	ASSERT_EQ(scan.get_query(threads).Addresses.size(), 10);
+	ASSERT_EQ(scan.get_query(handles).Addresses.size(), 10);
+
+	EXPECT_EQ(scan.get_query(threads).Addresses.select(0), 0x100000);
+	EXPECT_EQ(scan.get_query(handles).Addresses.select(0), 0x100034);
+	EXPECT_TRUE(scan.get_query(threads).Addresses.contains(0x100048 + 12));
+
+	EXPECT_TRUE(scan.get_query(missing).IsAnswered);
+	EXPECT_TRUE(scan.get_query(missing).MethodTables.empty());
+	EXPECT_TRUE(scan.get_query(missing).Addresses.empty());
+
+	// Answered queries are not walked again.
+	EXPECT_TRUE(scan.run(segments, &heap, nullptr));
+	EXPECT_EQ(scan.get_walks(), 1);
+
+	// A new query walks once, for itself only.
+	auto others = scan.add_query("Other", std::vector<unsigned long>(1, 0x5200));
+
+	EXPECT_TRUE(scan.run(segments, &heap, nullptr));
+	EXPECT_EQ(scan.get_walks(), 2);
+	EXPECT_EQ(scan.get_query(others).Addresses.size(), 10);
+	EXPECT_EQ(scan.get_query(threads).Addresses.size(), 10);
+
+	// A grown heap answers all queries again.
+	segments = CreateHeap(heap, 33);
+
+	EXPECT_TRUE(scan.run(segments, &heap, nullptr));
+	EXPECT_EQ(scan.get_walks(), 3);
+	EXPECT_EQ(scan.get_query(threads).Addresses.size(), 11);
+	EXPECT_EQ(scan.get_query(handles).Addresses.size(), 11);
+	EXPECT_EQ(scan.get_query(others).Addresses.size(), 11);
+
+	// Invalidated answers are walked again on the same segments.
+	scan.invalidate();
+
+	EXPECT_FALSE(scan.get_query(threads).IsAnswered);
+	EXPECT_TRUE(scan.run(segments, &heap, nullptr));
+	EXPECT_EQ(scan.get_walks(), 4);
+	EXPECT_EQ(scan.get_query(threads).Addresses.size(), 11);
+
+	EXPECT_EQ(logger->_logs.size(), 0);
+
+	scan.clear();
+
+	EXPECT_EQ(scan.size(), 0);
+
+	delete executor;
+	delete logger;
+}
\ No newline at end of file
@@ -0,0 +1,388 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file HeapStatisticsTest.cpp
+
+Implements HeapStatisticsTest class defines unit tests for HeapStatTable and HeapStatistics classes.
+*/
+
+#include "..\stdafx.h"
+
+#include <map>
+
+#include "HeapStatTable.h"
+#include "HeapStatistics.h"
+#include "FakeDebuggerCommandExecutor.h"
+#include "FakeHeap.h"
+#include "FakeLogger.h"
+
+/**
+Creates two small object heap segments, the second one is ephemeral with generation 1 and 0 starting at its 30th and 60th objects, and a large object heap segment.
+*/
+static RangeList CreateHeap(FakeHeap& heap, GenerationStartList& generation_starts)
+{
+	heap.add_method_table(0x5000, 12, 0);
+	heap.add_method_table(0x5100, 14, 2);
+	heap.add_method_table(0x5200, 12, 4);
+
+	auto ranges = new std::vector<const MemoryRange>();
+
+	unsigned long counts[] = { 300, 90 };
+
+	for (unsigned long segment = 0; segment < 2; segment++)
+	{
+		auto start = 0x100000 * (segment + 1);
+		auto address = start;
+
+		for (unsigned long i = 0; i < counts[segment]; i++)
+		{
+			if (segment == 1 && i == 30)
+			{
+				generation_starts.push_back(std::make_pair(1UL, address));
+			}
+
+			if (segment == 1 && i == 60)
+			{
+				generation_starts.insert(generation_starts.begin(), std::make_pair(0UL, address));
+			}
+
+			switch (i % 3)
+			{
+			case 0:
+				address += heap.add_object(address, 0x5000, 12, 0, 0);
+				break;
+			case 1:
+				address += heap.add_object(address, 0x5100, 14, 2, i % 7);
+				break;
+			default:
+				address += heap.add_object(address, 0x5200, 12, 4, i % 5);
+				break;
+			}
+		}
+
+		ranges->push_back(MemoryRange(start, address - start, State::Commit, Usage::GCHeap));
+	}
+
+	generation_starts.push_back(std::make_pair(2UL, 0x100000UL));
+
+	auto address = 0x800000UL;
+
+	for (unsigned long i = 0; i < 4; i++)
+	{
+		address += heap.add_object(address, 0x5200, 12, 4, 0x100);
+
+		// Large objects are 8 byte aligned.
+		heap.write_u32(address, 0);
+		address += 4;
+	}
+
+	ranges->push_back(MemoryRange(0x800000, address - 0x800000, State::Commit, Usage::GCLOHeap));
+
+	return RangeList(ranges);
+}
+
+TEST(HeapStatTable, AddGrowAndMerge)
+{
+	HeapStatTable table;
+	HeapStatTable other;
+
+	for (unsigned long long key = 0; key < 1000; key++)
+	{
+		table.add(key << 12, 1, key);
+		table.add(key << 12, 1, key);
+	}
+
+	for (unsigned long long key = 500; key < 1500; key++)
+	{
+		other.add(key << 12, 1, 1);
+	}
+
+	EXPECT_EQ(table.size(), 1000);
+	EXPECT_EQ(table.get_slots().size(), 2048);
+	EXPECT_EQ(table.find(7 << 12)->Count, 2);
+	EXPECT_EQ(table.find(7 << 12)->Bytes, 14);
+	EXPECT_TRUE(table.find(1000 << 12) == nullptr);
+	EXPECT_TRUE(table.find(HeapStatTable::EMPTY_KEY) == nullptr);
+
+	table.merge(other);
+
+	EXPECT_EQ(table.size(), 1500);
+	EXPECT_EQ(table.find(499 << 12)->Count, 2);
+	EXPECT_EQ(table.find(500 << 12)->Count, 3);
+	EXPECT_EQ(table.find(500 << 12)->Bytes, 1001);
+	EXPECT_EQ(table.find(1499 << 12)->Count, 1);
+}
+
+TEST(HeapStatistics, ParallelSameAsSequentialWalk)
+{
+	auto logger = new FakeLogger();
+
+	FakeHeap heap;
+	GenerationStartList generation_starts;
+
+	auto segments = CreateHeap(heap, generation_starts);
+
+	MethodTableCache method_tables;
+
+	method_tables.attach(nullptr, &heap, logger);
+
+	// Expected totals per MethodTable and generation.
+	std::map<std::pair<unsigned long, unsigned long>, std::pair<unsigned long long, unsigned long long>> expected;
+
+	auto walker = GCHeapWalker(segments, &heap, &method_tables, logger);
+
+	EXPECT_TRUE(walker.walk([&](const GCHeapObject& object)
+	{
+		auto generation = 2UL;
+
+		if (object.Address >= 0x800000)
+		{
+			generation = HeapStatistics::LARGE_OBJECT_GENERATION;
+		}
+		else if (object.Address >= generation_starts[0].second)
+		{
+			generation = 0;
+		}
+		else if (object.Address >= generation_starts[1].second)
+		{
+			generation = 1;
+		}
+
+		auto& totals = expected[std::make_pair(object.MethodTable, generation)];
+
+		totals.first++;
+		totals.second += object.Size;
+
+		return true;
+	}));
+
+	ParallelGCHeapWalker sequential_walker(segments, &heap, &method_tables, nullptr, logger, 1);
+
+	HeapStatistics sequential(segments, generation_starts);
+
+	EXPECT_TRUE(sequential.collect(sequential_walker));
+
+	heap._is_thread_safe = true;
+
+	GCHeapBoundaryIndex boundary_index;
+
+	for (int walk = 0; walk < 2; walk++)
+	{
+		// Second walk splits segments at boundaries found by the first one.
+		ParallelGCHeapWalker parallel_walker(segments, &heap, &method_tables, &boundary_index, logger, 4, 0x200);
+
+		HeapStatistics parallel(segments, generation_starts);
+
+		EXPECT_TRUE(parallel.collect(parallel_walker));
+		EXPECT_TRUE(parallel.is_complete());
+
+		auto& a = sequential.get_entries();
+		auto& b = parallel.get_entries();
+
+		ASSERT_EQ(a.size(), b.size());
+
+		for (size_t i = 0; i < a.size(); i++)
+		{
+			EXPECT_EQ(a[i].MethodTable, b[i].MethodTable);
+			EXPECT_EQ(a[i].Segment, b[i].Segment);
+			EXPECT_EQ(a[i].Generation, b[i].Generation);
+			EXPECT_EQ(a[i].Count, b[i].Count);
+			EXPECT_EQ(a[i].Bytes, b[i].Bytes);
+		}
+	}
+
+	EXPECT_GT(boundary_index.size(), 0);
+
+	// Entries of both small object heap segments add up to the walked totals.
+	std::map<std::pair<unsigned long, unsigned long>, std::pair<unsigned long long, unsigned long long>> actual;
+
+	for (auto& entry : sequential.get_entries())
+	{
+		auto& totals = actual[std::make_pair(entry.MethodTable, entry.Generation)];
+
+		totals.first += entry.Count;
+		totals.second += entry.Bytes;
+	}
+
+	EXPECT_TRUE(actual == expected);
+
+	EXPECT_EQ(actual[std::make_pair(0x5000UL, 0UL)].first, 10);
+	EXPECT_EQ(actual[std::make_pair(0x5000UL, 1UL)].first, 10);
+	EXPECT_EQ(actual[std::make_pair(0x5000UL, 2UL)].first, 110);
+	EXPECT_EQ(actual[std::make_pair(0x5200UL, 3UL)].first, 4);
+
+	EXPECT_EQ(logger->_logs.size(), 0);
+
+	delete logger;
+}
+
+TEST(HeapStatistics, Query)
+{
+	auto logger = new FakeLogger();
+
+	std::vector<std::string> commands;
+
+	auto executor = new FakeDebuggerCommandExecutor(FakeDebuggerCommandExecutor::OutputLambda([&](const std::string& command, std::string& output)
+	{
+		commands.push_back(command);
+
+		if (command.find(".echo MT 5000; !dumpmt 5000;") != std::string::npos)
+		{
+			output += "MT 5000\nName:            System.Object\n";
+		}
+
+		if (command.find(".echo MT 5100; !dumpmt 5100;") != std::string::npos)
+		{
+			output += "MT 5100\nName:            System.String\n";
+		}
+
+		if (command.find(".echo MT 5200; !dumpmt 5200;") != std::string::npos)
+		{
+			output += "MT 5200\nName:            System.Int32[]\n";
+		}
+
+		return true;
+	}));
+
+	FakeHeap heap;
+	GenerationStartList generation_starts;
+
+	auto segments = CreateHeap(heap, generation_starts);
+
+	MethodTableCache method_tables;
+
+	method_tables.attach(executor, &heap, logger);
+
+	ParallelGCHeapWalker walker(segments, &heap, &method_tables, nullptr, logger, 1);
+
+	HeapStatistics statistics(segments, generation_starts);
+
+	EXPECT_TRUE(statistics.collect(walker));
+
+	HeapStatQuery query;
+
+	// All objects by count, the large objects make 0x5200 first.
+	query.Sort = HeapStatSort::Count;
+	query.Top = 2;
+
+	auto result = statistics.query(query, nullptr);
+
+	ASSERT_EQ(result.Rows.size(), 2);
+	EXPECT_EQ(result.Types, 3);
+	EXPECT_EQ(result.Count, 394);
+	EXPECT_EQ(result.Bytes, segments->at(0).Size + segments->at(1).Size + segments->at(2).Size - 4 * 4);
+	EXPECT_EQ(result.Rows[0].MethodTable, 0x5200);
+	EXPECT_EQ(result.Rows[0].Count, 134);
+	EXPECT_EQ(result.Rows[1].MethodTable, 0x5000);
+	EXPECT_EQ(result.Rows[1].Count, 130);
+	EXPECT_TRUE(result.Rows[0].Name.empty());
+
+	// Equal counts in a segment are ordered by MethodTable, any address in the segment selects it.
+	query.Segment = 0x100010;
+	query.Top = 0;
+
+	result = statistics.query(query, nullptr);
+
+	ASSERT_EQ(result.Rows.size(), 3);
+	EXPECT_EQ(result.Count, 300);
+	EXPECT_EQ(result.Bytes, segments->at(0).Size);
+	EXPECT_EQ(result.Rows[0].MethodTable, 0x5000);
+	EXPECT_EQ(result.Rows[1].MethodTable, 0x5100);
+	EXPECT_EQ(result.Rows[2].MethodTable, 0x5200);
+
+	query.Sort = HeapStatSort::Bytes;
+
+	result = statistics.query(query, nullptr);
+
+	ASSERT_EQ(result.Rows.size(), 3);
+	EXPECT_EQ(result.Rows[0].MethodTable, 0x5100);
+	EXPECT_EQ(result.Rows[2].MethodTable, 0x5000);
+	EXPECT_EQ(result.Rows[2].Bytes, 100 * 12);
+
+	// Unknown segment.
+	query.Segment = 0x300000;
+
+	result = statistics.query(query, nullptr);
+
+	EXPECT_EQ(result.Rows.size(), 0);
+	EXPECT_EQ(result.Types, 0);
+
+	// Large object heap.
+	query.Segment = 0;
+	query.Generation = HeapStatistics::LARGE_OBJECT_GENERATION;
+
+	result = statistics.query(query, nullptr);
+
+	ASSERT_EQ(result.Rows.size(), 1);
+	EXPECT_EQ(result.Rows[0].MethodTable, 0x5200);
+	EXPECT_EQ(result.Rows[0].Count, 4);
+	EXPECT_EQ(result.Bytes, segments->at(2).Size - 4 * 4);
+
+	query.Generation = 1;
+
+	result = statistics.query(query, nullptr);
+
+	EXPECT_EQ(result.Count, 30);
+	EXPECT_EQ(result.Types, 3);
+
+	// Names of selected rows are loaded with one command.
+	query.Generation = HeapStatQuery::ALL_GENERATIONS;
+	query.Top = 1;
+
+	result = statistics.query(query, &method_tables);
+
+	ASSERT_EQ(result.Rows.size(), 1);
+	EXPECT_EQ(result.Rows[0].Name, "System.Int32[]");
+	EXPECT_EQ(commands.size(), 1);
+
+	// Type filter loads remaining names with one command.
+	query.TypePrefix = "System.Str";
+	query.Top = 0;
+
+	result = statistics.query(query, &method_tables);
+
+	ASSERT_EQ(result.Rows.size(), 1);
+	EXPECT_EQ(result.Rows[0].MethodTable, 0x5100);
+	EXPECT_EQ(result.Rows[0].Name, "System.String");
+	EXPECT_EQ(result.Count, 130);
+	EXPECT_EQ(commands.size(), 2);
+
+	// Statistics are valid for the same heap only.
+	EXPECT_TRUE(statistics.matches(segments, generation_starts));
+	EXPECT_FALSE(statistics.matches(segments, GenerationStartList()));
+
+	auto grown = new std::vector<const MemoryRange>(segments->begin(), segments->end());
+
+	grown->pop_back();
+	grown->push_back(MemoryRange(0x800000, segments->at(2).Size + 0x10, State::Commit, Usage::GCLOHeap));
+
+	EXPECT_FALSE(statistics.matches(RangeList(grown), generation_starts));
+
+	EXPECT_EQ(logger->_logs.size(), 0);
+
+	delete executor;
+	delete logger;
+}
\ No newline at end of file
@@ -0,0 +1,146 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file IMemoryReaderTest.cpp
+
+Implements IMemoryReaderTest class defines unit tests for the vectored read of IMemoryReader class.
+*/
+
+#include "..\stdafx.h"
+
+#include "IMemoryReader.h"
+#include "FakeMemoryReader.h"
+
+/**
+Creates a reader whose readable memory is [0x10000, 0x14000) and [0x15000, 0x20000), each byte is the low byte of its address.
+*/
+static FakeMemoryReader* CreateFakeMemoryReader()
+{
+	return new FakeMemoryReader(FakeMemoryReader::ReadLambda([](unsigned long offset, void* buffer, unsigned long cb, unsigned long* read)
+	{
+		unsigned long count = 0;
+
+		for (; count < cb; count++)
+		{
+			auto address = offset + count;
+
+			if (address < 0x10000 || address >= 0x20000 || (address >= 0x14000 && address < 0x15000))
+			{
+				break;
+			}
+
+			static_cast<unsigned char*>(buffer)[count] = address & 0xFF;
+		}
+
+		*read = count;
+
+		return count == cb;
+	}));
+}
+
+TEST(IMemoryReader, ReadMany_empty)
+{
+	auto reader = CreateFakeMemoryReader();
+
+	std::vector<MemoryReadRequest> requests;
+
+	EXPECT_EQ(reader->ReadMany(requests), 0);
+	EXPECT_EQ(reader->_reads, 0);
+
+	delete reader;
+}
+
+TEST(IMemoryReader, ReadMany_coalesced)
+{
+	auto reader = CreateFakeMemoryReader();
+
+	std::vector<unsigned char> values(0x300);
+	std::vector<MemoryReadRequest> requests;
+
+	// Unsorted requests over three adjacent pages.
+	for (unsigned long i = 0; i < values.size(); i++)
+	{
+		requests.push_back(MemoryReadRequest(0x12ff0 - i * 0x10, 1, &values[i]));
+	}
+
+	EXPECT_EQ(reader->ReadMany(requests), values.size());
+	EXPECT_EQ(reader->_reads, 1);
+
+	for (unsigned long i = 0; i < values.size(); i++)
+	{
+		EXPECT_TRUE(requests[i].succeeded);
+		EXPECT_EQ(values[i], (0x12ff0 - i * 0x10) & 0xFF);
+	}
+
+	delete reader;
+}
+
+TEST(IMemoryReader, ReadMany_distantPages)
+{
+	auto reader = CreateFakeMemoryReader();
+
+	unsigned long values[3];
+
+	std::vector<MemoryReadRequest> requests;
+
+	requests.push_back(MemoryReadRequest(0x1f004, 4, &values[0]));
+	requests.push_back(MemoryReadRequest(0x10008, 4, &values[1]));
+	requests.push_back(MemoryReadRequest(0x1000c, 4, &values[2]));
+
+	EXPECT_EQ(reader->ReadMany(requests), 3);
+	EXPECT_EQ(reader->_reads, 2);
+	EXPECT_EQ(values[0] & 0xFF, 0x04);
+	EXPECT_EQ(values[1] & 0xFF, 0x08);
+
+	delete reader;
+}
+
+TEST(IMemoryReader, ReadMany_unreadablePage)
+{
+	auto reader = CreateFakeMemoryReader();
+
+	unsigned long values[4];
+
+	std::vector<MemoryReadRequest> requests;
+
+	requests.push_back(MemoryReadRequest(0x13ff0, 4, &values[0]));
+	requests.push_back(MemoryReadRequest(0x13ffe, 4, &values[1]));
+	requests.push_back(MemoryReadRequest(0x14010, 4, &values[2]));
+	requests.push_back(MemoryReadRequest(0x15010, 4, &values[3]));
+
+	EXPECT_EQ(reader->ReadMany(requests), 2);
+
+	EXPECT_TRUE(requests[0].succeeded);
+	EXPECT_FALSE(requests[1].succeeded);
+	EXPECT_FALSE(requests[2].succeeded);
+	EXPECT_TRUE(requests[3].succeeded);
+	EXPECT_EQ(values[3] & 0xFF, 0x10);
+
+	// The page after the unreadable page is read again.
+	EXPECT_EQ(reader->_reads, 2);
+
+	delete reader;
+}
\ No newline at end of file
@@ -0,0 +1,141 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file ImageBufferPoolTest.cpp
+
+Implements ImageBufferPoolTest class defines unit tests for ImageBufferPool class.
+*/
+
+#include "..\stdafx.h"
+
+#include "ImageBufferPool.h"
+
+TEST(ImageBufferPool, ReusesReleasedBuffers)
+{
+	ImageBufferPool pool;
+
+	const unsigned char* pixels = nullptr;
+
+	{
+		auto buffer = pool.acquire(64, 16);
+
+		EXPECT_EQ(buffer.get_width(), 64);
+		EXPECT_EQ(buffer.get_height(), 16);
+		EXPECT_FALSE(buffer.empty());
+
+		pixels = buffer.data();
+	}
+
+	EXPECT_EQ(pool.size(), 1);
+
+	// Same or smaller images take the released buffer.
+	auto buffer = pool.acquire(32, 16);
+
+	EXPECT_EQ(buffer.data(), pixels);
+	EXPECT_EQ(pool.size(), 0);
+
+	// Larger images allocate.
+	auto larger = pool.acquire(128, 16);
+
+	EXPECT_NE(larger.data(), pixels);
+}
+
+TEST(ImageBufferPool, PicksSmallestBufferThatFits)
+{
+	ImageBufferPool pool;
+
+	const unsigned char* smallPixels = nullptr;
+
+	{
+		auto large = pool.acquire(256, 256);
+		auto small = pool.acquire(16, 16);
+
+		smallPixels = small.data();
+	}
+
+	EXPECT_EQ(pool.size(), 2);
+
+	auto buffer = pool.acquire(8, 8);
+
+	EXPECT_EQ(buffer.data(), smallPixels);
+}
+
+TEST(ImageBufferPool, MoveTransfersOwnership)
+{
+	ImageBufferPool pool;
+
+	auto buffer = pool.acquire(16, 16);
+	auto pixels = buffer.data();
+
+	ImageBuffer moved(std::move(buffer));
+
+	EXPECT_TRUE(buffer.empty());
+	EXPECT_EQ(buffer.get_width(), 0);
+	EXPECT_EQ(moved.data(), pixels);
+
+	ImageBuffer assigned;
+
+	assigned = std::move(moved);
+
+	EXPECT_TRUE(moved.empty());
+	EXPECT_EQ(assigned.data(), pixels);
+	EXPECT_EQ(pool.size(), 0);
+
+	assigned.reset();
+
+	EXPECT_TRUE(assigned.empty());
+	EXPECT_EQ(pool.size(), 1);
+}
+
+TEST(ImageBufferPool, KeepsAtMostMaxBuffers)
+{
+	ImageBufferPool pool(2);
+
+	{
+		auto a = pool.acquire(4, 4);
+		auto b = pool.acquire(4, 4);
+		auto c = pool.acquire(4, 4);
+	}
+
+	EXPECT_EQ(pool.size(), 2);
+}
+
+TEST(ImageBufferPool, BuffersOutlivePool)
+{
+	ImageBuffer buffer;
+
+	{
+		ImageBufferPool pool;
+
+		buffer = pool.acquire(16, 16);
+	}
+
+	// Pixels are freed instead of being returned to the destroyed pool.
+	buffer.data()[0] = 1;
+	buffer.reset();
+
+	EXPECT_TRUE(buffer.empty());
+}
\ No newline at end of file
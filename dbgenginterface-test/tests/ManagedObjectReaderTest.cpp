@@ -0,0 +1,126 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file ManagedObjectReaderTest.cpp
+
+Implements ManagedObjectReaderTest class defines unit tests for ManagedObjectReader class.
+*/
+
+#include "..\stdafx.h"
+
+#include "ManagedObjectReader.h"
+#include "FakeHeap.h"
+
+TEST(ManagedObjectReader, SelectsLayout)
+{
+	EXPECT_EQ(IManagedObjectReader::find_version("clr"), ClrVersion::Clr4);
+	EXPECT_EQ(IManagedObjectReader::find_version("MSCORWKS"), ClrVersion::Clr2);
+	EXPECT_EQ(IManagedObjectReader::find_version("coreclr"), ClrVersion::Unknown);
+
+	auto reader = IManagedObjectReader::create(ClrVersion::Clr2);
+
+	EXPECT_EQ(reader->get_version(), ClrVersion::Clr2);
+
+	reader = IManagedObjectReader::create(ClrVersion::Unknown);
+
+	EXPECT_EQ(reader->get_version(), ClrVersion::Unknown);
+
+	EXPECT_EQ(ThreadLayout<Clr4X86>::Name::OFFSET, 0xc);
+	EXPECT_EQ(SafeHandleLayout<Clr4X86>::Handle::OFFSET, 4);
+	EXPECT_EQ(SafeHandleLayout<Clr4X86>::Handle::SIZE, 4);
+	EXPECT_EQ(StringLayout<Clr4X86>::FirstChar::OFFSET, 8);
+}
+
+TEST(ManagedObjectReader, ReadsThreads)
+{
+	FakeHeap heap;
+
+	for (unsigned long address = 0x1000; address < 0x3000; address++)
+	{
+		heap.write_u8(address, 0);
+	}
+
+	// CLR 4 x86 Thread.
+	heap.write_u32(0x1000 + 0xc, 0x7000);
+	heap.write_u32(0x1000 + 0x28, 12);
+
+	// CLR 2.0 x86 Thread.
+	heap.write_u32(0x2000 + 0xc, 0x7100);
+	heap.write_u32(0x2000 + 0x30, 13);
+
+	std::vector<unsigned long> addresses;
+
+	addresses.push_back(0x1000);
+	addresses.push_back(0x3000);
+
+	std::vector<ManagedThreadFields> threads;
+
+	IManagedObjectReader::create(ClrVersion::Clr4)->read_threads(&heap, addresses, threads);
+
+	ASSERT_EQ(threads.size(), 2);
+	EXPECT_TRUE(threads[0].IsRead);
+	EXPECT_EQ(threads[0].Name, 0x7000);
+	EXPECT_EQ(threads[0].ManagedThreadId, 12);
+	EXPECT_FALSE(threads[1].IsRead);
+
+	addresses[0] = 0x2000;
+
+	IManagedObjectReader::create(ClrVersion::Clr2)->read_threads(&heap, addresses, threads);
+
+	EXPECT_TRUE(threads[0].IsRead);
+	EXPECT_EQ(threads[0].Name, 0x7100);
+	EXPECT_EQ(threads[0].ManagedThreadId, 13);
+}
+
+TEST(ManagedObjectReader, ReadsSafeHandles)
+{
+	FakeHeap heap;
+
+	for (unsigned long address = 0x1000; address < 0x3000; address++)
+	{
+		heap.write_u8(address, 0);
+	}
+
+	heap.write_u32(0x1000 + 4, 0x1f4);
+
+	std::vector<unsigned long> addresses;
+	std::vector<unsigned long long> handles;
+	std::vector<char> is_read;
+
+	addresses.push_back(0x1000);
+
+	IManagedObjectReader::create(ClrVersion::Clr4)->read_safe_handles(&heap, addresses, handles, is_read);
+
+	ASSERT_EQ(handles.size(), 1);
+	EXPECT_TRUE(is_read[0] != 0);
+	EXPECT_EQ(handles[0], 0x1f4);
+
+	addresses[0] = 0x3000;
+
+	IManagedObjectReader::create(ClrVersion::Clr4)->read_safe_handles(&heap, addresses, handles, is_read);
+
+	EXPECT_FALSE(is_read[0] != 0);
+}
\ No newline at end of file
@@ -0,0 +1,183 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file ManagedStringReaderTest.cpp
+
+Implements ManagedStringReaderTest class defines unit tests for ManagedStringReader class.
+*/
+
+#include "..\stdafx.h"
+
+#include "ManagedStringReader.h"
+#include "FakeHeap.h"
+#include "FakeLogger.h"
+
+/**
+Writes a System.String object.
+*/
+static void AddString(FakeHeap& heap, unsigned long address, const std::vector<unsigned short>& chars)
+{
+	heap.write_u32(address, 0x5100);
+	heap.write_u32(address + ManagedStringReader::STRING_LENGTH_OFFSET, chars.size());
+
+	for (size_t i = 0; i < chars.size(); i++)
+	{
+		heap.write_u16(address + ManagedStringReader::STRING_CHARS_OFFSET + 2 * i, chars[i]);
+	}
+}
+
+TEST(ManagedStringReader, Utf16ToUtf8)
+{
+	char output[64];
+
+	unsigned short ascii[] = { 'W', 'o', 'r', 'k', 'e', 'r', ' ', 'T', 'h', 'r', 'e', 'a', 'd', ' ', '#', '1', '2' };
+
+	auto length = ManagedStringReader::Utf16ToUtf8(ascii, 17, output);
+
+	EXPECT_EQ(std::string(output, length), "Worker Thread #12");
+
+	// Non-ASCII characters after and inside SIMD blocks.
+	unsigned short mixed[] = { 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 0xe9, 'i', 0x4e2d, 0xd83d, 0xde00, 'j', 0xd800, 'k', 0xdc00 };
+
+	length = ManagedStringReader::Utf16ToUtf8(mixed, 17, output);
+
+	EXPECT_EQ(std::string(output, length), "abcdefgh\xc3\xa9i\xe4\xb8\xad\xf0\x9f\x98\x80j\xef\xbf\xbdk\xef\xbf\xbd");
+
+	EXPECT_EQ(ManagedStringReader::Utf16ToUtf8(mixed, 0, output), 0);
+}
+
+TEST(ManagedStringReader, ReadsStringsInOneBlock)
+{
+	auto logger = new FakeLogger();
+
+	FakeHeap heap;
+
+	for (unsigned long address = 0x10000; address < 0x12000; address++)
+	{
+		heap.write_u8(address, 0);
+	}
+
+	AddString(heap, 0x10000, { 'M', 'a', 'i', 'n' });
+	AddString(heap, 0x10020, { 0x0130, 's', 't', 'a', 'n', 'b', 'u', 'l' });
+	AddString(heap, 0x10040, std::vector<unsigned short>());
+
+	// Header at the end of readable memory, characters are not readable.
+	heap.write_u32(0x11ff8, 0x5100);
+	heap.write_u32(0x11ffc, 3);
+
+	std::vector<unsigned short> long_string(40, 'x');
+
+	AddString(heap, 0x10100, long_string);
+
+	ManagedStringReader reader(&heap, logger, 32);
+
+	std::vector<unsigned long> addresses;
+
+	addresses.push_back(0x10000);
+	addresses.push_back(0x10020);
+	addresses.push_back(0);
+	addresses.push_back(0x10040);
+	addresses.push_back(0x11ff8);
+	addresses.push_back(0x10100);
+	addresses.push_back(0x20000);
+
+	auto strings = reader.read(addresses);
+
+	ASSERT_EQ(strings.size(), 7);
+
+	EXPECT_TRUE(strings.is_read(0));
+	EXPECT_STREQ(strings.get(0), "Main");
+	EXPECT_EQ(strings.get_length(0), 4);
+
+	EXPECT_TRUE(strings.is_read(1));
+	EXPECT_STREQ(strings.get(1), "\xc4\xb0stanbul");
+	EXPECT_EQ(strings.get_length(1), 9);
+
+	EXPECT_FALSE(strings.is_read(2));
+	EXPECT_STREQ(strings.get(2), "");
+
+	EXPECT_TRUE(strings.is_read(3));
+	EXPECT_STREQ(strings.get(3), "");
+
+	// Characters past the written memory.
+	EXPECT_FALSE(strings.is_read(4));
+	EXPECT_STREQ(strings.get(4), "");
+
+	EXPECT_TRUE(strings.is_read(5));
+	EXPECT_EQ(std::string(strings.get(5)), std::string(32, 'x'));
+
+	EXPECT_FALSE(strings.is_read(6));
+
+	EXPECT_EQ(strings.get_data_size(), 4 + 9 + 32 + 7);
+
+	// Lengths and characters take one coalesced read each, except the unreadable ones.
+	EXPECT_LE(heap._reads, 6);
+	EXPECT_EQ(logger->_logs.size(), 1);
+
+	delete logger;
+}
+
+TEST(ManagedStringReader, ReadsWideStrings)
+{
+	auto logger = new FakeLogger();
+
+	FakeHeap heap;
+
+	for (unsigned long address = 0x10000; address < 0x10100; address++)
+	{
+		heap.write_u8(address, 0);
+	}
+
+	AddString(heap, 0x10000, { 'M', 'a', 'i', 'n' });
+	AddString(heap, 0x10020, { 0x0130, 0xd83d, 0xde00 });
+
+	ManagedStringReader reader(&heap, logger);
+
+	std::vector<unsigned long> addresses;
+
+	addresses.push_back(0x10000);
+	addresses.push_back(0);
+	addresses.push_back(0x10020);
+
+	auto strings = reader.read_wide(addresses);
+
+	ASSERT_EQ(strings.size(), 3);
+
+	EXPECT_TRUE(strings.is_read(0));
+	EXPECT_EQ(std::vector<unsigned short>(strings.get(0), strings.get(0) + 5), std::vector<unsigned short>({ 'M', 'a', 'i', 'n', 0 }));
+
+	EXPECT_FALSE(strings.is_read(1));
+	EXPECT_EQ(strings.get(1)[0], 0);
+
+	// Surrogate pairs are kept as they are.
+	EXPECT_TRUE(strings.is_read(2));
+	EXPECT_EQ(strings.get_length(2), 3);
+	EXPECT_EQ(std::vector<unsigned short>(strings.get(2), strings.get(2) + 4), std::vector<unsigned short>({ 0x0130, 0xd83d, 0xde00, 0 }));
+
+	EXPECT_EQ(strings.get_data_size(), 4 + 3 + 3);
+
+	delete logger;
+}
\ No newline at end of file
@@ -0,0 +1,265 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file MethodTableCacheTest.cpp
+
+Implements MethodTableCacheTest class defines unit tests for MethodTableCache class.
+*/
+
+#include "..\stdafx.h"
+
+#include "MethodTableCache.h"
+#include "FakeDebuggerCommandExecutor.h"
+#include "FakeHeap.h"
+#include "FakeLogger.h"
+
+/**
+Creates an executor that answers !dumpmt, !dumpclass and !name2ee for a Thread type deriving from CriticalFinalizerObject.
+*/
+static FakeDebuggerCommandExecutor* CreateExecutor(std::vector<std::string>& commands)
+{
+	return new FakeDebuggerCommandExecutor(FakeDebuggerCommandExecutor::OutputLambda([&](const std::string& command, std::string& output)
+	{
+		commands.push_back(command);
+
+		if (command.find(".echo MT 6000; !dumpmt 6000;") != std::string::npos)
+		{
+			output += "MT 6000\n"
+				"EEClass:         00000100\n"
+				"Module:          72a51000\n"
+				"Name:            System.Threading.Thread\n"
+				"BaseSize:        0x34\n"
+				"ComponentSize:   0x0\n";
+		}
+
+		if (command.find(".echo MT 5000; !dumpmt 5000;") != std::string::npos)
+		{
+			output += "MT 5000\n"
+				"EEClass:         00000200\n"
+				"Name:            System.Runtime.ConstrainedExecution.CriticalFinalizerObject\n";
+		}
+
+		if (command.find(".echo MT 7000; !dumpmt 7000;") != std::string::npos)
+		{
+			output += "MT 7000\n"
+				"7000 is not a MethodTable\n";
+		}
+
+		if (command == "!dumpclass 100")
+		{
+			output = "Class Name:      System.Threading.Thread\n"
+				"      MT    Field   Offset                 Type VT     Attr    Value Name\n"
+				"72f62254  4000606        c        System.String  0 instance           m_Name\n"
+				"72f62254  4000607       28         System.Int32  1 instance           m_ManagedThreadId\n"
+				"72f62254  4000608       28         System.Int32  1   static  00000000 s_Count\n";
+		}
+
+		if (command == "!dumpclass 200")
+		{
+			output = "      MT    Field   Offset                 Type VT     Attr    Value Name\n"
+				"72f62254  4000601        4        System.Object  0 instance           m_Base\n";
+		}
+
+		if (command == "!name2ee *!System.Threading.Thread")
+		{
+			output = "Module:      72a51000\n"
+				"Assembly:    mscorlib.dll\n"
+				"Token:       020001a9\n"
+				"MethodTable: 6000\n"
+				"EEClass:     100\n"
+				"Name:        System.Threading.Thread\n"
+				"--------------------------------------\n"
+				"Module:      72a52000\n"
+				"Assembly:    Other.dll\n"
+				"Token:       020001a9\n"
+				"MethodTable: <not loaded>\n";
+		}
+
+		return true;
+	}));
+}
+
+TEST(MethodTableCache, LoadSizes)
+{
+	auto logger = new FakeLogger();
+
+	FakeHeap heap;
+
+	heap.add_method_table(0x5000, 12, 0);
+	heap.add_method_table(0x6000, 0x34, 0, 0x5000);
+	heap.add_method_table(0x7000, 14, 2);
+
+	MethodTableCache cache;
+
+	cache.attach(nullptr, &heap, logger);
+
+	std::vector<unsigned long> method_tables;
+
+	method_tables.push_back(0x6000);
+	method_tables.push_back(0x7000);
+	method_tables.push_back(0x6000);
+	method_tables.push_back(0x8000);
+
+	cache.load(method_tables);
+
+	EXPECT_EQ(cache.size(), 3);
+
+	auto reads = heap._reads;
+
+	unsigned long base_size;
+	unsigned long component_size;
+
+	EXPECT_TRUE(cache.get_sizes(0x6000, base_size, component_size));
+	EXPECT_EQ(base_size, 0x34);
+	EXPECT_EQ(component_size, 0);
+	EXPECT_EQ(cache.get(0x6000).ParentMethodTable, 0x5000);
+
+	EXPECT_TRUE(cache.get_sizes(0x7000, base_size, component_size));
+	EXPECT_EQ(base_size, 14);
+	EXPECT_EQ(component_size, 2);
+
+	EXPECT_FALSE(cache.get_sizes(0x8000, base_size, component_size));
+
+	// Loaded entries are not read again.
+	EXPECT_EQ(heap._reads, reads);
+
+	// Lazily read entry.
+	EXPECT_TRUE(cache.get_sizes(0x5000, base_size, component_size));
+	EXPECT_EQ(heap._reads, reads + 1);
+
+	EXPECT_TRUE(cache.get_sizes(0x5000, base_size, component_size));
+	EXPECT_EQ(heap._reads, reads + 1);
+
+	delete logger;
+}
+
+TEST(MethodTableCache, LoadNames)
+{
+	auto logger = new FakeLogger();
+
+	std::vector<std::string> commands;
+
+	auto executor = CreateExecutor(commands);
+
+	MethodTableCache cache;
+
+	cache.attach(executor, nullptr, logger);
+
+	std::vector<unsigned long> method_tables;
+
+	method_tables.push_back(0x6000);
+	method_tables.push_back(0x7000);
+	method_tables.push_back(0x5000);
+
+	cache.load_names(method_tables);
+
+	EXPECT_EQ(commands.size(), 1);
+
+	EXPECT_EQ(cache.get_name(0x6000), "System.Threading.Thread");
+	EXPECT_EQ(cache.get_name(0x5000), "System.Runtime.ConstrainedExecution.CriticalFinalizerObject");
+	EXPECT_EQ(cache.get_name(0x7000), "");
+	EXPECT_EQ(commands.size(), 1);
+
+	// Sizes from !dumpmt when the MethodTable cannot be read.
+	unsigned long base_size;
+	unsigned long component_size;
+
+	EXPECT_TRUE(cache.get_sizes(0x6000, base_size, component_size));
+	EXPECT_EQ(base_size, 0x34);
+
+	EXPECT_EQ(logger->_logs.size(), 0);
+
+	delete executor;
+	delete logger;
+}
+
+TEST(MethodTableCache, FieldOffsets)
+{
+	auto logger = new FakeLogger();
+
+	std::vector<std::string> commands;
+
+	auto executor = CreateExecutor(commands);
+
+	FakeHeap heap;
+
+	heap.add_method_table(0x5000, 12, 0);
+	heap.add_method_table(0x6000, 0x34, 0, 0x5000);
+
+	MethodTableCache cache;
+
+	cache.attach(executor, &heap, logger);
+
+	unsigned long offset = 0;
+
+	EXPECT_TRUE(cache.get_field_offset(0x6000, "m_Name", offset));
+	EXPECT_EQ(offset, 0xc);
+
+	EXPECT_TRUE(cache.get_field_offset(0x6000, "m_ManagedThreadId", offset));
+	EXPECT_EQ(offset, 0x28);
+
+	EXPECT_EQ(commands.size(), 2);
+
+	// Inherited field.
+	EXPECT_TRUE(cache.get_field_offset(0x6000, "m_Base", offset));
+	EXPECT_EQ(offset, 4);
+
+	EXPECT_FALSE(cache.get_field_offset(0x6000, "s_Count", offset));
+	EXPECT_FALSE(cache.get_field_offset(0x6000, "m_Missing", offset));
+
+	// Each class is dumped once.
+	EXPECT_EQ(commands.size(), 4);
+
+	delete executor;
+	delete logger;
+}
+
+TEST(MethodTableCache, FindMethodTables)
+{
+	auto logger = new FakeLogger();
+
+	std::vector<std::string> commands;
+
+	auto executor = CreateExecutor(commands);
+
+	MethodTableCache cache;
+
+	cache.attach(executor, nullptr, logger);
+
+	auto method_tables = cache.find_method_tables("System.Threading.Thread");
+
+	ASSERT_EQ(method_tables.size(), 1);
+	EXPECT_EQ(method_tables[0], 0x6000);
+	EXPECT_EQ(cache.get_name(0x6000), "System.Threading.Thread");
+
+	method_tables = cache.find_method_tables("System.Threading.Thread");
+
+	EXPECT_EQ(method_tables.size(), 1);
+	EXPECT_EQ(commands.size(), 1);
+
+	delete executor;
+	delete logger;
+}
\ No newline at end of file
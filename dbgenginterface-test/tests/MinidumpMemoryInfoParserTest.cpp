@@ -0,0 +1,197 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file MinidumpMemoryInfoParserTest.cpp
+
+Implements MinidumpMemoryInfoParserTest class defines unit tests for MinidumpMemoryInfoParser class.
+*/
+
+#include "..\stdafx.h"
+
+#include "MinidumpFile.h"
+#include "MinidumpMemoryReader.h"
+#include "MinidumpMemoryInfoParser.h"
+#include "FakeMinidump.h"
+#include "FakeLogger.h"
+
+static void AddMemoryInfo(std::vector<unsigned char>& bytes, unsigned long long base, unsigned long long allocation_base, unsigned long long size, unsigned long state, unsigned long protect, unsigned long type)
+{
+	FakeMinidump::append_u64(bytes, base);
+	FakeMinidump::append_u64(bytes, allocation_base);
+	FakeMinidump::append_u32(bytes, protect);
+	FakeMinidump::append_u32(bytes, 0);
+	FakeMinidump::append_u64(bytes, size);
+	FakeMinidump::append_u32(bytes, state);
+	FakeMinidump::append_u32(bytes, protect);
+	FakeMinidump::append_u32(bytes, type);
+	FakeMinidump::append_u32(bytes, 0);
+}
+
+static void SetPointer(std::vector<unsigned char>& page, unsigned long offset, unsigned long value)
+{
+	for (unsigned long i = 0; i < 4; i++)
+	{
+		page[offset + i] = static_cast<unsigned char>(value >> (8 * i));
+	}
+}
+
+TEST(MinidumpMemoryInfoParser, NoMemoryInfo)
+{
+	auto logger = new FakeLogger();
+
+	FakeMinidump fake;
+
+	auto& data = fake.build();
+
+	MinidumpFile dump(logger);
+
+	EXPECT_TRUE(dump.attach(data.data(), data.size()));
+
+	MinidumpMemoryInfoParser parser(dump, nullptr, logger);
+
+	auto output = parser.execute();
+
+	EXPECT_FALSE(output.has_ranges());
+	EXPECT_EQ(logger->_logs.size(), 1);
+
+	delete logger;
+}
+
+TEST(MinidumpMemoryInfoParser, MemoryInfoList)
+{
+	auto logger = new FakeLogger();
+
+	const unsigned long COMMIT = 0x1000, RESERVE = 0x2000, FREE = 0x10000;
+	const unsigned long PRIVATE = 0x20000, IMAGE = 0x1000000;
+
+	std::vector<unsigned char> infos;
+
+	FakeMinidump::append_u32(infos, 16);
+	FakeMinidump::append_u32(infos, 48);
+	FakeMinidump::append_u64(infos, 11);
+
+	// Entries are not sorted.
+	AddMemoryInfo(infos, 0x401000, 0, 0xff000, FREE, 1, 0);
+	AddMemoryInfo(infos, 0x400000, 0x400000, 0x1000, COMMIT, 2, IMAGE);
+	AddMemoryInfo(infos, 0x100000, 0x100000, 0xfd000, RESERVE, 0, PRIVATE);
+	AddMemoryInfo(infos, 0x1fd000, 0x100000, 0x1000, COMMIT, 0x104, PRIVATE);
+	AddMemoryInfo(infos, 0x1fe000, 0x100000, 0x2000, COMMIT, 4, PRIVATE);
+	AddMemoryInfo(infos, 0x500000, 0x500000, 0x1000, COMMIT, 4, PRIVATE);
+	AddMemoryInfo(infos, 0x501000, 0x500000, 0xf000, RESERVE, 0, PRIVATE);
+	AddMemoryInfo(infos, 0x600000, 0x600000, 0x1000, COMMIT, 4, PRIVATE);
+	AddMemoryInfo(infos, 0x610000, 0x610000, 0x1000, COMMIT, 4, PRIVATE);
+	AddMemoryInfo(infos, 0x7ffde000, 0x7ffde000, 0x1000, COMMIT, 4, PRIVATE);
+	AddMemoryInfo(infos, 0x7ffdf000, 0x7ffdf000, 0x1000, COMMIT, 4, PRIVATE);
+
+	std::vector<unsigned char> threads;
+
+	FakeMinidump::append_u32(threads, 1);
+	FakeMinidump::append_u32(threads, 0x1234);
+	FakeMinidump::append_u32(threads, 0);
+	FakeMinidump::append_u32(threads, 0x20);
+	FakeMinidump::append_u32(threads, 0);
+	FakeMinidump::append_u64(threads, 0x7ffdf000);
+	FakeMinidump::append_u64(threads, 0x1ff000);
+	FakeMinidump::append_u32(threads, 0x1000);
+	FakeMinidump::append_u32(threads, 0);
+	FakeMinidump::append_u32(threads, 0);
+	FakeMinidump::append_u32(threads, 0);
+
+	std::vector<unsigned char> teb(0x1000), peb(0x1000), parameters(0x1000);
+
+	SetPointer(teb, 0x30, 0x7ffde000);
+	SetPointer(peb, 0x10, 0x600000);
+	SetPointer(peb, 0x88, 1);
+	SetPointer(peb, 0x90, 0x7ffde800);
+	SetPointer(peb, 0x800, 0x500000);
+	SetPointer(parameters, 0x48, 0x610000);
+
+	FakeMinidump fake;
+
+	fake.add_stream(MinidumpFile::MEMORY_INFO_LIST_STREAM, infos);
+	fake.add_stream(MinidumpFile::THREAD_LIST_STREAM, threads);
+	fake.add_memory(0x600000, parameters);
+	fake.add_memory(0x7ffde000, peb);
+	fake.add_memory(0x7ffdf000, teb);
+
+	auto& data = fake.build();
+
+	MinidumpFile dump(logger);
+
+	EXPECT_TRUE(dump.attach(data.data(), data.size()));
+
+	auto threads_read = dump.get_threads();
+
+	ASSERT_EQ(threads_read.size(), 1);
+	EXPECT_EQ(threads_read[0].ThreadId, 0x1234);
+	EXPECT_EQ(threads_read[0].Teb, 0x7ffdf000);
+	EXPECT_EQ(threads_read[0].StackSize, 0x1000);
+
+	MinidumpMemoryReader reader(dump);
+	MinidumpMemoryInfoParser parser(dump, &reader, logger);
+
+	auto output = parser.execute();
+
+	ASSERT_TRUE(output.has_ranges());
+
+	auto ranges = output.get_ranges();
+
+	ASSERT_EQ(ranges->size(), 11);
+
+	EXPECT_EQ(ranges->at(0).Address, 0x100000);
+	EXPECT_EQ(ranges->at(0).Size, 0xfd000);
+	EXPECT_EQ(ranges->at(0).State, State::Reserve);
+	EXPECT_EQ(ranges->at(0).Usage, Usage::Stack);
+	EXPECT_EQ(ranges->at(1).Usage, Usage::Stack);
+	EXPECT_EQ(ranges->at(2).Usage, Usage::Stack);
+	EXPECT_EQ(ranges->at(2).State, State::Commit);
+
+	EXPECT_EQ(ranges->at(3).Address, 0x400000);
+	EXPECT_EQ(ranges->at(3).Usage, Usage::Image);
+	EXPECT_EQ(ranges->at(4).State, State::Free);
+	EXPECT_EQ(ranges->at(4).Usage, Usage::Free);
+
+	EXPECT_EQ(ranges->at(5).Usage, Usage::Heap);
+	EXPECT_EQ(ranges->at(6).Usage, Usage::Heap);
+	EXPECT_EQ(ranges->at(6).State, State::Reserve);
+
+	EXPECT_EQ(ranges->at(7).Usage, Usage::ProcessParameters);
+	EXPECT_EQ(ranges->at(8).Usage, Usage::EnvironmentBlock);
+	EXPECT_EQ(ranges->at(9).Usage, Usage::PEB);
+	EXPECT_EQ(ranges->at(10).Usage, Usage::TEB);
+
+	// Without target memory only the thread list is used.
+	MinidumpMemoryInfoParser parser_without_memory(dump, nullptr, logger);
+
+	ranges = parser_without_memory.execute().get_ranges();
+
+	EXPECT_EQ(ranges->at(5).Usage, Usage::VirtualAlloc);
+	EXPECT_EQ(ranges->at(9).Usage, Usage::VirtualAlloc);
+	EXPECT_EQ(ranges->at(10).Usage, Usage::TEB);
+	EXPECT_EQ(logger->_logs.size(), 0);
+
+	delete logger;
+}
\ No newline at end of file
@@ -0,0 +1,191 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file MinidumpMemoryReaderTest.cpp
+
+Implements MinidumpMemoryReaderTest class defines unit tests for MinidumpFile and MinidumpMemoryReader classes.
+*/
+
+#include "..\stdafx.h"
+
+#include "MinidumpFile.h"
+#include "MinidumpMemoryReader.h"
+#include "FakeMinidump.h"
+#include "FakeLogger.h"
+
+static std::vector<unsigned char> CreateBytes(unsigned char first, unsigned long size)
+{
+	std::vector<unsigned char> bytes(size);
+
+	for (unsigned long i = 0; i < size; i++)
+	{
+		bytes[i] = static_cast<unsigned char>(first + i);
+	}
+
+	return bytes;
+}
+
+TEST(MinidumpFile, CannotOpenFile)
+{
+	auto logger = new FakeLogger();
+
+	MinidumpFile dump(logger);
+
+	EXPECT_FALSE(dump.open("this file does not exist.dmp"));
+	EXPECT_FALSE(dump.is_open());
+	EXPECT_EQ(logger->_logs.size(), 1);
+
+	delete logger;
+}
+
+TEST(MinidumpFile, InvalidSignature)
+{
+	auto logger = new FakeLogger();
+
+	std::vector<unsigned char> data(64, 0);
+
+	MinidumpFile dump(logger);
+
+	EXPECT_FALSE(dump.attach(data.data(), data.size()));
+	EXPECT_FALSE(dump.is_open());
+
+	delete logger;
+}
+
+TEST(MinidumpMemoryReader, NoMemory)
+{
+	auto logger = new FakeLogger();
+
+	FakeMinidump fake;
+
+	auto& data = fake.build();
+
+	MinidumpFile dump(logger);
+
+	EXPECT_TRUE(dump.attach(data.data(), data.size()));
+
+	MinidumpMemoryReader reader(dump);
+
+	EXPECT_FALSE(reader.has_memory());
+
+	unsigned long value = 0;
+	unsigned long read = 0;
+
+	EXPECT_FALSE(reader.ReadMemory(0x1000, &value, sizeof(value), &read) != 0);
+	EXPECT_EQ(read, 0);
+
+	delete logger;
+}
+
+TEST(MinidumpMemoryReader, MemoryList)
+{
+	auto logger = new FakeLogger();
+
+	FakeMinidump fake(false);
+
+	fake.add_memory(0x20000, CreateBytes(0x10, 0x100));
+	fake.add_memory(0x10000, CreateBytes(0x80, 0x10));
+
+	auto& data = fake.build();
+
+	MinidumpFile dump(logger);
+
+	EXPECT_TRUE(dump.attach(data.data(), data.size()));
+
+	MinidumpMemoryReader reader(dump);
+
+	EXPECT_EQ(reader.get_regions().size(), 2);
+	EXPECT_EQ(reader.get_regions()[0].Address, 0x10000);
+
+	unsigned char buffer[4];
+	unsigned long read = 0;
+
+	EXPECT_TRUE(reader.ReadMemory(0x20010, buffer, sizeof(buffer), &read) != 0);
+	EXPECT_EQ(read, 4);
+	EXPECT_EQ(buffer[0], 0x20);
+	EXPECT_EQ(buffer[3], 0x23);
+
+	EXPECT_FALSE(reader.ReadMemory(0x1000e, buffer, sizeof(buffer), &read) != 0);
+	EXPECT_EQ(read, 2);
+	EXPECT_EQ(buffer[0], 0x8e);
+
+	delete logger;
+}
+
+TEST(MinidumpMemoryReader, Memory64List)
+{
+	auto logger = new FakeLogger();
+
+	FakeMinidump fake;
+
+	fake.add_memory(0x10000, CreateBytes(0x00, 0x1000));
+	fake.add_memory(0x11000, CreateBytes(0x40, 0x1000));
+	fake.add_memory(0x30000, CreateBytes(0x80, 0x1000));
+
+	auto& data = fake.build();
+
+	MinidumpFile dump(logger);
+
+	EXPECT_TRUE(dump.attach(data.data(), data.size()));
+
+	MinidumpMemoryReader reader(dump);
+
+	EXPECT_EQ(reader.get_regions().size(), 3);
+
+	// Read across adjacent regions.
+	unsigned char buffer[8];
+	unsigned long read = 0;
+
+	EXPECT_TRUE(reader.ReadMemory(0x10ffc, buffer, sizeof(buffer), &read) != 0);
+	EXPECT_EQ(read, 8);
+	EXPECT_EQ(buffer[3], 0xff);
+	EXPECT_EQ(buffer[4], 0x40);
+
+	// Zero-copy access.
+	auto pointer = static_cast<const unsigned char*>(reader.get_pointer(0x30010, 4));
+
+	ASSERT_TRUE(pointer != nullptr);
+	EXPECT_EQ(pointer[0], 0x90);
+	EXPECT_TRUE(reader.get_pointer(0x10ffc, 8) == nullptr);
+	EXPECT_TRUE(reader.get_pointer(0x20000, 4) == nullptr);
+
+	// Vectored read.
+	unsigned char values[3];
+
+	std::vector<MemoryReadRequest> requests;
+
+	requests.push_back(MemoryReadRequest(0x30001, 1, &values[0]));
+	requests.push_back(MemoryReadRequest(0x20000, 1, &values[1]));
+	requests.push_back(MemoryReadRequest(0x11001, 1, &values[2]));
+
+	EXPECT_EQ(reader.ReadMany(requests), 2);
+	EXPECT_TRUE(requests[0].succeeded);
+	EXPECT_FALSE(requests[1].succeeded);
+	EXPECT_EQ(values[0], 0x81);
+	EXPECT_EQ(values[2], 0x41);
+
+	delete logger;
+}
\ No newline at end of file
@@ -0,0 +1,197 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file MinidumpStackReaderTest.cpp
+
+Implements MinidumpStackReaderTest class defines unit tests for MinidumpStackReader class.
+*/
+
+#include "..\stdafx.h"
+
+#include "MinidumpFile.h"
+#include "MinidumpMemoryReader.h"
+#include "MinidumpStackReader.h"
+#include "FakeMinidump.h"
+#include "FakeLogger.h"
+
+static void SetU32(std::vector<unsigned char>& bytes, unsigned long offset, unsigned long value)
+{
+	for (unsigned long i = 0; i < 4; i++)
+	{
+		bytes[offset + i] = static_cast<unsigned char>(value >> (8 * i));
+	}
+}
+
+static void SetString(std::vector<unsigned char>& bytes, unsigned long offset, const std::string& value)
+{
+	std::copy(value.begin(), value.end(), bytes.begin() + offset);
+}
+
+static void AddThread(FakeMinidump& fake, std::vector<unsigned char>& threads, unsigned long thread_id, unsigned long eip, unsigned long esp)
+{
+	std::vector<unsigned char> context(0x2cc);
+
+	SetU32(context, 0xb4, esp + 0x40);
+	SetU32(context, 0xb8, eip);
+	SetU32(context, 0xc4, esp);
+
+	auto context_rva = fake.add_blob(context);
+
+	FakeMinidump::append_u32(threads, thread_id);
+	FakeMinidump::append_u32(threads, 0);
+	FakeMinidump::append_u32(threads, 0x20);
+	FakeMinidump::append_u32(threads, 0);
+	FakeMinidump::append_u64(threads, 0x7ffdf000);
+	FakeMinidump::append_u64(threads, esp);
+	FakeMinidump::append_u32(threads, 0);
+	FakeMinidump::append_u32(threads, 0);
+	FakeMinidump::append_u32(threads, static_cast<unsigned long>(context.size()));
+	FakeMinidump::append_u32(threads, context_rva);
+}
+
+static std::vector<unsigned char> CreateStack(unsigned long value1, unsigned long value2, unsigned long value3)
+{
+	std::vector<unsigned char> stack(0x20);
+
+	SetU32(stack, 0, value1);
+	SetU32(stack, 4, value2);
+	SetU32(stack, 8, value3);
+
+	return stack;
+}
+
+TEST(MinidumpStackReader, TopFrames)
+{
+	auto logger = new FakeLogger();
+
+	FakeMinidump fake;
+
+	// ntdll image with an export directory at 0x1000.
+	std::vector<unsigned char> image(0x2000);
+
+	SetU32(image, 0x3c, 0x80);
+	SetU32(image, 0x80, 0x4550);
+	SetU32(image, 0x80 + 24, 0x10b);
+	SetU32(image, 0x80 + 24 + 96, 0x1000);
+	SetU32(image, 0x80 + 24 + 100, 0x100);
+
+	SetU32(image, 0x1014, 3);
+	SetU32(image, 0x1018, 3);
+	SetU32(image, 0x101c, 0x1040);
+	SetU32(image, 0x1020, 0x1050);
+	SetU32(image, 0x1024, 0x1060);
+
+	SetU32(image, 0x1040, 0x500);
+	SetU32(image, 0x1044, 0x500);
+	SetU32(image, 0x1048, 0x600);
+
+	SetU32(image, 0x1050, 0x1080);
+	SetU32(image, 0x1054, 0x10a0);
+	SetU32(image, 0x1058, 0x10c0);
+
+	image[0x1060] = 1;
+	image[0x1062] = 0;
+	image[0x1064] = 2;
+
+	SetString(image, 0x1080, "ZwWaitForSingleObject");
+	SetString(image, 0x10a0, "NtWaitForSingleObject");
+	SetString(image, 0x10c0, "KiFastSystemCallRet");
+
+	fake.add_memory(0x77000000, image);
+
+	std::vector<unsigned char> name;
+	std::string path = "C:\\Windows\\SysWOW64\\ntdll.dll";
+
+	FakeMinidump::append_u32(name, static_cast<unsigned long>(path.size() * 2));
+
+	for (auto ch : path)
+	{
+		FakeMinidump::append_u16(name, ch);
+	}
+
+	auto name_rva = fake.add_blob(name);
+
+	std::vector<unsigned char> modules;
+
+	FakeMinidump::append_u32(modules, 1);
+	FakeMinidump::append_u64(modules, 0x77000000);
+	FakeMinidump::append_u32(modules, 0x2000);
+	FakeMinidump::append_u32(modules, 0);
+	FakeMinidump::append_u32(modules, 0);
+	FakeMinidump::append_u32(modules, name_rva);
+	modules.resize(4 + 108);
+
+	fake.add_stream(MinidumpFile::MODULE_LIST_STREAM, modules);
+
+	std::vector<unsigned char> threads;
+
+	FakeMinidump::append_u32(threads, 3);
+
+	// Thread in the system call stub, thread in KiFastSystemCallRet and thread with no stack memory.
+	AddThread(fake, threads, 0x10, 0x7700050c, 0x200000);
+	AddThread(fake, threads, 0x20, 0x77000600, 0x300000);
+	AddThread(fake, threads, 0x30, 0x7700050c, 0x400000);
+
+	fake.add_stream(MinidumpFile::THREAD_LIST_STREAM, threads);
+
+	fake.add_memory(0x200000, CreateStack(0x76000000, 0x144, 0));
+	fake.add_memory(0x300000, CreateStack(0x7700050c, 0x75000000, 0x148));
+
+	auto& data = fake.build();
+
+	MinidumpFile dump(logger);
+
+	EXPECT_TRUE(dump.attach(data.data(), data.size()));
+
+	auto modules_read = dump.get_modules();
+
+	ASSERT_EQ(modules_read.size(), 1);
+	EXPECT_EQ(modules_read[0].Name, "ntdll");
+
+	MinidumpMemoryReader reader(dump);
+	MinidumpStackReader stack_reader(dump, &reader, logger);
+
+	auto frames = stack_reader.get_top_frames();
+
+	ASSERT_EQ(frames.size(), 2);
+
+	EXPECT_EQ(frames[0].thread_id, 0x10);
+	EXPECT_EQ(frames[0].child_ebp, 0x200040);
+	EXPECT_EQ(frames[0].symbol_name, "ntdll!NtWaitForSingleObject");
+	EXPECT_EQ(frames[0].symbol_offset, 0xc);
+	EXPECT_EQ(frames[0].ret_address, 0x76000000);
+	EXPECT_EQ(frames[0].arg1, 0x144);
+
+	EXPECT_EQ(frames[1].thread_id, 0x20);
+	EXPECT_EQ(frames[1].symbol_name, "ntdll!NtWaitForSingleObject");
+	EXPECT_EQ(frames[1].symbol_offset, 0xc);
+	EXPECT_EQ(frames[1].ret_address, 0x75000000);
+	EXPECT_EQ(frames[1].arg1, 0x148);
+
+	EXPECT_EQ(logger->_logs.size(), 0);
+
+	delete logger;
+}
\ No newline at end of file
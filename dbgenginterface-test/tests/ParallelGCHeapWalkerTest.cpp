@@ -0,0 +1,215 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file ParallelGCHeapWalkerTest.cpp
+
+Implements ParallelGCHeapWalkerTest class defines unit tests for ParallelGCHeapWalker class.
+*/
+
+#include "..\stdafx.h"
+
+#include "ParallelGCHeapWalker.h"
+#include "FakeHeap.h"
+#include "FakeLogger.h"
+
+/**
+Creates three small object heap segments of different sizes and a large object heap segment.
+*/
+static RangeList CreateHeap(FakeHeap& heap)
+{
+	heap.add_method_table(0x5000, 12, 0);
+	heap.add_method_table(0x5100, 14, 2);
+	heap.add_method_table(0x5200, 12, 4);
+
+	auto ranges = new std::vector<const MemoryRange>();
+
+	unsigned long counts[] = { 400, 20, 150 };
+
+	for (unsigned long segment = 0; segment < 3; segment++)
+	{
+		auto start = 0x100000 * (segment + 1);
+		auto address = start;
+
+		for (unsigned long i = 0; i < counts[segment]; i++)
+		{
+			switch (i % 3)
+			{
+			case 0:
+				address += heap.add_object(address, 0x5000, 12, 0, 0);
+				break;
+			case 1:
+				address += heap.add_object(address, 0x5100, 14, 2, i % 7);
+				break;
+			default:
+				address += heap.add_object(address, 0x5200, 12, 4, i % 5);
+				break;
+			}
+		}
+
+		ranges->push_back(MemoryRange(start, address - start, State::Commit, Usage::GCHeap));
+	}
+
+	auto address = 0x800000UL;
+
+	for (unsigned long i = 0; i < 4; i++)
+	{
+		address += heap.add_object(address, 0x5200, 12, 4, 0x100);
+
+		// Large objects are 8 byte aligned.
+		heap.write_u32(address, 0);
+		address += 4;
+	}
+
+	ranges->push_back(MemoryRange(0x800000, address - 0x800000, State::Commit, Usage::GCLOHeap));
+
+	return RangeList(ranges);
+}
+
+/**
+Walks a heap in parallel and merges objects of work items in order.
+*/
+static bool WalkParallel(ParallelGCHeapWalker& walker, std::vector<unsigned long>& addresses)
+{
+	std::vector<std::vector<unsigned long>> item_addresses(walker.get_work_items().size());
+
+	auto ret = walker.walk([&](size_t item, const GCHeapObject& object)
+	{
+		item_addresses[item].push_back(object.Address);
+
+		return true;
+	});
+
+	for (auto& items : item_addresses)
+	{
+		addresses.insert(addresses.end(), items.begin(), items.end());
+	}
+
+	return ret;
+}
+
+TEST(ParallelGCHeapWalker, SameAsSequentialWalk)
+{
+	auto logger = new FakeLogger();
+
+	FakeHeap heap;
+
+	auto segments = CreateHeap(heap);
+
+	MethodTableCache method_tables;
+
+	method_tables.attach(nullptr, &heap, logger);
+
+	std::vector<unsigned long> expected;
+
+	auto walker = GCHeapWalker(segments, &heap, &method_tables, logger);
+
+	EXPECT_TRUE(walker.walk([&](const GCHeapObject& object){ expected.push_back(object.Address); return true; }));
+
+	heap._is_thread_safe = true;
+
+	GCHeapBoundaryIndex boundary_index;
+
+	// First walk splits by segment and records boundaries.
+	ParallelGCHeapWalker parallel_walker(segments, &heap, &method_tables, &boundary_index, logger, 4, 0x400);
+
+	EXPECT_EQ(parallel_walker.get_thread_count(), 4);
+	EXPECT_EQ(parallel_walker.get_work_items().size(), 4);
+
+	std::vector<unsigned long> addresses;
+
+	EXPECT_TRUE(WalkParallel(parallel_walker, addresses));
+	EXPECT_EQ(addresses, expected);
+	EXPECT_EQ(parallel_walker.get_objects(), expected.size());
+	EXPECT_EQ(boundary_index.size(), 4);
+
+	// Second walk splits segments at recorded boundaries.
+	ParallelGCHeapWalker split_walker(segments, &heap, &method_tables, &boundary_index, logger, 4, 0x400);
+
+	EXPECT_GT(split_walker.get_work_items().size(), 8);
+
+	addresses.clear();
+
+	EXPECT_TRUE(WalkParallel(split_walker, addresses));
+	EXPECT_EQ(addresses, expected);
+
+	EXPECT_EQ(logger->_logs.size(), 0);
+
+	delete logger;
+}
+
+TEST(ParallelGCHeapWalker, SingleThreadForUnsafeReader)
+{
+	auto logger = new FakeLogger();
+
+	FakeHeap heap;
+
+	auto segments = CreateHeap(heap);
+
+	MethodTableCache method_tables;
+
+	method_tables.attach(nullptr, &heap, logger);
+
+	ParallelGCHeapWalker walker(segments, &heap, &method_tables, nullptr, logger, 4);
+
+	EXPECT_EQ(walker.get_thread_count(), 1);
+
+	unsigned long count = 0;
+
+	EXPECT_TRUE(walker.walk([&](size_t item, const GCHeapObject& object){ return ++count < 10; }));
+	EXPECT_EQ(count, 10);
+
+	delete logger;
+}
+
+TEST(ParallelGCHeapWalker, InvalidObject)
+{
+	auto logger = new FakeLogger();
+
+	FakeHeap heap;
+
+	auto segments = CreateHeap(heap);
+
+	heap.write_u32(0x20000c, 0x6000);
+	heap._is_thread_safe = true;
+
+	MethodTableCache method_tables;
+
+	method_tables.attach(nullptr, &heap, logger);
+
+	GCHeapBoundaryIndex boundary_index;
+
+	ParallelGCHeapWalker walker(segments, &heap, &method_tables, &boundary_index, logger, 2);
+
+	unsigned long count = 0;
+
+	EXPECT_FALSE(walker.walk([&](size_t item, const GCHeapObject& object){ return true; }));
+
+	// Logs are written by the calling thread, boundaries of the corrupt segment are not kept.
+	EXPECT_EQ(logger->_logs.size(), 1);
+	EXPECT_EQ(boundary_index.size(), 3);
+
+	delete logger;
+}
\ No newline at end of file
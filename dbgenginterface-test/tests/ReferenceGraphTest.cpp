@@ -0,0 +1,278 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file ReferenceGraphTest.cpp
+
+Implements ReferenceGraphTest class defines unit tests for ReferenceGraph class.
+*/
+
+#include "..\stdafx.h"
+
+#include <cstdio>
+#include <fstream>
+
+#include "ReferenceGraph.h"
+#include "FakeHeap.h"
+#include "FakeLogger.h"
+
+static const unsigned long MT_PAIR = 0x5000;
+static const unsigned long MT_ARRAY = 0x5100;
+static const unsigned long MT_STRUCTS = 0x5200;
+static const unsigned long MT_LEAF = 0x5300;
+
+/**
+Writes MethodTables with GC descriptors: a class with two pointer fields, an object array, an array of { object, int } structs and a class without pointers.
+*/
+static void AddMethodTables(FakeHeap& heap)
+{
+	heap.add_method_table(MT_PAIR, 16, 0);
+	heap.write_u32(MT_PAIR, GCDesc::CONTAINS_POINTERS_FLAG);
+	heap.write_u32(MT_PAIR - 4, 1);
+	heap.write_u32(MT_PAIR - 12, (unsigned long) -8);
+	heap.write_u32(MT_PAIR - 8, 4);
+
+	heap.add_method_table(MT_ARRAY, 12, 4);
+	heap.write_u32(MT_ARRAY, MethodTableCache::HAS_COMPONENT_SIZE_FLAG | GCDesc::CONTAINS_POINTERS_FLAG | 4);
+	heap.write_u32(MT_ARRAY - 4, 1);
+	heap.write_u32(MT_ARRAY - 12, (unsigned long) -12);
+	heap.write_u32(MT_ARRAY - 8, 8);
+
+	heap.add_method_table(MT_STRUCTS, 12, 8);
+	heap.write_u32(MT_STRUCTS, MethodTableCache::HAS_COMPONENT_SIZE_FLAG | GCDesc::CONTAINS_POINTERS_FLAG | 8);
+	heap.write_u32(MT_STRUCTS - 4, (unsigned long) -1);
+	heap.write_u32(MT_STRUCTS - 12, 0x00040001);
+	heap.write_u32(MT_STRUCTS - 8, 8);
+
+	heap.add_method_table(MT_LEAF, 12, 0);
+}
+
+/**
+Creates a segment with objects referencing each other and a second segment, listed first, referencing the first.
+Objects are pair (0x100000), pair (0x100010), array (0x100020), structs (0x100038), leaf (0x100054) and pair (0x200000).
+*/
+static RangeList CreateHeap(FakeHeap& heap, unsigned long fillers)
+{
+	AddMethodTables(heap);
+
+	auto address = 0x100000UL;
+
+	address += heap.add_object(address, MT_PAIR, 16, 0, 0);
+	heap.write_u32(0x100004, 0x100010);
+	heap.write_u32(0x100008, 0x100020);
+
+	address += heap.add_object(address, MT_PAIR, 16, 0, 0);
+	heap.write_u32(0x100014, 0x100054);
+
+	address += heap.add_object(address, MT_ARRAY, 12, 4, 3);
+	heap.write_u32(0x100028, 0x100000);
+	heap.write_u32(0x10002c, 0x100054);
+	heap.write_u32(0x100030, 0x999990);
+
+	address += heap.add_object(address, MT_STRUCTS, 12, 8, 2);
+	heap.write_u32(0x100040, 0x100010);
+	heap.write_u32(0x100044, 7);
+	heap.write_u32(0x100048, 0x100054);
+	heap.write_u32(0x10004c, 9);
+
+	address += heap.add_object(address, MT_LEAF, 12, 0, 0);
+
+	for (unsigned long i = 0; i < fillers; i++)
+	{
+		auto filler = address;
+
+		address += heap.add_object(address, MT_PAIR, 16, 0, 0);
+		heap.write_u32(filler + 4, 0x100054);
+		heap.write_u32(filler + 8, filler - 16 * (i % 3));
+	}
+
+	auto ranges = new std::vector<const MemoryRange>();
+
+	ranges->push_back(MemoryRange(0x200000, heap.add_object(0x200000, MT_PAIR, 16, 0, 0), State::Commit, Usage::GCHeap));
+	ranges->push_back(MemoryRange(0x100000, address - 0x100000, State::Commit, Usage::GCHeap));
+
+	heap.write_u32(0x200004, 0x100000);
+	heap.write_u32(0x200008, 0x100000);
+
+	return RangeList(ranges);
+}
+
+static std::vector<unsigned int> ToVector(const ReferenceNodeRange& range)
+{
+	return std::vector<unsigned int>(range.begin(), range.end());
+}
+
+TEST(ReferenceGraph, ForwardAndReverseEdges)
+{
+	auto logger = new FakeLogger();
+
+	FakeHeap heap;
+
+	auto segments = CreateHeap(heap, 0);
+
+	MethodTableCache method_tables;
+
+	method_tables.attach(nullptr, &heap, logger);
+
+	ParallelGCHeapWalker walker(segments, &heap, &method_tables, nullptr, logger);
+
+	ReferenceGraph graph(segments);
+
+	EXPECT_TRUE(graph.build(walker, &method_tables));
+	EXPECT_TRUE(graph.matches(segments));
+	EXPECT_EQ(graph.get_node_count(), 6);
+	EXPECT_EQ(graph.get_edge_count(), 9);
+
+	EXPECT_EQ(graph.find_node(0x100000), 0);
+	EXPECT_EQ(graph.find_node(0x100024), 2);
+	EXPECT_EQ(graph.find_node(0x200000), 5);
+	EXPECT_EQ(graph.find_node(0x200010), ReferenceGraph::NOT_FOUND);
+	EXPECT_EQ(graph.find_node(0x1000), ReferenceGraph::NOT_FOUND);
+	EXPECT_EQ(graph.get_address(3), 0x100038);
+	EXPECT_EQ(graph.get_method_table(3), MT_STRUCTS);
+	EXPECT_EQ(graph.get_size(3), 28);
+
+	EXPECT_EQ(ToVector(graph.get_references(0)), std::vector<unsigned int>({ 1, 2 }));
+	EXPECT_EQ(ToVector(graph.get_references(1)), std::vector<unsigned int>({ 4 }));
+	EXPECT_EQ(ToVector(graph.get_references(2)), std::vector<unsigned int>({ 0, 4 }));
+	EXPECT_EQ(ToVector(graph.get_references(3)), std::vector<unsigned int>({ 1, 4 }));
+	EXPECT_TRUE(graph.get_references(4).empty());
+	EXPECT_EQ(ToVector(graph.get_references(5)), std::vector<unsigned int>({ 0, 0 }));
+
+	EXPECT_EQ(ToVector(graph.get_referrers(0)), std::vector<unsigned int>({ 2, 5, 5 }));
+	EXPECT_EQ(ToVector(graph.get_referrers(1)), std::vector<unsigned int>({ 0, 3 }));
+	EXPECT_EQ(ToVector(graph.get_referrers(2)), std::vector<unsigned int>({ 0 }));
+	EXPECT_TRUE(graph.get_referrers(3).empty());
+	EXPECT_EQ(ToVector(graph.get_referrers(4)), std::vector<unsigned int>({ 1, 2, 3 }));
+	EXPECT_TRUE(graph.get_referrers(5).empty());
+
+	EXPECT_EQ(logger->_logs.size(), 0);
+
+	delete logger;
+}
+
+TEST(ReferenceGraph, ParallelSameAsSequential)
+{
+	auto logger = new FakeLogger();
+
+	FakeHeap heap;
+
+	auto segments = CreateHeap(heap, 300);
+
+	MethodTableCache method_tables;
+
+	method_tables.attach(nullptr, &heap, logger);
+
+	ParallelGCHeapWalker walker(segments, &heap, &method_tables, nullptr, logger);
+
+	ReferenceGraph expected(segments);
+
+	EXPECT_TRUE(expected.build(walker, &method_tables));
+
+	heap._is_thread_safe = true;
+
+	GCHeapBoundaryIndex boundary_index;
+
+	// First walk records boundaries, second walk splits segments.
+	ParallelGCHeapWalker first_walker(segments, &heap, &method_tables, &boundary_index, logger, 4, 0x400);
+	ReferenceGraph first_graph(segments);
+
+	EXPECT_TRUE(first_graph.build(first_walker, &method_tables));
+
+	ParallelGCHeapWalker split_walker(segments, &heap, &method_tables, &boundary_index, logger, 4, 0x400);
+	ReferenceGraph graph(segments);
+
+	EXPECT_GT(split_walker.get_work_items().size(), 4);
+	EXPECT_TRUE(graph.build(split_walker, &method_tables));
+
+	EXPECT_EQ(graph.get_node_count(), 306);
+	EXPECT_EQ(graph.get_edge_count(), expected.get_edge_count());
+
+	for (unsigned int node = 0; node < expected.get_node_count(); node++)
+	{
+		EXPECT_EQ(graph.get_address(node), expected.get_address(node));
+		EXPECT_EQ(ToVector(graph.get_references(node)), ToVector(expected.get_references(node)));
+		EXPECT_EQ(ToVector(graph.get_referrers(node)), ToVector(expected.get_referrers(node)));
+	}
+
+	EXPECT_EQ(graph.get_referrers(4).size(), 303);
+	EXPECT_TRUE(std::is_sorted(graph.get_referrers(4).begin(), graph.get_referrers(4).end()));
+
+	delete logger;
+}
+
+TEST(ReferenceGraph, SaveAndLoad)
+{
+	auto logger = new FakeLogger();
+
+	FakeHeap heap;
+
+	auto segments = CreateHeap(heap, 10);
+
+	MethodTableCache method_tables;
+
+	method_tables.attach(nullptr, &heap, logger);
+
+	ParallelGCHeapWalker walker(segments, &heap, &method_tables, nullptr, logger);
+
+	ReferenceGraph graph(segments);
+
+	EXPECT_TRUE(graph.build(walker, &method_tables));
+
+	const std::string path = "ReferenceGraphTest.bin";
+
+	EXPECT_TRUE(graph.save(path));
+
+	ReferenceGraph loaded;
+
+	EXPECT_TRUE(loaded.load(path));
+	EXPECT_FALSE(loaded.matches(segments));
+	EXPECT_TRUE(loaded.is_complete());
+	EXPECT_EQ(loaded.get_node_count(), graph.get_node_count());
+	EXPECT_EQ(loaded.get_edge_count(), graph.get_edge_count());
+
+	for (unsigned int node = 0; node < graph.get_node_count(); node++)
+	{
+		EXPECT_EQ(loaded.get_address(node), graph.get_address(node));
+		EXPECT_EQ(loaded.get_method_table(node), graph.get_method_table(node));
+		EXPECT_EQ(loaded.get_size(node), graph.get_size(node));
+		EXPECT_EQ(ToVector(loaded.get_references(node)), ToVector(graph.get_references(node)));
+		EXPECT_EQ(ToVector(loaded.get_referrers(node)), ToVector(graph.get_referrers(node)));
+	}
+
+	// Files with unexpected sizes are rejected.
+	{
+		std::ofstream stream(path, std::ios::binary | std::ios::app);
+
+		stream.write("x", 1);
+	}
+
+	EXPECT_FALSE(loaded.load(path));
+	EXPECT_EQ(loaded.get_node_count(), 0);
+
+	std::remove(path.c_str());
+
+	delete logger;
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file SafeWaitHandleParserTest.cpp
+
+Implements SafeWaitHandleParserTest class defines unit tests for SafeWaitHandleParser class.
+*/
+
+#include "..\stdafx.h"
+
+#include "SafeWaitHandleParser.h"
+#include "FakeMemoryReader.h"
+#include "FakeLogger.h"
+
+TEST(SafeWaitHandleParser, NoAddresses)
+{
+	auto reader = new FakeMemoryReader(FakeMemoryReader::ReadLambda([](unsigned long offset, void* buffer, unsigned long cb, unsigned long* read)
+	{
+		*read = 0;
+
+		return 0;
+	}));
+
+	auto logger = new FakeLogger();
+
+	auto parser = SafeWaitHandleParser(reader, logger);
+
+	auto output = parser.execute(DumpHeapCommandOutput());
+
+	EXPECT_FALSE(output.has_handle_addresses());
+	EXPECT_EQ(reader->_reads, 0);
+
+	delete reader;
+	delete logger;
+}
+
+TEST(SafeWaitHandleParser, ValidObjects)
+{
+	// Handle value of an object is its address shifted right by 4, the rest of the object is zero.
+	auto reader = new FakeMemoryReader(FakeMemoryReader::ReadLambda([](unsigned long offset, void* buffer, unsigned long cb, unsigned long* read)
+	{
+		for (unsigned long i = 0; i < cb; i++)
+		{
+			auto address = offset + i;
+			auto field_offset = address & 0xF;
+
+			unsigned char value = 0;
+
+			if (field_offset >= 4 && field_offset < 7)
+			{
+				value = ((address >> 4) >> (8 * (field_offset - 4))) & 0xFF;
+			}
+
+			static_cast<unsigned char*>(buffer)[i] = value;
+		}
+
+		*read = cb;
+
+		return 1;
+	}));
+
+	auto logger = new FakeLogger();
+
+	std::vector<unsigned long> addresses;
+
+	addresses.push_back(0x00851010);
+	addresses.push_back(0);
+	addresses.push_back(0x00851000);
+	addresses.push_back(0x00852f00);
+
+	auto parser = SafeWaitHandleParser(reader, logger);
+
+	auto output = parser.execute(DumpHeapCommandOutput(CompressedAddressSet(addresses)));
+
+	EXPECT_TRUE(output.has_handle_addresses());
+
+	auto handle_addresses = output.get_handle_addresses();
+
+	EXPECT_EQ(handle_addresses->size(), 3);
+	EXPECT_EQ(handle_addresses->at(0x85101), 0x00851010);
+	EXPECT_EQ(handle_addresses->at(0x85100), 0x00851000);
+	EXPECT_EQ(handle_addresses->at(0x852f0), 0x00852f00);
+	EXPECT_EQ(reader->_reads, 1);
+
+	delete reader;
+	delete logger;
+}
\ No newline at end of file
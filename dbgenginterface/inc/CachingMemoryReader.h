@@ -0,0 +1,103 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file CachingMemoryReader.h
+
+Defines the CachingMemoryReader class.
+*/
+
+#ifndef __CACHINGMEMORYREADER_H__
+
+#define __CACHINGMEMORYREADER_H__
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "IMemoryReader.h"
+
+/**
+\class CachingMemoryReader
+
+Decorates an IMemoryReader with a page cache, LRU eviction and sequential read-ahead.
+*/
+class CachingMemoryReader : public IMemoryReader
+{
+public:
+	static const unsigned long PAGE_SIZE = 4096;
+	static const unsigned long DEFAULT_MAX_PAGES = 1024;
+	static const unsigned long DEFAULT_READ_AHEAD_PAGES = 8;
+
+private:
+	struct CachedPage
+	{
+		unsigned long valid_bytes;
+		std::vector<unsigned char> data;
+		std::list<unsigned long>::iterator lru_position;
+	};
+
+	IMemoryReader* _reader;
+
+	unsigned long _max_pages;
+	unsigned long _read_ahead_pages;
+
+	std::unordered_map<unsigned long, CachedPage> _pages;
+	std::list<unsigned long> _lru;
+
+	unsigned long _last_missed_page = 0;
+	bool _has_last_missed_page = false;
+
+	unsigned long _hits = 0;
+	unsigned long _misses = 0;
+	unsigned long _engine_reads = 0;
+	unsigned long _bytes_fetched = 0;
+
+	CachedPage* find_page(unsigned long page_address);
+	CachedPage* fetch_pages(unsigned long page_address, unsigned long page_count);
+	void evict();
+
+public:
+	CachingMemoryReader(IMemoryReader* reader, unsigned long max_pages = DEFAULT_MAX_PAGES, unsigned long read_ahead_pages = DEFAULT_READ_AHEAD_PAGES)
+		: _reader(reader), _max_pages(max_pages == 0 ? 1 : max_pages), _read_ahead_pages(read_ahead_pages)
+	{
+
+	}
+
+#pragma push_macro("ReadMemory")
+#undef ReadMemory
+	virtual unsigned long ReadMemory(unsigned long offset, void *lpBuffer, unsigned long cb, unsigned long* lpcbBytesRead) override;
+#pragma pop_macro("ReadMemory")
+
+	void clear();
+
+	unsigned long get_hits() const { return _hits; }
+	unsigned long get_misses() const { return _misses; }
+	unsigned long get_engine_reads() const { return _engine_reads; }
+	unsigned long get_bytes_fetched() const { return _bytes_fetched; }
+	unsigned long get_cached_pages() const { return static_cast<unsigned long>(_pages.size()); }
+};
+
+#endif // #ifndef __CACHINGMEMORYREADER_H__
\ No newline at end of file
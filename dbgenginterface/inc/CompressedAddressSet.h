@@ -0,0 +1,144 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file CompressedAddressSet.h
+
+Defines the CompressedAddressSet and CompressedAddressSetBuilder classes.
+*/
+
+#ifndef __COMPRESSEDADDRESSSET_H__
+
+#define __COMPRESSEDADDRESSSET_H__
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+/**
+\class CompressedAddressSet
+
+Represents a sorted set of addresses in blocks of BLOCK_SIZE addresses. A block keeps its first address,
+the following addresses are kept as differences to their predecessors, encoded as variable length integers of 7 bits per byte.
+Object addresses on the GC heap are a few dozen bytes apart, so most addresses take one byte.
+*/
+class CompressedAddressSet
+{
+public:
+	static const size_t BLOCK_SIZE = 128;
+
+	/**
+	\class const_iterator
+
+	Iterates addresses in ascending order, decoding one difference per step.
+	*/
+	class const_iterator
+	{
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef unsigned long value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const unsigned long* pointer;
+		typedef unsigned long reference;
+
+	private:
+		const CompressedAddressSet* _set;
+		size_t _index;
+		const unsigned char* _next;
+		unsigned long _value;
+
+		friend class CompressedAddressSet;
+
+		void load_block(size_t block);
+
+	public:
+		const_iterator(const CompressedAddressSet* set, size_t index);
+
+		unsigned long operator*() const { return _value; }
+		const_iterator& operator++();
+		const_iterator operator++(int) { auto ret = *this; ++(*this); return ret; }
+
+		bool operator==(const const_iterator& other) const { return _index == other._index; }
+		bool operator!=(const const_iterator& other) const { return _index != other._index; }
+
+		void seek(unsigned long address);
+		size_t get_index() const { return _index; }
+	};
+
+private:
+	std::vector<unsigned long> _block_firsts;
+	std::vector<size_t> _block_offsets;
+	std::vector<unsigned char> _data;
+
+	size_t _size = 0;
+	unsigned long _back = 0;
+
+	void append(unsigned long address);
+
+	friend class CompressedAddressSetBuilder;
+
+public:
+	CompressedAddressSet()
+	{
+
+	}
+
+	CompressedAddressSet(const std::vector<unsigned long>& addresses);
+
+	const_iterator begin() const { return const_iterator(this, 0); }
+	const_iterator end() const { return const_iterator(this, _size); }
+	const_iterator lower_bound(unsigned long address) const;
+
+	size_t size() const { return _size; }
+	bool empty() const { return _size == 0; }
+	size_t memory_size() const;
+
+	bool contains(unsigned long address) const;
+	size_t rank(unsigned long address) const;
+	unsigned long select(size_t index) const;
+
+	std::vector<unsigned long> to_vector() const;
+
+	static CompressedAddressSet intersect(const CompressedAddressSet& a, const CompressedAddressSet& b);
+	static CompressedAddressSet unite(const CompressedAddressSet& a, const CompressedAddressSet& b);
+};
+
+/**
+\class CompressedAddressSetBuilder
+
+Builds a CompressedAddressSet from addresses in any order. Ascending runs, such as objects of one heap segment, are compressed as they are added and merged at the end.
+*/
+class CompressedAddressSetBuilder
+{
+private:
+	std::vector<CompressedAddressSet> _runs;
+	CompressedAddressSet _current;
+
+public:
+	void add(unsigned long address);
+	CompressedAddressSet build();
+};
+
+#endif // #ifndef __COMPRESSEDADDRESSSET_H__
\ No newline at end of file
@@ -0,0 +1,81 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file DeflateEncoder.h
+
+Defines the DeflateEncoder class.
+*/
+
+#ifndef __DEFLATEENCODER_H__
+
+#define __DEFLATEENCODER_H__
+
+#include <vector>
+
+/**
+\class DeflateEncoder
+
+Encodes data as a raw deflate stream (RFC 1951) with fixed Huffman codes, appending to an output buffer as data is written.
+Matches are only searched at a few caller-provided distances, such as one pixel or one image row, which finds the long runs in heap maps without hash chains.
+Matches can reach into history before the written data, so blocks of a larger buffer can be encoded on separate threads and concatenated.
+*/
+class DeflateEncoder
+{
+public:
+	static const unsigned int WINDOW_SIZE = 32768;
+	static const unsigned int MIN_MATCH = 3;
+	static const unsigned int MAX_MATCH = 258;
+	static const unsigned int END_OF_BLOCK = 256;
+
+private:
+	std::vector<unsigned char>& _output;
+	std::vector<unsigned int> _distances;
+
+	unsigned int _bit_buffer = 0;
+	unsigned int _bit_count = 0;
+	bool _is_block_open = false;
+
+	void write_bits(unsigned int value, unsigned int count);
+	void write_symbol(unsigned int symbol);
+	void write_match(unsigned int length, unsigned int distance);
+	void align();
+
+	DeflateEncoder(const DeflateEncoder&);
+	DeflateEncoder& operator=(const DeflateEncoder&);
+
+public:
+	explicit DeflateEncoder(std::vector<unsigned char>& output);
+
+	void add_distance(unsigned int distance);
+	void write(const unsigned char* data, size_t size, size_t history);
+	void flush();
+	void finish();
+
+	static unsigned int adler32(const unsigned char* data, size_t size, unsigned int adler = 1);
+	static unsigned int adler32_combine(unsigned int adler1, unsigned int adler2, size_t size2);
+};
+
+#endif // #ifndef __DEFLATEENCODER_H__
\ No newline at end of file
@@ -24,7 +24,7 @@
 // http://github.com/krk/
 
 /**
-\file DumpHeapOutput.h
+\file DumpHeapCommandOutput.h
 
 Defines the DumpHeapCommandOutput class.
 */
@@ -33,7 +33,7 @@ Defines the DumpHeapCommandOutput class.
 
 #define __DUMPHEAPCOMMANDOUTPUT_H__
 
-#include <vector>
+#include "CompressedAddressSet.h"
 
 /**
 \class DumpHeapCommandOutput
@@ -43,7 +43,7 @@ Represents output of the !dumpheap command.
 class DumpHeapCommandOutput
 {
 private:
-	std::vector<unsigned long> *_addresses = nullptr;
+	CompressedAddressSet _addresses;
 
 public:
 	DumpHeapCommandOutput()
@@ -51,15 +51,15 @@ public:
 
 	}
 
-	DumpHeapCommandOutput(std::vector<unsigned long> *addresses)
-		: _addresses(addresses)
+	DumpHeapCommandOutput(CompressedAddressSet addresses)
+		: _addresses(std::move(addresses))
 	{
 
 	}
 
-	std::vector<unsigned long>* get_addresses() const;
+	const CompressedAddressSet& get_addresses() const;
 
-	bool has_addresses() const { return _addresses != nullptr&& _addresses->size() > 0; }
+	bool has_addresses() const { return !_addresses.empty(); }
 };
 
 #endif // #ifndef __DUMPHEAPCOMMANDOUTPUT_H__
\ No newline at end of file
@@ -58,7 +58,8 @@ private:
 
 	IDebuggerCommandExecutor* _executor;
 
-	std::vector<unsigned long>* Parse(const std::string& lines);
+	CompressedAddressSet Parse(const std::string& lines);
+	bool ParseLine(const std::string& line, unsigned long& address);
 	std::vector<unsigned long>* ParseTables(const std::string& clr_exact_type_name, const std::string& lines);
 
 protected:
@@ -35,6 +35,11 @@ Defines the EEHeapCommandOutput class.
 
 #include "MemoryRange.h"
 
+#include <utility>
+#include <vector>
+
+typedef std::vector<std::pair<unsigned long, unsigned long>> GenerationStartList;
+
 /**
 \class EEHeapCommandOutput
 
@@ -44,6 +49,7 @@ class EEHeapCommandOutput
 {
 private:
 	RangeList _ranges = nullptr;
+	GenerationStartList _generation_starts;
 
 public:
 	EEHeapCommandOutput()
@@ -57,7 +63,14 @@ public:
 
 	}
 
+	EEHeapCommandOutput(const RangeList ranges, const GenerationStartList& generation_starts)
+		: _ranges(ranges), _generation_starts(generation_starts)
+	{
+
+	}
+
 	RangeList get_ranges();
+	const GenerationStartList& get_generation_starts() const { return _generation_starts; }
 
 	bool has_ranges() { return _ranges != nullptr && _ranges->size() > 0; }
 };
@@ -55,7 +55,7 @@ private:
 	IDebuggerCommandExecutor* _executor;
 	ILogger* _logger;
 
-	std::vector<const MemoryRange>* Parse(const std::string& lines);
+	std::vector<const MemoryRange>* Parse(const std::string& lines, GenerationStartList& generation_starts);
 
 public:
 	EEHeapCommandParser(IDebuggerCommandExecutor* executor, ILogger* logger)
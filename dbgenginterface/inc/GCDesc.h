@@ -0,0 +1,124 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file GCDesc.h
+
+Defines the GCDesc class.
+*/
+
+#ifndef __GCDESC_H__
+
+#define __GCDESC_H__
+
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "IMemoryReader.h"
+
+/**
+\class GCDesc
+
+Represents the GC descriptor of an x86 CLR MethodTable, the series of pointer fields that the GC stores in front of the MethodTable.
+A positive series count is followed by (size, offset) series, sizes are relative to the object size.
+A negative series count describes arrays of value types with pointers, one (pointers, skip) item per run of each element.
+*/
+class GCDesc
+{
+public:
+	static const unsigned long CONTAINS_POINTERS_FLAG = 0x01000000;
+	static const unsigned long MAX_SERIES = 4096;
+	static const unsigned long POINTER_SIZE = 4;
+
+	std::vector<std::pair<long, unsigned long>> Series;
+	std::vector<std::pair<unsigned short, unsigned short>> ValueSeries;
+	unsigned long ValueStartOffset = 0;
+
+	bool read(IMemoryReader* memory_reader, unsigned long method_table);
+
+	/**
+	Enumerates non-null pointer fields of an object.
+
+	\param object Bytes of the object, from its MethodTable pointer.
+	\param size Object size.
+	\param callback Invoked with the value of each non-null pointer field.
+	*/
+	template <typename Callback>
+	void for_each_reference(const unsigned char* object, unsigned long size, Callback callback) const
+	{
+		auto visit = [&](unsigned long offset)
+		{
+			unsigned int value;
+
+			memcpy(&value, object + offset, sizeof(value));
+
+			if (value != 0)
+			{
+				callback(static_cast<unsigned long>(value));
+			}
+		};
+
+		for (auto& series : Series)
+		{
+			auto stop = static_cast<long long>(series.second) + series.first + size;
+
+			for (auto offset = series.second; offset < stop && offset + POINTER_SIZE <= size; offset += POINTER_SIZE)
+			{
+				visit(offset);
+			}
+		}
+
+		if (ValueSeries.empty() || size < POINTER_SIZE)
+		{
+			return;
+		}
+
+		// The last pointer size of an object is the header of the next one.
+		auto stop = size - POINTER_SIZE;
+
+		for (auto offset = ValueStartOffset; offset < stop;)
+		{
+			auto start = offset;
+
+			for (auto& item : ValueSeries)
+			{
+				for (unsigned short i = 0; i < item.first && offset + POINTER_SIZE <= size; i++, offset += POINTER_SIZE)
+				{
+					visit(offset);
+				}
+
+				offset += item.second;
+			}
+
+			if (offset == start)
+			{
+				break;
+			}
+		}
+	}
+};
+
+#endif // #ifndef __GCDESC_H__
\ No newline at end of file
@@ -0,0 +1,116 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file GCHeapWalker.h
+
+Defines the GCHeapWalker class.
+*/
+
+#ifndef __GCHEAPWALKER_H__
+
+#define __GCHEAPWALKER_H__
+
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "MemoryRange.h"
+#include "ILogger.h"
+#include "IMemoryReader.h"
+#include "MethodTableCache.h"
+
+/**
+\class GCHeapObject
+
+Represents an object found on the GC heap.
+*/
+class GCHeapObject
+{
+public:
+	unsigned long Address;
+	unsigned long MethodTable;
+	unsigned long Size;
+
+	GCHeapObject(unsigned long address, unsigned long method_table, unsigned long size)
+		: Address(address), MethodTable(method_table), Size(size)
+	{
+
+	}
+};
+
+typedef std::function<bool(const GCHeapObject&)> GCHeapObjectCallback;
+
+/**
+\class GCHeapWalker
+
+Implements a walker of x86 CLR heap segments that steps from object to object by MethodTable base and component sizes, an alternative to parsing !dumpheap output.
+*/
+class GCHeapWalker
+{
+public:
+	static const unsigned long WINDOW_SIZE = 64 * 1024;
+	static const unsigned long POINTER_SIZE = 4;
+	static const unsigned long OBJECT_HEADER_SIZE = 2 * POINTER_SIZE;
+	static const unsigned long MIN_OBJECT_SIZE = 3 * POINTER_SIZE;
+	static const unsigned long LARGE_OBJECT_ALIGNMENT = 8;
+	static const unsigned long METHOD_TABLE_MARK_BITS = 3;
+
+private:
+	RangeList _segments;
+	IMemoryReader* _memory_reader;
+	MethodTableCache* _method_table_cache;
+	ILogger* _logger;
+
+	std::unordered_map<unsigned long, std::pair<unsigned long, unsigned long>> _method_table_sizes;
+
+	std::vector<unsigned char> _window;
+	unsigned long _window_address = 0;
+	unsigned long _window_size = 0;
+	unsigned long _segment_end = 0;
+
+	unsigned long _objects = 0;
+	unsigned long _gap_bytes = 0;
+
+	const unsigned char* read_window(unsigned long address, unsigned long size, unsigned long limit);
+	bool get_sizes(unsigned long method_table, unsigned long& base_size, unsigned long& component_size);
+
+public:
+	GCHeapWalker(RangeList segments, IMemoryReader* memory_reader, MethodTableCache* method_table_cache, ILogger* logger)
+		: _segments(segments), _memory_reader(memory_reader), _method_table_cache(method_table_cache), _logger(logger)
+	{
+
+	}
+
+	bool walk(const GCHeapObjectCallback& callback);
+	bool walk_segment(const MemoryRange& segment, const GCHeapObjectCallback& callback);
+	const unsigned char* read_object(const GCHeapObject& object);
+
+	unsigned long get_objects() const { return _objects; }
+	unsigned long get_gap_bytes() const { return _gap_bytes; }
+};
+
+#endif // #ifndef __GCHEAPWALKER_H__
\ No newline at end of file
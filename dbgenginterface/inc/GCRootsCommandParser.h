@@ -0,0 +1,73 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file GCRootsCommandParser.h
+
+Defines the GCRootsCommandParser class.
+*/
+
+#ifndef __GCROOTSCOMMANDPARSER_H__
+
+#define __GCROOTSCOMMANDPARSER_H__
+
+#include <string>
+#include <vector>
+
+#include "IDebuggerCommandExecutor.h"
+#include "ILogger.h"
+
+/**
+\class GCRootsCommandParser
+
+Implements a parser for gchandles and dumpstackobjects outputs, finding objects held by strong handles and by thread stacks.
+*/
+class GCRootsCommandParser
+{
+private:
+	const std::string _command_handles = "!gchandles";
+	const std::string _command_stack_objects = "~*e !dumpstackobjects";
+
+	IDebuggerCommandExecutor* _executor;
+
+	static bool IsAddress(const std::string& text);
+
+protected:
+	ILogger* _logger;
+
+public:
+	GCRootsCommandParser(IDebuggerCommandExecutor* executor, ILogger* logger)
+		: _executor(executor), _logger(logger)
+	{
+
+	}
+
+	std::vector<unsigned long> execute();
+
+	void ParseHandles(const std::string& lines, std::vector<unsigned long>& roots);
+	void ParseStackObjects(const std::string& lines, std::vector<unsigned long>& roots);
+};
+
+#endif // #ifndef __GCROOTSCOMMANDPARSER_H__
\ No newline at end of file
@@ -0,0 +1,106 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file HeapMapAggregator.h
+
+Defines the HeapMapAggregator class.
+*/
+
+#ifndef __HEAPMAPAGGREGATOR_H__
+
+#define __HEAPMAPAGGREGATOR_H__
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "MemoryRange.h"
+#include "HeapMapHilbertCurve.h"
+
+/**
+Ways of coloring a pixel from the bytes of each usage under it.
+*/
+enum class HeapMapAggregation
+{
+	Dominant,
+	Blend
+};
+
+/**
+\class HeapMapAggregator
+
+Renders memory ranges to a heap map of any size, the 32-bit address space is split evenly over pixels laid out top to bottom in columns, left to right, or along a Hilbert curve if one is set.
+Each pixel counts the bytes of every state and usage under it and takes the color of the usage with the most bytes, or blends the colors of all usages
+and the background by their bytes. Ranges of a layer are counted, never drawn over each other, so a pixel shows small ranges in proportion to their size.
+Bytes are counted for one class of state and usage at a time with a difference array over the pixels its ranges cover, so rendering is O(ranges + pixels).
+*/
+class HeapMapAggregator
+{
+public:
+	static const unsigned long long ADDRESS_SPACE_SIZE = 0x100000000ULL;
+
+private:
+	static const unsigned int STATE_COUNT = 4;
+	static const unsigned int USAGE_COUNT = 13;
+
+	unsigned int _width;
+	unsigned int _height;
+	HeapMapAggregation _aggregation;
+	unsigned long long _pixel_size = 0;
+	unsigned int _hidden_usages = 0;
+	std::shared_ptr<const HeapMapHilbertCurve> _curve;
+
+	std::vector<std::pair<RangeList, bool>> _layers;
+
+	std::vector<int> _starts;
+	std::vector<unsigned long long> _bytes;
+	std::vector<unsigned long long> _best_bytes;
+	std::vector<unsigned int> _best_colors;
+	std::vector<unsigned long long> _sums;
+
+	void count(const std::vector<const MemoryRange*>& ranges);
+	void merge(size_t pixel, unsigned int color, int& covering);
+	bool get_pixels(const MemoryRange& range, size_t& first, size_t& last) const;
+	unsigned long long get_pixel_size(size_t pixel) const;
+
+public:
+	HeapMapAggregator(unsigned int width, unsigned int height, HeapMapAggregation aggregation = HeapMapAggregation::Dominant);
+
+	void add_layer(RangeList ranges, bool is_monochrome = false);
+	void clear_layers() { _layers.clear(); }
+	void render(unsigned char* buffer);
+
+	void set_curve(std::shared_ptr<const HeapMapHilbertCurve> curve) { _curve = curve; }
+	void set_visible(Usage usage, bool is_visible);
+	bool is_visible(Usage usage) const;
+
+	unsigned int get_width() const { return _width; }
+	unsigned int get_height() const { return _height; }
+	unsigned long long get_pixel_address(unsigned long long pixel) const;
+	unsigned long long get_pixel(unsigned long long address) const;
+};
+
+#endif // #ifndef __HEAPMAPAGGREGATOR_H__
\ No newline at end of file
@@ -0,0 +1,145 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file HeapMapCompositor.h
+
+Defines the HeapMapCompositor class that renders usages of memory ranges to coverage masks and composites the masks of visible usages.
+*/
+
+#ifndef __HEAPMAPCOMPOSITOR_H__
+
+#define __HEAPMAPCOMPOSITOR_H__
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "MemoryRange.h"
+#include "HeapMapRasterizer.h"
+#include "HeapMapHilbertCurve.h"
+
+/**
+\class HeapMapMask
+
+Represents the pages covered by ranges of one layer with the same state and usage, with the depth of the last range drawn on each page.
+*/
+class HeapMapMask
+{
+public:
+	unsigned int Layer;
+	State State;
+	Usage Usage;
+	unsigned long FirstPage;
+	std::vector<unsigned char> Coverage;
+
+	HeapMapMask(unsigned int layer, ::State state, ::Usage usage, unsigned long first_page, unsigned long end_page)
+		: Layer(layer), State(state), Usage(usage), FirstPage(first_page), Coverage(end_page - first_page)
+	{
+
+	}
+
+	unsigned long get_end_page() const { return FirstPage + static_cast<unsigned long>(Coverage.size()); }
+};
+
+/**
+\class HeapMapComposition
+
+Represents a heap map composited from layers of a compositor.
+*/
+class HeapMapComposition
+{
+public:
+	std::vector<std::pair<unsigned int, bool>> Layers;
+	unsigned char* Buffer;
+	std::vector<HeapMapRect> Rects;
+
+	HeapMapComposition(unsigned char* buffer, unsigned int width, unsigned int height)
+		: Buffer(buffer), Rects(1, HeapMapRect(0, 0, width, height))
+	{
+
+	}
+
+	void add_layer(unsigned int layer, bool is_monochrome = false) { Layers.push_back(std::make_pair(layer, is_monochrome)); }
+};
+
+/**
+\class HeapMapCompositor
+
+Renders each state and usage of a layer of ranges once to a coverage mask with one byte per page, so showing and hiding usages only composites the masks again.
+Masks cover the pages from the first to the last range of their usage, in the column order of HeapMapRasterizer, and are composited with SSE2 selects of 16 pages at a time in layer order.
+A mask byte is the depth of the range drawn on the page: ranges in page order without overlaps are all at depth 1, otherwise a range is one deeper than the ranges it is drawn over on each page,
+and a page takes the deepest visible mask of a layer. Overlapping ranges are composited in range order like HeapMapRasterizer::draw, ranges of hidden usages uncover the ranges below them.
+Depths stop at MAX_DEPTH, pages under more overlapping ranges take the first of the deepest masks in state and usage order.
+Masks of a layer are filled in column tiles on multiple threads, with ranges of each tile found in a HeapMapRangeIndex.
+Layers keep their ranges, so updating a layer with ranges of the next snapshot renders only pages of ranges that changed.
+Maps composite layers by index, so the native map and the monochrome native layer of the GC map share masks.
+Composited pages are copied to the map in columns, or along a Hilbert curve if one is set.
+*/
+class HeapMapCompositor
+{
+private:
+	static const unsigned int STATE_COUNT = 4;
+	static const unsigned int USAGE_COUNT = 13;
+	static const unsigned int TILE_WIDTH = 64;
+	static const unsigned int MAX_DEPTH = 255;
+
+	unsigned int _width;
+	unsigned int _height;
+	unsigned int _hidden_usages = 0;
+
+	std::vector<RangeList> _ranges;
+	std::vector<HeapMapMask> _masks;
+	std::shared_ptr<const HeapMapHilbertCurve> _curve;
+
+	bool get_pages(const MemoryRange& range, unsigned long& first_page, unsigned long& end_page) const;
+	void add_masks(unsigned int layer, RangeList ranges, unsigned int thread_count);
+	bool get_changed_spans(const std::vector<const MemoryRange>& old_ranges, const std::vector<const MemoryRange>& new_ranges,
+		std::vector<std::pair<unsigned long, unsigned long>>& spans, std::vector<size_t>& added) const;
+
+	static void blend(unsigned int* pages, unsigned char* depths, const unsigned char* coverage, size_t count, unsigned int pixel);
+
+public:
+	HeapMapCompositor(unsigned int width, unsigned int height);
+
+	unsigned int add_layer(RangeList ranges, unsigned int thread_count = 0);
+	void update_layer(unsigned int layer, RangeList ranges);
+	void clear();
+
+	void set_curve(std::shared_ptr<const HeapMapHilbertCurve> curve) { _curve = curve; }
+	void set_visible(Usage usage, bool is_visible);
+	bool is_visible(Usage usage) const;
+
+	void composite(const HeapMapComposition& map, unsigned int first_column, unsigned int end_column, std::vector<unsigned int>& pages) const;
+	void composite(const HeapMapComposition& map) const;
+	void composite_parallel(const std::vector<HeapMapComposition>& maps, unsigned int thread_count = 0) const;
+
+	unsigned int get_width() const { return _width; }
+	unsigned int get_height() const { return _height; }
+	unsigned int get_layer_count() const { return static_cast<unsigned int>(_ranges.size()); }
+	size_t get_mask_count() const { return _masks.size(); }
+};
+
+#endif // #ifndef __HEAPMAPCOMPOSITOR_H__
\ No newline at end of file
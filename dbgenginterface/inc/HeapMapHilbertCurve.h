@@ -0,0 +1,79 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file HeapMapHilbertCurve.h
+
+Defines the HeapMapHilbertCurve class that lays out heap map pixels along a Hilbert curve.
+*/
+
+#ifndef __HEAPMAPHILBERTCURVE_H__
+
+#define __HEAPMAPHILBERTCURVE_H__
+
+#include <vector>
+
+class HeapMapRect;
+
+/**
+Layout of pages or aggregated pixels of a heap map.
+*/
+enum class HeapMapLayout
+{
+	Columns,
+	Hilbert
+};
+
+/**
+\class HeapMapHilbertCurve
+
+Lays out pixels of a heap map in address order along a Hilbert curve, so pages close in the address space stay close on the map.
+Maps are squares of a power of two side by side, or stacked for maps taller than wide, each square is a Hilbert curve from the corner next to the end of the previous square.
+Positions are found two bits of the index at a time with a state table and kept as row-major offsets, so pixels are placed with one lookup each.
+Aligned blocks of 4^k indices fill aligned squares of 2^k pixels, so a span of indices is covered by a few squares per power of two.
+*/
+class HeapMapHilbertCurve
+{
+private:
+	unsigned int _width;
+	unsigned int _height;
+
+	std::vector<unsigned int> _offsets;
+
+public:
+	HeapMapHilbertCurve(unsigned int width, unsigned int height);
+
+	static bool is_supported(unsigned int width, unsigned int height);
+	static void get_position(unsigned int order, unsigned long index, unsigned int& x, unsigned int& y);
+
+	void copy_to(const unsigned int* pixels, unsigned long first_index, unsigned long end_index, unsigned char* buffer) const;
+	void get_rects(unsigned long first_index, unsigned long end_index, std::vector<HeapMapRect>& rects) const;
+
+	unsigned int get_offset(size_t index) const { return _offsets[index]; }
+	unsigned int get_width() const { return _width; }
+	unsigned int get_height() const { return _height; }
+};
+
+#endif // #ifndef __HEAPMAPHILBERTCURVE_H__
\ No newline at end of file
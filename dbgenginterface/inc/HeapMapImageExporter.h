@@ -0,0 +1,72 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file HeapMapImageExporter.h
+
+Defines the HeapMapImageExporter class.
+*/
+
+#ifndef __HEAPMAPIMAGEEXPORTER_H__
+
+#define __HEAPMAPIMAGEEXPORTER_H__
+
+#include <ostream>
+#include <string>
+
+/**
+Image file formats of exported heap maps.
+*/
+enum class ImageFormat
+{
+	Png,
+	Ppm
+};
+
+/**
+\class HeapMapImageExporter
+
+Saves rendered heap maps as PNG or binary PPM images without Qt, so maps can be exported from headless sessions.
+Pixels are read as 32-bit values with blue in the lowest byte, as QImage::Format_RGB32 reads them, so exported images match images saved by Qt.
+PNG rows are filtered and deflated in blocks of ROW_BLOCK rows on multiple threads, each block is written as one IDAT chunk.
+*/
+class HeapMapImageExporter
+{
+public:
+	static const unsigned int ROW_BLOCK = 32;
+
+private:
+	static void write_chunk(std::ostream& stream, const char* type, const unsigned char* data, size_t size);
+	static void to_rgb(const unsigned char* pixels, unsigned int width, unsigned char* rgb);
+
+public:
+	static bool save(const unsigned char* pixels, unsigned int width, unsigned int height, const std::string& path, ImageFormat format, unsigned int thread_count = 0);
+	static bool write_png(std::ostream& stream, const unsigned char* pixels, unsigned int width, unsigned int height, unsigned int thread_count = 0);
+	static bool write_ppm(std::ostream& stream, const unsigned char* pixels, unsigned int width, unsigned int height);
+
+	static unsigned int crc32(const unsigned char* data, size_t size, unsigned int crc = 0);
+};
+
+#endif // #ifndef __HEAPMAPIMAGEEXPORTER_H__
\ No newline at end of file
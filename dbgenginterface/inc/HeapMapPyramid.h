@@ -0,0 +1,94 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file HeapMapPyramid.h
+
+Defines the HeapMapPyramid class.
+*/
+
+#ifndef __HEAPMAPPYRAMID_H__
+
+#define __HEAPMAPPYRAMID_H__
+
+#include <vector>
+
+#include "HeapMapRasterizer.h"
+
+/**
+\class HeapMapPyramid
+
+Represents a heap map at multiple resolutions, from one page per pixel at level 0 to one pixel for the whole map.
+Each pixel of a level covers 2x2 pixels of the level below. Pixels of state and usage colors are classed by color, and the class with the most pages under a pixel gives its color, ties going to the first state and usage.
+Maps with other colors, as blended aggregated maps, are averaged instead, each pixel of a level is the mean of the pixels it covers in the level below.
+Pages of each class are counted for pixels from level FIRST_COUNTED_LEVEL, so a pixel is computed from the counts of the 2x2 pixels below it and an update takes the changed rectangle and a few pixels per level.
+Levels are kept as row-major 32-bit pixels, so viewers can show any level or a part of it without rasterizing ranges again.
+Buffers are kept when the pyramid is built again or cleared, so refreshing a map of the same size does not allocate.
+Changed rectangles of a map are updated without computing other pixels again.
+*/
+class HeapMapPyramid
+{
+public:
+	static const unsigned int NO_CLASS = 0xFFFFFFFF;
+
+private:
+	static const unsigned int FIRST_COUNTED_LEVEL = 2;
+
+	std::vector<std::vector<unsigned int>> _levels;
+	std::vector<std::vector<unsigned int>> _counts;
+	std::vector<unsigned int> _widths;
+	std::vector<unsigned int> _heights;
+	size_t _level_count = 0;
+	bool _is_averaged = false;
+
+	std::vector<unsigned char> _classes;
+	std::vector<unsigned int> _cell;
+
+	void add_level(unsigned int width, unsigned int height);
+
+	bool classify(unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1);
+	void update_region(const unsigned char* buffer, unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1);
+	void update_dominant(unsigned int shift, unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1);
+	void update_average(unsigned int shift, unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1);
+
+public:
+	void build(const unsigned char* buffer, unsigned int width, unsigned int height);
+	void update(const unsigned char* buffer, unsigned int width, unsigned int height, const std::vector<HeapMapRect>& rects);
+	void clear();
+
+	size_t get_level_count() const { return _level_count; }
+	unsigned int get_width(size_t level) const { return _widths[level]; }
+	unsigned int get_height(size_t level) const { return _heights[level]; }
+	const unsigned char* get_pixels(size_t level) const { return reinterpret_cast<const unsigned char*>(_levels[level].data()); }
+	unsigned int get_pixel(size_t level, unsigned int x, unsigned int y) const { return _levels[level][(size_t) y * _widths[level] + x]; }
+
+	size_t select_level(double scale) const;
+	bool is_averaged() const { return _is_averaged; }
+
+	static unsigned int get_class(unsigned int pixel);
+	static unsigned int get_class_count();
+};
+
+#endif // #ifndef __HEAPMAPPYRAMID_H__
\ No newline at end of file
@@ -0,0 +1,192 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file HeapMapRasterizer.h
+
+Defines the HeapMapRasterizer class.
+*/
+
+#ifndef __HEAPMAPRASTERIZER_H__
+
+#define __HEAPMAPRASTERIZER_H__
+
+#include <memory>
+#include <vector>
+
+#include "MemoryRange.h"
+#include "HeapMapHilbertCurve.h"
+
+/**
+\class HeapMapRangeIndex
+
+Orders ranges by their first page, so ranges of layers are swept in page order and ranges overlapping a span of pages are found with binary searches.
+*/
+class HeapMapRangeIndex
+{
+private:
+	RangeList _ranges;
+
+	std::vector<unsigned int> _order;
+	std::vector<unsigned long> _first_pages;
+	std::vector<unsigned long> _max_end_pages;
+
+	bool _is_list_order = true;
+
+public:
+	explicit HeapMapRangeIndex(RangeList ranges);
+
+	void find(unsigned long first_page, unsigned long end_page, std::vector<unsigned int>& indexes) const;
+
+	const MemoryRange& get(unsigned int index) const { return (*_ranges)[index]; }
+	unsigned int get_index(size_t position) const { return _order[position]; }
+	size_t size() const { return _order.size(); }
+};
+
+/**
+\class HeapMapSpan
+
+Represents consecutive pages of a heap map drawn in one pixel value.
+*/
+class HeapMapSpan
+{
+public:
+	unsigned long FirstPage;
+	unsigned long EndPage;
+	unsigned int Pixel;
+
+	HeapMapSpan(unsigned long first_page, unsigned long end_page, unsigned int pixel)
+		: FirstPage(first_page), EndPage(end_page), Pixel(pixel)
+	{
+
+	}
+
+	bool operator==(const HeapMapSpan& other) const
+	{
+		return FirstPage == other.FirstPage && EndPage == other.EndPage && Pixel == other.Pixel;
+	}
+};
+
+/**
+\class HeapMapRect
+
+Represents a rectangle of heap map pixels.
+*/
+class HeapMapRect
+{
+public:
+	unsigned int X;
+	unsigned int Y;
+	unsigned int Width;
+	unsigned int Height;
+
+	HeapMapRect(unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+		: X(x), Y(y), Width(width), Height(height)
+	{
+
+	}
+
+	bool operator==(const HeapMapRect& other) const
+	{
+		return X == other.X && Y == other.Y && Width == other.Width && Height == other.Height;
+	}
+};
+
+/**
+\class HeapMapLayer
+
+Represents indexed ranges drawn over a heap map, optionally in one color.
+*/
+class HeapMapLayer
+{
+public:
+	std::shared_ptr<const HeapMapRangeIndex> Index;
+	bool IsMonochrome;
+
+	HeapMapLayer(std::shared_ptr<const HeapMapRangeIndex> index, bool is_monochrome)
+		: Index(index), IsMonochrome(is_monochrome)
+	{
+
+	}
+};
+
+/**
+\class HeapMapRasterizer
+
+Renders memory ranges to a heap map with one pixel per page, pages are laid out top to bottom in columns, left to right, or along a Hilbert curve if one is set.
+Pages are kept in page order, so a range is one run of pixels filled with 32-bit stores, and the map is transposed once to rows of 32-bit pixels.
+Pixels are 32-bit 0x80RRGGBB values, so the window, PNG and PPM images show the colors of get_color as SVG images do.
+Ranges of hidden usages are not drawn, so the ranges below them show as they do in HeapMapCompositor. Saved images are drawn once, without the masks kept for the window.
+Layers can be reduced to spans of pages with their final pixels, comparing spans of two renders gives the rectangles to render again.
+*/
+class HeapMapRasterizer
+{
+public:
+	static const unsigned long PAGE_SIZE = 4096;
+	static const unsigned int BACKGROUND = 0x80808080;
+
+private:
+	static const unsigned int TRANSPOSE_BLOCK = 32;
+
+	unsigned int _width;
+	unsigned int _height;
+	unsigned int _hidden_usages = 0;
+
+	std::vector<unsigned int> _pages;
+	std::vector<HeapMapLayer> _layers;
+	std::shared_ptr<const HeapMapHilbertCurve> _curve;
+
+	void draw(const MemoryRange& range, bool is_monochrome, unsigned long first_page, unsigned long end_page);
+
+public:
+	HeapMapRasterizer(unsigned int width, unsigned int height);
+
+	void clear();
+	void fill(unsigned long first_page, unsigned long page_count, unsigned int pixel);
+	void draw(RangeList ranges, bool is_monochrome = false);
+	void copy_to(unsigned char* buffer) const;
+	void copy_to(unsigned char* buffer, unsigned int first_column, unsigned int end_column) const;
+
+	void set_curve(std::shared_ptr<const HeapMapHilbertCurve> curve) { _curve = curve; }
+	void set_visible(Usage usage, bool is_visible);
+	bool is_visible(Usage usage) const;
+
+	void add_layer(std::shared_ptr<const HeapMapRangeIndex> index, bool is_monochrome = false);
+	void add_layer(RangeList ranges, bool is_monochrome = false);
+	void clear_layers() { _layers.clear(); }
+	void get_spans(std::vector<HeapMapSpan>& spans) const;
+	void get_changed_rects(const std::vector<HeapMapSpan>& old_spans, const std::vector<HeapMapSpan>& new_spans, std::vector<HeapMapRect>& rects) const;
+
+	unsigned int get_width() const { return _width; }
+	unsigned int get_height() const { return _height; }
+	unsigned long get_page_count() const { return static_cast<unsigned long>(_pages.size()); }
+
+	static void copy_columns(const unsigned int* pages, unsigned int width, unsigned int height, unsigned char* buffer, unsigned int first_column, unsigned int end_column);
+	static unsigned long get_page_count(const MemoryRange& range);
+	static unsigned int get_color(State state, Usage usage);
+	static unsigned int to_pixel(unsigned int color);
+};
+
+#endif // #ifndef __HEAPMAPRASTERIZER_H__
\ No newline at end of file
@@ -0,0 +1,94 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file HeapMapSvgExporter.h
+
+Defines the HeapMapSvgExporter class that saves heap maps as SVG images of merged ranges.
+*/
+
+#ifndef __HEAPMAPSVGEXPORTER_H__
+
+#define __HEAPMAPSVGEXPORTER_H__
+
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "MemoryRange.h"
+
+/**
+\class HeapMapSvgExporter
+
+Saves heap maps as SVG images, pages are laid out top to bottom in columns, left to right, like HeapMapRasterizer lays them out.
+Contiguous ranges of a layer with the same state and usage are merged to a run, each run is written as at most three rectangles with a tooltip of its addresses,
+so images grow with the number of ranges, not with the number of pages. Layers are written in the order they are added, later layers over earlier layers.
+Elements are formatted to a buffer that is written to the stream in blocks of BUFFER_SIZE bytes.
+*/
+class HeapMapSvgExporter
+{
+public:
+	static const size_t BUFFER_SIZE = 64 * 1024;
+
+private:
+	/**
+	Represents contiguous ranges of a layer with the same state and usage.
+	*/
+	struct Run
+	{
+		unsigned long FirstPage;
+		unsigned long EndPage;
+		unsigned long long Address;
+		unsigned long long EndAddress;
+		State State;
+		Usage Usage;
+	};
+
+	unsigned int _width;
+	unsigned int _height;
+
+	std::vector<std::pair<RangeList, bool>> _layers;
+
+	void get_runs(RangeList ranges, bool is_monochrome, std::vector<Run>& runs) const;
+	void write_run(std::string& buffer, const Run& run, bool is_monochrome) const;
+
+public:
+	HeapMapSvgExporter(unsigned int width, unsigned int height);
+
+	void add_layer(RangeList ranges, bool is_monochrome = false);
+	void clear_layers() { _layers.clear(); }
+
+	bool write(std::ostream& stream, unsigned int display_width = 0, unsigned int display_height = 0) const;
+	bool save(const std::string& path, unsigned int display_width = 0, unsigned int display_height = 0) const;
+
+	unsigned int get_width() const { return _width; }
+	unsigned int get_height() const { return _height; }
+
+	static const char* get_state_name(State state);
+	static const char* get_usage_name(Usage usage);
+};
+
+#endif // #ifndef __HEAPMAPSVGEXPORTER_H__
\ No newline at end of file
@@ -0,0 +1,106 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file HeapScan.h
+
+Defines the HeapScanQuery and HeapScan classes.
+*/
+
+#ifndef __HEAPSCAN_H__
+
+#define __HEAPSCAN_H__
+
+#include <string>
+#include <vector>
+
+#include "MemoryRange.h"
+#include "ILogger.h"
+#include "IMemoryReader.h"
+#include "MethodTableCache.h"
+#include "CompressedAddressSet.h"
+#include "ParallelGCHeapWalker.h"
+
+/**
+\class HeapScanQuery
+
+Represents a type registered with a HeapScan and a compressed set of addresses of its objects.
+*/
+class HeapScanQuery
+{
+public:
+	std::string TypeName;
+	std::vector<unsigned long> MethodTables;
+	CompressedAddressSet Addresses;
+	bool IsAnswered = false;
+
+	HeapScanQuery(const std::string& type_name, const std::vector<unsigned long>& method_tables)
+		: TypeName(type_name), MethodTables(method_tables)
+	{
+
+	}
+};
+
+/**
+\class HeapScan
+
+Finds objects of many types with one heap walk. Queries are kept for a debugging session, a walk answers all queries registered so far,
+and answers are reused until the heap segments change or they are invalidated.
+*/
+class HeapScan
+{
+private:
+	MethodTableCache* _method_table_cache = nullptr;
+	ILogger* _logger = nullptr;
+
+	std::vector<HeapScanQuery> _queries;
+	RangeList _segments;
+
+	unsigned long _walks = 0;
+
+	HeapScan(const HeapScan&);
+	HeapScan& operator=(const HeapScan&);
+
+public:
+	HeapScan()
+	{
+
+	}
+
+	void attach(MethodTableCache* method_table_cache, ILogger* logger) { _method_table_cache = method_table_cache; _logger = logger; }
+	void clear();
+	void invalidate();
+
+	size_t add_query(const std::string& clr_exact_type_name);
+	size_t add_query(const std::string& type_name, const std::vector<unsigned long>& method_tables);
+
+	bool run(RangeList segments, IMemoryReader* memory_reader, GCHeapBoundaryIndex* boundary_index);
+
+	const HeapScanQuery& get_query(size_t query) const { return _queries[query]; }
+	size_t size() const { return _queries.size(); }
+	unsigned long get_walks() const { return _walks; }
+};
+
+#endif // #ifndef __HEAPSCAN_H__
\ No newline at end of file
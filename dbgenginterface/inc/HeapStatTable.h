@@ -0,0 +1,88 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file HeapStatTable.h
+
+Defines the HeapStatSlot and HeapStatTable classes.
+*/
+
+#ifndef __HEAPSTATTABLE_H__
+
+#define __HEAPSTATTABLE_H__
+
+#include <vector>
+
+/**
+\class HeapStatSlot
+
+Represents a slot of HeapStatTable, the object count and total size of a key.
+*/
+class HeapStatSlot
+{
+public:
+	unsigned long long Key;
+	unsigned long long Count;
+	unsigned long long Bytes;
+
+	HeapStatSlot(unsigned long long key)
+		: Key(key), Count(0), Bytes(0)
+	{
+
+	}
+};
+
+/**
+\class HeapStatTable
+
+Implements an open-addressing hash table with linear probing that counts objects and bytes per key.
+A table is not thread-safe, each worker fills its own and tables are merged after the walk.
+*/
+class HeapStatTable
+{
+public:
+	static const unsigned long long EMPTY_KEY = ~0ULL;
+	static const size_t INITIAL_CAPACITY = 64;
+
+private:
+	std::vector<HeapStatSlot> _slots;
+	size_t _size = 0;
+	size_t _mask;
+
+	size_t find_slot(unsigned long long key) const;
+	void grow();
+
+public:
+	HeapStatTable(size_t capacity = INITIAL_CAPACITY);
+
+	void add(unsigned long long key, unsigned long long count, unsigned long long bytes);
+	void merge(const HeapStatTable& other);
+	const HeapStatSlot* find(unsigned long long key) const;
+
+	const std::vector<HeapStatSlot>& get_slots() const { return _slots; }
+	size_t size() const { return _size; }
+};
+
+#endif // #ifndef __HEAPSTATTABLE_H__
\ No newline at end of file
@@ -0,0 +1,157 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file HeapStatistics.h
+
+Defines the HeapStatEntry, HeapStatQuery, HeapStatRow, HeapStatResult and HeapStatistics classes.
+*/
+
+#ifndef __HEAPSTATISTICS_H__
+
+#define __HEAPSTATISTICS_H__
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "MemoryRange.h"
+#include "EEHeapCommandOutput.h"
+#include "MethodTableCache.h"
+#include "ParallelGCHeapWalker.h"
+
+/**
+\class HeapStatEntry
+
+Represents the object count and total size of a MethodTable in a generation of a segment.
+*/
+class HeapStatEntry
+{
+public:
+	unsigned long MethodTable;
+	unsigned long Segment;
+	unsigned long Generation;
+	unsigned long long Count;
+	unsigned long long Bytes;
+
+	HeapStatEntry(unsigned long method_table, unsigned long segment, unsigned long generation, unsigned long long count, unsigned long long bytes)
+		: MethodTable(method_table), Segment(segment), Generation(generation), Count(count), Bytes(bytes)
+	{
+
+	}
+};
+
+enum class HeapStatSort
+{
+	Count,
+	Bytes
+};
+
+/**
+\class HeapStatQuery
+
+Represents filters, order and row limit of a heap statistics query.
+*/
+class HeapStatQuery
+{
+public:
+	static const int ALL_GENERATIONS = -1;
+
+	std::string TypePrefix;
+	int Generation = ALL_GENERATIONS;
+	unsigned long Segment = 0;
+	HeapStatSort Sort = HeapStatSort::Bytes;
+	size_t Top = 0;
+};
+
+/**
+\class HeapStatRow
+
+Represents the object count and total size of a MethodTable selected by a query.
+*/
+class HeapStatRow
+{
+public:
+	unsigned long MethodTable;
+	std::string Name;
+	unsigned long long Count;
+	unsigned long long Bytes;
+
+	HeapStatRow(unsigned long method_table, unsigned long long count, unsigned long long bytes)
+		: MethodTable(method_table), Count(count), Bytes(bytes)
+	{
+
+	}
+};
+
+/**
+\class HeapStatResult
+
+Represents rows of a query and totals of all MethodTables that passed its filters.
+*/
+class HeapStatResult
+{
+public:
+	std::vector<HeapStatRow> Rows;
+	unsigned long long Count = 0;
+	unsigned long long Bytes = 0;
+	size_t Types = 0;
+};
+
+/**
+\class HeapStatistics
+
+Aggregates object counts and sizes per MethodTable, segment and generation with one heap walk, so that queries with different filters do not walk the heap again.
+*/
+class HeapStatistics
+{
+public:
+	static const unsigned long LARGE_OBJECT_GENERATION = 3;
+
+private:
+	RangeList _segments;
+	GenerationStartList _generation_starts;
+
+	std::vector<std::pair<unsigned long, unsigned long>> _ephemeral_starts;
+	std::vector<HeapStatEntry> _entries;
+
+	bool _is_complete = false;
+
+	const MemoryRange* find_segment(unsigned long address) const;
+
+public:
+	HeapStatistics(RangeList segments, const GenerationStartList& generation_starts);
+
+	unsigned long get_generation(size_t segment, unsigned long address) const;
+	bool collect(ParallelGCHeapWalker& walker);
+	bool matches(RangeList segments, const GenerationStartList& generation_starts) const;
+
+	HeapStatResult query(const HeapStatQuery& query, MethodTableCache* method_table_cache) const;
+
+	const std::vector<HeapStatEntry>& get_entries() const { return _entries; }
+	bool is_complete() const { return _is_complete; }
+};
+
+#endif // #ifndef __HEAPSTATISTICS_H__
\ No newline at end of file
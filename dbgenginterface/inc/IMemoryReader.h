@@ -34,22 +34,48 @@ Defines the IMemoryReader class.
 #define __IMEMORYREADER_H__
 
 #include <string>
+#include <vector>
+
+/**
+\class MemoryReadRequest
+
+Represents one destination of a vectored memory read.
+*/
+class MemoryReadRequest
+{
+public:
+	unsigned long address;
+	unsigned long size;
+	void* buffer;
+	bool succeeded = false;
+
+	MemoryReadRequest(unsigned long address, unsigned long size, void* buffer)
+		: address(address), size(size), buffer(buffer)
+	{
+
+	}
+};
 
 /**
 \class IMemoryReader
 
-Represents a command executor.
+Represents a memory reader.
 */
 
 class IMemoryReader
 {
 public:
+	static const unsigned long READ_PAGE_SIZE = 4096;
+	static const unsigned long MAX_COALESCED_READ_SIZE = 256 * READ_PAGE_SIZE;
 
 #pragma push_macro("ReadMemory")
 #undef ReadMemory
 	virtual unsigned long ReadMemory(unsigned long offset, void *lpBuffer, unsigned long cb, unsigned long* lpcbBytesRead) = 0;
 #pragma pop_macro("ReadMemory")
 
+	virtual unsigned long ReadMany(std::vector<MemoryReadRequest>& requests);
+
+	virtual bool IsThreadSafe() { return false; }
 };
 
 #endif // #ifndef __IMEMORYREADER_H__
\ No newline at end of file
@@ -0,0 +1,122 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file ImageBufferPool.h
+
+Defines the ImageBuffer and ImageBufferPool classes.
+*/
+
+#ifndef __IMAGEBUFFERPOOL_H__
+
+#define __IMAGEBUFFERPOOL_H__
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+\class ImageBufferPoolState
+
+Represents buffers returned to a pool, shared by the pool and its buffers so buffers can outlive the pool.
+*/
+class ImageBufferPoolState
+{
+public:
+	std::mutex Mutex;
+	std::vector<std::vector<unsigned int>> Buffers;
+	size_t MaxBuffers;
+
+	explicit ImageBufferPoolState(size_t max_buffers)
+		: MaxBuffers(max_buffers)
+	{
+
+	}
+};
+
+/**
+\class ImageBuffer
+
+Owns pixels of an image taken from an ImageBufferPool, and returns them to the pool when destroyed.
+Buffers can be moved but not copied.
+*/
+class ImageBuffer
+{
+private:
+	std::weak_ptr<ImageBufferPoolState> _pool;
+	std::vector<unsigned int> _pixels;
+	unsigned int _width = 0;
+	unsigned int _height = 0;
+
+	ImageBuffer(const ImageBuffer&);
+	ImageBuffer& operator=(const ImageBuffer&);
+
+	friend class ImageBufferPool;
+
+public:
+	ImageBuffer()
+	{
+
+	}
+
+	ImageBuffer(ImageBuffer&& other);
+	ImageBuffer& operator=(ImageBuffer&& other);
+	~ImageBuffer();
+
+	void reset();
+
+	unsigned char* data() { return reinterpret_cast<unsigned char*>(_pixels.data()); }
+	const unsigned char* data() const { return reinterpret_cast<const unsigned char*>(_pixels.data()); }
+	unsigned int get_width() const { return _width; }
+	unsigned int get_height() const { return _height; }
+	bool empty() const { return _pixels.empty(); }
+};
+
+/**
+\class ImageBufferPool
+
+Keeps pixel buffers of released images to reuse them for images of the same or smaller size, so repeated renders do not allocate.
+Buffers can be acquired and released on multiple threads.
+*/
+class ImageBufferPool
+{
+public:
+	static const size_t MAX_BUFFERS = 4;
+
+private:
+	std::shared_ptr<ImageBufferPoolState> _state;
+
+	ImageBufferPool(const ImageBufferPool&);
+	ImageBufferPool& operator=(const ImageBufferPool&);
+
+public:
+	explicit ImageBufferPool(size_t max_buffers = MAX_BUFFERS);
+
+	ImageBuffer acquire(unsigned int width, unsigned int height);
+
+	size_t size();
+};
+
+#endif // #ifndef __IMAGEBUFFERPOOL_H__
\ No newline at end of file
@@ -0,0 +1,136 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file ManagedObjectLayout.h
+
+Defines compile-time field descriptors and object layouts of CLR types per runtime version of 32-bit processes.
+*/
+
+#ifndef __MANAGEDOBJECTLAYOUT_H__
+
+#define __MANAGEDOBJECTLAYOUT_H__
+
+/**
+\class ManagedField
+
+Describes a field by its type and offset from the object address.
+*/
+template <typename T, unsigned long Offset>
+class ManagedField
+{
+public:
+	typedef T Type;
+
+	static const unsigned long OFFSET = Offset;
+	static const unsigned long SIZE = sizeof(T);
+};
+
+template <typename T, unsigned long Offset>
+const unsigned long ManagedField<T, Offset>::OFFSET;
+
+template <typename T, unsigned long Offset>
+const unsigned long ManagedField<T, Offset>::SIZE;
+
+enum class ClrVersion
+{
+	Unknown,
+	Clr2,
+	Clr4
+};
+
+/**
+\class Clr2X86
+
+Tags layouts of CLR 2.0 (.NET 2.0 to 3.5) 32-bit processes.
+*/
+class Clr2X86
+{
+public:
+	typedef unsigned int Pointer;
+};
+
+/**
+\class Clr4X86
+
+Tags layouts of CLR 4 (.NET 4.0 to 4.8) 32-bit processes.
+*/
+class Clr4X86
+{
+public:
+	typedef unsigned int Pointer;
+};
+
+/**
+\class ThreadLayout
+
+Describes System.Threading.Thread, reference fields come first, then m_DONT_USE_InternalThread, m_Priority and m_ManagedThreadId.
+CLR 2.0 keeps two more references, m_ThreadStaticsBuckets and m_ThreadStaticsBits, before the culture fields.
+*/
+template <typename Runtime>
+class ThreadLayout;
+
+template <>
+class ThreadLayout<Clr2X86>
+{
+public:
+	typedef ManagedField<Clr2X86::Pointer, 0x0c> Name;
+	typedef ManagedField<int, 0x30> ManagedThreadId;
+};
+
+template <>
+class ThreadLayout<Clr4X86>
+{
+public:
+	typedef ManagedField<Clr4X86::Pointer, 0x0c> Name;
+	typedef ManagedField<int, 0x28> ManagedThreadId;
+};
+
+/**
+\class SafeHandleLayout
+
+Describes System.Runtime.InteropServices.SafeHandle, the handle is its first field.
+*/
+template <typename Runtime>
+class SafeHandleLayout
+{
+public:
+	typedef ManagedField<typename Runtime::Pointer, sizeof(typename Runtime::Pointer)> Handle;
+};
+
+/**
+\class StringLayout
+
+Describes System.String, the length is followed by UTF-16 characters.
+*/
+template <typename Runtime>
+class StringLayout
+{
+public:
+	typedef ManagedField<unsigned int, sizeof(typename Runtime::Pointer)> Length;
+	typedef ManagedField<unsigned short, sizeof(typename Runtime::Pointer) + 4> FirstChar;
+};
+
+#endif // #ifndef __MANAGEDOBJECTLAYOUT_H__
\ No newline at end of file
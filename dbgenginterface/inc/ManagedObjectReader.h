@@ -0,0 +1,168 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file ManagedObjectReader.h
+
+Defines the ManagedThreadFields, IManagedObjectReader and ManagedObjectReader classes.
+*/
+
+#ifndef __MANAGEDOBJECTREADER_H__
+
+#define __MANAGEDOBJECTREADER_H__
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "IMemoryReader.h"
+#include "ManagedObjectLayout.h"
+
+/**
+\class ManagedThreadFields
+
+Represents fields of a System.Threading.Thread object.
+*/
+class ManagedThreadFields
+{
+public:
+	unsigned long long Name = 0;
+	int ManagedThreadId = 0;
+	bool IsRead = false;
+};
+
+/**
+\class IManagedObjectReader
+
+Represents a reader of managed object fields for one runtime version of 32-bit processes. Fields of all objects are read with one vectored read.
+*/
+class IManagedObjectReader
+{
+public:
+	virtual ~IManagedObjectReader()
+	{
+
+	}
+
+	virtual void read_threads(IMemoryReader* memory_reader, const std::vector<unsigned long>& addresses, std::vector<ManagedThreadFields>& threads) const = 0;
+	virtual void read_safe_handles(IMemoryReader* memory_reader, const std::vector<unsigned long>& addresses, std::vector<unsigned long long>& handles, std::vector<char>& is_read) const = 0;
+
+	virtual ClrVersion get_version() const = 0;
+
+	static std::unique_ptr<IManagedObjectReader> create(ClrVersion version);
+	static ClrVersion find_version(const std::string& runtime_module_name);
+};
+
+/**
+\class ManagedObjectReader
+
+Implements IManagedObjectReader with offsets and sizes of the layouts of a runtime known at compile time.
+*/
+template <typename Runtime>
+class ManagedObjectReader : public IManagedObjectReader
+{
+private:
+	ClrVersion _version;
+
+public:
+	ManagedObjectReader(ClrVersion version)
+		: _version(version)
+	{
+
+	}
+
+	/**
+	Reads name and managed thread id fields of Thread objects.
+
+	\param memory_reader Memory reader.
+	\param addresses Thread object addresses.
+	\param threads Fields in the order of addresses.
+	*/
+	virtual void read_threads(IMemoryReader* memory_reader, const std::vector<unsigned long>& addresses, std::vector<ManagedThreadFields>& threads) const override
+	{
+		typedef typename ThreadLayout<Runtime>::Name Name;
+		typedef typename ThreadLayout<Runtime>::ManagedThreadId ManagedThreadId;
+
+		std::vector<typename Name::Type> names(addresses.size());
+		std::vector<typename ManagedThreadId::Type> ids(addresses.size());
+		std::vector<MemoryReadRequest> requests;
+
+		requests.reserve(2 * addresses.size());
+
+		for (size_t i = 0; i < addresses.size(); i++)
+		{
+			requests.push_back(MemoryReadRequest(addresses[i] + Name::OFFSET, Name::SIZE, &names[i]));
+			requests.push_back(MemoryReadRequest(addresses[i] + ManagedThreadId::OFFSET, ManagedThreadId::SIZE, &ids[i]));
+		}
+
+		memory_reader->ReadMany(requests);
+
+		threads.resize(addresses.size());
+
+		for (size_t i = 0; i < addresses.size(); i++)
+		{
+			threads[i].Name = names[i];
+			threads[i].ManagedThreadId = ids[i];
+			threads[i].IsRead = requests[2 * i].succeeded && requests[2 * i + 1].succeeded;
+		}
+	}
+
+	/**
+	Reads handle fields of SafeHandle objects.
+
+	\param memory_reader Memory reader.
+	\param addresses SafeHandle object addresses.
+	\param handles Handle values in the order of addresses.
+	\param is_read Non-zero for handles that are read.
+	*/
+	virtual void read_safe_handles(IMemoryReader* memory_reader, const std::vector<unsigned long>& addresses, std::vector<unsigned long long>& handles, std::vector<char>& is_read) const override
+	{
+		typedef typename SafeHandleLayout<Runtime>::Handle Handle;
+
+		std::vector<typename Handle::Type> values(addresses.size());
+		std::vector<MemoryReadRequest> requests;
+
+		requests.reserve(addresses.size());
+
+		for (size_t i = 0; i < addresses.size(); i++)
+		{
+			requests.push_back(MemoryReadRequest(addresses[i] + Handle::OFFSET, Handle::SIZE, &values[i]));
+		}
+
+		memory_reader->ReadMany(requests);
+
+		handles.assign(values.begin(), values.end());
+		is_read.resize(addresses.size());
+
+		for (size_t i = 0; i < addresses.size(); i++)
+		{
+			is_read[i] = requests[i].succeeded;
+		}
+	}
+
+	virtual ClrVersion get_version() const override { return _version; }
+};
+
+#endif // #ifndef __MANAGEDOBJECTREADER_H__
\ No newline at end of file
@@ -0,0 +1,104 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file ManagedStringReader.h
+
+Defines the ManagedStringBlock and ManagedStringReader classes.
+*/
+
+#ifndef __MANAGEDSTRINGREADER_H__
+
+#define __MANAGEDSTRINGREADER_H__
+
+#include <vector>
+
+#include "ILogger.h"
+#include "IMemoryReader.h"
+
+/**
+\class ManagedStringBlockOf
+
+Represents strings kept in one block, each string ends with a zero code unit.
+*/
+template <typename Char>
+class ManagedStringBlockOf
+{
+private:
+	std::vector<Char> _data;
+	std::vector<size_t> _offsets;
+	std::vector<size_t> _lengths;
+	std::vector<char> _is_read;
+
+	friend class ManagedStringReader;
+
+public:
+	const Char* get(size_t index) const { return _data.data() + _offsets[index]; }
+	size_t get_length(size_t index) const { return _lengths[index]; }
+	bool is_read(size_t index) const { return _is_read[index] != 0; }
+
+	size_t size() const { return _offsets.size(); }
+	size_t get_data_size() const { return _data.size(); }
+};
+
+/** UTF-8 strings. */
+typedef ManagedStringBlockOf<char> ManagedStringBlock;
+
+/** UTF-16 strings as stored by the CLR, for wide output. */
+typedef ManagedStringBlockOf<unsigned short> ManagedWideStringBlock;
+
+/**
+\class ManagedStringReader
+
+Implements a reader of x86 CLR System.String objects. Lengths and characters of all strings are read with one vectored read each, and converted to UTF-8 or kept as UTF-16 in one block.
+*/
+class ManagedStringReader
+{
+public:
+	static const unsigned long STRING_LENGTH_OFFSET = 4;
+	static const unsigned long STRING_CHARS_OFFSET = 8;
+	static const unsigned long DEFAULT_MAX_LENGTH = 64 * 1024;
+
+private:
+	IMemoryReader* _memory_reader;
+	ILogger* _logger;
+	unsigned long _max_length;
+
+	void read_chars(const std::vector<unsigned long>& addresses, std::vector<unsigned short>& chars, std::vector<size_t>& char_offsets, std::vector<char>& is_read);
+
+public:
+	ManagedStringReader(IMemoryReader* memory_reader, ILogger* logger, unsigned long max_length = DEFAULT_MAX_LENGTH)
+		: _memory_reader(memory_reader), _logger(logger), _max_length(max_length)
+	{
+
+	}
+
+	ManagedStringBlock read(const std::vector<unsigned long>& addresses);
+	ManagedWideStringBlock read_wide(const std::vector<unsigned long>& addresses);
+
+	static size_t Utf16ToUtf8(const unsigned short* source, size_t count, char* destination);
+};
+
+#endif // #ifndef __MANAGEDSTRINGREADER_H__
\ No newline at end of file
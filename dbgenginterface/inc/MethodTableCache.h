@@ -0,0 +1,150 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file MethodTableCache.h
+
+Defines the MethodTableCache class.
+*/
+
+#ifndef __METHODTABLECACHE_H__
+
+#define __METHODTABLECACHE_H__
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "GCDesc.h"
+#include "IDebuggerCommandExecutor.h"
+#include "ILogger.h"
+#include "IMemoryReader.h"
+
+/**
+\class MethodTableField
+
+Represents an instance field of a type and its offset from the object address.
+*/
+class MethodTableField
+{
+public:
+	std::string Name;
+	unsigned long Offset;
+
+	MethodTableField(const std::string& name, unsigned long offset)
+		: Name(name), Offset(offset)
+	{
+
+	}
+};
+
+/**
+\class MethodTableInfo
+
+Represents metadata of a MethodTable. Sizes are read from target memory, name and fields from SOS output.
+*/
+class MethodTableInfo
+{
+public:
+	unsigned long MethodTable = 0;
+	unsigned long BaseSize = 0;
+	unsigned long ComponentSize = 0;
+	unsigned long ParentMethodTable = 0;
+	unsigned long EEClass = 0;
+	std::string Name;
+	std::vector<MethodTableField> Fields;
+	GCDesc GCDescriptor;
+
+	bool IsRead = false;
+	bool ContainsPointers = false;
+	bool IsGCDescRead = false;
+	bool IsNamed = false;
+	bool IsFieldsRead = false;
+
+	bool is_valid() const { return BaseSize >= MIN_BASE_SIZE; }
+
+	static const unsigned long MIN_BASE_SIZE = 12;
+};
+
+/**
+\class MethodTableCache
+
+Caches MethodTable metadata for a debugging session. Entries are filled lazily, or in batches with one vectored read or one debugger command.
+Only get_sizes and get_gc_desc can be called from multiple threads.
+*/
+class MethodTableCache
+{
+public:
+	static const unsigned long HAS_COMPONENT_SIZE_FLAG = 0x80000000;
+	static const unsigned long PARENT_METHOD_TABLE_OFFSET = 0x10;
+	static const unsigned long METHOD_TABLE_READ_SIZE = 0x14;
+	static const unsigned long MAX_PARENT_DEPTH = 64;
+
+private:
+	const std::string _command_dumpmt = "!dumpmt";
+	const std::string _command_dumpclass = "!dumpclass";
+	const std::string _command_name2ee = "!name2ee *!";
+
+	IDebuggerCommandExecutor* _executor = nullptr;
+	IMemoryReader* _memory_reader = nullptr;
+	ILogger* _logger = nullptr;
+
+	std::unordered_map<unsigned long, MethodTableInfo> _method_tables;
+	std::unordered_map<std::string, std::vector<unsigned long>> _type_names;
+
+	std::mutex _mutex;
+
+	void set_sizes(MethodTableInfo& info, const unsigned char* fields);
+	void ParseDumpMT(const std::string& lines);
+	void ParseDumpClass(MethodTableInfo& info, const std::string& lines);
+
+	MethodTableCache(const MethodTableCache&);
+	MethodTableCache& operator=(const MethodTableCache&);
+
+public:
+	MethodTableCache()
+	{
+
+	}
+
+	void attach(IDebuggerCommandExecutor* executor, IMemoryReader* memory_reader, ILogger* logger);
+	void clear();
+
+	void load(const std::vector<unsigned long>& method_tables);
+	void load_names(const std::vector<unsigned long>& method_tables);
+
+	const MethodTableInfo& get(unsigned long method_table);
+	bool get_sizes(unsigned long method_table, unsigned long& base_size, unsigned long& component_size);
+	bool get_gc_desc(unsigned long method_table, GCDesc& gc_desc);
+	const std::string& get_name(unsigned long method_table);
+	bool get_field_offset(unsigned long method_table, const std::string& field_name, unsigned long& offset);
+
+	std::vector<unsigned long> find_method_tables(const std::string& clr_exact_type_name);
+
+	size_t size() const { return _method_tables.size(); }
+};
+
+#endif // #ifndef __METHODTABLECACHE_H__
\ No newline at end of file
@@ -0,0 +1,147 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file MinidumpFile.h
+
+Defines the MinidumpFile class.
+*/
+
+#ifndef __MINIDUMPFILE_H__
+
+#define __MINIDUMPFILE_H__
+
+#include <string>
+#include <cstring>
+#include <vector>
+
+#include "ILogger.h"
+
+/**
+\class MinidumpThread
+
+Represents a MINIDUMP_THREAD entry of the thread list stream.
+*/
+class MinidumpThread
+{
+public:
+	unsigned long ThreadId;
+	unsigned long long Teb;
+	unsigned long long StackStart;
+	unsigned long long StackSize;
+	unsigned long ContextRva;
+	unsigned long ContextSize;
+
+	MinidumpThread(unsigned long thread_id, unsigned long long teb, unsigned long long stack_start, unsigned long long stack_size, unsigned long context_rva, unsigned long context_size)
+		: ThreadId(thread_id), Teb(teb), StackStart(stack_start), StackSize(stack_size), ContextRva(context_rva), ContextSize(context_size)
+	{
+
+	}
+};
+
+/**
+\class MinidumpModule
+
+Represents a MINIDUMP_MODULE entry of the module list stream.
+*/
+class MinidumpModule
+{
+public:
+	unsigned long long BaseOfImage;
+	unsigned long SizeOfImage;
+	std::string Name;
+
+	MinidumpModule(unsigned long long base_of_image, unsigned long size_of_image, const std::string& name)
+		: BaseOfImage(base_of_image), SizeOfImage(size_of_image), Name(name)
+	{
+
+	}
+};
+
+/**
+\class MinidumpFile
+
+Represents a read-only memory mapping of a Windows minidump (.dmp) file and its stream directory.
+*/
+class MinidumpFile
+{
+public:
+	static const unsigned long SIGNATURE = 0x504d444d; // "MDMP"
+
+	static const unsigned long THREAD_LIST_STREAM = 3;
+	static const unsigned long MODULE_LIST_STREAM = 4;
+	static const unsigned long MEMORY_LIST_STREAM = 5;
+	static const unsigned long MEMORY64_LIST_STREAM = 9;
+	static const unsigned long MEMORY_INFO_LIST_STREAM = 16;
+
+private:
+	ILogger* _logger;
+
+	const unsigned char* _data = nullptr;
+	unsigned long long _size = 0;
+
+	bool _is_mapped = false;
+	void* _file_handle = nullptr;
+	void* _mapping_handle = nullptr;
+
+	unsigned long _stream_count = 0;
+	unsigned long _stream_directory_rva = 0;
+
+	bool parse_header();
+	void unmap();
+
+	MinidumpFile(const MinidumpFile&);
+	MinidumpFile& operator=(const MinidumpFile&);
+
+public:
+	MinidumpFile(ILogger* logger)
+		: _logger(logger)
+	{
+
+	}
+
+	~MinidumpFile()
+	{
+		close();
+	}
+
+	bool open(const std::string& filename);
+	bool attach(const void* data, unsigned long long size);
+	void close();
+
+	bool is_open() const { return _data != nullptr; }
+
+	const unsigned char* at(unsigned long long rva, unsigned long long size) const;
+	bool find_stream(unsigned long stream_type, const unsigned char*& stream, unsigned long& stream_size) const;
+
+	std::vector<MinidumpThread> get_threads() const;
+	std::vector<MinidumpModule> get_modules() const;
+
+	static unsigned short read_u16(const unsigned char* p) { unsigned short v; memcpy(&v, p, sizeof(v)); return v; }
+	static unsigned long read_u32(const unsigned char* p) { unsigned int v; memcpy(&v, p, sizeof(v)); return v; }
+	static unsigned long long read_u64(const unsigned char* p) { unsigned long long v; memcpy(&v, p, sizeof(v)); return v; }
+};
+
+#endif // #ifndef __MINIDUMPFILE_H__
\ No newline at end of file
@@ -0,0 +1,94 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file MinidumpMemoryInfoParser.h
+
+Defines the MinidumpMemoryInfoParser class.
+*/
+
+#ifndef __MINIDUMPMEMORYINFOPARSER_H__
+
+#define __MINIDUMPMEMORYINFOPARSER_H__
+
+#include "MemoryRange.h"
+
+#include <unordered_map>
+#include <vector>
+
+#include "ILogger.h"
+#include "IMemoryReader.h"
+#include "MinidumpFile.h"
+#include "AddressCommandOutput.h"
+
+/**
+\class MinidumpMemoryInfoParser
+
+Implements a producer of address ranges from the MemoryInfoListStream of a minidump, an alternative to parsing !address output.
+*/
+class MinidumpMemoryInfoParser
+{
+private:
+	static const unsigned long MEM_COMMIT_STATE = 0x1000;
+	static const unsigned long MEM_RESERVE_STATE = 0x2000;
+	static const unsigned long MEM_FREE_STATE = 0x10000;
+	static const unsigned long MEM_PRIVATE_TYPE = 0x20000;
+	static const unsigned long MEM_MAPPED_TYPE = 0x40000;
+	static const unsigned long MEM_IMAGE_TYPE = 0x1000000;
+	static const unsigned long PAGE_GUARD_PROTECT = 0x100;
+	static const unsigned long MAX_HEAP_COUNT = 1024;
+
+	struct MemoryInfo
+	{
+		unsigned long long BaseAddress;
+		unsigned long long AllocationBase;
+		unsigned long long RegionSize;
+		unsigned long State;
+		unsigned long Protect;
+		unsigned long Type;
+	};
+
+	const MinidumpFile& _dump;
+	IMemoryReader* _reader;
+	ILogger* _logger;
+
+	std::vector<MemoryInfo> Parse(const unsigned char* stream, unsigned long stream_size);
+	void FindSystemRegions(const std::vector<MemoryInfo>& infos, std::unordered_map<unsigned long long, ::Usage>& allocation_usages, std::unordered_map<unsigned long long, ::Usage>& region_usages);
+
+	static const MemoryInfo* FindRegion(const std::vector<MemoryInfo>& infos, unsigned long long address);
+	static ::State GetState(const MemoryInfo& info);
+	static ::Usage GetUsage(const MemoryInfo& info);
+
+public:
+	MinidumpMemoryInfoParser(const MinidumpFile& dump, IMemoryReader* reader, ILogger* logger)
+		: _dump(dump), _reader(reader), _logger(logger)
+	{
+
+	}
+
+	AddressCommandOutput execute();
+};
+
+#endif // #ifndef __MINIDUMPMEMORYINFOPARSER_H__
\ No newline at end of file
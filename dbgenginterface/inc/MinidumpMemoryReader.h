@@ -0,0 +1,95 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file MinidumpMemoryReader.h
+
+Defines the MinidumpMemoryReader class.
+*/
+
+#ifndef __MINIDUMPMEMORYREADER_H__
+
+#define __MINIDUMPMEMORYREADER_H__
+
+#include <vector>
+
+#include "IMemoryReader.h"
+#include "MinidumpFile.h"
+
+/**
+\class MinidumpMemoryRegion
+
+Represents a range of target memory stored in a minidump file.
+*/
+class MinidumpMemoryRegion
+{
+public:
+	unsigned long long Address;
+	unsigned long long Size;
+	unsigned long long FileOffset;
+
+	MinidumpMemoryRegion(unsigned long long address, unsigned long long size, unsigned long long file_offset)
+		: Address(address), Size(size), FileOffset(file_offset)
+	{
+
+	}
+};
+
+/**
+\class MinidumpMemoryReader
+
+Reads target memory directly from a memory-mapped minidump file.
+*/
+class MinidumpMemoryReader : public IMemoryReader
+{
+private:
+	const MinidumpFile& _dump;
+
+	std::vector<MinidumpMemoryRegion> _regions;
+
+	void add_memory_list(const unsigned char* stream, unsigned long stream_size);
+	void add_memory64_list(const unsigned char* stream, unsigned long stream_size);
+	std::vector<MinidumpMemoryRegion>::const_iterator find_region(unsigned long long address) const;
+
+public:
+	MinidumpMemoryReader(const MinidumpFile& dump);
+
+#pragma push_macro("ReadMemory")
+#undef ReadMemory
+	virtual unsigned long ReadMemory(unsigned long offset, void *lpBuffer, unsigned long cb, unsigned long* lpcbBytesRead) override;
+#pragma pop_macro("ReadMemory")
+
+	virtual unsigned long ReadMany(std::vector<MemoryReadRequest>& requests) override;
+
+	virtual bool IsThreadSafe() override { return true; }
+
+	const void* get_pointer(unsigned long address, unsigned long size) const;
+
+	const std::vector<MinidumpMemoryRegion>& get_regions() const { return _regions; }
+
+	bool has_memory() const { return !_regions.empty(); }
+};
+
+#endif // #ifndef __MINIDUMPMEMORYREADER_H__
\ No newline at end of file
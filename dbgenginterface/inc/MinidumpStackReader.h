@@ -0,0 +1,80 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file MinidumpStackReader.h
+
+Defines the MinidumpStackReader class.
+*/
+
+#ifndef __MINIDUMPSTACKREADER_H__
+
+#define __MINIDUMPSTACKREADER_H__
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <unordered_map>
+
+#include "ILogger.h"
+#include "IMemoryReader.h"
+#include "MinidumpFile.h"
+#include "PartialStackFrame.h"
+
+/**
+\class MinidumpStackReader
+
+Implements a producer of top stack frames of x86 threads from the thread list, thread contexts and module export tables of a minidump.
+*/
+class MinidumpStackReader
+{
+private:
+	static const unsigned long CONTEXT_EBP_OFFSET = 0xb4;
+	static const unsigned long CONTEXT_EIP_OFFSET = 0xb8;
+	static const unsigned long CONTEXT_ESP_OFFSET = 0xc4;
+	static const unsigned long MIN_CONTEXT_SIZE = 0xcc;
+	static const unsigned long MAX_EXPORT_COUNT = 0x10000;
+
+	typedef std::vector<std::pair<unsigned long, std::string>> ExportList;
+
+	const MinidumpFile& _dump;
+	IMemoryReader* _memory_reader;
+	ILogger* _logger;
+
+	std::vector<MinidumpModule> _modules;
+	std::unordered_map<unsigned long long, ExportList> _exports;
+
+	const MinidumpModule* find_module(unsigned long address) const;
+	const ExportList& get_exports(const MinidumpModule& module);
+	bool read_exports(const MinidumpModule& module, ExportList& exports);
+	bool resolve_symbol(unsigned long address, std::string& symbol_name, unsigned long& symbol_offset);
+
+public:
+	MinidumpStackReader(const MinidumpFile& dump, IMemoryReader* memory_reader, ILogger* logger);
+
+	std::vector<PartialStackFrame> get_top_frames();
+};
+
+#endif // #ifndef __MINIDUMPSTACKREADER_H__
\ No newline at end of file
@@ -0,0 +1,76 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file ParallelFor.h
+
+Defines the parallel_for function that spreads indexes over threads.
+*/
+
+#ifndef __PARALLELFOR_H__
+
+#define __PARALLELFOR_H__
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/**
+Runs a function for each index on a number of threads, indexes are taken in order from a shared counter.
+
+\param thread_count Number of threads, including the calling thread.
+\param count Number of indexes.
+\param function Invoked with each index once.
+*/
+template <typename Function>
+void parallel_for(unsigned int thread_count, size_t count, Function function)
+{
+	std::atomic<size_t> next(0);
+
+	auto work = [&]()
+	{
+		for (auto i = next++; i < count; i = next++)
+		{
+			function(i);
+		}
+	};
+
+	std::vector<std::thread> threads;
+
+	for (unsigned int i = 1; i < thread_count && i < count; i++)
+	{
+		threads.push_back(std::thread(work));
+	}
+
+	work();
+
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+}
+
+#endif // #ifndef __PARALLELFOR_H__
\ No newline at end of file
@@ -0,0 +1,110 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file ParallelGCHeapWalker.h
+
+Defines the GCHeapBoundaryIndex and ParallelGCHeapWalker classes.
+*/
+
+#ifndef __PARALLELGCHEAPWALKER_H__
+
+#define __PARALLELGCHEAPWALKER_H__
+
+#include <functional>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "MemoryRange.h"
+#include "ILogger.h"
+#include "IMemoryReader.h"
+#include "MethodTableCache.h"
+#include "GCHeapWalker.h"
+
+/**
+\class GCHeapBoundaryIndex
+
+Keeps object addresses found at regular intervals of segments by previous walks, so that later walks can split segments there.
+*/
+class GCHeapBoundaryIndex
+{
+private:
+	std::map<unsigned long, std::pair<unsigned long, std::vector<unsigned long>>> _segments;
+
+public:
+	void add(const MemoryRange& segment, const std::vector<unsigned long>& boundaries);
+	const std::vector<unsigned long>* find(const MemoryRange& segment) const;
+	void clear() { _segments.clear(); }
+
+	size_t size() const { return _segments.size(); }
+};
+
+typedef std::function<bool(size_t, const GCHeapObject&)> GCHeapWorkItemCallback;
+typedef std::function<bool(size_t, const GCHeapObject&, const unsigned char*)> GCHeapWorkItemContentCallback;
+
+/**
+\class ParallelGCHeapWalker
+
+Implements a walker that splits GC heap segments into work items and walks them on multiple threads with work-stealing.
+Work items are in address order, so results kept per work item can be merged deterministically.
+*/
+class ParallelGCHeapWalker
+{
+public:
+	static const unsigned long SPLIT_SIZE = 16 * 1024 * 1024;
+
+private:
+	RangeList _segments;
+	IMemoryReader* _memory_reader;
+	MethodTableCache* _method_table_cache;
+	GCHeapBoundaryIndex* _boundary_index;
+	ILogger* _logger;
+	unsigned int _thread_count;
+	unsigned long _split_size;
+
+	std::vector<MemoryRange> _work_items;
+	std::vector<size_t> _work_item_segments;
+
+	unsigned long _objects = 0;
+
+	void plan();
+	bool walk_items(const std::function<bool(size_t, const GCHeapObject&, GCHeapWalker&)>& callback);
+
+public:
+	ParallelGCHeapWalker(RangeList segments, IMemoryReader* memory_reader, MethodTableCache* method_table_cache, GCHeapBoundaryIndex* boundary_index, ILogger* logger, unsigned int thread_count = 0, unsigned long split_size = SPLIT_SIZE);
+
+	bool walk(const GCHeapWorkItemCallback& callback);
+	bool walk_contents(const GCHeapWorkItemContentCallback& callback);
+
+	const std::vector<MemoryRange>& get_work_items() const { return _work_items; }
+	const std::vector<size_t>& get_work_item_segments() const { return _work_item_segments; }
+	unsigned int get_thread_count() const { return _thread_count; }
+	unsigned long get_objects() const { return _objects; }
+
+	static bool is_same_heap(RangeList a, RangeList b);
+};
+
+#endif // #ifndef __PARALLELGCHEAPWALKER_H__
\ No newline at end of file
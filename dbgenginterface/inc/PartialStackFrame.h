@@ -0,0 +1,62 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file PartialStackFrame.h
+
+Defines the PartialStackFrame class.
+*/
+
+#ifndef __PARTIALSTACKFRAME_H__
+
+#define __PARTIALSTACKFRAME_H__
+
+#include <string>
+
+/**
+\class PartialStackFrame
+
+Represents an ChildEBP, return address and first three arguments of a stack frame.
+*/
+class PartialStackFrame
+{
+	// 13 12f2e5b8 7071b7ad 12f2e5f8 8e188ec4 12f2e804 clr!MethodDescCallSite::CallTargetWorker+0x152 (FPO: [Non-Fpo])
+
+public:
+	bool _is_valid = true;
+
+	unsigned long thread_id = 0;
+	unsigned long child_ebp;
+	unsigned long ret_address;
+	unsigned long arg1;
+	unsigned long arg2;
+	unsigned long arg3;
+	std::string symbol_name;
+	unsigned long symbol_offset;
+
+	bool isValid() { return _is_valid; }
+};
+
+#endif // #ifndef __PARTIALSTACKFRAME_H__
\ No newline at end of file
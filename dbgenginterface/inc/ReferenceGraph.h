@@ -0,0 +1,121 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file ReferenceGraph.h
+
+Defines the ReferenceGraph class.
+*/
+
+#ifndef __REFERENCEGRAPH_H__
+
+#define __REFERENCEGRAPH_H__
+
+#include <string>
+#include <vector>
+
+#include "MemoryRange.h"
+#include "MethodTableCache.h"
+#include "ParallelGCHeapWalker.h"
+
+/**
+\class ReferenceNodeRange
+
+Represents a range of node ids in an adjacency array of a ReferenceGraph.
+*/
+class ReferenceNodeRange
+{
+	const unsigned int* _begin;
+	const unsigned int* _end;
+
+public:
+	ReferenceNodeRange(const unsigned int* begin, const unsigned int* end)
+		: _begin(begin), _end(end)
+	{
+
+	}
+
+	const unsigned int* begin() const { return _begin; }
+	const unsigned int* end() const { return _end; }
+	size_t size() const { return _end - _begin; }
+	bool empty() const { return _begin == _end; }
+	unsigned int operator[](size_t i) const { return _begin[i]; }
+};
+
+/**
+\class ReferenceGraph
+
+Represents references between managed objects in compressed sparse row format.
+Nodes are objects in address order, edges are non-null pointer fields found with GC descriptors of their MethodTables.
+Forward and reverse adjacency arrays are kept, so references and referrers of an object are found with one binary search.
+*/
+class ReferenceGraph
+{
+public:
+	static const unsigned int NOT_FOUND = 0xFFFFFFFF;
+	static const unsigned int FILE_VERSION = 1;
+
+private:
+	RangeList _segments;
+
+	std::vector<unsigned int> _addresses;
+	std::vector<unsigned int> _method_tables;
+	std::vector<unsigned int> _sizes;
+
+	std::vector<unsigned int> _reference_offsets;
+	std::vector<unsigned int> _references;
+	std::vector<unsigned int> _referrer_offsets;
+	std::vector<unsigned int> _referrers;
+
+	unsigned int _thread_count = 1;
+	bool _is_complete = false;
+
+	void build_referrers();
+
+public:
+	explicit ReferenceGraph(RangeList segments = RangeList());
+
+	bool build(ParallelGCHeapWalker& walker, MethodTableCache* method_table_cache);
+	bool matches(RangeList segments) const;
+
+	unsigned int find_node(unsigned long address) const;
+
+	ReferenceNodeRange get_references(unsigned int node) const;
+	ReferenceNodeRange get_referrers(unsigned int node) const;
+
+	unsigned long get_address(unsigned int node) const { return _addresses[node]; }
+	unsigned long get_method_table(unsigned int node) const { return _method_tables[node]; }
+	unsigned long get_size(unsigned int node) const { return _sizes[node]; }
+
+	size_t get_node_count() const { return _addresses.size(); }
+	size_t get_edge_count() const { return _references.size(); }
+	size_t memory_size() const;
+	bool is_complete() const { return _is_complete; }
+
+	bool save(const std::string& path) const;
+	bool load(const std::string& path);
+};
+
+#endif // #ifndef __REFERENCEGRAPH_H__
\ No newline at end of file
@@ -42,6 +42,7 @@ Defines the SafeWaitHandleParser class.
 #include "ILogger.h"
 #include "DumpHeapCommandOutput.h"
 #include "SafeWaitHandleOutput.h"
+#include "ManagedObjectReader.h"
 
 /**
 \class SafeWaitHandleParser
@@ -53,12 +54,13 @@ class SafeWaitHandleParser
 private:
 	IMemoryReader* _reader;
 	ILogger* _logger;
+	const IManagedObjectReader* _object_reader;
 
-	std::map<unsigned long, unsigned long>* parse(const std::vector<unsigned long>& object_addresses);
+	std::map<unsigned long, unsigned long>* parse(const CompressedAddressSet& object_addresses);
 
 public:
-	SafeWaitHandleParser(IMemoryReader* reader, ILogger* logger)
-		: _reader(reader)
+	SafeWaitHandleParser(IMemoryReader* reader, ILogger* logger, const IManagedObjectReader* object_reader = nullptr)
+		: _reader(reader), _object_reader(object_reader)
 	{
 		_logger = logger;
 	}
@@ -0,0 +1,72 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file BufferedLogger.cpp
+
+Implements BufferedLogger class that keeps log messages for later output.
+*/
+
+#include <cstdarg>
+#include <cstdio>
+
+#include "BufferedLogger.h"
+
+/**
+Formats and keeps a message.
+
+\param lpFormat printf format string.
+*/
+void BufferedLogger::Log(const char* lpFormat, ...)
+{
+	char buffer[512];
+
+	va_list args;
+
+	va_start(args, lpFormat);
+
+	vsnprintf(buffer, sizeof(buffer), lpFormat, args);
+
+	va_end(args);
+
+	buffer[sizeof(buffer) - 1] = '\0';
+
+	_messages.push_back(buffer);
+}
+
+/**
+Writes kept messages to a logger in the order they were logged.
+
+\param logger Target logger.
+*/
+void BufferedLogger::flush(ILogger* logger)
+{
+	for (auto& message : _messages)
+	{
+		logger->Log("%s", message.c_str());
+	}
+
+	_messages.clear();
+}
\ No newline at end of file
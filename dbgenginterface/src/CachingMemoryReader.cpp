@@ -0,0 +1,239 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file CachingMemoryReader.cpp
+
+Implements CachingMemoryReader class that serves small reads from a page cache in front of another IMemoryReader.
+*/
+
+#include <algorithm>
+#include <cstring>
+
+#include "CachingMemoryReader.h"
+
+const unsigned long CachingMemoryReader::PAGE_SIZE;
+const unsigned long CachingMemoryReader::DEFAULT_MAX_PAGES;
+const unsigned long CachingMemoryReader::DEFAULT_READ_AHEAD_PAGES;
+
+/**
+Reads memory through the page cache, fetching missing pages from the underlying reader.
+
+Consecutive missing pages of a request are fetched with a single read. When a miss immediately
+follows the previously missed pages, the read is extended by the read-ahead window.
+
+\param offset Address to read from.
+\param lpBuffer Buffer to copy the memory to.
+\param cb Number of bytes to read.
+\param lpcbBytesRead Number of contiguous bytes read from offset.
+\return Nonzero if all cb bytes were read.
+*/
+#pragma push_macro("ReadMemory")
+#undef ReadMemory
+unsigned long CachingMemoryReader::ReadMemory(unsigned long offset, void *lpBuffer, unsigned long cb, unsigned long* lpcbBytesRead)
+{
+	auto buffer = static_cast<unsigned char*>(lpBuffer);
+
+	unsigned long copied = 0;
+
+	while (copied < cb)
+	{
+		auto address = offset + copied;
+		auto page_address = address & ~(PAGE_SIZE - 1);
+
+		auto page = find_page(page_address);
+
+		if (page)
+		{
+			_hits++;
+		}
+		else
+		{
+			_misses++;
+
+			// Fetch all missing pages of this request in one read.
+			auto last_page_address = (offset + cb - 1) & ~(PAGE_SIZE - 1);
+
+			unsigned long page_count = 1;
+
+			auto is_sequential = _has_last_missed_page && page_address == _last_missed_page + PAGE_SIZE;
+
+			auto wanted_pages = is_sequential ? 1 + _read_ahead_pages : 1;
+
+			while (page_count < _max_pages)
+			{
+				auto next_page_address = page_address + page_count * PAGE_SIZE;
+
+				if (next_page_address < page_address)
+				{
+					// Wrapped around the address space.
+					break;
+				}
+
+				if (next_page_address > last_page_address && page_count >= wanted_pages)
+				{
+					break;
+				}
+
+				if (_pages.find(next_page_address) != _pages.end())
+				{
+					break;
+				}
+
+				page_count++;
+			}
+
+			_last_missed_page = page_address + (page_count - 1) * PAGE_SIZE;
+			_has_last_missed_page = true;
+
+			page = fetch_pages(page_address, page_count);
+		}
+
+		auto page_offset = address - page_address;
+
+		if (page_offset >= page->valid_bytes)
+		{
+			break;
+		}
+
+		auto count = std::min(page->valid_bytes - page_offset, cb - copied);
+
+		memcpy(buffer + copied, page->data.data() + page_offset, count);
+
+		copied += count;
+
+		if (page_offset + count < PAGE_SIZE)
+		{
+			// Either done or the rest of the page is not readable.
+			break;
+		}
+	}
+
+	if (lpcbBytesRead)
+	{
+		*lpcbBytesRead = copied;
+	}
+
+	return copied == cb;
+}
+#pragma pop_macro("ReadMemory")
+
+/**
+Drops all cached pages, keeping the statistics.
+*/
+void CachingMemoryReader::clear()
+{
+	_pages.clear();
+	_lru.clear();
+
+	_has_last_missed_page = false;
+}
+
+/**
+Finds a cached page and marks it as most recently used.
+
+\param page_address Page aligned address.
+\return Cached page or nullptr.
+*/
+CachingMemoryReader::CachedPage* CachingMemoryReader::find_page(unsigned long page_address)
+{
+	auto it = _pages.find(page_address);
+
+	if (it == _pages.end())
+	{
+		return nullptr;
+	}
+
+	_lru.splice(_lru.begin(), _lru, it->second.lru_position);
+
+	return &it->second;
+}
+
+/**
+Reads consecutive pages from the underlying reader with a single read and caches them.
+
+Pages after the first unreadable byte are not cached, the page containing it is cached
+with its readable prefix.
+
+\param page_address Page aligned address of the first page.
+\param page_count Number of pages to read.
+\return The first page, never nullptr.
+*/
+CachingMemoryReader::CachedPage* CachingMemoryReader::fetch_pages(unsigned long page_address, unsigned long page_count)
+{
+	auto size = page_count * PAGE_SIZE;
+
+	std::vector<unsigned char> data(size);
+
+	unsigned long bytes_read = 0;
+
+#pragma push_macro("ReadMemory")
+#undef ReadMemory
+	_reader->ReadMemory(page_address, data.data(), size, &bytes_read);
+#pragma pop_macro("ReadMemory")
+
+	_engine_reads++;
+
+	bytes_read = std::min(bytes_read, size);
+
+	_bytes_fetched += bytes_read;
+
+	auto cached_count = std::min(page_count, bytes_read / PAGE_SIZE + 1);
+
+	for (unsigned long i = 0; i < cached_count; i++)
+	{
+		auto current_page_address = page_address + i * PAGE_SIZE;
+		auto page_start = i * PAGE_SIZE;
+
+		while (_pages.size() >= _max_pages)
+		{
+			evict();
+		}
+
+		_lru.push_front(current_page_address);
+
+		auto& page = _pages[current_page_address];
+
+		page.lru_position = _lru.begin();
+		page.valid_bytes = bytes_read > page_start ? std::min(bytes_read - page_start, PAGE_SIZE) : 0;
+		page.data.assign(data.begin() + page_start, data.begin() + page_start + PAGE_SIZE);
+	}
+
+	return &_pages[page_address];
+}
+
+/**
+Evicts the least recently used page.
+*/
+void CachingMemoryReader::evict()
+{
+	if (_lru.empty())
+	{
+		return;
+	}
+
+	_pages.erase(_lru.back());
+	_lru.pop_back();
+}
\ No newline at end of file
@@ -0,0 +1,378 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file CompressedAddressSet.cpp
+
+Implements CompressedAddressSet class that keeps sorted addresses as variable length differences.
+*/
+
+#include <algorithm>
+
+#include "CompressedAddressSet.h"
+
+const size_t CompressedAddressSet::BLOCK_SIZE;
+
+/**
+Constructs an iterator at an index.
+
+\param set Set to iterate.
+\param index Index of the address, size of the set for the end iterator.
+*/
+CompressedAddressSet::const_iterator::const_iterator(const CompressedAddressSet* set, size_t index)
+	: _set(set), _index(index), _next(nullptr), _value(0)
+{
+	if (index >= set->_size)
+	{
+		_index = set->_size;
+
+		return;
+	}
+
+	load_block(index / BLOCK_SIZE);
+
+	while (_index < index)
+	{
+		++(*this);
+	}
+}
+
+/**
+Moves to the first address of a block.
+
+\param block Block index.
+*/
+void CompressedAddressSet::const_iterator::load_block(size_t block)
+{
+	_index = block * BLOCK_SIZE;
+	_value = _set->_block_firsts[block];
+	_next = _set->_data.data() + _set->_block_offsets[block];
+}
+
+/**
+Moves to the next address.
+*/
+CompressedAddressSet::const_iterator& CompressedAddressSet::const_iterator::operator++()
+{
+	if (++_index >= _set->_size)
+	{
+		_index = _set->_size;
+
+		return *this;
+	}
+
+	if (_index % BLOCK_SIZE == 0)
+	{
+		load_block(_index / BLOCK_SIZE);
+
+		return *this;
+	}
+
+	unsigned long delta = 0;
+
+	for (unsigned int shift = 0;; shift += 7)
+	{
+		auto byte = *_next++;
+
+		delta |= static_cast<unsigned long>(byte & 0x7f) << shift;
+
+		if ((byte & 0x80) == 0)
+		{
+			break;
+		}
+	}
+
+	_value += delta;
+
+	return *this;
+}
+
+/**
+Moves forward to the first address that is not less than an address, skipping whole blocks by their first addresses.
+
+\param address Address to find.
+*/
+void CompressedAddressSet::const_iterator::seek(unsigned long address)
+{
+	if (_index >= _set->_size || _value >= address)
+	{
+		return;
+	}
+
+	auto block = _index / BLOCK_SIZE;
+	auto& firsts = _set->_block_firsts;
+
+	auto it = std::upper_bound(firsts.begin() + block + 1, firsts.end(), address);
+
+	auto last_block = static_cast<size_t>(it - firsts.begin()) - 1;
+
+	if (last_block > block)
+	{
+		load_block(last_block);
+	}
+
+	while (_index < _set->_size && _value < address)
+	{
+		++(*this);
+	}
+}
+
+/**
+Constructs a set of addresses.
+
+\param addresses Addresses in any order, duplicates are kept once.
+*/
+CompressedAddressSet::CompressedAddressSet(const std::vector<unsigned long>& addresses)
+{
+	auto sorted = addresses;
+
+	std::sort(sorted.begin(), sorted.end());
+
+	for (auto address : sorted)
+	{
+		if (_size == 0 || address != _back)
+		{
+			append(address);
+		}
+	}
+}
+
+/**
+Adds an address greater than all addresses of the set.
+
+\param address Address.
+*/
+void CompressedAddressSet::append(unsigned long address)
+{
+	if (_size % BLOCK_SIZE == 0)
+	{
+		_block_firsts.push_back(address);
+		_block_offsets.push_back(_data.size());
+	}
+	else
+	{
+		auto delta = address - _back;
+
+		while (delta >= 0x80)
+		{
+			_data.push_back(static_cast<unsigned char>(delta | 0x80));
+
+			delta >>= 7;
+		}
+
+		_data.push_back(static_cast<unsigned char>(delta));
+	}
+
+	_back = address;
+	_size++;
+}
+
+/**
+Finds the first address that is not less than an address.
+
+\param address Address.
+*/
+CompressedAddressSet::const_iterator CompressedAddressSet::lower_bound(unsigned long address) const
+{
+	auto it = begin();
+
+	it.seek(address);
+
+	return it;
+}
+
+/**
+Approximates the memory used by the set.
+*/
+size_t CompressedAddressSet::memory_size() const
+{
+	return sizeof(*this) + _block_firsts.capacity() * sizeof(unsigned long) + _block_offsets.capacity() * sizeof(size_t) + _data.capacity();
+}
+
+/**
+Checks if the set contains an address.
+
+\param address Address.
+*/
+bool CompressedAddressSet::contains(unsigned long address) const
+{
+	auto it = lower_bound(address);
+
+	return it != end() && *it == address;
+}
+
+/**
+Counts addresses less than an address.
+
+\param address Address.
+*/
+size_t CompressedAddressSet::rank(unsigned long address) const
+{
+	return lower_bound(address).get_index();
+}
+
+/**
+Finds the address at an index.
+
+\param index Index, must be less than the size of the set.
+*/
+unsigned long CompressedAddressSet::select(size_t index) const
+{
+	return *const_iterator(this, index);
+}
+
+/**
+Decompresses the set.
+*/
+std::vector<unsigned long> CompressedAddressSet::to_vector() const
+{
+	std::vector<unsigned long> ret;
+
+	ret.reserve(_size);
+
+	for (auto it = begin(); it != end(); ++it)
+	{
+		ret.push_back(*it);
+	}
+
+	return ret;
+}
+
+/**
+Finds addresses in both sets. Addresses of the smaller set are looked up in the larger one, skipping blocks of the larger set.
+
+\param a A set.
+\param b Another set.
+*/
+CompressedAddressSet CompressedAddressSet::intersect(const CompressedAddressSet& a, const CompressedAddressSet& b)
+{
+	auto& small = a.size() <= b.size() ? a : b;
+	auto& large = a.size() <= b.size() ? b : a;
+
+	CompressedAddressSet ret;
+
+	auto it = large.begin();
+
+	for (auto address : small)
+	{
+		it.seek(address);
+
+		if (it == large.end())
+		{
+			break;
+		}
+
+		if (*it == address)
+		{
+			ret.append(address);
+		}
+	}
+
+	return ret;
+}
+
+/**
+Finds addresses in either set.
+
+\param a A set.
+\param b Another set.
+*/
+CompressedAddressSet CompressedAddressSet::unite(const CompressedAddressSet& a, const CompressedAddressSet& b)
+{
+	CompressedAddressSet ret;
+
+	auto it_a = a.begin();
+	auto it_b = b.begin();
+
+	while (it_a != a.end() || it_b != b.end())
+	{
+		unsigned long address;
+
+		if (it_b == b.end() || (it_a != a.end() && *it_a <= *it_b))
+		{
+			address = *it_a++;
+		}
+		else
+		{
+			address = *it_b++;
+		}
+
+		if (ret._size == 0 || address != ret._back)
+		{
+			ret.append(address);
+		}
+	}
+
+	return ret;
+}
+
+/**
+Adds an address.
+
+\param address Address.
+*/
+void CompressedAddressSetBuilder::add(unsigned long address)
+{
+	if (_current._size != 0 && address <= _current._back)
+	{
+		if (address == _current._back)
+		{
+			return;
+		}
+
+		// A new ascending run.
+		_runs.push_back(CompressedAddressSet());
+		std::swap(_runs.back(), _current);
+	}
+
+	_current.append(address);
+}
+
+/**
+Merges ascending runs into one set, pairwise so each address is merged a logarithmic number of times.
+*/
+CompressedAddressSet CompressedAddressSetBuilder::build()
+{
+	_runs.push_back(CompressedAddressSet());
+	std::swap(_runs.back(), _current);
+
+	while (_runs.size() > 1)
+	{
+		std::vector<CompressedAddressSet> merged;
+
+		for (size_t i = 0; i < _runs.size(); i += 2)
+		{
+			merged.push_back(i + 1 < _runs.size() ? CompressedAddressSet::unite(_runs[i], _runs[i + 1]) : _runs[i]);
+		}
+
+		_runs.swap(merged);
+	}
+
+	auto ret = _runs.back();
+
+	_runs.clear();
+
+	return ret;
+}
\ No newline at end of file
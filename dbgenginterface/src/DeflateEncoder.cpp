@@ -0,0 +1,395 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file DeflateEncoder.cpp
+
+Implements DeflateEncoder class that writes deflate streams with fixed Huffman codes.
+*/
+
+#include <algorithm>
+
+#include "DeflateEncoder.h"
+
+const unsigned int DeflateEncoder::WINDOW_SIZE;
+const unsigned int DeflateEncoder::MIN_MATCH;
+const unsigned int DeflateEncoder::MAX_MATCH;
+const unsigned int DeflateEncoder::END_OF_BLOCK;
+
+static const unsigned int LENGTH_BASES[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const unsigned int LENGTH_EXTRA_BITS[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const unsigned int DISTANCE_BASES[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const unsigned int DISTANCE_EXTRA_BITS[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+/**
+Reverses the bits of a Huffman code, deflate writes codes starting from their most significant bit.
+
+\param code Code.
+\param length Length of the code in bits.
+*/
+static unsigned int reverse_bits(unsigned int code, unsigned int length)
+{
+	unsigned int reversed = 0;
+
+	for (unsigned int i = 0; i < length; i++)
+	{
+		reversed = (reversed << 1) | ((code >> i) & 1);
+	}
+
+	return reversed;
+}
+
+/**
+Fixed Huffman codes of RFC 1951 3.2.6, bit reversed, and length codes by match length.
+*/
+static const struct FixedCodes
+{
+	unsigned int LiteralCodes[288];
+	unsigned int LiteralLengths[288];
+	unsigned int DistanceCodes[30];
+	unsigned char LengthCodes[DeflateEncoder::MAX_MATCH + 1];
+
+	FixedCodes()
+	{
+		for (unsigned int symbol = 0; symbol < 288; symbol++)
+		{
+			unsigned int code;
+			unsigned int length;
+
+			if (symbol < 144)
+			{
+				code = 0x30 + symbol;
+				length = 8;
+			}
+			else if (symbol < 256)
+			{
+				code = 0x190 + symbol - 144;
+				length = 9;
+			}
+			else if (symbol < 280)
+			{
+				code = symbol - 256;
+				length = 7;
+			}
+			else
+			{
+				code = 0xC0 + symbol - 280;
+				length = 8;
+			}
+
+			LiteralCodes[symbol] = reverse_bits(code, length);
+			LiteralLengths[symbol] = length;
+		}
+
+		for (unsigned int code = 0; code < 30; code++)
+		{
+			DistanceCodes[code] = reverse_bits(code, 5);
+		}
+
+		LengthCodes[0] = LengthCodes[1] = LengthCodes[2] = 0;
+
+		for (unsigned int length = DeflateEncoder::MIN_MATCH; length <= DeflateEncoder::MAX_MATCH; length++)
+		{
+			LengthCodes[length] = static_cast<unsigned char>(std::upper_bound(LENGTH_BASES, LENGTH_BASES + 29, length) - LENGTH_BASES - 1);
+		}
+	}
+} Fixed;
+
+/**
+\param output Buffer that encoded bytes are appended to.
+*/
+DeflateEncoder::DeflateEncoder(std::vector<unsigned char>& output)
+	: _output(output)
+{
+
+}
+
+/**
+Adds a distance at which matches are searched. Distances past the window are ignored.
+
+\param distance Distance in bytes.
+*/
+void DeflateEncoder::add_distance(unsigned int distance)
+{
+	if (distance != 0 && distance <= WINDOW_SIZE && std::find(_distances.begin(), _distances.end(), distance) == _distances.end())
+	{
+		_distances.push_back(distance);
+	}
+}
+
+/**
+Encodes data, taking the longest match at any of the distances or a literal for each position.
+
+\param data Data to encode.
+\param size Size of the data.
+\param history Number of bytes before the data that matches can refer to, they must have been encoded before the data in the same stream.
+*/
+void DeflateEncoder::write(const unsigned char* data, size_t size, size_t history)
+{
+	if (size == 0)
+	{
+		return;
+	}
+
+	if (!_is_block_open)
+	{
+		// Not final, fixed Huffman codes.
+		write_bits(0, 1);
+		write_bits(1, 2);
+
+		_is_block_open = true;
+	}
+
+	size_t i = 0;
+
+	while (i < size)
+	{
+		auto max_length = static_cast<unsigned int>(std::min<size_t>(MAX_MATCH, size - i));
+
+		unsigned int best_length = 0;
+		unsigned int best_distance = 0;
+
+		if (max_length >= MIN_MATCH)
+		{
+			for (auto distance : _distances)
+			{
+				if (distance > history + i)
+				{
+					continue;
+				}
+
+				auto source = data + i - distance;
+				auto target = data + i;
+
+				unsigned int length = 0;
+
+				while (length < max_length && source[length] == target[length])
+				{
+					length++;
+				}
+
+				if (length > best_length)
+				{
+					best_length = length;
+					best_distance = distance;
+				}
+			}
+		}
+
+		if (best_length >= MIN_MATCH)
+		{
+			write_match(best_length, best_distance);
+
+			i += best_length;
+		}
+		else
+		{
+			write_symbol(data[i]);
+
+			i++;
+		}
+	}
+}
+
+/**
+Ends the current block and aligns the stream to a byte with an empty stored block, so encoded streams can be concatenated.
+*/
+void DeflateEncoder::flush()
+{
+	if (_is_block_open)
+	{
+		write_symbol(END_OF_BLOCK);
+
+		_is_block_open = false;
+	}
+
+	// Not final, stored.
+	write_bits(0, 3);
+
+	align();
+
+	_output.push_back(0x00);
+	_output.push_back(0x00);
+	_output.push_back(0xFF);
+	_output.push_back(0xFF);
+}
+
+/**
+Ends the current block and the stream with an empty final block.
+*/
+void DeflateEncoder::finish()
+{
+	if (_is_block_open)
+	{
+		write_symbol(END_OF_BLOCK);
+
+		_is_block_open = false;
+	}
+
+	// Final, fixed Huffman codes.
+	write_bits(1, 1);
+	write_bits(1, 2);
+	write_symbol(END_OF_BLOCK);
+
+	align();
+}
+
+/**
+Appends bits, least significant bit first.
+
+\param value Bits.
+\param count Number of bits, at most 24.
+*/
+void DeflateEncoder::write_bits(unsigned int value, unsigned int count)
+{
+	_bit_buffer |= value << _bit_count;
+	_bit_count += count;
+
+	while (_bit_count >= 8)
+	{
+		_output.push_back(static_cast<unsigned char>(_bit_buffer));
+
+		_bit_buffer >>= 8;
+		_bit_count -= 8;
+	}
+}
+
+/**
+Pads the last byte with zero bits.
+*/
+void DeflateEncoder::align()
+{
+	if (_bit_count != 0)
+	{
+		write_bits(0, 8 - _bit_count);
+	}
+}
+
+/**
+Appends a literal or the end of block symbol.
+
+\param symbol Symbol.
+*/
+void DeflateEncoder::write_symbol(unsigned int symbol)
+{
+	write_bits(Fixed.LiteralCodes[symbol], Fixed.LiteralLengths[symbol]);
+}
+
+/**
+Appends a match.
+
+\param length Length of the match, from MIN_MATCH to MAX_MATCH.
+\param distance Distance of the match, from 1 to WINDOW_SIZE.
+*/
+void DeflateEncoder::write_match(unsigned int length, unsigned int distance)
+{
+	auto length_code = Fixed.LengthCodes[length];
+
+	write_symbol(257 + length_code);
+	write_bits(length - LENGTH_BASES[length_code], LENGTH_EXTRA_BITS[length_code]);
+
+	auto distance_code = std::upper_bound(DISTANCE_BASES, DISTANCE_BASES + 30, distance) - DISTANCE_BASES - 1;
+
+	write_bits(Fixed.DistanceCodes[distance_code], 5);
+	write_bits(distance - DISTANCE_BASES[distance_code], DISTANCE_EXTRA_BITS[distance_code]);
+}
+
+/**
+Updates an Adler-32 checksum, as used by zlib streams.
+
+\param data Data.
+\param size Size of the data.
+\param adler Checksum of the preceding data, 1 for none.
+*/
+unsigned int DeflateEncoder::adler32(const unsigned char* data, size_t size, unsigned int adler)
+{
+	const unsigned int BASE = 65521;
+	const size_t MAX_RUN = 5552;
+
+	auto a = adler & 0xFFFF;
+	auto b = adler >> 16;
+
+	while (size != 0)
+	{
+		auto run = std::min(size, MAX_RUN);
+
+		size -= run;
+
+		for (size_t i = 0; i < run; i++)
+		{
+			a += data[i];
+			b += a;
+		}
+
+		data += run;
+
+		a %= BASE;
+		b %= BASE;
+	}
+
+	return a | (b << 16);
+}
+
+/**
+Combines Adler-32 checksums of two consecutive parts of data, so parts can be summed on separate threads.
+
+\param adler1 Checksum of the first part.
+\param adler2 Checksum of the second part.
+\param size2 Size of the second part.
+*/
+unsigned int DeflateEncoder::adler32_combine(unsigned int adler1, unsigned int adler2, size_t size2)
+{
+	const unsigned int BASE = 65521;
+
+	auto remainder = static_cast<unsigned int>(size2 % BASE);
+
+	auto a = adler1 & 0xFFFF;
+	auto b = (remainder * a) % BASE;
+
+	a += (adler2 & 0xFFFF) + BASE - 1;
+	b += (adler1 >> 16) + (adler2 >> 16) + BASE - remainder;
+
+	if (a >= BASE)
+	{
+		a -= BASE;
+	}
+
+	if (a >= BASE)
+	{
+		a -= BASE;
+	}
+
+	if (b >= 2 * BASE)
+	{
+		b -= 2 * BASE;
+	}
+
+	if (b >= BASE)
+	{
+		b -= BASE;
+	}
+
+	return a | (b << 16);
+}
\ No newline at end of file
@@ -0,0 +1,441 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file DominatorTree.cpp
+
+Implements DominatorTree class that computes dominators and retained sizes of objects in a reference graph.
+*/
+
+#include <algorithm>
+#include <new>
+#include <unordered_map>
+
+#include "DominatorTree.h"
+
+const unsigned int DominatorTree::ROOT;
+
+static const unsigned int UNLINKED = 0xFFFFFFFF;
+
+/**
+Returns the number of bytes allocated at the peak of a build, on top of the graph.
+
+\param node_count Number of nodes in the graph.
+*/
+size_t DominatorTree::get_build_memory_size(size_t node_count)
+{
+	return 6 * sizeof(unsigned int) * (node_count + 1) + node_count / 8;
+}
+
+/**
+Computes immediate dominators and retained sizes, see build_dominators.
+Working arrays that cannot be allocated leave the tree empty instead of failing the caller.
+
+\param graph Reference graph, must outlive this instance.
+\param roots Addresses of root objects, addresses not in the graph are skipped.
+\return false if the graph is empty or the working arrays cannot be allocated.
+*/
+bool DominatorTree::build(const ReferenceGraph& graph, const std::vector<unsigned long>& roots)
+{
+	try
+	{
+		return build_dominators(graph, roots);
+	}
+	catch (std::bad_alloc&)
+	{
+		std::vector<unsigned int>().swap(_idoms);
+		std::vector<unsigned int>().swap(_retained);
+
+		return false;
+	}
+}
+
+/**
+Computes immediate dominators and retained sizes.
+Nodes are numbered in DFS order from 1, 0 is the virtual root. Semidominators are found with path compression over referrers,
+then each immediate dominator is the nearest common ancestor of the DFS parent and the semidominator.
+
+\param graph Reference graph, must outlive this instance.
+\param roots Addresses of root objects, addresses not in the graph are skipped.
+\return false if the graph is empty.
+*/
+bool DominatorTree::build_dominators(const ReferenceGraph& graph, const std::vector<unsigned long>& roots)
+{
+	_graph = &graph;
+	_idoms.clear();
+	_retained.clear();
+	_root_count = 0;
+	_unrooted_count = 0;
+
+	auto node_count = static_cast<unsigned int>(graph.get_node_count());
+
+	if (node_count == 0)
+	{
+		return false;
+	}
+
+	std::vector<unsigned int> numbers(node_count, 0);
+	std::vector<unsigned int> vertices(node_count + 1);
+	std::vector<unsigned int> parents(node_count + 1, 0);
+	std::vector<unsigned int> semis(node_count + 1);
+	std::vector<unsigned int> labels(node_count + 1);
+	std::vector<unsigned int> ancestors(node_count + 1);
+	std::vector<bool> is_root(node_count, false);
+
+	unsigned int count = 1;
+
+	vertices[0] = ROOT;
+
+	// The stack is kept in ancestors and the next reference of each node in labels, both are set after the DFS.
+	auto visit = [&](unsigned int root)
+	{
+		if (numbers[root] != 0)
+		{
+			return false;
+		}
+
+		is_root[root] = true;
+		numbers[root] = count;
+		vertices[count] = root;
+		labels[count] = 0;
+		ancestors[0] = count;
+		count++;
+
+		size_t depth = 1;
+
+		while (depth > 0)
+		{
+			auto v = ancestors[depth - 1];
+			auto references = graph.get_references(vertices[v]);
+
+			if (labels[v] == references.size())
+			{
+				depth--;
+
+				continue;
+			}
+
+			auto w = references[labels[v]++];
+
+			if (numbers[w] == 0)
+			{
+				numbers[w] = count;
+				vertices[count] = w;
+				parents[count] = v;
+				labels[count] = 0;
+				ancestors[depth++] = count;
+				count++;
+			}
+		}
+
+		return true;
+	};
+
+	for (auto address : roots)
+	{
+		auto node = graph.find_node(address);
+
+		if (node != ReferenceGraph::NOT_FOUND && !is_root[node])
+		{
+			is_root[node] = true;
+
+			_root_count++;
+		}
+	}
+
+	for (unsigned int node = 0; node < node_count; node++)
+	{
+		if (is_root[node])
+		{
+			visit(node);
+		}
+	}
+
+	for (unsigned int node = 0; node < node_count; node++)
+	{
+		if (numbers[node] == 0 && graph.get_referrers(node).empty() && visit(node))
+		{
+			_unrooted_count++;
+		}
+	}
+
+	for (unsigned int node = 0; node < node_count; node++)
+	{
+		if (visit(node))
+		{
+			_unrooted_count++;
+		}
+	}
+
+	for (unsigned int v = 0; v < count; v++)
+	{
+		semis[v] = v;
+		labels[v] = v;
+		ancestors[v] = UNLINKED;
+	}
+
+	std::vector<unsigned int> path;
+
+	auto eval = [&](unsigned int v)
+	{
+		if (ancestors[v] == UNLINKED)
+		{
+			return v;
+		}
+
+		for (auto u = v; ancestors[ancestors[u]] != UNLINKED; u = ancestors[u])
+		{
+			path.push_back(u);
+		}
+
+		while (!path.empty())
+		{
+			auto u = path.back();
+			auto a = ancestors[u];
+
+			path.pop_back();
+
+			if (semis[labels[a]] < semis[labels[u]])
+			{
+				labels[u] = labels[a];
+			}
+
+			ancestors[u] = ancestors[a];
+		}
+
+		return labels[v];
+	};
+
+	for (auto w = count - 1; w > 0; w--)
+	{
+		auto node = vertices[w];
+
+		if (is_root[node])
+		{
+			semis[w] = 0;
+		}
+
+		for (auto referrer : graph.get_referrers(node))
+		{
+			auto u = eval(numbers[referrer]);
+
+			if (semis[u] < semis[w])
+			{
+				semis[w] = semis[u];
+			}
+		}
+
+		ancestors[w] = parents[w];
+	}
+
+	std::vector<unsigned int>().swap(labels);
+	std::vector<unsigned int>().swap(ancestors);
+
+	// Parents become immediate dominators.
+	auto& idoms = parents;
+
+	for (unsigned int w = 1; w < count; w++)
+	{
+		while (idoms[w] > semis[w])
+		{
+			idoms[w] = idoms[idoms[w]];
+		}
+	}
+
+	// Semidominators are not needed anymore, their storage keeps retained sizes by node.
+	auto& retained = semis;
+
+	retained.assign(node_count, 0);
+
+	for (auto w = count - 1; w > 0; w--)
+	{
+		auto node = vertices[w];
+
+		retained[node] += graph.get_size(node);
+
+		if (idoms[w] != 0)
+		{
+			retained[vertices[idoms[w]]] += retained[node];
+		}
+	}
+
+	// Numbers of nodes are replaced with their immediate dominators.
+	for (unsigned int w = 1; w < count; w++)
+	{
+		numbers[vertices[w]] = idoms[w] == 0 ? ROOT : vertices[idoms[w]];
+	}
+
+	_idoms.swap(numbers);
+	_retained.swap(retained);
+
+	return true;
+}
+
+/**
+Returns the number of bytes used by the arrays of the tree.
+*/
+size_t DominatorTree::memory_size() const
+{
+	return sizeof(unsigned int) * (_idoms.capacity() + _retained.capacity());
+}
+
+/**
+Selects objects retaining the most memory.
+
+\param top Number of objects, 0 for all.
+\return Node ids, largest retained size first.
+*/
+std::vector<unsigned int> DominatorTree::get_top_objects(size_t top) const
+{
+	std::vector<unsigned int> nodes(_retained.size());
+
+	for (unsigned int i = 0; i < nodes.size(); i++)
+	{
+		nodes[i] = i;
+	}
+
+	top = top == 0 ? nodes.size() : std::min(top, nodes.size());
+
+	std::partial_sort(nodes.begin(), nodes.begin() + top, nodes.end(), [&](unsigned int a, unsigned int b)
+	{
+		if (_retained[a] != _retained[b])
+		{
+			return _retained[a] > _retained[b];
+		}
+
+		return a < b;
+	});
+
+	nodes.erase(nodes.begin() + top, nodes.end());
+
+	return nodes;
+}
+
+/**
+Selects types retaining the most memory. Instances of a type dominated by another instance of the same type are not counted twice,
+so the retained size of a type is the memory freed if all of its instances were unreachable.
+
+\param top Number of types, 0 for all.
+\return Rows, largest retained size first.
+*/
+std::vector<RetainedTypeRow> DominatorTree::get_top_types(size_t top) const
+{
+	std::vector<RetainedTypeRow> rows;
+
+	if (_idoms.empty())
+	{
+		return rows;
+	}
+
+	auto node_count = static_cast<unsigned int>(_idoms.size());
+
+	// Children of the virtual root are at node_count.
+	std::vector<unsigned int> child_offsets(node_count + 2, 0);
+	std::vector<unsigned int> children(node_count);
+
+	for (auto idom : _idoms)
+	{
+		child_offsets[(idom == ROOT ? node_count : idom) + 1]++;
+	}
+
+	for (unsigned int i = 0; i <= node_count; i++)
+	{
+		child_offsets[i + 1] += child_offsets[i];
+	}
+
+	{
+		std::vector<unsigned int> cursors(child_offsets.begin(), child_offsets.end() - 1);
+
+		for (unsigned int node = 0; node < node_count; node++)
+		{
+			children[cursors[_idoms[node] == ROOT ? node_count : _idoms[node]]++] = node;
+		}
+	}
+
+	std::unordered_map<unsigned long, size_t> row_indexes;
+	std::unordered_map<unsigned long, unsigned int> path_counts;
+
+	std::vector<std::pair<unsigned int, unsigned int>> stack;
+
+	stack.push_back(std::make_pair(node_count, child_offsets[node_count]));
+
+	while (!stack.empty())
+	{
+		auto& top_entry = stack.back();
+		auto node = top_entry.first;
+
+		if (top_entry.second == child_offsets[node + 1])
+		{
+			if (node != node_count)
+			{
+				path_counts[_graph->get_method_table(node)]--;
+			}
+
+			stack.pop_back();
+
+			continue;
+		}
+
+		auto child = children[top_entry.second++];
+		auto method_table = _graph->get_method_table(child);
+
+		auto it = row_indexes.find(method_table);
+
+		if (it == row_indexes.end())
+		{
+			it = row_indexes.insert(std::make_pair(method_table, rows.size())).first;
+
+			rows.push_back(RetainedTypeRow(method_table));
+		}
+
+		auto& row = rows[it->second];
+
+		row.Count++;
+		row.Bytes += _graph->get_size(child);
+
+		if (path_counts[method_table]++ == 0)
+		{
+			row.RetainedBytes += _retained[child];
+		}
+
+		stack.push_back(std::make_pair(child, child_offsets[child]));
+	}
+
+	top = top == 0 ? rows.size() : std::min(top, rows.size());
+
+	std::partial_sort(rows.begin(), rows.begin() + top, rows.end(), [](const RetainedTypeRow& a, const RetainedTypeRow& b)
+	{
+		if (a.RetainedBytes != b.RetainedBytes)
+		{
+			return a.RetainedBytes > b.RetainedBytes;
+		}
+
+		return a.MethodTable < b.MethodTable;
+	});
+
+	rows.erase(rows.begin() + top, rows.end());
+
+	return rows;
+}
\ No newline at end of file
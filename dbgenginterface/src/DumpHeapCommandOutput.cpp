@@ -34,7 +34,7 @@ Implements DumpHeapCommandOutput class that represents output of the !dumpheap c
 /**
 Returns the parsed addresses.
 */
-std::vector<unsigned long>* DumpHeapCommandOutput::get_addresses() const
+const CompressedAddressSet& DumpHeapCommandOutput::get_addresses() const
 {
 	return _addresses;
 }
@@ -58,9 +58,7 @@ DumpHeapCommandOutput DumpHeapCommandParser::execute_by_mt(unsigned long method_
 		return DumpHeapCommandOutput();
 	}
 
-	auto ranges = Parse(output);
-
-	return DumpHeapCommandOutput(ranges);
+	return DumpHeapCommandOutput(Parse(output));
 }
 
 /**
@@ -81,19 +79,19 @@ DumpHeapCommandOutput DumpHeapCommandParser::execute(const std::string& clr_part
 		return DumpHeapCommandOutput();
 	}
 
-	auto ranges = Parse(output);
-
-	return DumpHeapCommandOutput(ranges);
+	return DumpHeapCommandOutput(Parse(output));
 }
 
 /**
 Parses lines of an dumpheap output to find the address information.
 
+Addresses are collected into a compressed set, so large heaps do not need a plain vector of all objects.
+
 \param lines DumpHeap output lines.
 */
-std::vector<unsigned long>* DumpHeapCommandParser::Parse(const std::string& lines)
+CompressedAddressSet DumpHeapCommandParser::Parse(const std::string& lines)
 {
-	auto ret = new std::vector<unsigned long>();
+	CompressedAddressSetBuilder builder;
 
 	std::istringstream iss(lines);
 
@@ -101,25 +99,44 @@ std::vector<unsigned long>* DumpHeapCommandParser::Parse(const std::string& line
 
 	while (std::getline(iss, line))
 	{
-		if (line.size() < 8)
+		unsigned long address;
+
+		if (ParseLine(line, address))
 		{
-			continue;
+			builder.add(address);
 		}
+	}
 
-		auto addressText = line.substr(0, 8);
+	return builder.build();
+}
 
-		try{
-			auto address = std::stoul(addressText, nullptr, 16);
+/**
+Parses the object address at the start of a dumpheap output line.
 
-			ret->push_back(address);
-		}
-		catch (std::invalid_argument)
-		{
-			_logger->Log("Address cannot be read: %s\n", line);
-		}
+\param line DumpHeap output line.
+\param address Receives the address.
+\return true if the line starts with an address.
+*/
+bool DumpHeapCommandParser::ParseLine(const std::string& line, unsigned long& address)
+{
+	if (line.size() < 8)
+	{
+		return false;
 	}
 
-	return ret;
+	auto addressText = line.substr(0, 8);
+
+	try{
+		address = std::stoul(addressText, nullptr, 16);
+
+		return true;
+	}
+	catch (std::invalid_argument)
+	{
+		_logger->Log("Address cannot be read: %s\n", line);
+	}
+
+	return false;
 }
 
 MethodTableOutput DumpHeapCommandParser::find_method_tables(const std::string& clr_exact_type_name)
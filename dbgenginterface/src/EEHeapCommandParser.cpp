@@ -52,17 +52,20 @@ EEHeapCommandOutput EEHeapCommandParser::execute()
 		return EEHeapCommandOutput();
 	}
 
-	auto ranges = Parse(output);
+	GenerationStartList generation_starts;
 
-	return EEHeapCommandOutput(RangeList(ranges));
+	auto ranges = Parse(output, generation_starts);
+
+	return EEHeapCommandOutput(RangeList(ranges), generation_starts);
 }
 
 /**
 Parses lines of an address output to find the range information.
 
 \param lines Address output lines.
+\param generation_starts Generation numbers and start addresses, for each heap.
 */
-std::vector<const MemoryRange>* EEHeapCommandParser::Parse(const std::string& lines)
+std::vector<const MemoryRange>* EEHeapCommandParser::Parse(const std::string& lines, GenerationStartList& generation_starts)
 {
 	auto ret = new std::vector<const MemoryRange>();
 
@@ -88,6 +91,18 @@ std::vector<const MemoryRange>* EEHeapCommandParser::Parse(const std::string& li
 	//go until we are out of lines or reach the "GC Heap Size" line
 	while (std::getline(iss, line) && line.find("GC Heap Size") == std::string::npos)
 	{
+		auto generation_index = line.find("generation ");
+		auto starts_index = line.find(" starts at 0x");
+
+		if (generation_index == 0 && starts_index != std::string::npos)
+		{
+			// generation 0 starts at 0x3def26f8
+			auto generation = std::stoul(line.substr(11, starts_index - 11), nullptr, 10);
+			auto address = std::stoul(line.substr(starts_index + 13), nullptr, 16);
+
+			generation_starts.push_back(std::make_pair(generation, address));
+		}
+
 		if (line.find("allocated") != std::string::npos)
 		{
 			currentLine++;
@@ -119,8 +134,8 @@ std::vector<const MemoryRange>* EEHeapCommandParser::Parse(const std::string& li
 			std::getline(iss, line);
 			currentLine++;
 
-			//get the Large object heaps
-			while (std::getline(iss, line) && line.find("Total") == std::string::npos)
+			//get the Large object heaps, until Total Size or Heap Size of a server GC heap.
+			while (std::getline(iss, line) && line.find("Size:") == std::string::npos)
 			{
 				auto addressText = line.substr(10, 8);
 
@@ -0,0 +1,109 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file GCDesc.cpp
+
+Implements GCDesc class that reads GC descriptors of MethodTables.
+*/
+
+#include "GCDesc.h"
+
+const unsigned long GCDesc::CONTAINS_POINTERS_FLAG;
+const unsigned long GCDesc::MAX_SERIES;
+const unsigned long GCDesc::POINTER_SIZE;
+
+static unsigned long read_u32(const unsigned char* p)
+{
+	unsigned int v;
+
+	memcpy(&v, p, sizeof(v));
+
+	return v;
+}
+
+/**
+Reads the GC descriptor in front of a MethodTable, for types with the CONTAINS_POINTERS_FLAG only.
+
+\param memory_reader Memory reader.
+\param method_table MethodTable address.
+\return false if the descriptor cannot be read or has too many series.
+*/
+bool GCDesc::read(IMemoryReader* memory_reader, unsigned long method_table)
+{
+	Series.clear();
+	ValueSeries.clear();
+
+	unsigned char count_bytes[POINTER_SIZE];
+	unsigned long read = 0;
+
+	if (!memory_reader->ReadMemory(method_table - POINTER_SIZE, count_bytes, POINTER_SIZE, &read))
+	{
+		return false;
+	}
+
+	auto count = static_cast<long>(static_cast<int>(read_u32(count_bytes)));
+
+	if (count == 0 || count > static_cast<long>(MAX_SERIES) || -count > static_cast<long>(MAX_SERIES))
+	{
+		return count == 0;
+	}
+
+	// Series are below the count, the highest series is enumerated first.
+	auto series_size = count > 0 ? 2 * POINTER_SIZE * count : POINTER_SIZE * (-count - 1) + 2 * POINTER_SIZE;
+	auto series_address = method_table - POINTER_SIZE - series_size;
+
+	std::vector<unsigned char> bytes(series_size);
+
+	if (!memory_reader->ReadMemory(series_address, bytes.data(), series_size, &read))
+	{
+		return false;
+	}
+
+	if (count > 0)
+	{
+		for (long i = count - 1; i >= 0; i--)
+		{
+			auto series = bytes.data() + 2 * POINTER_SIZE * i;
+
+			Series.push_back(std::make_pair(static_cast<long>(static_cast<int>(read_u32(series))), read_u32(series + POINTER_SIZE)));
+		}
+	}
+	else
+	{
+		auto highest = bytes.data() + series_size - 2 * POINTER_SIZE;
+
+		ValueStartOffset = read_u32(highest + POINTER_SIZE);
+
+		for (long i = 0; i < -count; i++)
+		{
+			auto item = read_u32(highest - POINTER_SIZE * i);
+
+			ValueSeries.push_back(std::make_pair(static_cast<unsigned short>(item & 0xffff), static_cast<unsigned short>(item >> 16)));
+		}
+	}
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,242 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file GCHeapWalker.cpp
+
+Implements GCHeapWalker class that enumerates objects of GC heap segments through a memory reader.
+*/
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#include "GCHeapWalker.h"
+
+const unsigned long GCHeapWalker::WINDOW_SIZE;
+const unsigned long GCHeapWalker::POINTER_SIZE;
+const unsigned long GCHeapWalker::OBJECT_HEADER_SIZE;
+const unsigned long GCHeapWalker::MIN_OBJECT_SIZE;
+const unsigned long GCHeapWalker::LARGE_OBJECT_ALIGNMENT;
+const unsigned long GCHeapWalker::METHOD_TABLE_MARK_BITS;
+
+static unsigned long read_pointer(const unsigned char* p)
+{
+	unsigned int v;
+
+	memcpy(&v, p, sizeof(v));
+
+	return v;
+}
+
+/**
+Walks all segments.
+
+\param callback Invoked for each object, returns false to stop the walk.
+\return false if a segment could not be walked to its end.
+*/
+bool GCHeapWalker::walk(const GCHeapObjectCallback& callback)
+{
+	if (!_segments)
+	{
+		return false;
+	}
+
+	auto is_stopped = false;
+	auto is_complete = true;
+
+	auto stoppable_callback = [&](const GCHeapObject& object)
+	{
+		is_stopped = !callback(object);
+
+		return !is_stopped;
+	};
+
+	for (auto& segment : *_segments)
+	{
+		if (segment.Usage != Usage::GCHeap && segment.Usage != Usage::GCLOHeap)
+		{
+			continue;
+		}
+
+		is_complete = walk_segment(segment, stoppable_callback) && is_complete;
+
+		if (is_stopped)
+		{
+			break;
+		}
+	}
+
+	return is_complete;
+}
+
+/**
+Walks objects of a segment, starting from the first object up to the allocated end. Zeroed gaps left by allocation contexts are skipped.
+
+\param segment Segment range from !eeheap -gc.
+\param callback Invoked for each object, returns false to stop the walk.
+\return false if an object could not be read or has an invalid MethodTable or size.
+*/
+bool GCHeapWalker::walk_segment(const MemoryRange& segment, const GCHeapObjectCallback& callback)
+{
+	auto address = segment.Address;
+	auto end = segment.Address + std::min(segment.Size, ULONG_MAX - segment.Address);
+	auto is_large = segment.Usage == Usage::GCLOHeap;
+
+	_segment_end = end;
+
+	while (address < end && end - address >= MIN_OBJECT_SIZE)
+	{
+		auto header = read_window(address, OBJECT_HEADER_SIZE, end);
+
+		if (!header)
+		{
+			_logger->Log("Cannot read object at %x.\n", address);
+
+			return false;
+		}
+
+		auto method_table = read_pointer(header) & ~METHOD_TABLE_MARK_BITS;
+
+		if (method_table == 0)
+		{
+			_gap_bytes += POINTER_SIZE;
+			address += POINTER_SIZE;
+
+			continue;
+		}
+
+		unsigned long base_size;
+		unsigned long component_size;
+
+		if (!get_sizes(method_table, base_size, component_size))
+		{
+			_logger->Log("Invalid MethodTable %x of object at %x.\n", method_table, address);
+
+			return false;
+		}
+
+		unsigned long long size = base_size;
+
+		if (component_size != 0)
+		{
+			size += static_cast<unsigned long long>(component_size) * read_pointer(header + POINTER_SIZE);
+		}
+
+		size = (size + POINTER_SIZE - 1) & ~static_cast<unsigned long long>(POINTER_SIZE - 1);
+
+		if (size > end - address)
+		{
+			_logger->Log("Invalid size %llx of object at %x.\n", size, address);
+
+			return false;
+		}
+
+		_objects++;
+
+		if (!callback(GCHeapObject(address, method_table, static_cast<unsigned long>(size))))
+		{
+			return true;
+		}
+
+		address += static_cast<unsigned long>(size);
+
+		if (is_large)
+		{
+			address = (address + LARGE_OBJECT_ALIGNMENT - 1) & ~(LARGE_OBJECT_ALIGNMENT - 1);
+		}
+	}
+
+	return true;
+}
+
+/**
+Reads all bytes of an object found by the current walk, from the same window as object headers.
+Only valid in the callback of walk_segment, until the callback returns.
+
+\param object Object passed to the callback.
+\return Pointer to Size bytes from the object address, or nullptr if they cannot be read.
+*/
+const unsigned char* GCHeapWalker::read_object(const GCHeapObject& object)
+{
+	return read_window(object.Address, object.Size, std::max(_segment_end, object.Address + object.Size));
+}
+
+/**
+Returns target memory from a window that is refilled with one read of up to WINDOW_SIZE bytes when a request falls outside of it.
+
+\param address Target address.
+\param size Number of bytes needed.
+\param limit Address that the window does not extend past.
+\return Pointer to the bytes, or nullptr if they cannot be read.
+*/
+const unsigned char* GCHeapWalker::read_window(unsigned long address, unsigned long size, unsigned long limit)
+{
+	if (address >= _window_address && address - _window_address + size <= _window_size)
+	{
+		return _window.data() + (address - _window_address);
+	}
+
+	auto count = std::max(size, std::min(WINDOW_SIZE, limit - address));
+
+	_window.resize(std::max(count, WINDOW_SIZE));
+
+	unsigned long read = 0;
+
+	_memory_reader->ReadMemory(address, _window.data(), count, &read);
+
+	_window_address = address;
+	_window_size = read;
+
+	return read >= size ? _window.data() : nullptr;
+}
+
+/**
+Gets base size and component size of a MethodTable from a map of this walker, in front of the shared cache.
+
+\param method_table MethodTable address.
+\param base_size Base size of instances, including the object header.
+\param component_size Size of array elements or string characters, zero for other types.
+\return false if the MethodTable is not valid.
+*/
+bool GCHeapWalker::get_sizes(unsigned long method_table, unsigned long& base_size, unsigned long& component_size)
+{
+	auto it = _method_table_sizes.find(method_table);
+
+	if (it == _method_table_sizes.end())
+	{
+		if (!_method_table_cache->get_sizes(method_table, base_size, component_size))
+		{
+			base_size = 0;
+		}
+
+		it = _method_table_sizes.insert(std::make_pair(method_table, std::make_pair(base_size, component_size))).first;
+	}
+
+	base_size = it->second.first;
+	component_size = it->second.second;
+
+	return base_size != 0;
+}
\ No newline at end of file
@@ -0,0 +1,158 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file GCRootsCommandParser.cpp
+
+Implements GCRootsCommandParser class that parses !gchandles and !dumpstackobjects outputs.
+*/
+
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+
+#include "GCRootsCommandParser.h"
+
+// Weak handles do not keep objects alive.
+static const char* StrongHandleTypes[] = { "Strong", "Pinned", "RefCounted", "AsyncPinned", "SizedRef" };
+
+/**
+Executes gchandles and dumpstackobjects commands on all threads, and parses the outputs.
+SOS versions that only print handle statistics yield stack roots only.
+
+\return Sorted addresses of root objects, without duplicates.
+*/
+std::vector<unsigned long> GCRootsCommandParser::execute()
+{
+	std::vector<unsigned long> roots;
+
+	std::string output;
+
+	if (_executor->ExecuteCommand(_command_handles, output))
+	{
+		ParseHandles(output, roots);
+	}
+	else
+	{
+		_logger->Log("Cannot get gchandles info.\n");
+	}
+
+	output.clear();
+
+	if (_executor->ExecuteCommand(_command_stack_objects, output))
+	{
+		ParseStackObjects(output, roots);
+	}
+	else
+	{
+		_logger->Log("Cannot get dumpstackobjects info.\n");
+	}
+
+	std::sort(roots.begin(), roots.end());
+
+	roots.erase(std::unique(roots.begin(), roots.end()), roots.end());
+
+	return roots;
+}
+
+/**
+Checks if a token is a pointer sized hexadecimal number.
+
+\param text Token.
+*/
+bool GCRootsCommandParser::IsAddress(const std::string& text)
+{
+	return text.size() == 8 && text.find_first_not_of("0123456789abcdefABCDEF") == std::string::npos;
+}
+
+/**
+Parses "Handle Type Object Size Data Type" lines of a gchandles output, adding objects of strong handles.
+
+\param lines gchandles output lines.
+\param roots Vector to add object addresses to.
+*/
+void GCRootsCommandParser::ParseHandles(const std::string& lines, std::vector<unsigned long>& roots)
+{
+	std::istringstream iss(lines);
+
+	std::string line;
+
+	while (std::getline(iss, line))
+	{
+		std::istringstream line_stream(line);
+		std::vector<std::string> items((std::istream_iterator<std::string>(line_stream)), std::istream_iterator<std::string>());
+
+		if (items.size() < 3 || !IsAddress(items[0]) || !IsAddress(items[2]))
+		{
+			continue;
+		}
+
+		if (std::find(std::begin(StrongHandleTypes), std::end(StrongHandleTypes), items[1]) == std::end(StrongHandleTypes))
+		{
+			continue;
+		}
+
+		try{
+			roots.push_back(std::stoul(items[2], nullptr, 16));
+		}
+		catch (std::invalid_argument)
+		{
+			_logger->Log("Handle cannot be read: %s\n", line.c_str());
+		}
+	}
+}
+
+/**
+Parses "ESP/REG Object Name" lines of a dumpstackobjects output.
+
+\param lines dumpstackobjects output lines.
+\param roots Vector to add object addresses to.
+*/
+void GCRootsCommandParser::ParseStackObjects(const std::string& lines, std::vector<unsigned long>& roots)
+{
+	std::istringstream iss(lines);
+
+	std::string line;
+
+	while (std::getline(iss, line))
+	{
+		std::istringstream line_stream(line);
+		std::vector<std::string> items((std::istream_iterator<std::string>(line_stream)), std::istream_iterator<std::string>());
+
+		// Registers are listed by name, stack slots by address.
+		if (items.size() < 3 || !IsAddress(items[1]) || (!IsAddress(items[0]) && items[0].size() != 3))
+		{
+			continue;
+		}
+
+		try{
+			roots.push_back(std::stoul(items[1], nullptr, 16));
+		}
+		catch (std::invalid_argument)
+		{
+			_logger->Log("Stack object cannot be read: %s\n", line.c_str());
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,363 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file HeapMapAggregator.cpp
+
+Implements HeapMapAggregator class that renders heap maps of any size by counting bytes of each usage under pixels.
+*/
+
+#include <algorithm>
+
+#include "HeapMapAggregator.h"
+#include "HeapMapRasterizer.h"
+
+const unsigned long long HeapMapAggregator::ADDRESS_SPACE_SIZE;
+const unsigned int HeapMapAggregator::STATE_COUNT;
+const unsigned int HeapMapAggregator::USAGE_COUNT;
+
+/**
+\param width Width of the map.
+\param height Height of the map.
+\param aggregation Coloring of pixels.
+*/
+HeapMapAggregator::HeapMapAggregator(unsigned int width, unsigned int height, HeapMapAggregation aggregation)
+	: _width(width), _height(height), _aggregation(aggregation)
+{
+
+}
+
+/**
+Adds ranges to count, bytes of all layers are counted together.
+
+\param ranges Memory ranges.
+\param is_monochrome True to count ranges that are not free as undefined usage.
+*/
+void HeapMapAggregator::add_layer(RangeList ranges, bool is_monochrome)
+{
+	if (ranges != nullptr)
+	{
+		_layers.push_back(std::make_pair(ranges, is_monochrome));
+	}
+}
+
+/**
+Shows or hides ranges of a usage in all layers, bytes of hidden ranges are counted as background.
+
+\param usage Usage.
+\param is_visible True to count ranges of the usage.
+*/
+void HeapMapAggregator::set_visible(Usage usage, bool is_visible)
+{
+	auto bit = 1u << (unsigned int) usage;
+
+	_hidden_usages = is_visible ? _hidden_usages & ~bit : _hidden_usages | bit;
+}
+
+/**
+Checks if ranges of a usage are counted.
+
+\param usage Usage.
+*/
+bool HeapMapAggregator::is_visible(Usage usage) const
+{
+	return (_hidden_usages & (1u << (unsigned int) usage)) == 0;
+}
+
+/**
+Gets the first address of a pixel, pixels start at rounded up multiples of the address space divided by the number of pixels.
+
+\param pixel Pixel index in column order, up to the number of pixels.
+*/
+unsigned long long HeapMapAggregator::get_pixel_address(unsigned long long pixel) const
+{
+	auto pixel_count = (unsigned long long) _width * _height;
+
+	return (pixel * ADDRESS_SPACE_SIZE + pixel_count - 1) / pixel_count;
+}
+
+/**
+Gets the pixel an address is in.
+
+\param address Address.
+\return Pixel index in column order.
+*/
+unsigned long long HeapMapAggregator::get_pixel(unsigned long long address) const
+{
+	return address * ((unsigned long long) _width * _height) / ADDRESS_SPACE_SIZE;
+}
+
+/**
+Renders the map. Ranges are grouped by layer, state and usage, then bytes of each group are counted and merged into the pixels its ranges cover,
+walking the ranges in address order so pixels without ranges of the group are skipped. Ties of the dominant usage go to later groups, so ranges of later layers win over ranges of earlier layers that cover the same bytes.
+
+\param buffer Buffer of 4 * width * height bytes, pixels are in the format of HeapMapRasterizer.
+*/
+void HeapMapAggregator::render(unsigned char* buffer)
+{
+	auto pixel_count = (size_t) _width * _height;
+
+	if (pixel_count == 0)
+	{
+		return;
+	}
+
+	_starts.assign(pixel_count + 1, 0);
+	_bytes.assign(pixel_count, 0);
+
+	if (_aggregation == HeapMapAggregation::Dominant)
+	{
+		_best_bytes.assign(pixel_count, 0);
+		_best_colors.assign(pixel_count, HeapMapRasterizer::get_color(State::Undefined, Usage::Undefined));
+	}
+	else
+	{
+		_sums.assign(4 * pixel_count, 0);
+	}
+
+	std::vector<std::vector<const MemoryRange*>> groups(_layers.size() * STATE_COUNT * USAGE_COUNT);
+
+	for (size_t layer = 0; layer < _layers.size(); layer++)
+	{
+		for (auto& range : *_layers[layer].first)
+		{
+			if (!is_visible(range.Usage))
+			{
+				continue;
+			}
+
+			auto usage = _layers[layer].second && range.Usage != Usage::Free ? Usage::Undefined : range.Usage;
+
+			groups[(layer * STATE_COUNT + (unsigned int) range.State) * USAGE_COUNT + (unsigned int) usage].push_back(&range);
+		}
+	}
+
+	_pixel_size = ADDRESS_SPACE_SIZE % pixel_count == 0 ? ADDRESS_SPACE_SIZE / pixel_count : 0;
+
+	for (size_t group = 0; group < groups.size(); group++)
+	{
+		if (groups[group].empty())
+		{
+			continue;
+		}
+
+		auto state = (State) (group / USAGE_COUNT % STATE_COUNT);
+		auto usage = (Usage) (group % USAGE_COUNT);
+		auto color = HeapMapRasterizer::get_color(state, usage);
+
+		auto& ranges = groups[group];
+
+		auto is_before = [](const MemoryRange* a, const MemoryRange* b){ return a->Address < b->Address; };
+
+		// Ranges from VirtualQuery and eeheap are usually sorted already.
+		if (!std::is_sorted(ranges.begin(), ranges.end(), is_before))
+		{
+			std::stable_sort(ranges.begin(), ranges.end(), is_before);
+		}
+
+		count(ranges);
+
+		int covering = 0;
+		size_t next_pixel = 0;
+
+		for (auto range : ranges)
+		{
+			size_t first;
+			size_t last;
+
+			if (!get_pixels(*range, first, last) || last < next_pixel)
+			{
+				continue;
+			}
+
+			for (auto pixel = std::max(first, next_pixel); pixel <= last; pixel++)
+			{
+				merge(pixel, color, covering);
+			}
+
+			next_pixel = last + 1;
+		}
+	}
+
+	auto pixels = reinterpret_cast<unsigned int*>(buffer);
+	auto background = HeapMapRasterizer::get_color(State::Undefined, Usage::Undefined);
+
+	for (size_t pixel = 0; pixel < pixel_count; pixel++)
+	{
+		unsigned int color;
+
+		if (_aggregation == HeapMapAggregation::Dominant)
+		{
+			color = _best_colors[pixel];
+		}
+		else
+		{
+			auto sums = &_sums[4 * pixel];
+			auto size = get_pixel_size(pixel);
+
+			// Bytes without ranges are blended in the background color.
+			auto empty = sums[3] < size ? size - sums[3] : 0;
+			auto total = sums[3] + empty;
+
+			color = 0;
+
+			for (int channel = 0; channel < 3; channel++)
+			{
+				auto value = (sums[channel] + empty * ((background >> (16 - 8 * channel)) & 0xFF)) / total;
+
+				color |= (unsigned int) value << (16 - 8 * channel);
+			}
+		}
+
+		auto offset = _curve ? _curve->get_offset(pixel) : (pixel % _height) * _width + pixel / _height;
+
+		pixels[offset] = HeapMapRasterizer::to_pixel(color);
+	}
+}
+
+/**
+Merges the counted bytes of a group in a pixel into the pixel, and clears the counts.
+
+\param pixel Pixel index in column order.
+\param color Color of the group.
+\param covering Number of ranges covering pixels before this one, updated for this pixel.
+*/
+void HeapMapAggregator::merge(size_t pixel, unsigned int color, int& covering)
+{
+	covering += _starts[pixel];
+
+	_starts[pixel] = 0;
+
+	auto bytes = _bytes[pixel];
+
+	_bytes[pixel] = 0;
+
+	if (covering != 0)
+	{
+		bytes += (unsigned long long) covering * get_pixel_size(pixel);
+	}
+
+	if (bytes == 0)
+	{
+		return;
+	}
+
+	if (_aggregation == HeapMapAggregation::Dominant)
+	{
+		if (bytes >= _best_bytes[pixel])
+		{
+			_best_bytes[pixel] = bytes;
+			_best_colors[pixel] = color;
+		}
+	}
+	else
+	{
+		auto sums = &_sums[4 * pixel];
+
+		sums[0] += bytes * ((color >> 16) & 0xFF);
+		sums[1] += bytes * ((color >> 8) & 0xFF);
+		sums[2] += bytes * (color & 0xFF);
+		sums[3] += bytes;
+	}
+}
+
+/**
+Gets the number of bytes in a pixel.
+
+\param pixel Pixel index in column order.
+*/
+unsigned long long HeapMapAggregator::get_pixel_size(size_t pixel) const
+{
+	// Pixels of maps that split the address space evenly have the same size.
+	if (_pixel_size != 0)
+	{
+		return _pixel_size;
+	}
+
+	return get_pixel_address(pixel + 1) - get_pixel_address(pixel);
+}
+
+/**
+Gets the pixels a range has bytes in.
+
+\param range Memory range.
+\param first Receives the first pixel.
+\param last Receives the last pixel.
+\return false if the range has no bytes in the address space.
+*/
+bool HeapMapAggregator::get_pixels(const MemoryRange& range, size_t& first, size_t& last) const
+{
+	auto start = (unsigned long long) range.Address;
+	auto end = std::min(start + range.Size, ADDRESS_SPACE_SIZE);
+
+	if (start >= end)
+	{
+		return false;
+	}
+
+	first = (size_t) get_pixel(start);
+	last = (size_t) get_pixel(end - 1);
+
+	return true;
+}
+
+/**
+Counts bytes of ranges over pixels. Bytes in the first and last pixels of a range are added to the pixels,
+pixels between them are marked in a difference array whose running sum is the number of ranges covering a pixel.
+
+\param ranges Memory ranges.
+*/
+void HeapMapAggregator::count(const std::vector<const MemoryRange*>& ranges)
+{
+	for (auto range : ranges)
+	{
+		size_t first;
+		size_t last;
+
+		if (!get_pixels(*range, first, last))
+		{
+			continue;
+		}
+
+		auto start = (unsigned long long) range->Address;
+		auto end = std::min(start + range->Size, ADDRESS_SPACE_SIZE);
+
+		if (first == last)
+		{
+			_bytes[first] += end - start;
+
+			continue;
+		}
+
+		_bytes[first] += get_pixel_address(first + 1) - start;
+		_bytes[last] += end - get_pixel_address(last);
+
+		if (last > first + 1)
+		{
+			_starts[first + 1]++;
+			_starts[last]--;
+		}
+	}
+}
\ No newline at end of file
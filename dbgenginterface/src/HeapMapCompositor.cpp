@@ -0,0 +1,617 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file HeapMapCompositor.cpp
+
+Implements HeapMapCompositor class that composites coverage masks of usages to heap maps.
+*/
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#define HEAPMAPCOMPOSITOR_SSE2
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+#include "HeapMapCompositor.h"
+#include "ParallelFor.h"
+
+const unsigned int HeapMapCompositor::STATE_COUNT;
+const unsigned int HeapMapCompositor::USAGE_COUNT;
+const unsigned int HeapMapCompositor::TILE_WIDTH;
+const unsigned int HeapMapCompositor::MAX_DEPTH;
+
+/**
+Initializes a compositor without layers, all usages are visible.
+
+\param width Width of the map in pixels.
+\param height Height of the map in pixels.
+*/
+HeapMapCompositor::HeapMapCompositor(unsigned int width, unsigned int height)
+	: _width(width), _height(height)
+{
+
+}
+
+/**
+Gets the pages of a range on the map.
+
+\param range Memory range.
+\param first_page Receives the first page.
+\param end_page Receives the page after the range, clipped to the map.
+\return false if the range has no pages on the map.
+*/
+bool HeapMapCompositor::get_pages(const MemoryRange& range, unsigned long& first_page, unsigned long& end_page) const
+{
+	first_page = range.Address / HeapMapRasterizer::PAGE_SIZE;
+	end_page = std::min((unsigned long) _width * _height, first_page + HeapMapRasterizer::get_page_count(range));
+
+	return first_page < end_page;
+}
+
+/**
+Renders ranges to masks of a new layer, one mask for each state and usage of the ranges.
+
+\param ranges Memory ranges, can be null for a layer without masks.
+\param thread_count Number of threads filling masks, 0 for the number of processors.
+\return Index of the layer.
+*/
+unsigned int HeapMapCompositor::add_layer(RangeList ranges, unsigned int thread_count)
+{
+	auto layer = (unsigned int) _ranges.size();
+
+	_ranges.push_back(ranges);
+
+	add_masks(layer, ranges, thread_count);
+
+	return layer;
+}
+
+/**
+Renders ranges to masks of a layer that has no masks. Masks are filled in tiles of TILE_WIDTH columns on multiple threads,
+each tile finds the ranges overlapping it with a HeapMapRangeIndex and draws them in range order, so tiles write disjoint pages of the masks.
+
+\param layer Index of the layer.
+\param ranges Memory ranges, can be null.
+\param thread_count Number of threads, 0 for the number of processors.
+*/
+void HeapMapCompositor::add_masks(unsigned int layer, RangeList ranges, unsigned int thread_count)
+{
+	if (!ranges)
+	{
+		return;
+	}
+
+	std::vector<unsigned long> first_pages(STATE_COUNT * USAGE_COUNT, ULONG_MAX);
+	std::vector<unsigned long> end_pages(STATE_COUNT * USAGE_COUNT, 0);
+
+	unsigned long first_page;
+	unsigned long end_page;
+
+	for (auto& range : *ranges)
+	{
+		if (get_pages(range, first_page, end_page))
+		{
+			auto group = (unsigned int) range.State * USAGE_COUNT + (unsigned int) range.Usage;
+
+			first_pages[group] = std::min(first_pages[group], first_page);
+			end_pages[group] = std::max(end_pages[group], end_page);
+		}
+	}
+
+	// Masks are created once with their final size, so adding masks does not copy coverage.
+	std::vector<size_t> masks(first_pages.size());
+
+	_masks.reserve(_masks.size() + std::count_if(end_pages.begin(), end_pages.end(), [](unsigned long page){ return page != 0; }));
+
+	for (unsigned int group = 0; group < first_pages.size(); group++)
+	{
+		if (end_pages[group] != 0)
+		{
+			masks[group] = _masks.size();
+
+			_masks.push_back(HeapMapMask(layer, (State) (group / USAGE_COUNT), (Usage) (group % USAGE_COUNT), first_pages[group], end_pages[group]));
+		}
+	}
+
+	if (thread_count == 0)
+	{
+		thread_count = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	HeapMapRangeIndex index(ranges);
+
+	auto tile_pages = (unsigned long) TILE_WIDTH * _height;
+	auto tile_count = ((size_t) _width + TILE_WIDTH - 1) / TILE_WIDTH;
+
+	// A range is one deeper than the ranges drawn before it on each of its pages, ranges in page order without overlaps are all at the first depth.
+	parallel_for(thread_count, tile_count, [&](size_t tile)
+	{
+		auto tile_first_page = (unsigned long) tile * tile_pages;
+		auto tile_end_page = std::min((unsigned long) _width * _height, tile_first_page + tile_pages);
+
+		std::vector<unsigned int> indexes;
+		std::vector<unsigned char> depths(tile_end_page - tile_first_page, 0);
+
+		index.find(tile_first_page, tile_end_page, indexes);
+
+		for (auto i : indexes)
+		{
+			auto& range = index.get(i);
+
+			unsigned long range_first_page;
+			unsigned long range_end_page;
+
+			get_pages(range, range_first_page, range_end_page);
+
+			range_first_page = std::max(range_first_page, tile_first_page);
+			range_end_page = std::min(range_end_page, tile_end_page);
+
+			auto& mask = _masks[masks[(unsigned int) range.State * USAGE_COUNT + (unsigned int) range.Usage]];
+
+			auto depth = &depths[range_first_page - tile_first_page];
+			auto coverage = &mask.Coverage[range_first_page - mask.FirstPage];
+
+			for (unsigned long page = 0; page < range_end_page - range_first_page; page++)
+			{
+				depth[page] = (unsigned char) std::min<unsigned int>(MAX_DEPTH, depth[page] + 1u);
+				coverage[page] = depth[page];
+			}
+		}
+	});
+}
+
+/**
+Compares ranges of a layer with new ranges, ranges with the same pages, state and usage are kept.
+
+\param old_ranges Ranges of the layer.
+\param new_ranges New ranges of the layer.
+\param spans Receives the changed spans of pages in page order, pages of ranges found in only one of the lists.
+\param added Receives indexes of the new ranges not found in the layer.
+\return false if ranges of either list are not in page order or overlap, then spans are not complete.
+*/
+bool HeapMapCompositor::get_changed_spans(const std::vector<const MemoryRange>& old_ranges, const std::vector<const MemoryRange>& new_ranges,
+	std::vector<std::pair<unsigned long, unsigned long>>& spans, std::vector<size_t>& added) const
+{
+	spans.clear();
+	added.clear();
+
+	auto add_span = [&](unsigned long first_page, unsigned long end_page)
+	{
+		if (!spans.empty() && spans.back().second >= first_page)
+		{
+			spans.back().second = std::max(spans.back().second, end_page);
+		}
+		else
+		{
+			spans.push_back(std::make_pair(first_page, end_page));
+		}
+	};
+
+	auto next = [&](const std::vector<const MemoryRange>& ranges, size_t& index, unsigned long& first_page, unsigned long& end_page)
+	{
+		for (; index < ranges.size(); index++)
+		{
+			if (get_pages(ranges[index], first_page, end_page))
+			{
+				return true;
+			}
+		}
+
+		return false;
+	};
+
+	size_t a = 0;
+	size_t b = 0;
+	unsigned long first_a;
+	unsigned long end_a;
+	unsigned long first_b;
+	unsigned long end_b;
+	unsigned long max_end_a = 0;
+	unsigned long max_end_b = 0;
+
+	auto has_a = next(old_ranges, a, first_a, end_a);
+	auto has_b = next(new_ranges, b, first_b, end_b);
+
+	while (has_a || has_b)
+	{
+		auto is_in_a = has_a && (!has_b || first_a <= first_b);
+		auto is_in_b = has_b && (!has_a || first_b <= first_a);
+
+		if ((is_in_a && first_a < max_end_a) || (is_in_b && first_b < max_end_b))
+		{
+			return false;
+		}
+
+		auto is_same = is_in_a && is_in_b && end_a == end_b && old_ranges[a].State == new_ranges[b].State && old_ranges[a].Usage == new_ranges[b].Usage;
+
+		if (is_in_a)
+		{
+			if (!is_same)
+			{
+				add_span(first_a, end_a);
+			}
+
+			max_end_a = end_a;
+			has_a = next(old_ranges, ++a, first_a, end_a);
+		}
+
+		if (is_in_b)
+		{
+			if (!is_same)
+			{
+				add_span(first_b, end_b);
+				added.push_back(b);
+			}
+
+			max_end_b = end_b;
+			has_b = next(new_ranges, ++b, first_b, end_b);
+		}
+	}
+
+	return true;
+}
+
+/**
+Replaces the ranges of a layer. If the ranges of the layer and the new ranges are in page order without overlaps, masks are kept
+and only the pages of ranges that differ are cleared and rendered again, masks grow for new ranges past them.
+Otherwise masks of the layer are rendered again.
+
+\param layer Index of the layer.
+\param ranges New memory ranges, can be null for a layer without masks.
+*/
+void HeapMapCompositor::update_layer(unsigned int layer, RangeList ranges)
+{
+	auto old_ranges = _ranges[layer];
+
+	_ranges[layer] = ranges;
+
+	if (old_ranges == ranges)
+	{
+		return;
+	}
+
+	std::vector<std::pair<unsigned long, unsigned long>> spans;
+	std::vector<size_t> added;
+
+	if (!old_ranges || !ranges || !get_changed_spans(*old_ranges, *ranges, spans, added))
+	{
+		_masks.erase(std::remove_if(_masks.begin(), _masks.end(), [&](const HeapMapMask& mask){ return mask.Layer == layer; }), _masks.end());
+
+		add_masks(layer, ranges, 0);
+
+		return;
+	}
+
+	if (spans.empty())
+	{
+		return;
+	}
+
+	for (auto& mask : _masks)
+	{
+		if (mask.Layer != layer)
+		{
+			continue;
+		}
+
+		auto span = std::upper_bound(spans.begin(), spans.end(), mask.FirstPage, [](unsigned long page, const std::pair<unsigned long, unsigned long>& span){ return page < span.second; });
+
+		for (; span != spans.end() && span->first < mask.get_end_page(); ++span)
+		{
+			auto first_page = std::max(span->first, mask.FirstPage);
+			auto end_page = std::min(span->second, mask.get_end_page());
+
+			std::memset(&mask.Coverage[first_page - mask.FirstPage], 0, end_page - first_page);
+		}
+	}
+
+	std::vector<unsigned long> first_pages(STATE_COUNT * USAGE_COUNT, ULONG_MAX);
+	std::vector<unsigned long> end_pages(STATE_COUNT * USAGE_COUNT, 0);
+
+	unsigned long first_page;
+	unsigned long end_page;
+
+	for (auto i : added)
+	{
+		auto& range = (*ranges)[i];
+
+		get_pages(range, first_page, end_page);
+
+		auto group = (unsigned int) range.State * USAGE_COUNT + (unsigned int) range.Usage;
+
+		first_pages[group] = std::min(first_pages[group], first_page);
+		end_pages[group] = std::max(end_pages[group], end_page);
+	}
+
+	// Masks grow once to the pages of their added ranges, masks of new states and usages are added.
+	std::vector<size_t> masks(first_pages.size(), SIZE_MAX);
+
+	for (size_t i = 0; i < _masks.size(); i++)
+	{
+		if (_masks[i].Layer == layer)
+		{
+			masks[(unsigned int) _masks[i].State * USAGE_COUNT + (unsigned int) _masks[i].Usage] = i;
+		}
+	}
+
+	for (unsigned int group = 0; group < first_pages.size(); group++)
+	{
+		if (end_pages[group] == 0)
+		{
+			continue;
+		}
+
+		if (masks[group] == SIZE_MAX)
+		{
+			masks[group] = _masks.size();
+
+			_masks.push_back(HeapMapMask(layer, (State) (group / USAGE_COUNT), (Usage) (group % USAGE_COUNT), first_pages[group], end_pages[group]));
+
+			continue;
+		}
+
+		auto& mask = _masks[masks[group]];
+
+		if (first_pages[group] < mask.FirstPage || end_pages[group] > mask.get_end_page())
+		{
+			auto mask_first_page = std::min(first_pages[group], mask.FirstPage);
+			auto mask_end_page = std::max(end_pages[group], mask.get_end_page());
+
+			std::vector<unsigned char> coverage(mask_end_page - mask_first_page);
+
+			std::copy(mask.Coverage.begin(), mask.Coverage.end(), coverage.begin() + (mask.FirstPage - mask_first_page));
+
+			mask.Coverage.swap(coverage);
+			mask.FirstPage = mask_first_page;
+		}
+	}
+
+	for (auto i : added)
+	{
+		auto& range = (*ranges)[i];
+		auto& mask = _masks[masks[(unsigned int) range.State * USAGE_COUNT + (unsigned int) range.Usage]];
+
+		get_pages(range, first_page, end_page);
+
+		std::memset(&mask.Coverage[first_page - mask.FirstPage], 1, end_page - first_page);
+	}
+}
+
+/**
+Removes all layers and their masks, visibility of usages is kept.
+*/
+void HeapMapCompositor::clear()
+{
+	_masks.clear();
+	_ranges.clear();
+}
+
+/**
+Shows or hides ranges of a usage in all layers.
+
+\param usage Usage.
+\param is_visible True to show ranges of the usage.
+*/
+void HeapMapCompositor::set_visible(Usage usage, bool is_visible)
+{
+	auto bit = 1u << (unsigned int) usage;
+
+	_hidden_usages = is_visible ? _hidden_usages & ~bit : _hidden_usages | bit;
+}
+
+/**
+Checks if ranges of a usage are composited.
+
+\param usage Usage.
+*/
+bool HeapMapCompositor::is_visible(Usage usage) const
+{
+	return (_hidden_usages & (1u << (unsigned int) usage)) == 0;
+}
+
+/**
+Sets pages where a mask is deeper than the pages drawn before to a pixel, 16 pages at a time.
+
+\param pages Pages to set.
+\param depths Depths of the pages drawn before, 0 for background pages, set to the depths of the mask where it is drawn.
+\param coverage Depths of the mask, 0 for pages without ranges.
+\param count Number of pages.
+\param pixel Pixel of covered pages.
+*/
+void HeapMapCompositor::blend(unsigned int* pages, unsigned char* depths, const unsigned char* coverage, size_t count, unsigned int pixel)
+{
+	size_t i = 0;
+
+#ifdef HEAPMAPCOMPOSITOR_SSE2
+	auto color = _mm_set1_epi32((int) pixel);
+	auto ones = _mm_set1_epi8(-1);
+
+	for (; i + 16 <= count; i += 16)
+	{
+		auto cover = _mm_loadu_si128(reinterpret_cast<const __m128i*>(coverage + i));
+		auto depth = _mm_loadu_si128(reinterpret_cast<const __m128i*>(depths + i));
+		auto max_depth = _mm_max_epu8(cover, depth);
+
+		// Pages where the mask is not deeper keep their pixel.
+		auto mask = _mm_xor_si128(_mm_cmpeq_epi8(max_depth, depth), ones);
+		auto bits = _mm_movemask_epi8(mask);
+
+		if (bits == 0)
+		{
+			continue;
+		}
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(depths + i), max_depth);
+
+		auto target = reinterpret_cast<__m128i*>(pages + i);
+
+		if (bits == 0xffff)
+		{
+			for (int j = 0; j < 4; j++)
+			{
+				_mm_storeu_si128(target + j, color);
+			}
+
+			continue;
+		}
+
+		// Widen select bytes to 32-bit selects, one for each page.
+		auto low = _mm_unpacklo_epi8(mask, mask);
+		auto high = _mm_unpackhi_epi8(mask, mask);
+
+		__m128i selects[4] = { _mm_unpacklo_epi16(low, low), _mm_unpackhi_epi16(low, low), _mm_unpacklo_epi16(high, high), _mm_unpackhi_epi16(high, high) };
+
+		for (int j = 0; j < 4; j++)
+		{
+			auto value = _mm_loadu_si128(target + j);
+
+			_mm_storeu_si128(target + j, _mm_or_si128(_mm_and_si128(selects[j], color), _mm_andnot_si128(selects[j], value)));
+		}
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		if (coverage[i] > depths[i])
+		{
+			pages[i] = pixel;
+			depths[i] = coverage[i];
+		}
+	}
+}
+
+/**
+Composites masks of visible usages in the layers of a map to a tile of columns and copies it to the image buffer of the map.
+
+\param map Layers and image buffer of the map.
+\param first_column First column of the tile.
+\param end_column Column after the tile.
+\param pages Buffer for pages of the tile, can be reused across tiles.
+*/
+void HeapMapCompositor::composite(const HeapMapComposition& map, unsigned int first_column, unsigned int end_column, std::vector<unsigned int>& pages) const
+{
+	auto first_page = (unsigned long) first_column * _height;
+	auto end_page = (unsigned long) end_column * _height;
+
+	pages.assign(end_page - first_page, HeapMapRasterizer::BACKGROUND);
+
+	std::vector<unsigned char> depths;
+
+	for (auto& layer : map.Layers)
+	{
+		// Any page of a layer is drawn over pages of the layers before it.
+		depths.assign(end_page - first_page, 0);
+
+		for (auto& mask : _masks)
+		{
+			if (mask.Layer != layer.first || !is_visible(mask.Usage))
+			{
+				continue;
+			}
+
+			auto mask_first_page = std::max(first_page, mask.FirstPage);
+			auto mask_end_page = std::min(end_page, mask.get_end_page());
+
+			if (mask_first_page >= mask_end_page)
+			{
+				continue;
+			}
+
+			auto usage = layer.second && mask.Usage != Usage::Free ? Usage::Undefined : mask.Usage;
+
+			blend(&pages[mask_first_page - first_page], &depths[mask_first_page - first_page], &mask.Coverage[mask_first_page - mask.FirstPage], mask_end_page - mask_first_page, HeapMapRasterizer::to_pixel(HeapMapRasterizer::get_color(mask.State, usage)));
+		}
+	}
+
+	if (_curve)
+	{
+		_curve->copy_to(pages.data(), first_page, end_page, map.Buffer);
+	}
+	else
+	{
+		HeapMapRasterizer::copy_columns(pages.data(), _width, _height, map.Buffer, first_column, end_column);
+	}
+}
+
+/**
+Composites the rectangles of a map on the calling thread.
+
+\param map Layers, image buffer and rectangles of the map.
+*/
+void HeapMapCompositor::composite(const HeapMapComposition& map) const
+{
+	composite_parallel(std::vector<HeapMapComposition>(1, map), 1);
+}
+
+/**
+Composites the columns of rectangles of maps in tiles of at most TILE_WIDTH columns on multiple threads, other pixels of the image buffers are kept.
+
+\param maps Layers, image buffers and rectangles of the maps, rectangles of a map in disjoint columns.
+\param thread_count Number of threads, 0 for the number of processors.
+*/
+void HeapMapCompositor::composite_parallel(const std::vector<HeapMapComposition>& maps, unsigned int thread_count) const
+{
+	struct Tile
+	{
+		size_t Map;
+		unsigned int FirstColumn;
+		unsigned int EndColumn;
+	};
+
+	std::vector<Tile> tiles;
+
+	for (size_t i = 0; i < maps.size(); i++)
+	{
+		for (auto& rect : maps[i].Rects)
+		{
+			auto end_column = std::min(_width, rect.X + rect.Width);
+
+			for (auto column = rect.X; column < end_column; column += TILE_WIDTH)
+			{
+				Tile tile = { i, column, std::min(end_column, column + TILE_WIDTH) };
+
+				tiles.push_back(tile);
+			}
+		}
+	}
+
+	if (thread_count == 0)
+	{
+		thread_count = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	parallel_for(thread_count, tiles.size(), [&](size_t i)
+	{
+		std::vector<unsigned int> pages;
+
+		composite(maps[tiles[i].Map], tiles[i].FirstColumn, tiles[i].EndColumn, pages);
+	});
+}
\ No newline at end of file
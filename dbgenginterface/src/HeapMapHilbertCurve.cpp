@@ -0,0 +1,181 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file HeapMapHilbertCurve.cpp
+
+Implements HeapMapHilbertCurve class that lays out heap map pixels along a Hilbert curve.
+*/
+
+#include <algorithm>
+
+#include "HeapMapHilbertCurve.h"
+#include "HeapMapRasterizer.h"
+
+/**
+Quadrants of the Hilbert curve for each of its four orientations, indexed by orientation and the next two bits of the index.
+Entries hold the next orientation in bits 2-3, the x bit in bit 1 and the y bit in bit 0.
+*/
+static const unsigned char HilbertStates[4][4] =
+{
+	{ 0x04, 0x01, 0x03, 0x0A },
+	{ 0x00, 0x06, 0x07, 0x0D },
+	{ 0x0F, 0x09, 0x08, 0x02 },
+	{ 0x0B, 0x0E, 0x0C, 0x05 }
+};
+
+/**
+Computes positions of all pixels of a map.
+
+\param width Width of the map, a supported size.
+\param height Height of the map, a supported size.
+*/
+HeapMapHilbertCurve::HeapMapHilbertCurve(unsigned int width, unsigned int height)
+	: _width(width), _height(height), _offsets((size_t) width * height)
+{
+	auto side = std::min(width, height);
+	auto is_horizontal = width >= height;
+
+	unsigned int order = 0;
+
+	while ((1u << order) < side)
+	{
+		order++;
+	}
+
+	auto square = (size_t) side * side;
+
+	for (size_t index = 0; index < square; index++)
+	{
+		unsigned int x;
+		unsigned int y;
+
+		get_position(order, (unsigned long) index, x, y);
+
+		// Squares of a stacked map are transposed, so each ends next to the following square.
+		_offsets[index] = is_horizontal ? y * width + x : x * width + y;
+	}
+
+	// Other squares are the first square moved by whole squares.
+	for (size_t first_index = square; first_index < _offsets.size(); first_index += square)
+	{
+		auto move = (unsigned int) (first_index / square) * (is_horizontal ? side : side * width);
+
+		for (size_t index = 0; index < square; index++)
+		{
+			_offsets[first_index + index] = _offsets[index] + move;
+		}
+	}
+}
+
+/**
+Checks if a map can be laid out along a Hilbert curve, the short side must be a power of two and divide the long side.
+
+\param width Width of the map.
+\param height Height of the map.
+*/
+bool HeapMapHilbertCurve::is_supported(unsigned int width, unsigned int height)
+{
+	auto side = std::min(width, height);
+
+	return side != 0 && (side & (side - 1)) == 0 && std::max(width, height) % side == 0;
+}
+
+/**
+Gets the position of an index on a Hilbert curve in a square, from (0, 0) to (side - 1, 0).
+
+\param order Side of the square as a power of two.
+\param index Index on the curve, less than the square of the side.
+\param x Receives the column.
+\param y Receives the row.
+*/
+void HeapMapHilbertCurve::get_position(unsigned int order, unsigned long index, unsigned int& x, unsigned int& y)
+{
+	unsigned int state = 0;
+
+	x = 0;
+	y = 0;
+
+	for (auto level = order; level-- > 0;)
+	{
+		auto entry = HilbertStates[state][(index >> (2 * level)) & 3];
+
+		x = (x << 1) | ((entry >> 1) & 1);
+		y = (y << 1) | (entry & 1);
+		state = entry >> 2;
+	}
+}
+
+/**
+Copies pixels in curve order to their positions in a row-major image buffer.
+
+\param pixels Pixels from the first index.
+\param first_index Index of the first pixel.
+\param end_index Index after the last pixel.
+\param buffer Buffer of 4 * width * height bytes.
+*/
+void HeapMapHilbertCurve::copy_to(const unsigned int* pixels, unsigned long first_index, unsigned long end_index, unsigned char* buffer) const
+{
+	auto target = reinterpret_cast<unsigned int*>(buffer);
+
+	for (auto index = first_index; index < end_index; index++)
+	{
+		target[_offsets[index]] = pixels[index - first_index];
+	}
+}
+
+/**
+Gets squares covering the pixels of a span of indices, the largest aligned block of 4^k indices at each index of the span is one square.
+
+\param first_index Index of the first pixel.
+\param end_index Index after the last pixel.
+\param rects Receives the squares, they are appended.
+*/
+void HeapMapHilbertCurve::get_rects(unsigned long first_index, unsigned long end_index, std::vector<HeapMapRect>& rects) const
+{
+	auto side = std::min(_width, _height);
+	auto square = (unsigned long) side * side;
+
+	end_index = std::min(end_index, (unsigned long) _offsets.size());
+
+	for (auto index = first_index; index < end_index;)
+	{
+		unsigned long count = 1;
+		unsigned int block_side = 1;
+
+		while (count * 4 <= square && index % (count * 4) == 0 && index + count * 4 <= end_index)
+		{
+			count *= 4;
+			block_side *= 2;
+		}
+
+		// The first pixel of a block is a corner of its square.
+		auto offset = _offsets[index];
+
+		rects.push_back(HeapMapRect((offset % _width) & ~(block_side - 1), (offset / _width) & ~(block_side - 1), block_side, block_side));
+
+		index += count;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,329 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file HeapMapImageExporter.cpp
+
+Implements HeapMapImageExporter class that saves heap maps as PNG or PPM images.
+*/
+
+#include <algorithm>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#include "HeapMapImageExporter.h"
+#include "ParallelFor.h"
+#include "DeflateEncoder.h"
+
+const unsigned int HeapMapImageExporter::ROW_BLOCK;
+
+static const unsigned char PNG_SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+/**
+CRC-32 of bytes, for the polynomial of PNG chunks.
+*/
+static const struct CrcTable
+{
+	unsigned int Values[256];
+
+	CrcTable()
+	{
+		for (unsigned int i = 0; i < 256; i++)
+		{
+			auto value = i;
+
+			for (int bit = 0; bit < 8; bit++)
+			{
+				value = (value & 1) ? 0xEDB88320 ^ (value >> 1) : value >> 1;
+			}
+
+			Values[i] = value;
+		}
+	}
+} Crc;
+
+/**
+Appends a 32-bit value in network byte order.
+
+\param buffer Buffer.
+\param value Value.
+*/
+static void append_u32(std::vector<unsigned char>& buffer, unsigned int value)
+{
+	buffer.push_back(static_cast<unsigned char>(value >> 24));
+	buffer.push_back(static_cast<unsigned char>(value >> 16));
+	buffer.push_back(static_cast<unsigned char>(value >> 8));
+	buffer.push_back(static_cast<unsigned char>(value));
+}
+
+/**
+Saves a heap map to a file.
+
+\param pixels Row-major 32-bit pixels.
+\param width Width of the map.
+\param height Height of the map.
+\param path File path.
+\param format Image format.
+\param thread_count Number of threads to encode PNG images with, 0 for the number of processors.
+\return false if the map is empty or the file cannot be written.
+*/
+bool HeapMapImageExporter::save(const unsigned char* pixels, unsigned int width, unsigned int height, const std::string& path, ImageFormat format, unsigned int thread_count)
+{
+	std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+
+	if (!stream)
+	{
+		return false;
+	}
+
+	if (format == ImageFormat::Ppm)
+	{
+		return write_ppm(stream, pixels, width, height);
+	}
+
+	return write_png(stream, pixels, width, height, thread_count);
+}
+
+/**
+Writes a heap map as an 8-bit RGB PNG image. Rows are filtered with the Sub filter, so runs of a color become runs of zeros,
+and deflated with matches at one byte, one pixel and one row distances.
+
+\param stream Binary output stream.
+\param pixels Row-major 32-bit pixels.
+\param width Width of the map.
+\param height Height of the map.
+\param thread_count Number of threads, 0 for the number of processors.
+\return false if the map is empty or the stream fails.
+*/
+bool HeapMapImageExporter::write_png(std::ostream& stream, const unsigned char* pixels, unsigned int width, unsigned int height, unsigned int thread_count)
+{
+	if (width == 0 || height == 0)
+	{
+		return false;
+	}
+
+	if (thread_count == 0)
+	{
+		thread_count = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	auto stride = (size_t) width * 3 + 1;
+	auto block_count = (height + ROW_BLOCK - 1) / ROW_BLOCK;
+
+	std::vector<unsigned char> filtered(stride * height);
+
+	// All rows are filtered before deflating, matches at one row distance read the last row of the previous block.
+	parallel_for(thread_count, block_count, [&](size_t block)
+	{
+		auto end_row = std::min<size_t>(height, (block + 1) * ROW_BLOCK);
+
+		for (auto row = block * ROW_BLOCK; row < end_row; row++)
+		{
+			auto line = &filtered[row * stride];
+
+			line[0] = 1;
+
+			to_rgb(pixels + row * width * 4, width, line + 1);
+
+			for (auto i = stride - 1; i > 3; i--)
+			{
+				line[i] -= line[i - 3];
+			}
+		}
+	});
+
+	std::vector<std::vector<unsigned char>> blocks(block_count);
+	std::vector<unsigned int> adlers(block_count);
+
+	parallel_for(thread_count, block_count, [&](size_t block)
+	{
+		auto first = block * ROW_BLOCK * stride;
+		auto end = std::min<size_t>(height, (block + 1) * ROW_BLOCK) * stride;
+
+		auto& data = blocks[block];
+
+		if (block == 0)
+		{
+			// zlib header, 32K window, no dictionary.
+			data.push_back(0x78);
+			data.push_back(0x01);
+		}
+
+		DeflateEncoder encoder(data);
+
+		encoder.add_distance(1);
+		encoder.add_distance(3);
+		encoder.add_distance(static_cast<unsigned int>(stride));
+
+		for (auto row = first; row < end; row += stride)
+		{
+			encoder.write(&filtered[row], stride, row);
+		}
+
+		encoder.flush();
+
+		adlers[block] = DeflateEncoder::adler32(&filtered[first], end - first);
+	});
+
+	std::vector<unsigned char> header;
+
+	append_u32(header, width);
+	append_u32(header, height);
+
+	// 8-bit RGB, deflate, adaptive filtering, no interlace.
+	header.push_back(8);
+	header.push_back(2);
+	header.push_back(0);
+	header.push_back(0);
+	header.push_back(0);
+
+	stream.write(reinterpret_cast<const char*>(PNG_SIGNATURE), sizeof(PNG_SIGNATURE));
+
+	write_chunk(stream, "IHDR", header.data(), header.size());
+
+	unsigned int adler = 1;
+
+	for (size_t block = 0; block < block_count; block++)
+	{
+		auto rows = std::min<size_t>(height - block * ROW_BLOCK, ROW_BLOCK);
+
+		adler = DeflateEncoder::adler32_combine(adler, adlers[block], rows * stride);
+
+		write_chunk(stream, "IDAT", blocks[block].data(), blocks[block].size());
+
+		std::vector<unsigned char>().swap(blocks[block]);
+	}
+
+	std::vector<unsigned char> trailer;
+
+	DeflateEncoder(trailer).finish();
+
+	append_u32(trailer, adler);
+
+	write_chunk(stream, "IDAT", trailer.data(), trailer.size());
+	write_chunk(stream, "IEND", nullptr, 0);
+
+	return stream.good();
+}
+
+/**
+Writes a heap map as a binary PPM image, one row at a time.
+
+\param stream Binary output stream.
+\param pixels Row-major 32-bit pixels.
+\param width Width of the map.
+\param height Height of the map.
+\return false if the map is empty or the stream fails.
+*/
+bool HeapMapImageExporter::write_ppm(std::ostream& stream, const unsigned char* pixels, unsigned int width, unsigned int height)
+{
+	if (width == 0 || height == 0)
+	{
+		return false;
+	}
+
+	auto header = "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+
+	stream.write(header.c_str(), header.size());
+
+	std::vector<unsigned char> row((size_t) width * 3);
+
+	for (unsigned int y = 0; y < height; y++)
+	{
+		to_rgb(pixels + (size_t) y * width * 4, width, row.data());
+
+		stream.write(reinterpret_cast<const char*>(row.data()), row.size());
+	}
+
+	return stream.good();
+}
+
+/**
+Writes a PNG chunk.
+
+\param stream Binary output stream.
+\param type Four character chunk type.
+\param data Chunk data.
+\param size Size of the data.
+*/
+void HeapMapImageExporter::write_chunk(std::ostream& stream, const char* type, const unsigned char* data, size_t size)
+{
+	std::vector<unsigned char> length;
+
+	append_u32(length, static_cast<unsigned int>(size));
+
+	stream.write(reinterpret_cast<const char*>(length.data()), length.size());
+	stream.write(type, 4);
+
+	if (size != 0)
+	{
+		stream.write(reinterpret_cast<const char*>(data), size);
+	}
+
+	auto crc = crc32(data, size, crc32(reinterpret_cast<const unsigned char*>(type), 4));
+
+	std::vector<unsigned char> trailer;
+
+	append_u32(trailer, crc);
+
+	stream.write(reinterpret_cast<const char*>(trailer.data()), trailer.size());
+}
+
+/**
+Converts a row of 32-bit pixels to 8-bit RGB.
+
+\param pixels 32-bit pixels.
+\param width Number of pixels.
+\param rgb Buffer of 3 * width bytes.
+*/
+void HeapMapImageExporter::to_rgb(const unsigned char* pixels, unsigned int width, unsigned char* rgb)
+{
+	for (unsigned int x = 0; x < width; x++)
+	{
+		rgb[x * 3] = pixels[x * 4 + 2];
+		rgb[x * 3 + 1] = pixels[x * 4 + 1];
+		rgb[x * 3 + 2] = pixels[x * 4];
+	}
+}
+
+/**
+Updates a CRC-32 checksum, as used by PNG chunks.
+
+\param data Data.
+\param size Size of the data.
+\param crc Checksum of the preceding data, 0 for none.
+*/
+unsigned int HeapMapImageExporter::crc32(const unsigned char* data, size_t size, unsigned int crc)
+{
+	crc = ~crc;
+
+	for (size_t i = 0; i < size; i++)
+	{
+		crc = Crc.Values[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	}
+
+	return ~crc;
+}
\ No newline at end of file
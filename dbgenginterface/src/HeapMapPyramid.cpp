@@ -0,0 +1,436 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file HeapMapPyramid.cpp
+
+Implements HeapMapPyramid class that aggregates heap map pixels into lower resolution levels.
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "HeapMapPyramid.h"
+
+const unsigned int HeapMapPyramid::NO_CLASS;
+const unsigned int HeapMapPyramid::FIRST_COUNTED_LEVEL;
+
+/**
+Gets the pixels of the colors of all states and usages in state and usage order, each pixel once.
+*/
+static const std::vector<unsigned int>& GetClassPixels()
+{
+	static const std::vector<unsigned int> class_pixels = []()
+	{
+		std::vector<unsigned int> pixels;
+
+		for (unsigned int state = 0; state <= (unsigned int) State::Undefined; state++)
+		{
+			for (unsigned int usage = 0; usage <= (unsigned int) Usage::GCLOHeap; usage++)
+			{
+				auto pixel = HeapMapRasterizer::to_pixel(HeapMapRasterizer::get_color((State) state, (Usage) usage));
+
+				if (std::find(pixels.begin(), pixels.end(), pixel) == pixels.end())
+				{
+					pixels.push_back(pixel);
+				}
+			}
+		}
+
+		return pixels;
+	}();
+
+	return class_pixels;
+}
+
+/**
+Gets the class of a pixel.
+
+\param pixel Pixel.
+\return Index of the state and usage color of the pixel, NO_CLASS for other colors.
+*/
+unsigned int HeapMapPyramid::get_class(unsigned int pixel)
+{
+	auto& pixels = GetClassPixels();
+
+	auto it = std::find(pixels.begin(), pixels.end(), pixel);
+
+	return it == pixels.end() ? NO_CLASS : static_cast<unsigned int>(it - pixels.begin());
+}
+
+/**
+Gets the number of classes, one for each distinct state and usage color.
+*/
+unsigned int HeapMapPyramid::get_class_count()
+{
+	return static_cast<unsigned int>(GetClassPixels().size());
+}
+
+/**
+Builds levels from a heap map.
+
+\param buffer Row-major 32-bit pixels of the heap map.
+\param width Width of the heap map.
+\param height Height of the heap map.
+*/
+void HeapMapPyramid::build(const unsigned char* buffer, unsigned int width, unsigned int height)
+{
+	clear();
+
+	if (width == 0 || height == 0)
+	{
+		return;
+	}
+
+	add_level(width, height);
+
+	while (_widths[_level_count - 1] > 1 || _heights[_level_count - 1] > 1)
+	{
+		add_level((_widths[_level_count - 1] + 1) / 2, (_heights[_level_count - 1] + 1) / 2);
+	}
+
+	_classes.resize((size_t) width * height);
+
+	update_region(buffer, 0, 0, width, height);
+}
+
+/**
+Updates levels for changed rectangles of a heap map, only pixels covering the rectangles are computed again.
+The pyramid is built again if the size of the map changed.
+
+\param buffer Row-major 32-bit pixels of the heap map.
+\param width Width of the heap map.
+\param height Height of the heap map.
+\param rects Changed rectangles.
+*/
+void HeapMapPyramid::update(const unsigned char* buffer, unsigned int width, unsigned int height, const std::vector<HeapMapRect>& rects)
+{
+	if (_level_count == 0 || _widths[0] != width || _heights[0] != height)
+	{
+		build(buffer, width, height);
+
+		return;
+	}
+
+	for (auto& rect : rects)
+	{
+		auto end_x = std::min(width, rect.X + rect.Width);
+		auto end_y = std::min(height, rect.Y + rect.Height);
+
+		if (rect.X < end_x && rect.Y < end_y)
+		{
+			update_region(buffer, rect.X, rect.Y, end_x, end_y);
+		}
+	}
+}
+
+/**
+Copies a region of a heap map to level 0 and computes the pixels of other levels that cover it.
+A pixel of another color switches the pyramid to averages of the whole map, until the whole map is updated with state and usage colors only.
+
+\param buffer Row-major 32-bit pixels of the heap map.
+\param x0 First column of the region.
+\param y0 First row of the region.
+\param x1 Column after the region.
+\param y1 Row after the region.
+*/
+void HeapMapPyramid::update_region(const unsigned char* buffer, unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1)
+{
+	auto width = _widths[0];
+	auto height = _heights[0];
+
+	auto& pixels = _levels[0];
+
+	auto source = reinterpret_cast<const unsigned int*>(buffer);
+
+	for (auto y = y0; y < y1; y++)
+	{
+		auto row = (size_t) y * width;
+
+		memcpy(&pixels[row + x0], &source[row + x0], (x1 - x0) * sizeof(unsigned int));
+	}
+
+	if (x0 == 0 && y0 == 0 && x1 == width && y1 == height)
+	{
+		_is_averaged = false;
+	}
+
+	if (!_is_averaged && !classify(x0, y0, x1, y1))
+	{
+		_is_averaged = true;
+
+		x0 = 0;
+		y0 = 0;
+		x1 = width;
+		y1 = height;
+	}
+
+	for (unsigned int shift = 1; shift < _level_count; shift++)
+	{
+		if (_is_averaged)
+		{
+			update_average(shift, x0, y0, x1, y1);
+		}
+		else
+		{
+			update_dominant(shift, x0, y0, x1, y1);
+		}
+	}
+}
+
+/**
+Sets classes of level 0 pixels in a region.
+
+\param x0 First column of the region.
+\param y0 First row of the region.
+\param x1 Column after the region.
+\param y1 Row after the region.
+\return false if a pixel has no class.
+*/
+bool HeapMapPyramid::classify(unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1)
+{
+	auto width = _widths[0];
+
+	auto& pixels = _levels[0];
+
+	auto last_pixel = pixels[(size_t) y0 * width + x0];
+	auto last_class = get_class(last_pixel);
+
+	for (auto y = y0; y < y1; y++)
+	{
+		auto row = (size_t) y * width;
+
+		for (auto x = x0; x < x1; x++)
+		{
+			auto pixel = pixels[row + x];
+
+			if (pixel != last_pixel)
+			{
+				last_pixel = pixel;
+				last_class = get_class(pixel);
+			}
+
+			if (last_class == NO_CLASS)
+			{
+				return false;
+			}
+
+			_classes[row + x] = static_cast<unsigned char>(last_class);
+		}
+	}
+
+	return true;
+}
+
+/**
+Computes the pixels of a level that cover a region of level 0 from the dominant classes of their pages. Pages of pixels below FIRST_COUNTED_LEVEL are counted from level 0,
+pages of other pixels are the sums of the counts of the pixels below them.
+
+\param shift Index of the level.
+\param x0 First column of the region.
+\param y0 First row of the region.
+\param x1 Column after the region.
+\param y1 Row after the region.
+*/
+void HeapMapPyramid::update_dominant(unsigned int shift, unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1)
+{
+	auto width = _widths[0];
+	auto height = _heights[0];
+
+	auto& class_pixels = GetClassPixels();
+	auto class_count = get_class_count();
+
+	auto& level = _levels[shift];
+	auto level_width = _widths[shift];
+
+	auto below_width = _widths[shift - 1];
+	auto below_height = _heights[shift - 1];
+
+	// Pixels of the level covering the region.
+	auto level_x1 = ((x1 - 1) >> shift) + 1;
+	auto level_y1 = ((y1 - 1) >> shift) + 1;
+
+	auto& cell = _cell;
+
+	cell.resize(class_count);
+
+	for (auto y = y0 >> shift; y < level_y1; y++)
+	{
+		for (auto x = x0 >> shift; x < level_x1; x++)
+		{
+			std::fill(cell.begin(), cell.end(), 0);
+
+			if (shift <= FIRST_COUNTED_LEVEL)
+			{
+				auto end_row = std::min(height, (y + 1) << shift);
+				auto end_column = std::min(width, (x + 1) << shift);
+
+				for (auto row = y << shift; row < end_row; row++)
+				{
+					auto row_classes = &_classes[(size_t) row * width];
+
+					for (auto column = x << shift; column < end_column; column++)
+					{
+						cell[row_classes[column]]++;
+					}
+				}
+			}
+			else
+			{
+				for (auto below_y = 2 * y; below_y < std::min(below_height, 2 * y + 2); below_y++)
+				{
+					for (auto below_x = 2 * x; below_x < std::min(below_width, 2 * x + 2); below_x++)
+					{
+						auto below_cell = &_counts[shift - 1][((size_t) below_y * below_width + below_x) * class_count];
+
+						for (unsigned int c = 0; c < class_count; c++)
+						{
+							cell[c] += below_cell[c];
+						}
+					}
+				}
+			}
+
+			auto pixel = (size_t) y * level_width + x;
+
+			if (shift >= FIRST_COUNTED_LEVEL)
+			{
+				std::copy(cell.begin(), cell.end(), _counts[shift].begin() + pixel * class_count);
+			}
+
+			unsigned int dominant = 0;
+
+			for (unsigned int c = 1; c < class_count; c++)
+			{
+				if (cell[c] > cell[dominant])
+				{
+					dominant = c;
+				}
+			}
+
+			level[pixel] = class_pixels[dominant];
+		}
+	}
+}
+
+/**
+Computes the pixels of a level that cover a region of level 0 as the mean of the pixels they cover in the level below.
+
+\param shift Index of the level.
+\param x0 First column of the region.
+\param y0 First row of the region.
+\param x1 Column after the region.
+\param y1 Row after the region.
+*/
+void HeapMapPyramid::update_average(unsigned int shift, unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1)
+{
+	auto& level = _levels[shift];
+	auto& below = _levels[shift - 1];
+
+	auto level_width = _widths[shift];
+	auto below_width = _widths[shift - 1];
+	auto below_height = _heights[shift - 1];
+
+	auto level_x1 = ((x1 - 1) >> shift) + 1;
+	auto level_y1 = ((y1 - 1) >> shift) + 1;
+
+	for (auto y = y0 >> shift; y < level_y1; y++)
+	{
+		for (auto x = x0 >> shift; x < level_x1; x++)
+		{
+			unsigned int sums[3] = { 0, 0, 0 };
+			unsigned int count = 0;
+
+			for (auto below_y = 2 * y; below_y < std::min(below_height, 2 * y + 2); below_y++)
+			{
+				for (auto below_x = 2 * x; below_x < std::min(below_width, 2 * x + 2); below_x++)
+				{
+					auto pixel = below[(size_t) below_y * below_width + below_x];
+
+					for (int channel = 0; channel < 3; channel++)
+					{
+						sums[channel] += (pixel >> (8 * channel)) & 0xFF;
+					}
+
+					count++;
+				}
+			}
+
+			level[(size_t) y * level_width + x] = 0x80000000 | (sums[2] / count) << 16 | (sums[1] / count) << 8 | (sums[0] / count);
+		}
+	}
+}
+
+/**
+Adds a level, reusing the buffers of a previous build.
+
+\param width Width of the level.
+\param height Height of the level.
+*/
+void HeapMapPyramid::add_level(unsigned int width, unsigned int height)
+{
+	if (_level_count == _levels.size())
+	{
+		_levels.push_back(std::vector<unsigned int>());
+		_counts.push_back(std::vector<unsigned int>());
+		_widths.push_back(0);
+		_heights.push_back(0);
+	}
+
+	_widths[_level_count] = width;
+	_heights[_level_count] = height;
+
+	_counts[_level_count].resize(_level_count >= FIRST_COUNTED_LEVEL ? (size_t) width * height * get_class_count() : 0);
+	_levels[_level_count++].resize((size_t) width * height);
+}
+
+/**
+Removes all levels, keeping their buffers.
+*/
+void HeapMapPyramid::clear()
+{
+	_level_count = 0;
+	_is_averaged = false;
+}
+
+/**
+Selects the smallest level that is not magnified more than twice when shown at a scale of level 0.
+
+\param scale Displayed size of a level 0 pixel, less than 1 when zoomed out.
+\return Level index.
+*/
+size_t HeapMapPyramid::select_level(double scale) const
+{
+	size_t level = 0;
+
+	while (level + 1 < _level_count && scale <= 0.5)
+	{
+		scale *= 2;
+		level++;
+	}
+
+	return level;
+}
\ No newline at end of file
@@ -0,0 +1,600 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file HeapMapRasterizer.cpp
+
+Implements HeapMapRasterizer class that renders memory ranges to heap map pixels.
+*/
+
+#include <algorithm>
+#include <climits>
+#include <queue>
+
+#include "HeapMapRasterizer.h"
+
+const unsigned long HeapMapRasterizer::PAGE_SIZE;
+const unsigned int HeapMapRasterizer::BACKGROUND;
+const unsigned int HeapMapRasterizer::TRANSPOSE_BLOCK;
+
+/**
+Sorts ranges by their first page, ranges without pages are not indexed.
+
+\param ranges Memory ranges.
+*/
+HeapMapRangeIndex::HeapMapRangeIndex(RangeList ranges)
+	: _ranges(ranges)
+{
+	if (!ranges)
+	{
+		return;
+	}
+
+	for (unsigned int i = 0; i < ranges->size(); i++)
+	{
+		if (HeapMapRasterizer::get_page_count((*ranges)[i]) != 0)
+		{
+			_order.push_back(i);
+		}
+	}
+
+	auto is_before = [&](unsigned int a, unsigned int b){ return (*ranges)[a].Address / HeapMapRasterizer::PAGE_SIZE < (*ranges)[b].Address / HeapMapRasterizer::PAGE_SIZE; };
+
+	// Ranges from VirtualQuery and eeheap are usually sorted already, then found ranges need no sorting.
+	if (!std::is_sorted(_order.begin(), _order.end(), is_before))
+	{
+		std::stable_sort(_order.begin(), _order.end(), is_before);
+
+		_is_list_order = false;
+	}
+
+	_first_pages.reserve(_order.size());
+	_max_end_pages.reserve(_order.size());
+
+	unsigned long max_end_page = 0;
+
+	for (auto i : _order)
+	{
+		auto& range = (*ranges)[i];
+		auto first_page = range.Address / HeapMapRasterizer::PAGE_SIZE;
+
+		max_end_page = std::max(max_end_page, first_page + HeapMapRasterizer::get_page_count(range));
+
+		_first_pages.push_back(first_page);
+		_max_end_pages.push_back(max_end_page);
+	}
+}
+
+/**
+Finds ranges that have pages in a span.
+
+\param first_page First page of the span.
+\param end_page Page after the span.
+\param indexes Receives indexes of the ranges in the list, in list order.
+*/
+void HeapMapRangeIndex::find(unsigned long first_page, unsigned long end_page, std::vector<unsigned int>& indexes) const
+{
+	indexes.clear();
+
+	// Ranges before lo end before the span, ranges from hi start after it.
+	auto lo = std::upper_bound(_max_end_pages.begin(), _max_end_pages.end(), first_page) - _max_end_pages.begin();
+	auto hi = std::lower_bound(_first_pages.begin(), _first_pages.end(), end_page) - _first_pages.begin();
+
+	for (auto i = lo; i < hi; i++)
+	{
+		auto& range = (*_ranges)[_order[i]];
+
+		if (_first_pages[i] + HeapMapRasterizer::get_page_count(range) > first_page)
+		{
+			indexes.push_back(_order[i]);
+		}
+	}
+
+	if (!_is_list_order)
+	{
+		std::sort(indexes.begin(), indexes.end());
+	}
+}
+
+HeapMapRasterizer::HeapMapRasterizer(unsigned int width, unsigned int height)
+	: _width(width), _height(height), _pages((size_t) width * height, BACKGROUND)
+{
+
+}
+
+/**
+Fills all pixels with the background.
+*/
+void HeapMapRasterizer::clear()
+{
+	std::fill(_pages.begin(), _pages.end(), BACKGROUND);
+}
+
+/**
+Fills pixels of consecutive pages, pages past the map are clipped.
+
+\param first_page Index of the first page.
+\param page_count Number of pages.
+\param pixel Pixel value from to_pixel.
+*/
+void HeapMapRasterizer::fill(unsigned long first_page, unsigned long page_count, unsigned int pixel)
+{
+	auto map_pages = get_page_count();
+
+	if (first_page >= map_pages)
+	{
+		return;
+	}
+
+	std::fill_n(_pages.begin() + first_page, std::min(page_count, map_pages - first_page), pixel);
+}
+
+/**
+Gets the number of pages drawn for a range: whole pages, or one page for ranges of a page or less.
+
+\param range Memory range.
+*/
+unsigned long HeapMapRasterizer::get_page_count(const MemoryRange& range)
+{
+	if (range.Size == 0)
+	{
+		return 0;
+	}
+
+	return std::max(1UL, range.Size / PAGE_SIZE);
+}
+
+/**
+Draws ranges of visible usages in order, later ranges overwrite earlier ones.
+
+\param ranges Memory ranges.
+\param is_monochrome True to draw ranges that are not free in the color of undefined usage.
+*/
+void HeapMapRasterizer::draw(RangeList ranges, bool is_monochrome)
+{
+	if (ranges == nullptr)
+	{
+		return;
+	}
+
+	for (auto& range : *ranges)
+	{
+		if (is_visible(range.Usage))
+		{
+			draw(range, is_monochrome, 0, get_page_count());
+		}
+	}
+}
+
+/**
+Shows or hides ranges of a usage in draw, spans keep all usages.
+
+\param usage Usage.
+\param is_visible True to draw ranges of the usage.
+*/
+void HeapMapRasterizer::set_visible(Usage usage, bool is_visible)
+{
+	auto bit = 1u << (unsigned int) usage;
+
+	_hidden_usages = is_visible ? _hidden_usages & ~bit : _hidden_usages | bit;
+}
+
+/**
+Checks if ranges of a usage are drawn.
+
+\param usage Usage.
+*/
+bool HeapMapRasterizer::is_visible(Usage usage) const
+{
+	return (_hidden_usages & (1u << (unsigned int) usage)) == 0;
+}
+
+/**
+Draws the pages of a range in a span of pages.
+
+\param range Memory range.
+\param is_monochrome True to draw ranges that are not free in the color of undefined usage.
+\param first_page First page of the span.
+\param end_page Page after the span.
+*/
+void HeapMapRasterizer::draw(const MemoryRange& range, bool is_monochrome, unsigned long first_page, unsigned long end_page)
+{
+	auto usage = is_monochrome && range.Usage != Usage::Free ? Usage::Undefined : range.Usage;
+
+	auto range_first_page = std::max(first_page, range.Address / PAGE_SIZE);
+	auto range_end_page = std::min(end_page, range.Address / PAGE_SIZE + get_page_count(range));
+
+	if (range_first_page < range_end_page)
+	{
+		fill(range_first_page, range_end_page - range_first_page, to_pixel(get_color(range.State, usage)));
+	}
+}
+
+/**
+Adds a layer of ranges for get_spans, layers are drawn in the order they are added.
+
+\param index Indexed ranges, can be shared by rasterizers.
+\param is_monochrome True to draw ranges that are not free in the color of undefined usage.
+*/
+void HeapMapRasterizer::add_layer(std::shared_ptr<const HeapMapRangeIndex> index, bool is_monochrome)
+{
+	_layers.push_back(HeapMapLayer(index, is_monochrome));
+}
+
+/**
+Indexes ranges and adds them as a layer for get_spans.
+
+\param ranges Memory ranges.
+\param is_monochrome True to draw ranges that are not free in the color of undefined usage.
+*/
+void HeapMapRasterizer::add_layer(RangeList ranges, bool is_monochrome)
+{
+	add_layer(std::make_shared<const HeapMapRangeIndex>(ranges), is_monochrome);
+}
+
+/**
+Gets the final pixels of the layers as spans of pages in page order. A page takes the pixel of the last range drawn over it,
+found with a sweep over ranges by first page that keeps the ranges covering the current page by drawing order.
+Pages without ranges have no spans, spans are not clipped to the map.
+
+\param spans Receives the spans, consecutive spans of the same pixel are merged.
+*/
+void HeapMapRasterizer::get_spans(std::vector<HeapMapSpan>& spans) const
+{
+	spans.clear();
+
+	struct Event
+	{
+		unsigned long FirstPage;
+		unsigned long EndPage;
+		unsigned int Order;
+		unsigned int Pixel;
+	};
+
+	std::vector<Event> events;
+
+	unsigned int order_base = 0;
+
+	for (auto& layer : _layers)
+	{
+		auto& index = *layer.Index;
+		auto layer_begin = events.size();
+
+		unsigned int max_index = 0;
+
+		for (size_t i = 0; i < index.size(); i++)
+		{
+			auto list_index = index.get_index(i);
+			auto& range = index.get(list_index);
+			auto usage = layer.IsMonochrome && range.Usage != Usage::Free ? Usage::Undefined : range.Usage;
+			auto first_page = range.Address / PAGE_SIZE;
+
+			Event event = { first_page, first_page + get_page_count(range), order_base + list_index, to_pixel(get_color(range.State, usage)) };
+
+			events.push_back(event);
+
+			max_index = std::max(max_index, list_index + 1);
+		}
+
+		// Indexes are sorted by first page, so layers are merged instead of sorted.
+		std::inplace_merge(events.begin(), events.begin() + layer_begin, events.end(), [](const Event& a, const Event& b){ return a.FirstPage < b.FirstPage; });
+
+		order_base += max_index;
+	}
+
+	// Ranges covering the current page, the range drawn last on top.
+	std::priority_queue<std::pair<unsigned int, unsigned long>> active;
+	std::vector<unsigned int> pixels(order_base);
+
+	for (auto& event : events)
+	{
+		pixels[event.Order] = event.Pixel;
+	}
+
+	size_t next = 0;
+	unsigned long page = 0;
+
+	while (next < events.size() || !active.empty())
+	{
+		if (active.empty())
+		{
+			page = events[next].FirstPage;
+		}
+
+		for (; next < events.size() && events[next].FirstPage == page; next++)
+		{
+			active.push(std::make_pair(events[next].Order, events[next].EndPage));
+		}
+
+		while (!active.empty() && active.top().second <= page)
+		{
+			active.pop();
+		}
+
+		if (active.empty())
+		{
+			continue;
+		}
+
+		auto end_page = std::min(active.top().second, next < events.size() ? events[next].FirstPage : ULONG_MAX);
+		auto pixel = pixels[active.top().first];
+
+		if (!spans.empty() && spans.back().EndPage == page && spans.back().Pixel == pixel)
+		{
+			spans.back().EndPage = end_page;
+		}
+		else
+		{
+			spans.push_back(HeapMapSpan(page, end_page, pixel));
+		}
+
+		page = end_page;
+	}
+}
+
+/**
+Compares spans of two renders and gets the rectangles of pages that have different pixels, clipped to the map.
+A change within a column gives a rectangle in that column, a change over columns gives whole columns. Rectangles are merged so they have disjoint columns.
+
+\param old_spans Spans of the previous render.
+\param new_spans Spans of the next render.
+\param rects Receives rectangles in column order.
+*/
+void HeapMapRasterizer::get_changed_rects(const std::vector<HeapMapSpan>& old_spans, const std::vector<HeapMapSpan>& new_spans, std::vector<HeapMapRect>& rects) const
+{
+	rects.clear();
+
+	auto map_pages = get_page_count();
+
+	auto add_pages = [&](unsigned long first_page, unsigned long end_page)
+	{
+		end_page = std::min(end_page, map_pages);
+
+		if (first_page >= end_page)
+		{
+			return;
+		}
+
+		auto first_column = first_page / _height;
+		auto last_column = (end_page - 1) / _height;
+
+		auto rect = first_column == last_column
+			? HeapMapRect(first_column, first_page % _height, 1, (end_page - 1) % _height - first_page % _height + 1)
+			: HeapMapRect(first_column, 0, last_column - first_column + 1, _height);
+
+		if (!rects.empty() && rects.back().X + rects.back().Width >= rect.X)
+		{
+			auto& last = rects.back();
+
+			auto y = std::min(last.Y, rect.Y);
+			auto end_y = std::max(last.Y + last.Height, rect.Y + rect.Height);
+
+			last.Width = std::max(last.X + last.Width, rect.X + rect.Width) - last.X;
+			last.Y = y;
+			last.Height = end_y - y;
+		}
+		else
+		{
+			rects.push_back(rect);
+		}
+	};
+
+	size_t a = 0;
+	size_t b = 0;
+	unsigned long page = 0;
+	unsigned long changed_page = ULONG_MAX;
+
+	while (a < old_spans.size() || b < new_spans.size())
+	{
+		auto is_in_a = a < old_spans.size() && old_spans[a].FirstPage <= page;
+		auto is_in_b = b < new_spans.size() && new_spans[b].FirstPage <= page;
+
+		auto next_a = a < old_spans.size() ? (is_in_a ? old_spans[a].EndPage : old_spans[a].FirstPage) : ULONG_MAX;
+		auto next_b = b < new_spans.size() ? (is_in_b ? new_spans[b].EndPage : new_spans[b].FirstPage) : ULONG_MAX;
+		auto next_page = std::min(next_a, next_b);
+
+		auto pixel_a = is_in_a ? old_spans[a].Pixel : BACKGROUND;
+		auto pixel_b = is_in_b ? new_spans[b].Pixel : BACKGROUND;
+
+		if (pixel_a != pixel_b)
+		{
+			if (changed_page == ULONG_MAX)
+			{
+				changed_page = page;
+			}
+		}
+		else if (changed_page != ULONG_MAX)
+		{
+			add_pages(changed_page, page);
+
+			changed_page = ULONG_MAX;
+		}
+
+		page = next_page;
+
+		if (a < old_spans.size() && old_spans[a].EndPage <= page)
+		{
+			a++;
+		}
+
+		if (b < new_spans.size() && new_spans[b].EndPage <= page)
+		{
+			b++;
+		}
+	}
+
+	if (changed_page != ULONG_MAX)
+	{
+		add_pages(changed_page, page);
+	}
+}
+
+/**
+Copies the map to a row-major image buffer, transposing blocks of pixels that fit in the cache.
+
+\param buffer Buffer of 4 * width * height bytes.
+*/
+void HeapMapRasterizer::copy_to(unsigned char* buffer) const
+{
+	copy_to(buffer, 0, _width);
+}
+
+/**
+Copies columns of the map to a row-major image buffer, or their pages along the Hilbert curve if one is set.
+
+\param buffer Buffer of 4 * width * height bytes.
+\param first_column First column to copy.
+\param end_column Column after the last column to copy.
+*/
+void HeapMapRasterizer::copy_to(unsigned char* buffer, unsigned int first_column, unsigned int end_column) const
+{
+	if (_curve)
+	{
+		auto first_page = (unsigned long) first_column * _height;
+
+		_curve->copy_to(_pages.data() + first_page, first_page, (unsigned long) end_column * _height, buffer);
+
+		return;
+	}
+
+	copy_columns(_pages.data() + (size_t) first_column * _height, _width, _height, buffer, first_column, end_column);
+}
+
+/**
+Copies columns of pages in column order to a row-major image buffer, transposing blocks of pixels that fit in the cache.
+
+\param pages Pixels of the columns, starting with the first page of the first column.
+\param width Width of the image buffer.
+\param height Height of the image buffer.
+\param buffer Buffer of 4 * width * height bytes.
+\param first_column First column to copy.
+\param end_column Column after the last column to copy.
+*/
+void HeapMapRasterizer::copy_columns(const unsigned int* pages, unsigned int width, unsigned int height, unsigned char* buffer, unsigned int first_column, unsigned int end_column)
+{
+	auto pixels = reinterpret_cast<unsigned int*>(buffer);
+
+	for (unsigned int x0 = first_column; x0 < end_column; x0 += TRANSPOSE_BLOCK)
+	{
+		auto x1 = std::min(end_column, x0 + TRANSPOSE_BLOCK);
+
+		for (unsigned int y0 = 0; y0 < height; y0 += TRANSPOSE_BLOCK)
+		{
+			auto y1 = std::min(height, y0 + TRANSPOSE_BLOCK);
+
+			for (auto x = x0; x < x1; x++)
+			{
+				auto column = &pages[(size_t) (x - first_column) * height];
+
+				for (auto y = y0; y < y1; y++)
+				{
+					pixels[(size_t) y * width + x] = column[y];
+				}
+			}
+		}
+	}
+}
+
+/**
+Converts a 0xRRGGBB color to a pixel with blue in the lowest byte and 0x80 in the highest byte, as QImage::Format_RGB32 and HeapMapImageExporter read pixels.
+
+\param color Color.
+*/
+unsigned int HeapMapRasterizer::to_pixel(unsigned int color)
+{
+	return (color & 0xFFFFFF) | 0x80000000;
+}
+
+/**
+Gets the 0xRRGGBB color for the specified state and usage.
+
+\param state State.
+\param usage Usage.
+*/
+unsigned int HeapMapRasterizer::get_color(State state, Usage usage)
+{
+	if (state == State::Undefined)
+		return 0x808080;
+	if (usage == Usage::Free)
+		return 0xFFFFFF;
+
+	if (usage == Usage::EnvironmentBlock || usage == Usage::PEB || usage == Usage::ProcessParameters || usage == Usage::TEB || usage == Usage::Stack)
+	{
+		if (state == State::Commit)
+			return 0x800080;
+		else
+			return 0xFFC0CB;
+	}
+
+	if (usage == Usage::Heap)
+	{
+		if (state == State::Commit)
+			return 0x0000FF;
+		else
+			return 0xADD8E6;
+	}
+
+	if (usage == Usage::Image)
+	{
+		if (state == State::Commit)
+			return 0x8B0000;
+		else
+			return 0XFF0000;
+	}
+
+	if (usage == Usage::VirtualAlloc)
+	{
+		if (state == State::Commit)
+			return 0x008000;
+		else
+			return 0xADFF2F;
+	}
+
+	if (usage == Usage::PageHeap)
+	{
+		if (state == State::Commit)
+			return 0x000000;
+		else
+			return 0x2F4F4F;
+	}
+
+	if (usage == Usage::GCHeap)
+	{
+		if (state == State::Commit)
+			return 0x00FF7F;
+		else
+			return 0xADFF2F;
+	}
+
+	if (usage == Usage::GCLOHeap)
+	{
+		if (state == State::Commit)
+			return 0x006400;
+		else
+			return 0x32CD32;
+	}
+
+	return 0x808080;
+}
\ No newline at end of file
@@ -0,0 +1,391 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file HeapMapSvgExporter.cpp
+
+Implements HeapMapSvgExporter class that saves heap maps as SVG images of merged ranges.
+*/
+
+#include <algorithm>
+#include <fstream>
+
+#include "HeapMapSvgExporter.h"
+#include "HeapMapRasterizer.h"
+
+const size_t HeapMapSvgExporter::BUFFER_SIZE;
+
+static const char* StateNames[] = { "Free", "Commit", "Reserve", "Undefined" };
+static const char* UsageNames[] = { "VirtualAlloc", "Free", "Image", "Stack", "TEB", "Heap", "PageHeap", "PEB", "ProcessParameters", "EnvironmentBlock", "Undefined", "GCHeap", "GCLOHeap" };
+
+/**
+Appends a decimal number to a buffer.
+
+\param buffer Buffer.
+\param value Number.
+*/
+static void AppendNumber(std::string& buffer, unsigned long long value)
+{
+	char digits[20];
+	int count = 0;
+
+	do
+	{
+		digits[count++] = (char) ('0' + value % 10);
+		value /= 10;
+	} while (value != 0);
+
+	while (count > 0)
+	{
+		buffer += digits[--count];
+	}
+}
+
+/**
+Appends a hexadecimal number to a buffer, padded with zeros.
+
+\param buffer Buffer.
+\param value Number.
+\param width Minimum number of digits.
+*/
+static void AppendHex(std::string& buffer, unsigned long long value, int width)
+{
+	static const char HexDigits[] = "0123456789ABCDEF";
+
+	char digits[16];
+	int count = 0;
+
+	do
+	{
+		digits[count++] = HexDigits[value & 0xF];
+		value >>= 4;
+	} while (value != 0 || count < width);
+
+	while (count > 0)
+	{
+		buffer += digits[--count];
+	}
+}
+
+/**
+Appends the attributes of a rectangle to a buffer.
+
+\param buffer Buffer.
+\param x Column of the rectangle.
+\param y Row of the rectangle.
+\param width Width of the rectangle.
+\param height Height of the rectangle.
+*/
+static void AppendRect(std::string& buffer, unsigned long x, unsigned long y, unsigned long width, unsigned long height)
+{
+	buffer += "<rect x=\"";
+	AppendNumber(buffer, x);
+	buffer += "\" y=\"";
+	AppendNumber(buffer, y);
+	buffer += "\" width=\"";
+	AppendNumber(buffer, width);
+	buffer += "\" height=\"";
+	AppendNumber(buffer, height);
+	buffer += "\"";
+}
+
+/**
+Initializes an exporter without layers.
+
+\param width Width of the map in pages.
+\param height Height of the map in pages, the number of pages in a column.
+*/
+HeapMapSvgExporter::HeapMapSvgExporter(unsigned int width, unsigned int height)
+	: _width(width), _height(height)
+{
+
+}
+
+/**
+Adds ranges to write, layers are written in the order they are added.
+
+\param ranges Memory ranges.
+\param is_monochrome True to write ranges that are not free in the color of undefined usage.
+*/
+void HeapMapSvgExporter::add_layer(RangeList ranges, bool is_monochrome)
+{
+	if (ranges != nullptr)
+	{
+		_layers.push_back(std::make_pair(ranges, is_monochrome));
+	}
+}
+
+/**
+Gets runs of contiguous ranges of a layer with the same state and usage, in page order. Ranges are sorted only if they are not in address order.
+
+\param ranges Memory ranges.
+\param is_monochrome True to merge ranges that are not free as undefined usage.
+\param runs Receives the runs.
+*/
+void HeapMapSvgExporter::get_runs(RangeList ranges, bool is_monochrome, std::vector<Run>& runs) const
+{
+	runs.clear();
+
+	auto page_count = (unsigned long) _width * _height;
+
+	for (auto& range : *ranges)
+	{
+		auto first_page = range.Address / HeapMapRasterizer::PAGE_SIZE;
+		auto end_page = std::min(page_count, first_page + HeapMapRasterizer::get_page_count(range));
+
+		if (first_page >= end_page)
+		{
+			continue;
+		}
+
+		auto usage = is_monochrome && range.Usage != Usage::Free ? Usage::Undefined : range.Usage;
+
+		Run run = { first_page, end_page, range.Address, (unsigned long long) range.Address + range.Size, range.State, usage };
+
+		runs.push_back(run);
+	}
+
+	auto by_page = [](const Run& a, const Run& b){ return a.FirstPage < b.FirstPage; };
+
+	if (!std::is_sorted(runs.begin(), runs.end(), by_page))
+	{
+		std::stable_sort(runs.begin(), runs.end(), by_page);
+	}
+
+	size_t count = 0;
+
+	for (auto& run : runs)
+	{
+		if (count != 0)
+		{
+			auto& last = runs[count - 1];
+
+			if (run.FirstPage <= last.EndPage && run.State == last.State && run.Usage == last.Usage)
+			{
+				last.EndPage = std::max(last.EndPage, run.EndPage);
+				last.EndAddress = std::max(last.EndAddress, run.EndAddress);
+
+				continue;
+			}
+		}
+
+		runs[count++] = run;
+	}
+
+	runs.resize(count);
+}
+
+/**
+Writes a run as a partial first column, full columns and a partial last column, with a tooltip of its state, usage and addresses.
+
+\param buffer Buffer of the image.
+\param run Run.
+\param is_monochrome True if the run is in a monochrome layer, runs of undefined usage are named as native ranges.
+*/
+void HeapMapSvgExporter::write_run(std::string& buffer, const Run& run, bool is_monochrome) const
+{
+	unsigned long rects[3][4];
+	int count = 0;
+
+	auto add_rect = [&](unsigned long x, unsigned long y, unsigned long width, unsigned long height)
+	{
+		rects[count][0] = x;
+		rects[count][1] = y;
+		rects[count][2] = width;
+		rects[count][3] = height;
+		count++;
+	};
+
+	auto x0 = run.FirstPage / _height;
+	auto y0 = run.FirstPage % _height;
+	auto x1 = (run.EndPage - 1) / _height;
+	auto y1 = (run.EndPage - 1) % _height;
+
+	if (x0 == x1)
+	{
+		add_rect(x0, y0, 1, y1 - y0 + 1);
+	}
+	else
+	{
+		auto first_column = x0;
+		auto end_column = x1 + 1;
+
+		if (y0 != 0)
+		{
+			add_rect(x0, y0, 1, _height - y0);
+
+			first_column++;
+		}
+
+		if (y1 != _height - 1)
+		{
+			end_column--;
+		}
+
+		if (first_column < end_column)
+		{
+			add_rect(first_column, 0, end_column - first_column, _height);
+		}
+
+		if (y1 != _height - 1)
+		{
+			add_rect(x1, 0, 1, y1 + 1);
+		}
+	}
+
+	if (count == 1)
+	{
+		AppendRect(buffer, rects[0][0], rects[0][1], rects[0][2], rects[0][3]);
+	}
+	else
+	{
+		buffer += "<g";
+	}
+
+	buffer += " fill=\"#";
+	AppendHex(buffer, HeapMapRasterizer::get_color(run.State, run.Usage), 6);
+	buffer += "\"><title>";
+	buffer += is_monochrome && run.Usage == Usage::Undefined ? "Native" : get_usage_name(run.Usage);
+	buffer += ", ";
+	buffer += get_state_name(run.State);
+	buffer += ": 0x";
+	AppendHex(buffer, run.Address, 8);
+	buffer += "-0x";
+	AppendHex(buffer, run.EndAddress, 8);
+	buffer += "</title>";
+
+	if (count == 1)
+	{
+		buffer += "</rect>\n";
+
+		return;
+	}
+
+	buffer += "\n";
+
+	for (int i = 0; i < count; i++)
+	{
+		AppendRect(buffer, rects[i][0], rects[i][1], rects[i][2], rects[i][3]);
+
+		buffer += "/>\n";
+	}
+
+	buffer += "</g>\n";
+}
+
+/**
+Writes the layers as an SVG image with one unit per page, scaled to the display size.
+
+\param stream Output stream.
+\param display_width Width of the image, 0 for the width of the map.
+\param display_height Height of the image, 0 for the height of the map.
+\return false if the stream cannot be written.
+*/
+bool HeapMapSvgExporter::write(std::ostream& stream, unsigned int display_width, unsigned int display_height) const
+{
+	std::string buffer;
+
+	buffer.reserve(BUFFER_SIZE + 1024);
+
+	buffer += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"";
+	AppendNumber(buffer, display_width != 0 ? display_width : _width);
+	buffer += "\" height=\"";
+	AppendNumber(buffer, display_height != 0 ? display_height : _height);
+	buffer += "\" viewBox=\"0 0 ";
+	AppendNumber(buffer, _width);
+	buffer += " ";
+	AppendNumber(buffer, _height);
+	buffer += "\" preserveAspectRatio=\"none\" shape-rendering=\"crispEdges\">\n";
+
+	AppendRect(buffer, 0, 0, _width, _height);
+
+	buffer += " fill=\"#";
+	AppendHex(buffer, HeapMapRasterizer::get_color(State::Undefined, Usage::Undefined), 6);
+	buffer += "\"/>\n";
+
+	std::vector<Run> runs;
+
+	for (auto& layer : _layers)
+	{
+		get_runs(layer.first, layer.second, runs);
+
+		for (auto& run : runs)
+		{
+			write_run(buffer, run, layer.second);
+
+			if (buffer.size() >= BUFFER_SIZE)
+			{
+				stream.write(buffer.data(), buffer.size());
+				buffer.clear();
+			}
+		}
+	}
+
+	buffer += "</svg>\n";
+
+	stream.write(buffer.data(), buffer.size());
+
+	return stream.good();
+}
+
+/**
+Saves the layers to an SVG file.
+
+\param path File path.
+\param display_width Width of the image, 0 for the width of the map.
+\param display_height Height of the image, 0 for the height of the map.
+\return false if the file cannot be written.
+*/
+bool HeapMapSvgExporter::save(const std::string& path, unsigned int display_width, unsigned int display_height) const
+{
+	std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+
+	if (!stream)
+	{
+		return false;
+	}
+
+	return write(stream, display_width, display_height);
+}
+
+/**
+Gets the name of a state.
+
+\param state State.
+*/
+const char* HeapMapSvgExporter::get_state_name(State state)
+{
+	return StateNames[(unsigned int) state];
+}
+
+/**
+Gets the name of a usage.
+
+\param usage Usage.
+*/
+const char* HeapMapSvgExporter::get_usage_name(Usage usage)
+{
+	return UsageNames[(unsigned int) usage];
+}
\ No newline at end of file
@@ -0,0 +1,200 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file HeapScan.cpp
+
+Implements HeapScan class that answers many type queries with one heap walk.
+*/
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "HeapScan.h"
+
+/**
+Removes all queries and answers, when the debugged process changes.
+*/
+void HeapScan::clear()
+{
+	_queries.clear();
+	_segments = nullptr;
+}
+
+/**
+Drops answers of all queries so the next run walks the heap again, when objects may have been allocated since the last walk.
+*/
+void HeapScan::invalidate()
+{
+	for (auto& query : _queries)
+	{
+		query.Addresses = CompressedAddressSet();
+		query.IsAnswered = false;
+	}
+}
+
+/**
+Registers a type by name, its MethodTables are found with !name2ee.
+
+\param clr_exact_type_name Type name.
+\return Index of the query, MethodTables of the query are empty if the type is not found.
+*/
+size_t HeapScan::add_query(const std::string& clr_exact_type_name)
+{
+	for (size_t i = 0; i < _queries.size(); i++)
+	{
+		if (_queries[i].TypeName == clr_exact_type_name && !_queries[i].MethodTables.empty())
+		{
+			return i;
+		}
+	}
+
+	return add_query(clr_exact_type_name, _method_table_cache->find_method_tables(clr_exact_type_name));
+}
+
+/**
+Registers a type by its MethodTables. Queries with the same MethodTables are registered once.
+
+\param type_name Type name, only for display.
+\param method_tables MethodTables of the type.
+\return Index of the query.
+*/
+size_t HeapScan::add_query(const std::string& type_name, const std::vector<unsigned long>& method_tables)
+{
+	auto sorted = method_tables;
+
+	std::sort(sorted.begin(), sorted.end());
+	sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+	for (size_t i = 0; i < _queries.size(); i++)
+	{
+		if (_queries[i].MethodTables == sorted && (!sorted.empty() || _queries[i].TypeName == type_name))
+		{
+			return i;
+		}
+	}
+
+	_queries.push_back(HeapScanQuery(type_name, sorted));
+
+	return _queries.size() - 1;
+}
+
+/**
+Answers all queries that are not answered for the current heap with one walk, objects are dispatched to queries by MethodTable.
+
+\param segments Segment ranges from !eeheap -gc.
+\param memory_reader Memory reader.
+\param boundary_index Boundaries to split segments at, can be nullptr.
+\return false if the heap could not be walked to its end, unanswered queries are left empty.
+*/
+bool HeapScan::run(RangeList segments, IMemoryReader* memory_reader, GCHeapBoundaryIndex* boundary_index)
+{
+	if (!ParallelGCHeapWalker::is_same_heap(_segments, segments))
+	{
+		invalidate();
+
+		_segments = segments;
+	}
+
+	std::unordered_map<unsigned long, std::vector<size_t>> method_table_queries;
+
+	for (size_t i = 0; i < _queries.size(); i++)
+	{
+		if (_queries[i].IsAnswered)
+		{
+			continue;
+		}
+
+		// Types that are not found have no objects.
+		if (_queries[i].MethodTables.empty())
+		{
+			_queries[i].IsAnswered = true;
+
+			continue;
+		}
+
+		for (auto method_table : _queries[i].MethodTables)
+		{
+			method_table_queries[method_table].push_back(i);
+		}
+	}
+
+	if (method_table_queries.empty())
+	{
+		return true;
+	}
+
+	ParallelGCHeapWalker walker(segments, memory_reader, _method_table_cache, boundary_index, _logger);
+
+	// Objects are kept per work item and merged in address order.
+	std::vector<std::vector<std::pair<size_t, unsigned long>>> item_objects(walker.get_work_items().size());
+
+	auto is_complete = walker.walk([&](size_t item, const GCHeapObject& object)
+	{
+		auto it = method_table_queries.find(object.MethodTable);
+
+		if (it != method_table_queries.end())
+		{
+			for (auto query : it->second)
+			{
+				item_objects[item].push_back(std::make_pair(query, object.Address));
+			}
+		}
+
+		return true;
+	});
+
+	_walks++;
+
+	if (!is_complete)
+	{
+		return false;
+	}
+
+	// Segments are ascending runs, compressed as they are merged.
+	std::vector<CompressedAddressSetBuilder> builders(_queries.size());
+
+	for (auto& objects : item_objects)
+	{
+		for (auto& object : objects)
+		{
+			builders[object.first].add(object.second);
+		}
+	}
+
+	for (auto& method_table_query : method_table_queries)
+	{
+		for (auto query : method_table_query.second)
+		{
+			if (!_queries[query].IsAnswered)
+			{
+				_queries[query].Addresses = builders[query].build();
+				_queries[query].IsAnswered = true;
+			}
+		}
+	}
+
+	return true;
+}
\ No newline at end of file
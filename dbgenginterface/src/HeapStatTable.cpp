@@ -0,0 +1,156 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file HeapStatTable.cpp
+
+Implements HeapStatTable class that counts objects and bytes per key.
+*/
+
+#include "HeapStatTable.h"
+
+const unsigned long long HeapStatTable::EMPTY_KEY;
+const size_t HeapStatTable::INITIAL_CAPACITY;
+
+/**
+Constructs an instance of the HeapStatTable class.
+
+\param capacity Initial number of slots, rounded up to a power of two.
+*/
+HeapStatTable::HeapStatTable(size_t capacity)
+{
+	size_t slots = INITIAL_CAPACITY;
+
+	while (slots < capacity)
+	{
+		slots <<= 1;
+	}
+
+	_slots.assign(slots, HeapStatSlot(EMPTY_KEY));
+	_mask = slots - 1;
+}
+
+/**
+Finds the slot of a key, or the empty slot where it would be inserted.
+
+\param key Key, must not be EMPTY_KEY.
+*/
+size_t HeapStatTable::find_slot(unsigned long long key) const
+{
+	// Fibonacci hashing spreads MethodTable addresses that share low bits.
+	auto index = (size_t) ((key * 0x9E3779B97F4A7C15ULL) >> 32) & _mask;
+
+	while (_slots[index].Key != key && _slots[index].Key != EMPTY_KEY)
+	{
+		index = (index + 1) & _mask;
+	}
+
+	return index;
+}
+
+/**
+Doubles the number of slots and reinserts used slots.
+*/
+void HeapStatTable::grow()
+{
+	std::vector<HeapStatSlot> slots;
+
+	slots.swap(_slots);
+
+	_slots.assign(2 * slots.size(), HeapStatSlot(EMPTY_KEY));
+	_mask = _slots.size() - 1;
+
+	for (auto& slot : slots)
+	{
+		if (slot.Key != EMPTY_KEY)
+		{
+			_slots[find_slot(slot.Key)] = slot;
+		}
+	}
+}
+
+/**
+Adds objects to the totals of a key.
+
+\param key Key, must not be EMPTY_KEY.
+\param count Number of objects.
+\param bytes Total size of objects.
+*/
+void HeapStatTable::add(unsigned long long key, unsigned long long count, unsigned long long bytes)
+{
+	auto index = find_slot(key);
+
+	if (_slots[index].Key == EMPTY_KEY)
+	{
+		// Keep the load factor at most one half, so probe sequences stay short.
+		if (2 * (_size + 1) > _slots.size())
+		{
+			grow();
+
+			index = find_slot(key);
+		}
+
+		_slots[index].Key = key;
+
+		_size++;
+	}
+
+	_slots[index].Count += count;
+	_slots[index].Bytes += bytes;
+}
+
+/**
+Adds totals of all keys of another table.
+
+\param other Table to merge.
+*/
+void HeapStatTable::merge(const HeapStatTable& other)
+{
+	for (auto& slot : other._slots)
+	{
+		if (slot.Key != EMPTY_KEY)
+		{
+			add(slot.Key, slot.Count, slot.Bytes);
+		}
+	}
+}
+
+/**
+Finds the totals of a key.
+
+\param key Key.
+\return Slot of the key, or nullptr if it was not added.
+*/
+const HeapStatSlot* HeapStatTable::find(unsigned long long key) const
+{
+	if (key == EMPTY_KEY)
+	{
+		return nullptr;
+	}
+
+	auto& slot = _slots[find_slot(key)];
+
+	return slot.Key == key ? &slot : nullptr;
+}
\ No newline at end of file
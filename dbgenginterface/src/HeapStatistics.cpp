@@ -0,0 +1,340 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file HeapStatistics.cpp
+
+Implements HeapStatistics class that aggregates GC heap objects per MethodTable, segment and generation.
+*/
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "HeapStatTable.h"
+#include "HeapStatistics.h"
+
+const unsigned long HeapStatistics::LARGE_OBJECT_GENERATION;
+const int HeapStatQuery::ALL_GENERATIONS;
+
+/**
+Constructs an instance of the HeapStatistics class.
+
+\param segments Segment ranges from !eeheap -gc.
+\param generation_starts Generation starts from !eeheap -gc, generation 0 and 1 starts are in ephemeral segments.
+*/
+HeapStatistics::HeapStatistics(RangeList segments, const GenerationStartList& generation_starts)
+	: _segments(segments), _generation_starts(generation_starts)
+{
+	if (!_segments)
+	{
+		return;
+	}
+
+	// Objects of a segment without generation 0 and 1 starts are in generation 2.
+	_ephemeral_starts.assign(_segments->size(), std::make_pair(~0UL, ~0UL));
+
+	for (auto& generation_start : _generation_starts)
+	{
+		if (generation_start.first > 1)
+		{
+			continue;
+		}
+
+		for (size_t i = 0; i < _segments->size(); i++)
+		{
+			auto& segment = _segments->at(i);
+
+			// An empty generation 0 starts at the allocated end of its segment.
+			if (segment.Usage == Usage::GCHeap && generation_start.second >= segment.Address && generation_start.second <= segment.Address + segment.Size)
+			{
+				if (generation_start.first == 0)
+				{
+					_ephemeral_starts[i].first = generation_start.second;
+				}
+				else
+				{
+					_ephemeral_starts[i].second = generation_start.second;
+				}
+
+				break;
+			}
+		}
+	}
+}
+
+/**
+Finds the generation of an object.
+
+\param segment Index of the segment of the object.
+\param address Object address.
+\return Generation, LARGE_OBJECT_GENERATION for objects on the large object heap.
+*/
+unsigned long HeapStatistics::get_generation(size_t segment, unsigned long address) const
+{
+	if (_segments->at(segment).Usage == Usage::GCLOHeap)
+	{
+		return LARGE_OBJECT_GENERATION;
+	}
+
+	auto& starts = _ephemeral_starts[segment];
+
+	if (address >= starts.first)
+	{
+		return 0;
+	}
+
+	if (address >= starts.second)
+	{
+		return 1;
+	}
+
+	return 2;
+}
+
+/**
+Walks the heap and aggregates objects. Each work item is counted in its own table by the worker walking it, tables are merged after the walk.
+
+\param walker Walker of the segments this instance was constructed with.
+\return false if the heap could not be walked to its end, entries are kept for the walked part.
+*/
+bool HeapStatistics::collect(ParallelGCHeapWalker& walker)
+{
+	auto& work_items = walker.get_work_items();
+	auto& work_item_segments = walker.get_work_item_segments();
+
+	std::vector<HeapStatTable> item_tables(work_items.size());
+
+	_is_complete = walker.walk([&](size_t item, const GCHeapObject& object)
+	{
+		auto generation = get_generation(work_item_segments[item], object.Address);
+
+		item_tables[item].add(((unsigned long long) object.MethodTable << 2) | generation, 1, object.Size);
+
+		return true;
+	});
+
+	// Merge in address order, keyed by segment too.
+	HeapStatTable table;
+
+	for (size_t i = 0; i < item_tables.size(); i++)
+	{
+		for (auto& slot : item_tables[i].get_slots())
+		{
+			if (slot.Key != HeapStatTable::EMPTY_KEY)
+			{
+				table.add(((unsigned long long) work_item_segments[i] << 34) | slot.Key, slot.Count, slot.Bytes);
+			}
+		}
+	}
+
+	_entries.clear();
+	_entries.reserve(table.size());
+
+	for (auto& slot : table.get_slots())
+	{
+		if (slot.Key != HeapStatTable::EMPTY_KEY)
+		{
+			auto segment = (size_t) (slot.Key >> 34);
+			auto method_table = (unsigned long) ((slot.Key >> 2) & 0xffffffffULL);
+			auto generation = (unsigned long) (slot.Key & 3);
+
+			_entries.push_back(HeapStatEntry(method_table, _segments->at(segment).Address, generation, slot.Count, slot.Bytes));
+		}
+	}
+
+	std::sort(_entries.begin(), _entries.end(), [](const HeapStatEntry& a, const HeapStatEntry& b)
+	{
+		if (a.Segment != b.Segment)
+		{
+			return a.Segment < b.Segment;
+		}
+
+		if (a.Generation != b.Generation)
+		{
+			return a.Generation < b.Generation;
+		}
+
+		return a.MethodTable < b.MethodTable;
+	});
+
+	return _is_complete;
+}
+
+/**
+Checks if the heap has the same segments and generations as when this instance was constructed, so its entries are still valid.
+
+\param segments Segment ranges from !eeheap -gc.
+\param generation_starts Generation starts from !eeheap -gc.
+*/
+bool HeapStatistics::matches(RangeList segments, const GenerationStartList& generation_starts) const
+{
+	return _generation_starts == generation_starts && ParallelGCHeapWalker::is_same_heap(_segments, segments);
+}
+
+/**
+Finds the segment containing an address.
+
+\param address Address.
+\return Segment, or nullptr if no segment contains the address.
+*/
+const MemoryRange* HeapStatistics::find_segment(unsigned long address) const
+{
+	if (!_segments)
+	{
+		return nullptr;
+	}
+
+	for (auto& segment : *_segments)
+	{
+		if (address >= segment.Address && address < segment.Address + segment.Size)
+		{
+			return &segment;
+		}
+	}
+
+	return nullptr;
+}
+
+/**
+Aggregates entries per MethodTable and selects the top rows.
+Names are loaded with one debugger command, for all MethodTables when filtering by type name, otherwise only for selected rows.
+
+\param query Filters, order and row limit.
+\param method_table_cache MethodTable cache for type names, can be nullptr unless filtering by type name.
+\return Selected rows, largest first, and totals of all MethodTables passing the filters.
+*/
+HeapStatResult HeapStatistics::query(const HeapStatQuery& query, MethodTableCache* method_table_cache) const
+{
+	HeapStatResult result;
+
+	unsigned long segment_address = 0;
+
+	if (query.Segment != 0)
+	{
+		auto segment = find_segment(query.Segment);
+
+		if (!segment)
+		{
+			return result;
+		}
+
+		segment_address = segment->Address;
+	}
+
+	std::unordered_map<unsigned long, size_t> row_indexes;
+
+	std::vector<HeapStatRow> rows;
+
+	for (auto& entry : _entries)
+	{
+		if ((segment_address != 0 && entry.Segment != segment_address) || (query.Generation != HeapStatQuery::ALL_GENERATIONS && entry.Generation != (unsigned long) query.Generation))
+		{
+			continue;
+		}
+
+		auto it = row_indexes.find(entry.MethodTable);
+
+		if (it == row_indexes.end())
+		{
+			row_indexes[entry.MethodTable] = rows.size();
+
+			rows.push_back(HeapStatRow(entry.MethodTable, entry.Count, entry.Bytes));
+		}
+		else
+		{
+			rows[it->second].Count += entry.Count;
+			rows[it->second].Bytes += entry.Bytes;
+		}
+	}
+
+	if (!query.TypePrefix.empty())
+	{
+		std::vector<unsigned long> method_tables;
+
+		for (auto& row : rows)
+		{
+			method_tables.push_back(row.MethodTable);
+		}
+
+		method_table_cache->load_names(method_tables);
+
+		rows.erase(std::remove_if(rows.begin(), rows.end(), [&](HeapStatRow& row)
+		{
+			row.Name = method_table_cache->get_name(row.MethodTable);
+
+			return row.Name.compare(0, query.TypePrefix.size(), query.TypePrefix) != 0;
+		}), rows.end());
+	}
+
+	for (auto& row : rows)
+	{
+		result.Count += row.Count;
+		result.Bytes += row.Bytes;
+	}
+
+	result.Types = rows.size();
+
+	auto sort = query.Sort;
+
+	auto is_before = [sort](const HeapStatRow& a, const HeapStatRow& b)
+	{
+		auto a_value = sort == HeapStatSort::Count ? a.Count : a.Bytes;
+		auto b_value = sort == HeapStatSort::Count ? b.Count : b.Bytes;
+
+		if (a_value != b_value)
+		{
+			return a_value > b_value;
+		}
+
+		return a.MethodTable < b.MethodTable;
+	};
+
+	auto top = query.Top == 0 ? rows.size() : std::min(query.Top, rows.size());
+
+	std::partial_sort(rows.begin(), rows.begin() + top, rows.end(), is_before);
+
+	rows.erase(rows.begin() + top, rows.end());
+
+	if (query.TypePrefix.empty() && method_table_cache)
+	{
+		std::vector<unsigned long> method_tables;
+
+		for (auto& row : rows)
+		{
+			method_tables.push_back(row.MethodTable);
+		}
+
+		method_table_cache->load_names(method_tables);
+
+		for (auto& row : rows)
+		{
+			row.Name = method_table_cache->get_name(row.MethodTable);
+		}
+	}
+
+	result.Rows = rows;
+
+	return result;
+}
\ No newline at end of file
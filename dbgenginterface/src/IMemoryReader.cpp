@@ -0,0 +1,142 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file IMemoryReader.cpp
+
+Implements the vectored read of the IMemoryReader class.
+*/
+
+#include <algorithm>
+#include <cstring>
+
+#include "IMemoryReader.h"
+
+const unsigned long IMemoryReader::READ_PAGE_SIZE;
+const unsigned long IMemoryReader::MAX_COALESCED_READ_SIZE;
+
+/**
+Reads many small ranges with as few reads as possible.
+
+Requests are sorted by address and coalesced into page aligned spans, each span is read with
+a single ReadMemory call. When a span cannot be read completely, requests after the unreadable
+page are retried in a new span.
+
+\param requests Read requests, succeeded is set for each request.
+\return Number of succeeded requests.
+*/
+unsigned long IMemoryReader::ReadMany(std::vector<MemoryReadRequest>& requests)
+{
+	const unsigned long long page_mask = ~static_cast<unsigned long long>(READ_PAGE_SIZE - 1);
+
+	std::vector<size_t> order;
+
+	order.reserve(requests.size());
+
+	for (size_t i = 0; i < requests.size(); i++)
+	{
+		requests[i].succeeded = requests[i].size == 0;
+
+		if (requests[i].size != 0)
+		{
+			order.push_back(i);
+		}
+	}
+
+	std::sort(order.begin(), order.end(), [&requests](size_t a, size_t b){ return requests[a].address < requests[b].address; });
+
+	auto page_floor = [page_mask](unsigned long long address){ return address & page_mask; };
+	auto page_ceil = [page_mask](unsigned long long address){ return (address + READ_PAGE_SIZE - 1) & page_mask; };
+
+	std::vector<unsigned char> span;
+
+	auto succeeded = static_cast<unsigned long>(requests.size() - order.size());
+
+	size_t i = 0;
+
+	while (i < order.size())
+	{
+		auto& first = requests[order[i]];
+
+		auto span_start = page_floor(first.address);
+		auto span_end = page_ceil(static_cast<unsigned long long>(first.address) + first.size);
+
+		size_t j = i + 1;
+
+		for (; j < order.size(); j++)
+		{
+			auto& request = requests[order[j]];
+
+			auto request_end = page_ceil(static_cast<unsigned long long>(request.address) + request.size);
+
+			if (page_floor(request.address) > span_end || std::max(span_end, request_end) - span_start > MAX_COALESCED_READ_SIZE)
+			{
+				break;
+			}
+
+			span_end = std::max(span_end, request_end);
+		}
+
+		auto span_size = static_cast<unsigned long>(span_end - span_start);
+
+		span.resize(span_size);
+
+		unsigned long bytes_read = 0;
+
+#pragma push_macro("ReadMemory")
+#undef ReadMemory
+		ReadMemory(static_cast<unsigned long>(span_start), span.data(), span_size, &bytes_read);
+#pragma pop_macro("ReadMemory")
+
+		auto readable_end = span_start + std::min(bytes_read, span_size);
+
+		size_t k = i;
+
+		for (; k < j; k++)
+		{
+			auto& request = requests[order[k]];
+
+			auto request_end = static_cast<unsigned long long>(request.address) + request.size;
+
+			if (request_end <= readable_end)
+			{
+				memcpy(request.buffer, span.data() + (request.address - span_start), request.size);
+
+				request.succeeded = true;
+
+				succeeded++;
+			}
+			else if (page_floor(request.address) > page_floor(readable_end))
+			{
+				// Past the unreadable page, read the rest in a new span.
+				break;
+			}
+		}
+
+		i = k;
+	}
+
+	return succeeded;
+}
\ No newline at end of file
@@ -0,0 +1,150 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file ImageBufferPool.cpp
+
+Implements ImageBuffer and ImageBufferPool classes that reuse image pixel buffers.
+*/
+
+#include <algorithm>
+
+#include "ImageBufferPool.h"
+
+const size_t ImageBufferPool::MAX_BUFFERS;
+
+ImageBuffer::ImageBuffer(ImageBuffer&& other)
+	: _pool(std::move(other._pool)), _pixels(std::move(other._pixels)), _width(other._width), _height(other._height)
+{
+	other._width = 0;
+	other._height = 0;
+}
+
+ImageBuffer& ImageBuffer::operator=(ImageBuffer&& other)
+{
+	if (this != &other)
+	{
+		reset();
+
+		_pool = std::move(other._pool);
+		_pixels = std::move(other._pixels);
+		_width = other._width;
+		_height = other._height;
+
+		other._width = 0;
+		other._height = 0;
+	}
+
+	return *this;
+}
+
+ImageBuffer::~ImageBuffer()
+{
+	reset();
+}
+
+/**
+Returns pixels to the pool, or frees them if the pool is gone or full.
+*/
+void ImageBuffer::reset()
+{
+	auto pool = _pool.lock();
+
+	if (pool && !_pixels.empty())
+	{
+		std::lock_guard<std::mutex> lock(pool->Mutex);
+
+		if (pool->Buffers.size() < pool->MaxBuffers)
+		{
+			pool->Buffers.push_back(std::move(_pixels));
+		}
+	}
+
+	std::vector<unsigned int>().swap(_pixels);
+
+	_pool.reset();
+	_width = 0;
+	_height = 0;
+}
+
+/**
+\param max_buffers Number of released buffers to keep.
+*/
+ImageBufferPool::ImageBufferPool(size_t max_buffers)
+	: _state(std::make_shared<ImageBufferPoolState>(max_buffers))
+{
+
+}
+
+/**
+Gets a buffer for an image, reusing the smallest released buffer that is large enough. Pixels are not cleared.
+
+\param width Width of the image.
+\param height Height of the image.
+*/
+ImageBuffer ImageBufferPool::acquire(unsigned int width, unsigned int height)
+{
+	ImageBuffer buffer;
+
+	auto size = (size_t) width * height;
+
+	{
+		std::lock_guard<std::mutex> lock(_state->Mutex);
+
+		auto best = _state->Buffers.end();
+
+		for (auto it = _state->Buffers.begin(); it != _state->Buffers.end(); ++it)
+		{
+			if (it->capacity() >= size && (best == _state->Buffers.end() || it->capacity() < best->capacity()))
+			{
+				best = it;
+			}
+		}
+
+		if (best != _state->Buffers.end())
+		{
+			buffer._pixels = std::move(*best);
+
+			_state->Buffers.erase(best);
+		}
+	}
+
+	buffer._pixels.resize(size);
+	buffer._pool = _state;
+	buffer._width = width;
+	buffer._height = height;
+
+	return buffer;
+}
+
+/**
+Gets the number of released buffers kept for reuse.
+*/
+size_t ImageBufferPool::size()
+{
+	std::lock_guard<std::mutex> lock(_state->Mutex);
+
+	return _state->Buffers.size();
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file ManagedObjectReader.cpp
+
+Implements selection of the ManagedObjectReader specialization for a runtime.
+*/
+
+#include <algorithm>
+#include <cctype>
+
+#include "ManagedObjectReader.h"
+
+/**
+Creates the reader for a runtime version of a 32-bit process, CLR 4 layouts are used for an unknown version.
+
+\param version Runtime version.
+*/
+std::unique_ptr<IManagedObjectReader> IManagedObjectReader::create(ClrVersion version)
+{
+	if (version == ClrVersion::Clr2)
+	{
+		return std::unique_ptr<IManagedObjectReader>(new ManagedObjectReader<Clr2X86>(version));
+	}
+
+	return std::unique_ptr<IManagedObjectReader>(new ManagedObjectReader<Clr4X86>(version));
+}
+
+/**
+Finds the runtime version from the name of the loaded runtime module.
+
+\param runtime_module_name Module name without path or extension, mscorwks for CLR 2.0, clr for CLR 4.
+*/
+ClrVersion IManagedObjectReader::find_version(const std::string& runtime_module_name)
+{
+	auto name = runtime_module_name;
+
+	std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+	if (name == "clr")
+	{
+		return ClrVersion::Clr4;
+	}
+
+	if (name == "mscorwks" || name == "mscorsvr")
+	{
+		return ClrVersion::Clr2;
+	}
+
+	return ClrVersion::Unknown;
+}
\ No newline at end of file
@@ -0,0 +1,277 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file ManagedStringReader.cpp
+
+Implements ManagedStringReader class that reads many System.String objects at once.
+*/
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#define MANAGEDSTRINGREADER_SSE2
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+
+#include "ManagedStringReader.h"
+
+const unsigned long ManagedStringReader::STRING_LENGTH_OFFSET;
+const unsigned long ManagedStringReader::STRING_CHARS_OFFSET;
+const unsigned long ManagedStringReader::DEFAULT_MAX_LENGTH;
+
+/**
+Reads lengths and characters of strings with one vectored read each.
+
+\param addresses Addresses of System.String objects, zero for a null string.
+\param chars Receives characters of all strings.
+\param char_offsets Receives offsets of strings in chars, with the total length at the end.
+\param is_read Receives whether each string was read.
+*/
+void ManagedStringReader::read_chars(const std::vector<unsigned long>& addresses, std::vector<unsigned short>& chars, std::vector<size_t>& char_offsets, std::vector<char>& is_read)
+{
+	auto count = addresses.size();
+
+	std::vector<unsigned int> lengths(count, 0);
+	std::vector<MemoryReadRequest> requests;
+
+	requests.reserve(count);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		requests.push_back(MemoryReadRequest(addresses[i] + STRING_LENGTH_OFFSET, addresses[i] ? sizeof(unsigned int) : 0, &lengths[i]));
+	}
+
+	_memory_reader->ReadMany(requests);
+
+	// Characters of all strings are read into one buffer.
+	char_offsets.assign(count + 1, 0);
+	is_read.assign(count, 0);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		is_read[i] = addresses[i] != 0 && requests[i].succeeded;
+
+		if (!is_read[i])
+		{
+			lengths[i] = 0;
+		}
+		else if (lengths[i] > _max_length)
+		{
+			_logger->Log("String at %08x is truncated to %u characters.\n", addresses[i], _max_length);
+
+			lengths[i] = _max_length;
+		}
+
+		char_offsets[i + 1] = char_offsets[i] + lengths[i];
+	}
+
+	chars.assign(char_offsets[count] + 1, 0);
+
+	requests.clear();
+
+	for (size_t i = 0; i < count; i++)
+	{
+		requests.push_back(MemoryReadRequest(addresses[i] + STRING_CHARS_OFFSET, lengths[i] * sizeof(unsigned short), chars.data() + char_offsets[i]));
+	}
+
+	_memory_reader->ReadMany(requests);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		is_read[i] = is_read[i] && requests[i].succeeded;
+	}
+}
+
+/**
+Reads strings as UTF-8. Unreadable strings are empty and their is_read is false, strings longer than the maximum length are truncated.
+
+\param addresses Addresses of System.String objects, zero for a null string.
+\return Strings in the order of addresses.
+*/
+ManagedStringBlock ManagedStringReader::read(const std::vector<unsigned long>& addresses)
+{
+	ManagedStringBlock block;
+
+	auto count = addresses.size();
+
+	std::vector<unsigned short> chars;
+	std::vector<size_t> char_offsets;
+	std::vector<char> is_read;
+
+	read_chars(addresses, chars, char_offsets, is_read);
+
+	// A UTF-16 code unit takes at most 3 bytes in UTF-8.
+	block._data.resize(3 * char_offsets[count] + count);
+	block._offsets.resize(count);
+	block._lengths.resize(count);
+	block._is_read.resize(count);
+
+	size_t offset = 0;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		auto length = is_read[i] ? Utf16ToUtf8(chars.data() + char_offsets[i], char_offsets[i + 1] - char_offsets[i], block._data.data() + offset) : 0;
+
+		block._offsets[i] = offset;
+		block._lengths[i] = length;
+		block._is_read[i] = is_read[i];
+
+		offset += length;
+
+		block._data[offset++] = 0;
+	}
+
+	block._data.resize(offset);
+
+	return block;
+}
+
+/**
+Reads strings as UTF-16, without conversion. Unreadable strings are empty and their is_read is false, strings longer than the maximum length are truncated.
+
+\param addresses Addresses of System.String objects, zero for a null string.
+\return Strings in the order of addresses.
+*/
+ManagedWideStringBlock ManagedStringReader::read_wide(const std::vector<unsigned long>& addresses)
+{
+	ManagedWideStringBlock block;
+
+	auto count = addresses.size();
+
+	std::vector<unsigned short> chars;
+	std::vector<size_t> char_offsets;
+	std::vector<char> is_read;
+
+	read_chars(addresses, chars, char_offsets, is_read);
+
+	block._data.resize(char_offsets[count] + count);
+	block._offsets.resize(count);
+	block._lengths.resize(count);
+	block._is_read.resize(count);
+
+	size_t offset = 0;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		auto length = is_read[i] ? char_offsets[i + 1] - char_offsets[i] : 0;
+
+		std::copy(chars.begin() + char_offsets[i], chars.begin() + char_offsets[i] + length, block._data.begin() + offset);
+
+		block._offsets[i] = offset;
+		block._lengths[i] = length;
+		block._is_read[i] = is_read[i];
+
+		offset += length;
+
+		block._data[offset++] = 0;
+	}
+
+	block._data.resize(offset);
+
+	return block;
+}
+
+/**
+Converts UTF-16 to UTF-8, unpaired surrogates are converted to U+FFFD.
+ASCII runs are converted 8 code units at a time with SSE2.
+
+\param source UTF-16 code units.
+\param count Number of code units.
+\param destination Buffer of at least 3 * count bytes.
+\return Number of bytes written.
+*/
+size_t ManagedStringReader::Utf16ToUtf8(const unsigned short* source, size_t count, char* destination)
+{
+	auto output = reinterpret_cast<unsigned char*>(destination);
+
+	size_t i = 0;
+
+	while (i < count)
+	{
+#ifdef MANAGEDSTRINGREADER_SSE2
+		const __m128i non_ascii_mask = _mm_set1_epi16((short) 0xff80);
+
+		while (i + 8 <= count)
+		{
+			auto units = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+
+			if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(units, non_ascii_mask), _mm_setzero_si128())) != 0xffff)
+			{
+				break;
+			}
+
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(output), _mm_packus_epi16(units, units));
+
+			output += 8;
+			i += 8;
+		}
+
+		if (i == count)
+		{
+			break;
+		}
+#endif
+
+		unsigned long code_point = source[i++];
+
+		if (code_point >= 0xd800 && code_point <= 0xdfff)
+		{
+			if (code_point <= 0xdbff && i < count && source[i] >= 0xdc00 && source[i] <= 0xdfff)
+			{
+				code_point = 0x10000 + ((code_point - 0xd800) << 10) + (source[i++] - 0xdc00);
+			}
+			else
+			{
+				code_point = 0xfffd;
+			}
+		}
+
+		if (code_point < 0x80)
+		{
+			*output++ = (unsigned char) code_point;
+		}
+		else if (code_point < 0x800)
+		{
+			*output++ = (unsigned char) (0xc0 | (code_point >> 6));
+			*output++ = (unsigned char) (0x80 | (code_point & 0x3f));
+		}
+		else if (code_point < 0x10000)
+		{
+			*output++ = (unsigned char) (0xe0 | (code_point >> 12));
+			*output++ = (unsigned char) (0x80 | ((code_point >> 6) & 0x3f));
+			*output++ = (unsigned char) (0x80 | (code_point & 0x3f));
+		}
+		else
+		{
+			*output++ = (unsigned char) (0xf0 | (code_point >> 18));
+			*output++ = (unsigned char) (0x80 | ((code_point >> 12) & 0x3f));
+			*output++ = (unsigned char) (0x80 | ((code_point >> 6) & 0x3f));
+			*output++ = (unsigned char) (0x80 | (code_point & 0x3f));
+		}
+	}
+
+	return output - reinterpret_cast<unsigned char*>(destination);
+}
\ No newline at end of file
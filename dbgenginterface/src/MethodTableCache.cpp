@@ -0,0 +1,560 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file MethodTableCache.cpp
+
+Implements MethodTableCache class that caches MethodTable metadata read from target memory and SOS output.
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+#include "MethodTableCache.h"
+
+const unsigned long MethodTableInfo::MIN_BASE_SIZE;
+const unsigned long MethodTableCache::HAS_COMPONENT_SIZE_FLAG;
+const unsigned long MethodTableCache::PARENT_METHOD_TABLE_OFFSET;
+const unsigned long MethodTableCache::METHOD_TABLE_READ_SIZE;
+const unsigned long MethodTableCache::MAX_PARENT_DEPTH;
+
+static unsigned long read_pointer(const unsigned char* p)
+{
+	unsigned int v;
+
+	memcpy(&v, p, sizeof(v));
+
+	return v;
+}
+
+static std::string to_hex(unsigned long value)
+{
+	std::stringstream sstream;
+	sstream << std::hex << value;
+
+	return sstream.str();
+}
+
+/**
+Returns the text after a label, without surrounding whitespace.
+
+\param line Line of SOS output.
+\param label Label that the line starts with.
+\param value Text after the label.
+\return true if the line starts with the label.
+*/
+static bool get_labeled_value(const std::string& line, const std::string& label, std::string& value)
+{
+	if (line.compare(0, label.size(), label) != 0)
+	{
+		return false;
+	}
+
+	auto first = line.find_first_not_of(" \t", label.size());
+	auto last = line.find_last_not_of(" \t\r");
+
+	value = first == std::string::npos ? "" : line.substr(first, last - first + 1);
+
+	return true;
+}
+
+/**
+Sets the sources of metadata for the current command.
+
+\param executor Executor of SOS commands for names and fields.
+\param memory_reader Reader of MethodTables for sizes and parents.
+\param logger Logger.
+*/
+void MethodTableCache::attach(IDebuggerCommandExecutor* executor, IMemoryReader* memory_reader, ILogger* logger)
+{
+	_executor = executor;
+	_memory_reader = memory_reader;
+	_logger = logger;
+}
+
+/**
+Removes all entries, to be called when the target changes.
+*/
+void MethodTableCache::clear()
+{
+	_method_tables.clear();
+	_type_names.clear();
+}
+
+/**
+Decodes m_dwFlags, m_BaseSize and m_pParentMethodTable of an x86 CLR4 MethodTable.
+
+\param info Entry to fill.
+\param fields METHOD_TABLE_READ_SIZE bytes from the start of the MethodTable.
+*/
+void MethodTableCache::set_sizes(MethodTableInfo& info, const unsigned char* fields)
+{
+	auto flags = read_pointer(fields);
+
+	info.BaseSize = read_pointer(fields + 4);
+	info.ComponentSize = (flags & HAS_COMPONENT_SIZE_FLAG) != 0 ? flags & 0xFFFF : 0;
+	info.ParentMethodTable = read_pointer(fields + PARENT_METHOD_TABLE_OFFSET);
+	info.ContainsPointers = (flags & GCDesc::CONTAINS_POINTERS_FLAG) != 0;
+}
+
+/**
+Reads sizes and parents of MethodTables that are not cached with one vectored read.
+
+\param method_tables MethodTable addresses.
+*/
+void MethodTableCache::load(const std::vector<unsigned long>& method_tables)
+{
+	std::vector<MethodTableInfo*> infos;
+
+	for (auto method_table : method_tables)
+	{
+		auto& info = _method_tables[method_table];
+
+		if (info.IsRead)
+		{
+			continue;
+		}
+
+		info.MethodTable = method_table;
+		info.IsRead = true;
+
+		infos.push_back(&info);
+	}
+
+	if (infos.empty() || !_memory_reader)
+	{
+		return;
+	}
+
+	std::vector<unsigned char> buffer(infos.size() * METHOD_TABLE_READ_SIZE);
+	std::vector<MemoryReadRequest> requests;
+
+	requests.reserve(infos.size());
+
+	for (size_t i = 0; i < infos.size(); i++)
+	{
+		requests.push_back(MemoryReadRequest(infos[i]->MethodTable, METHOD_TABLE_READ_SIZE, &buffer[i * METHOD_TABLE_READ_SIZE]));
+	}
+
+	_memory_reader->ReadMany(requests);
+
+	for (size_t i = 0; i < infos.size(); i++)
+	{
+		if (requests[i].succeeded)
+		{
+			set_sizes(*infos[i], &buffer[i * METHOD_TABLE_READ_SIZE]);
+		}
+	}
+}
+
+/**
+Reads names of MethodTables that are not named with one debugger command running !dumpmt for each of them.
+
+\param method_tables MethodTable addresses.
+*/
+void MethodTableCache::load_names(const std::vector<unsigned long>& method_tables)
+{
+	std::string command;
+
+	for (auto method_table : method_tables)
+	{
+		auto& info = _method_tables[method_table];
+
+		if (info.IsNamed)
+		{
+			continue;
+		}
+
+		info.MethodTable = method_table;
+		info.IsNamed = true;
+
+		auto mt_hex = to_hex(method_table);
+
+		command += ".echo MT " + mt_hex + "; " + _command_dumpmt + " " + mt_hex + "; ";
+	}
+
+	if (command.empty() || !_executor)
+	{
+		return;
+	}
+
+	std::string output;
+
+	if (!_executor->ExecuteCommand(command, output))
+	{
+		_logger->Log("Cannot get method table names.\n");
+
+		return;
+	}
+
+	ParseDumpMT(output);
+}
+
+/**
+Parses !dumpmt outputs, each preceded by an MT marker line.
+
+\param lines Command output.
+*/
+void MethodTableCache::ParseDumpMT(const std::string& lines)
+{
+	/*
+	MT 72f5f9ac
+	EEClass:         72b4e3c8
+	Module:          72a51000
+	Name:            System.Threading.Thread
+	mdToken:         020001a9
+	File:            C:\Windows\Microsoft.NET\Framework\v4.0.30319\mscorlib.dll
+	BaseSize:        0x34
+	ComponentSize:   0x0
+	*/
+
+	std::istringstream iss(lines);
+
+	std::string line;
+	std::string value;
+
+	MethodTableInfo* info = nullptr;
+
+	auto has_sizes = false;
+
+	while (std::getline(iss, line))
+	{
+		try{
+			if (get_labeled_value(line, "MT ", value))
+			{
+				info = &_method_tables[std::stoul(value, nullptr, 16)];
+				has_sizes = info->is_valid();
+			}
+			else if (!info)
+			{
+				continue;
+			}
+			else if (get_labeled_value(line, "EEClass:", value))
+			{
+				info->EEClass = std::stoul(value, nullptr, 16);
+			}
+			else if (get_labeled_value(line, "Name:", value))
+			{
+				info->Name = value;
+			}
+			else if (!has_sizes && get_labeled_value(line, "BaseSize:", value))
+			{
+				// Sizes from SOS are kept if the MethodTable cannot be read.
+				info->BaseSize = std::stoul(value, nullptr, 16);
+			}
+			else if (!has_sizes && get_labeled_value(line, "ComponentSize:", value))
+			{
+				info->ComponentSize = std::stoul(value, nullptr, 16);
+			}
+		}
+		catch (std::invalid_argument)
+		{
+			_logger->Log("Method table info cannot be read: %s\n", line.c_str());
+		}
+	}
+}
+
+/**
+Parses instance fields of a !dumpclass output.
+
+\param info Entry to fill.
+\param lines Command output.
+*/
+void MethodTableCache::ParseDumpClass(MethodTableInfo& info, const std::string& lines)
+{
+	/*
+	      MT    Field   Offset                 Type VT     Attr    Value Name
+	72f5f9ac  4000603        4 ....Contexts.Context  0 instance           m_Context
+	72f62254  4000606        c        System.String  0 instance           m_Name
+	*/
+
+	std::istringstream iss(lines);
+
+	std::string line;
+
+	auto is_field = false;
+
+	while (std::getline(iss, line))
+	{
+		if (!is_field)
+		{
+			is_field = line.find("Offset") != std::string::npos && line.find("Attr") != std::string::npos;
+
+			continue;
+		}
+
+		std::istringstream line_stream(line);
+		std::vector<std::string> items((std::istream_iterator<std::string>(line_stream)), std::istream_iterator<std::string>());
+
+		if (items.size() < 7 || items[5] != "instance")
+		{
+			continue;
+		}
+
+		try{
+			info.Fields.push_back(MethodTableField(items.back(), std::stoul(items[2], nullptr, 16)));
+		}
+		catch (std::invalid_argument)
+		{
+			_logger->Log("Field cannot be read: %s\n", line.c_str());
+		}
+	}
+}
+
+/**
+Gets a MethodTable entry, reading its sizes and parent on first use.
+
+\param method_table MethodTable address.
+*/
+const MethodTableInfo& MethodTableCache::get(unsigned long method_table)
+{
+	auto& info = _method_tables[method_table];
+
+	if (!info.IsRead)
+	{
+		info.MethodTable = method_table;
+		info.IsRead = true;
+
+		unsigned char fields[METHOD_TABLE_READ_SIZE];
+		unsigned long read = 0;
+
+		if (_memory_reader && _memory_reader->ReadMemory(method_table, fields, sizeof(fields), &read))
+		{
+			set_sizes(info, fields);
+		}
+	}
+
+	return info;
+}
+
+/**
+Gets base size and component size of a MethodTable, can be called by heap walkers on multiple threads.
+
+\param method_table MethodTable address.
+\param base_size Base size of instances, including the object header.
+\param component_size Size of array elements or string characters, zero for other types.
+\return false if the MethodTable cannot be read or is not valid.
+*/
+bool MethodTableCache::get_sizes(unsigned long method_table, unsigned long& base_size, unsigned long& component_size)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	auto& info = get(method_table);
+
+	base_size = info.BaseSize;
+	component_size = info.ComponentSize;
+
+	return info.is_valid();
+}
+
+/**
+Gets the GC descriptor of a MethodTable, reading it on first use, can be called by heap walkers on multiple threads.
+
+\param method_table MethodTable address.
+\param gc_desc Receives the descriptor, empty for types without references.
+\return false if the MethodTable or its descriptor cannot be read.
+*/
+bool MethodTableCache::get_gc_desc(unsigned long method_table, GCDesc& gc_desc)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	get(method_table);
+
+	auto& info = _method_tables[method_table];
+
+	if (!info.is_valid())
+	{
+		return false;
+	}
+
+	if (!info.IsGCDescRead)
+	{
+		info.IsGCDescRead = true;
+
+		if (info.ContainsPointers && (!_memory_reader || !info.GCDescriptor.read(_memory_reader, method_table)))
+		{
+			info.GCDescriptor = GCDesc();
+		}
+	}
+
+	if (info.ContainsPointers && info.GCDescriptor.Series.empty() && info.GCDescriptor.ValueSeries.empty())
+	{
+		return false;
+	}
+
+	gc_desc = info.GCDescriptor;
+
+	return true;
+}
+
+/**
+Gets the type name of a MethodTable, running !dumpmt on first use.
+
+\param method_table MethodTable address.
+*/
+const std::string& MethodTableCache::get_name(unsigned long method_table)
+{
+	auto& info = _method_tables[method_table];
+
+	if (!info.IsNamed)
+	{
+		load_names(std::vector<unsigned long>(1, method_table));
+	}
+
+	return info.Name;
+}
+
+/**
+Finds the offset of an instance field of a type or its base types, running !dumpclass on first use.
+
+\param method_table MethodTable address.
+\param field_name Field name.
+\param offset Offset of the field from the object address.
+\return true if the field is found.
+*/
+bool MethodTableCache::get_field_offset(unsigned long method_table, const std::string& field_name, unsigned long& offset)
+{
+	for (unsigned long depth = 0; method_table != 0 && depth < MAX_PARENT_DEPTH; depth++)
+	{
+		get_name(method_table);
+
+		auto& info = _method_tables[method_table];
+
+		if (!info.IsFieldsRead)
+		{
+			info.IsFieldsRead = true;
+
+			std::string output;
+
+			if (_executor && info.EEClass != 0 && _executor->ExecuteCommand(_command_dumpclass + " " + to_hex(info.EEClass), output))
+			{
+				ParseDumpClass(info, output);
+			}
+		}
+
+		auto field = std::find_if(info.Fields.begin(), info.Fields.end(), [&](const MethodTableField& field){ return field.Name == field_name; });
+
+		if (field != info.Fields.end())
+		{
+			offset = field->Offset;
+
+			return true;
+		}
+
+		method_table = get(method_table).ParentMethodTable;
+	}
+
+	return false;
+}
+
+/**
+Finds MethodTables of a type with !name2ee, without scanning the heap.
+
+\param clr_exact_type_name Type name, including namespace.
+\return MethodTable addresses, cached when found.
+*/
+std::vector<unsigned long> MethodTableCache::find_method_tables(const std::string& clr_exact_type_name)
+{
+	auto it = _type_names.find(clr_exact_type_name);
+
+	if (it != _type_names.end())
+	{
+		return it->second;
+	}
+
+	std::vector<unsigned long> ret;
+
+	for (auto& method_table : _method_tables)
+	{
+		if (method_table.second.Name == clr_exact_type_name)
+		{
+			ret.push_back(method_table.first);
+		}
+	}
+
+	std::string output;
+
+	if (_executor && _executor->ExecuteCommand(_command_name2ee + clr_exact_type_name, output))
+	{
+		/*
+		Module:      72a51000
+		Assembly:    mscorlib.dll
+		Token:       020001a9
+		MethodTable: 72f5f9ac
+		EEClass:     72b4e3c8
+		Name:        System.Threading.Thread
+		*/
+
+		std::istringstream iss(output);
+
+		std::string line;
+		std::string value;
+
+		MethodTableInfo* info = nullptr;
+
+		while (std::getline(iss, line))
+		{
+			try{
+				if (get_labeled_value(line, "MethodTable:", value))
+				{
+					auto method_table = std::stoul(value, nullptr, 16);
+
+					info = &_method_tables[method_table];
+					info->MethodTable = method_table;
+
+					ret.push_back(method_table);
+				}
+				else if (info && get_labeled_value(line, "EEClass:", value))
+				{
+					info->EEClass = std::stoul(value, nullptr, 16);
+				}
+				else if (info && get_labeled_value(line, "Name:", value))
+				{
+					info->Name = value;
+					info->IsNamed = true;
+					info = nullptr;
+				}
+			}
+			catch (std::invalid_argument)
+			{
+				// <not loaded>
+				info = nullptr;
+			}
+		}
+	}
+
+	std::sort(ret.begin(), ret.end());
+	ret.erase(std::unique(ret.begin(), ret.end()), ret.end());
+
+	if (!ret.empty())
+	{
+		_type_names[clr_exact_type_name] = ret;
+	}
+
+	return ret;
+}
\ No newline at end of file
@@ -0,0 +1,389 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file MinidumpFile.cpp
+
+Implements MinidumpFile class that memory-maps a minidump file and locates its streams.
+*/
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cctype>
+
+#include "MinidumpFile.h"
+
+const unsigned long MinidumpFile::SIGNATURE;
+const unsigned long MinidumpFile::THREAD_LIST_STREAM;
+const unsigned long MinidumpFile::MODULE_LIST_STREAM;
+const unsigned long MinidumpFile::MEMORY_LIST_STREAM;
+const unsigned long MinidumpFile::MEMORY64_LIST_STREAM;
+const unsigned long MinidumpFile::MEMORY_INFO_LIST_STREAM;
+
+/**
+Memory-maps a minidump file read-only.
+
+The whole file is mapped, dumps larger than the free address space of the process cannot be opened.
+
+\param filename Path of the .dmp file.
+*/
+bool MinidumpFile::open(const std::string& filename)
+{
+	close();
+
+#ifdef _WIN32
+	auto file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		_logger->Log("Cannot open dump file %s.\n", filename.c_str());
+
+		return false;
+	}
+
+	LARGE_INTEGER file_size;
+
+	if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+	{
+		_logger->Log("Cannot get size of dump file %s.\n", filename.c_str());
+
+		CloseHandle(file);
+
+		return false;
+	}
+
+	auto mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+	if (!mapping)
+	{
+		_logger->Log("Cannot create mapping of dump file %s.\n", filename.c_str());
+
+		CloseHandle(file);
+
+		return false;
+	}
+
+	auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+	if (!view)
+	{
+		_logger->Log("Cannot map dump file %s.\n", filename.c_str());
+
+		CloseHandle(mapping);
+		CloseHandle(file);
+
+		return false;
+	}
+
+	_file_handle = file;
+	_mapping_handle = mapping;
+	_data = static_cast<const unsigned char*>(view);
+	_size = file_size.QuadPart;
+#else
+	auto fd = ::open(filename.c_str(), O_RDONLY);
+
+	if (fd < 0)
+	{
+		_logger->Log("Cannot open dump file %s.\n", filename.c_str());
+
+		return false;
+	}
+
+	struct stat file_stat;
+
+	if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0)
+	{
+		_logger->Log("Cannot get size of dump file %s.\n", filename.c_str());
+
+		::close(fd);
+
+		return false;
+	}
+
+	auto view = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	::close(fd);
+
+	if (view == MAP_FAILED)
+	{
+		_logger->Log("Cannot map dump file %s.\n", filename.c_str());
+
+		return false;
+	}
+
+	_data = static_cast<const unsigned char*>(view);
+	_size = file_stat.st_size;
+#endif
+
+	_is_mapped = true;
+
+	if (!parse_header())
+	{
+		close();
+
+		return false;
+	}
+
+	return true;
+}
+
+/**
+Uses an existing buffer as the contents of a minidump file.
+
+\param data Minidump contents, must outlive this instance.
+\param size Size of the data.
+*/
+bool MinidumpFile::attach(const void* data, unsigned long long size)
+{
+	close();
+
+	_data = static_cast<const unsigned char*>(data);
+	_size = size;
+
+	if (!parse_header())
+	{
+		close();
+
+		return false;
+	}
+
+	return true;
+}
+
+/**
+Unmaps the file.
+*/
+void MinidumpFile::close()
+{
+	if (_is_mapped)
+	{
+		unmap();
+	}
+
+	_data = nullptr;
+	_size = 0;
+	_is_mapped = false;
+	_stream_count = 0;
+	_stream_directory_rva = 0;
+}
+
+/**
+Releases the file mapping.
+*/
+void MinidumpFile::unmap()
+{
+#ifdef _WIN32
+	UnmapViewOfFile(_data);
+
+	CloseHandle(_mapping_handle);
+	CloseHandle(_file_handle);
+
+	_mapping_handle = nullptr;
+	_file_handle = nullptr;
+#else
+	munmap(const_cast<unsigned char*>(_data), static_cast<size_t>(_size));
+#endif
+}
+
+/**
+Validates the MINIDUMP_HEADER and locates the stream directory.
+*/
+bool MinidumpFile::parse_header()
+{
+	// Signature, Version, NumberOfStreams, StreamDirectoryRva, CheckSum, TimeDateStamp, Flags.
+	auto header = at(0, 32);
+
+	if (!header || read_u32(header) != SIGNATURE)
+	{
+		_logger->Log("Not a minidump file.\n");
+
+		return false;
+	}
+
+	_stream_count = read_u32(header + 8);
+	_stream_directory_rva = read_u32(header + 12);
+
+	if (!at(_stream_directory_rva, 12ULL * _stream_count))
+	{
+		_logger->Log("Minidump stream directory is truncated.\n");
+
+		return false;
+	}
+
+	return true;
+}
+
+/**
+Gets a bounds checked pointer into the file.
+
+\param rva File offset.
+\param size Number of bytes that must be available at rva.
+\return Pointer to the data or nullptr if the range is outside the file.
+*/
+const unsigned char* MinidumpFile::at(unsigned long long rva, unsigned long long size) const
+{
+	if (!_data || rva > _size || size > _size - rva)
+	{
+		return nullptr;
+	}
+
+	return _data + rva;
+}
+
+/**
+Finds the first stream of a type in the stream directory.
+
+\param stream_type MINIDUMP_STREAM_TYPE value.
+\param stream Pointer to the stream data.
+\param stream_size Size of the stream data.
+*/
+bool MinidumpFile::find_stream(unsigned long stream_type, const unsigned char*& stream, unsigned long& stream_size) const
+{
+	for (unsigned long i = 0; i < _stream_count; i++)
+	{
+		// StreamType, DataSize, Rva.
+		auto entry = at(_stream_directory_rva + 12ULL * i, 12);
+
+		if (read_u32(entry) != stream_type)
+		{
+			continue;
+		}
+
+		auto data_size = read_u32(entry + 4);
+		auto data = at(read_u32(entry + 8), data_size);
+
+		if (!data)
+		{
+			_logger->Log("Minidump stream %lu is truncated.\n", stream_type);
+
+			return false;
+		}
+
+		stream = data;
+		stream_size = data_size;
+
+		return true;
+	}
+
+	return false;
+}
+
+/**
+Reads the entries of the thread list stream.
+*/
+std::vector<MinidumpThread> MinidumpFile::get_threads() const
+{
+	std::vector<MinidumpThread> ret;
+
+	const unsigned char* stream;
+	unsigned long stream_size;
+
+	if (!find_stream(THREAD_LIST_STREAM, stream, stream_size) || stream_size < 4)
+	{
+		return ret;
+	}
+
+	auto count = std::min<unsigned long>(read_u32(stream), (stream_size - 4) / 48);
+
+	ret.reserve(count);
+
+	for (unsigned long i = 0; i < count; i++)
+	{
+		// ThreadId, SuspendCount, PriorityClass, Priority, Teb, Stack, ThreadContext.
+		auto thread = stream + 4 + 48 * i;
+
+		ret.push_back(MinidumpThread(read_u32(thread), read_u64(thread + 16), read_u64(thread + 24), read_u32(thread + 32), read_u32(thread + 44), read_u32(thread + 40)));
+	}
+
+	return ret;
+}
+
+/**
+Reads the entries of the module list stream. Module names are reduced to lower case file names without extension, as the debugger names modules.
+*/
+std::vector<MinidumpModule> MinidumpFile::get_modules() const
+{
+	std::vector<MinidumpModule> ret;
+
+	const unsigned char* stream;
+	unsigned long stream_size;
+
+	if (!find_stream(MODULE_LIST_STREAM, stream, stream_size) || stream_size < 4)
+	{
+		return ret;
+	}
+
+	auto count = std::min<unsigned long>(read_u32(stream), (stream_size - 4) / 108);
+
+	ret.reserve(count);
+
+	for (unsigned long i = 0; i < count; i++)
+	{
+		// BaseOfImage, SizeOfImage, CheckSum, TimeDateStamp, ModuleNameRva, ...
+		auto module = stream + 4 + 108 * i;
+
+		std::string name;
+
+		auto name_rva = read_u32(module + 20);
+		auto name_header = at(name_rva, 4);
+		auto name_data = name_header ? at(name_rva + 4, read_u32(name_header)) : nullptr;
+
+		if (name_data)
+		{
+			auto length = read_u32(name_header) / 2;
+
+			for (unsigned long c = 0; c < length; c++)
+			{
+				auto ch = read_u16(name_data + 2 * c);
+
+				if (ch == '\\' || ch == '/')
+					name.clear();
+				else
+					name.push_back(static_cast<char>(ch < 0x80 ? tolower(ch) : '?'));
+			}
+
+			auto dot_index = name.rfind('.');
+
+			if (dot_index != std::string::npos)
+			{
+				name = name.substr(0, dot_index);
+			}
+		}
+
+		ret.push_back(MinidumpModule(read_u64(module), read_u32(module + 8), name));
+	}
+
+	return ret;
+}
\ No newline at end of file
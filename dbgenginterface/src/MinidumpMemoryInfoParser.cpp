@@ -0,0 +1,316 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file MinidumpMemoryInfoParser.cpp
+
+Implements MinidumpMemoryInfoParser class that builds address ranges from the MemoryInfoListStream of a minidump.
+*/
+
+#include <algorithm>
+
+#include "MinidumpMemoryInfoParser.h"
+
+const unsigned long MinidumpMemoryInfoParser::MEM_COMMIT_STATE;
+const unsigned long MinidumpMemoryInfoParser::MEM_RESERVE_STATE;
+const unsigned long MinidumpMemoryInfoParser::MEM_FREE_STATE;
+const unsigned long MinidumpMemoryInfoParser::MEM_PRIVATE_TYPE;
+const unsigned long MinidumpMemoryInfoParser::MEM_MAPPED_TYPE;
+const unsigned long MinidumpMemoryInfoParser::MEM_IMAGE_TYPE;
+const unsigned long MinidumpMemoryInfoParser::PAGE_GUARD_PROTECT;
+const unsigned long MinidumpMemoryInfoParser::MAX_HEAP_COUNT;
+
+/**
+Decodes MINIDUMP_MEMORY_INFO entries into ranges, classifying stacks, TEBs, PEB, process parameters, environment and heaps
+from the thread list stream and, when a memory reader is available, from the PEB.
+*/
+AddressCommandOutput MinidumpMemoryInfoParser::execute()
+{
+	const unsigned char* stream;
+	unsigned long stream_size;
+
+	if (!_dump.find_stream(MinidumpFile::MEMORY_INFO_LIST_STREAM, stream, stream_size))
+	{
+		_logger->Log("Dump does not contain memory info.\n");
+
+		return AddressCommandOutput();
+	}
+
+	auto infos = Parse(stream, stream_size);
+
+	std::unordered_map<unsigned long long, ::Usage> allocation_usages;
+	std::unordered_map<unsigned long long, ::Usage> region_usages;
+
+	FindSystemRegions(infos, allocation_usages, region_usages);
+
+	auto ret = new std::vector<const MemoryRange>();
+
+	ret->reserve(infos.size());
+
+	for (auto& info : infos)
+	{
+		auto state = GetState(info);
+		auto usage = GetUsage(info);
+
+		if (state != State::Free)
+		{
+			auto region_usage = region_usages.find(info.BaseAddress);
+			auto allocation_usage = allocation_usages.find(info.AllocationBase);
+
+			if (region_usage != region_usages.end())
+				usage = region_usage->second;
+			else if (allocation_usage != allocation_usages.end())
+				usage = allocation_usage->second;
+		}
+
+		ret->push_back(MemoryRange(static_cast<unsigned long>(info.BaseAddress), static_cast<unsigned long>(info.RegionSize), state, usage));
+	}
+
+	return AddressCommandOutput(RangeList(ret));
+}
+
+/**
+Parses a MINIDUMP_MEMORY_INFO_LIST stream.
+
+\param stream Stream data.
+\param stream_size Size of the stream data.
+\return Regions sorted by base address.
+*/
+std::vector<MinidumpMemoryInfoParser::MemoryInfo> MinidumpMemoryInfoParser::Parse(const unsigned char* stream, unsigned long stream_size)
+{
+	std::vector<MemoryInfo> ret;
+
+	if (stream_size < 16)
+	{
+		return ret;
+	}
+
+	auto header_size = MinidumpFile::read_u32(stream);
+	auto entry_size = MinidumpFile::read_u32(stream + 4);
+	auto count = MinidumpFile::read_u64(stream + 8);
+
+	if (header_size < 16 || header_size > stream_size || entry_size < 48)
+	{
+		_logger->Log("Invalid memory info list.\n");
+
+		return ret;
+	}
+
+	count = std::min<unsigned long long>(count, (stream_size - header_size) / entry_size);
+
+	ret.reserve(static_cast<size_t>(count));
+
+	for (unsigned long long i = 0; i < count; i++)
+	{
+		// BaseAddress, AllocationBase, AllocationProtect, __alignment1, RegionSize, State, Protect, Type, __alignment2.
+		auto entry = stream + header_size + entry_size * i;
+
+		MemoryInfo info;
+
+		info.BaseAddress = MinidumpFile::read_u64(entry);
+		info.AllocationBase = MinidumpFile::read_u64(entry + 8);
+		info.RegionSize = MinidumpFile::read_u64(entry + 24);
+		info.State = MinidumpFile::read_u32(entry + 32);
+		info.Protect = MinidumpFile::read_u32(entry + 36);
+		info.Type = MinidumpFile::read_u32(entry + 40);
+
+		if (info.RegionSize == 0)
+		{
+			continue;
+		}
+
+		ret.push_back(info);
+	}
+
+	std::sort(ret.begin(), ret.end(), [](const MemoryInfo& a, const MemoryInfo& b){ return a.BaseAddress < b.BaseAddress; });
+
+	return ret;
+}
+
+/**
+Finds the region containing an address.
+
+\param infos Regions sorted by base address.
+\param address Target address.
+\return Region or nullptr.
+*/
+const MinidumpMemoryInfoParser::MemoryInfo* MinidumpMemoryInfoParser::FindRegion(const std::vector<MemoryInfo>& infos, unsigned long long address)
+{
+	auto it = std::upper_bound(infos.begin(), infos.end(), address, [](unsigned long long value, const MemoryInfo& info){ return value < info.BaseAddress; });
+
+	if (it == infos.begin())
+	{
+		return nullptr;
+	}
+
+	--it;
+
+	if (address - it->BaseAddress >= it->RegionSize)
+	{
+		return nullptr;
+	}
+
+	return &*it;
+}
+
+/**
+Finds stack, TEB, PEB, process parameters, environment and heap regions that !address would report.
+Stacks and heaps are matched by allocation base, the others by the region containing them.
+
+\param infos Regions sorted by base address.
+\param allocation_usages Usages keyed by allocation base.
+\param region_usages Usages keyed by region base address.
+*/
+void MinidumpMemoryInfoParser::FindSystemRegions(const std::vector<MemoryInfo>& infos, std::unordered_map<unsigned long long, ::Usage>& allocation_usages, std::unordered_map<unsigned long long, ::Usage>& region_usages)
+{
+	auto threads = _dump.get_threads();
+
+	unsigned long long teb = 0;
+
+	for (auto& thread : threads)
+	{
+		// Stack grows down from StackStart + StackSize, guard and reserved pages share the allocation.
+		auto stack = FindRegion(infos, thread.StackStart);
+
+		if (stack)
+			allocation_usages[stack->AllocationBase] = Usage::Stack;
+
+		auto teb_region = FindRegion(infos, thread.Teb);
+
+		if (teb_region)
+			region_usages[teb_region->BaseAddress] = Usage::TEB;
+
+		if (teb == 0)
+			teb = thread.Teb;
+	}
+
+	if (!_reader || teb == 0)
+	{
+		return;
+	}
+
+	// x86 TEB->ProcessEnvironmentBlock, PEB->ProcessParameters, NumberOfHeaps, ProcessHeaps, RTL_USER_PROCESS_PARAMETERS->Environment.
+	unsigned int peb = 0;
+	unsigned long read;
+
+	if (!_reader->ReadMemory(static_cast<unsigned long>(teb + 0x30), &peb, sizeof(peb), &read) || peb == 0)
+	{
+		return;
+	}
+
+	unsigned int process_parameters = 0;
+	unsigned int number_of_heaps = 0;
+	unsigned int process_heaps = 0;
+
+	std::vector<MemoryReadRequest> requests;
+
+	requests.push_back(MemoryReadRequest(peb + 0x10, sizeof(process_parameters), &process_parameters));
+	requests.push_back(MemoryReadRequest(peb + 0x88, sizeof(number_of_heaps), &number_of_heaps));
+	requests.push_back(MemoryReadRequest(peb + 0x90, sizeof(process_heaps), &process_heaps));
+
+	_reader->ReadMany(requests);
+
+	unsigned int environment = 0;
+
+	if (requests[0].succeeded && process_parameters != 0)
+	{
+		_reader->ReadMemory(process_parameters + 0x48, &environment, sizeof(environment), &read);
+	}
+
+	std::vector<unsigned int> heaps;
+
+	if (requests[1].succeeded && requests[2].succeeded && process_heaps != 0 && number_of_heaps <= MAX_HEAP_COUNT)
+	{
+		heaps.resize(number_of_heaps);
+
+		if (number_of_heaps > 0 && !_reader->ReadMemory(process_heaps, heaps.data(), number_of_heaps * sizeof(unsigned int), &read))
+		{
+			heaps.resize(read / sizeof(unsigned int));
+		}
+	}
+
+	for (auto heap : heaps)
+	{
+		auto region = FindRegion(infos, heap);
+
+		if (region)
+			allocation_usages[region->AllocationBase] = Usage::Heap;
+	}
+
+	auto system_regions = { std::make_pair(static_cast<unsigned long long>(peb), Usage::PEB),
+		std::make_pair(static_cast<unsigned long long>(process_parameters), Usage::ProcessParameters),
+		std::make_pair(static_cast<unsigned long long>(environment), Usage::EnvironmentBlock) };
+
+	for (auto& system_region : system_regions)
+	{
+		auto region = system_region.first != 0 ? FindRegion(infos, system_region.first) : nullptr;
+
+		if (region)
+			region_usages[region->BaseAddress] = system_region.second;
+	}
+}
+
+/**
+Maps MEM_COMMIT, MEM_RESERVE and MEM_FREE to the state of a range.
+
+\param info Region information.
+*/
+State MinidumpMemoryInfoParser::GetState(const MemoryInfo& info)
+{
+	switch (info.State)
+	{
+	case MEM_COMMIT_STATE:
+		return State::Commit;
+	case MEM_RESERVE_STATE:
+		return State::Reserve;
+	case MEM_FREE_STATE:
+		return State::Free;
+	default:
+		return State::Undefined;
+	}
+}
+
+/**
+Maps region type and protection to the usage of a range, before system regions are classified.
+
+\param info Region information.
+*/
+Usage MinidumpMemoryInfoParser::GetUsage(const MemoryInfo& info)
+{
+	if (info.State == MEM_FREE_STATE)
+		return Usage::Free;
+
+	if (info.Type == MEM_IMAGE_TYPE)
+		return Usage::Image;
+
+	// Guard pages outside of known stacks belong to threads not in the dump.
+	if ((info.Protect & PAGE_GUARD_PROTECT) != 0)
+		return Usage::Stack;
+
+	if (info.Type == MEM_PRIVATE_TYPE || info.Type == MEM_MAPPED_TYPE)
+		return Usage::VirtualAlloc;
+
+	return Usage::Undefined;
+}
\ No newline at end of file
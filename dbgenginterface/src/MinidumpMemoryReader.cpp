@@ -0,0 +1,255 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file MinidumpMemoryReader.cpp
+
+Implements MinidumpMemoryReader class that serves memory reads from a memory-mapped minidump file.
+*/
+
+#include <algorithm>
+#include <cstring>
+
+#include "MinidumpMemoryReader.h"
+
+/**
+Constructs an instance of the MinidumpMemoryReader class and builds the address to file offset index.
+
+\param dump Opened minidump file, must outlive this instance.
+*/
+MinidumpMemoryReader::MinidumpMemoryReader(const MinidumpFile& dump)
+	: _dump(dump)
+{
+	const unsigned char* stream;
+	unsigned long stream_size;
+
+	if (_dump.find_stream(MinidumpFile::MEMORY_LIST_STREAM, stream, stream_size))
+	{
+		add_memory_list(stream, stream_size);
+	}
+
+	if (_dump.find_stream(MinidumpFile::MEMORY64_LIST_STREAM, stream, stream_size))
+	{
+		add_memory64_list(stream, stream_size);
+	}
+
+	std::sort(_regions.begin(), _regions.end(), [](const MinidumpMemoryRegion& a, const MinidumpMemoryRegion& b){ return a.Address < b.Address; });
+
+	// Drop regions overlapping a previous region.
+	auto last = std::unique(_regions.begin(), _regions.end(), [](const MinidumpMemoryRegion& a, const MinidumpMemoryRegion& b){ return b.Address < a.Address + a.Size; });
+
+	_regions.erase(last, _regions.end());
+}
+
+/**
+Adds the regions of a MINIDUMP_MEMORY_LIST stream.
+
+\param stream Stream data.
+\param stream_size Size of the stream data.
+*/
+void MinidumpMemoryReader::add_memory_list(const unsigned char* stream, unsigned long stream_size)
+{
+	if (stream_size < 4)
+	{
+		return;
+	}
+
+	auto count = std::min<unsigned long long>(MinidumpFile::read_u32(stream), (stream_size - 4) / 16);
+
+	for (unsigned long long i = 0; i < count; i++)
+	{
+		// StartOfMemoryRange, Memory.DataSize, Memory.Rva.
+		auto descriptor = stream + 4 + 16 * i;
+
+		auto address = MinidumpFile::read_u64(descriptor);
+		auto size = MinidumpFile::read_u32(descriptor + 8);
+		auto rva = MinidumpFile::read_u32(descriptor + 12);
+
+		if (size == 0 || !_dump.at(rva, size))
+		{
+			continue;
+		}
+
+		_regions.push_back(MinidumpMemoryRegion(address, size, rva));
+	}
+}
+
+/**
+Adds the regions of a MINIDUMP_MEMORY64_LIST stream, whose data is stored contiguously from BaseRva.
+
+\param stream Stream data.
+\param stream_size Size of the stream data.
+*/
+void MinidumpMemoryReader::add_memory64_list(const unsigned char* stream, unsigned long stream_size)
+{
+	if (stream_size < 16)
+	{
+		return;
+	}
+
+	auto count = std::min<unsigned long long>(MinidumpFile::read_u64(stream), (stream_size - 16) / 16);
+	auto rva = MinidumpFile::read_u64(stream + 8);
+
+	for (unsigned long long i = 0; i < count; i++)
+	{
+		// StartOfMemoryRange, DataSize.
+		auto descriptor = stream + 16 + 16 * i;
+
+		auto address = MinidumpFile::read_u64(descriptor);
+		auto size = MinidumpFile::read_u64(descriptor + 8);
+
+		if (!_dump.at(rva, size))
+		{
+			break;
+		}
+
+		if (size != 0)
+		{
+			_regions.push_back(MinidumpMemoryRegion(address, size, rva));
+		}
+
+		rva += size;
+	}
+}
+
+/**
+Finds the region containing an address.
+
+\param address Target address.
+\return Iterator to the region or end of regions.
+*/
+std::vector<MinidumpMemoryRegion>::const_iterator MinidumpMemoryReader::find_region(unsigned long long address) const
+{
+	auto it = std::upper_bound(_regions.begin(), _regions.end(), address, [](unsigned long long value, const MinidumpMemoryRegion& region){ return value < region.Address; });
+
+	if (it == _regions.begin())
+	{
+		return _regions.end();
+	}
+
+	--it;
+
+	if (address - it->Address >= it->Size)
+	{
+		return _regions.end();
+	}
+
+	return it;
+}
+
+/**
+Copies target memory from the mapped file.
+
+\param offset Address to read from.
+\param lpBuffer Buffer to copy the memory to.
+\param cb Number of bytes to read.
+\param lpcbBytesRead Number of contiguous bytes read from offset.
+\return Nonzero if all cb bytes were read.
+*/
+#pragma push_macro("ReadMemory")
+#undef ReadMemory
+unsigned long MinidumpMemoryReader::ReadMemory(unsigned long offset, void *lpBuffer, unsigned long cb, unsigned long* lpcbBytesRead)
+#pragma pop_macro("ReadMemory")
+{
+	auto buffer = static_cast<unsigned char*>(lpBuffer);
+
+	unsigned long copied = 0;
+
+	auto region = find_region(offset);
+
+	while (copied < cb && region != _regions.end())
+	{
+		auto address = static_cast<unsigned long long>(offset) + copied;
+
+		if (address < region->Address || address - region->Address >= region->Size)
+		{
+			break;
+		}
+
+		auto region_offset = address - region->Address;
+		auto count = static_cast<unsigned long>(std::min<unsigned long long>(region->Size - region_offset, cb - copied));
+
+		memcpy(buffer + copied, _dump.at(region->FileOffset + region_offset, count), count);
+
+		copied += count;
+
+		// Continue into the next region only if it is adjacent.
+		++region;
+	}
+
+	if (lpcbBytesRead)
+	{
+		*lpcbBytesRead = copied;
+	}
+
+	return copied == cb;
+}
+
+/**
+Serves each request directly from the mapping, no coalescing is needed.
+
+\param requests Read requests, succeeded is set for each request.
+\return Number of succeeded requests.
+*/
+unsigned long MinidumpMemoryReader::ReadMany(std::vector<MemoryReadRequest>& requests)
+{
+	unsigned long succeeded = 0;
+
+	for (auto& request : requests)
+	{
+		unsigned long bytes_read = 0;
+
+#pragma push_macro("ReadMemory")
+#undef ReadMemory
+		request.succeeded = ReadMemory(request.address, request.buffer, request.size, &bytes_read) != 0;
+#pragma pop_macro("ReadMemory")
+
+		if (request.succeeded)
+		{
+			succeeded++;
+		}
+	}
+
+	return succeeded;
+}
+
+/**
+Gets a pointer into the mapped file for a range of target memory without copying.
+
+\param address Target address.
+\param size Number of bytes.
+\return Pointer to the memory or nullptr if the range is not stored in a single region.
+*/
+const void* MinidumpMemoryReader::get_pointer(unsigned long address, unsigned long size) const
+{
+	auto region = find_region(address);
+
+	if (region == _regions.end() || address - region->Address + size > region->Size)
+	{
+		return nullptr;
+	}
+
+	return _dump.at(region->FileOffset + (address - region->Address), size);
+}
\ No newline at end of file
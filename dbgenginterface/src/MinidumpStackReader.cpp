@@ -0,0 +1,326 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file MinidumpStackReader.cpp
+
+Implements MinidumpStackReader class that reads top stack frames of threads from a minidump without executing debugger commands.
+*/
+
+#include <algorithm>
+#include <cstring>
+
+#include "MinidumpStackReader.h"
+
+const unsigned long MinidumpStackReader::CONTEXT_EBP_OFFSET;
+const unsigned long MinidumpStackReader::CONTEXT_EIP_OFFSET;
+const unsigned long MinidumpStackReader::CONTEXT_ESP_OFFSET;
+const unsigned long MinidumpStackReader::MIN_CONTEXT_SIZE;
+const unsigned long MinidumpStackReader::MAX_EXPORT_COUNT;
+
+/**
+Constructs an instance of the MinidumpStackReader class.
+
+\param dump Opened minidump file, must outlive this instance.
+\param memory_reader Reader of the dump memory, used for stacks and export tables.
+\param logger Logger.
+*/
+MinidumpStackReader::MinidumpStackReader(const MinidumpFile& dump, IMemoryReader* memory_reader, ILogger* logger)
+	: _dump(dump), _memory_reader(memory_reader), _logger(logger), _modules(dump.get_modules())
+{
+	std::sort(_modules.begin(), _modules.end(), [](const MinidumpModule& a, const MinidumpModule& b){ return a.BaseOfImage < b.BaseOfImage; });
+}
+
+/**
+Reads the instruction pointer of each thread from its context and the return address and first three arguments from its stack,
+as the first line of kv output would show them. Threads in KiFastSystemCallRet are reported from the system call stub that called it.
+
+\return Top frames, or empty if no frame could be resolved to an export.
+*/
+std::vector<PartialStackFrame> MinidumpStackReader::get_top_frames()
+{
+	std::vector<PartialStackFrame> ret;
+
+	auto threads = _dump.get_threads();
+
+	std::vector<unsigned long> eips;
+	std::vector<unsigned int> stacks(threads.size() * 5);
+	std::vector<MemoryReadRequest> requests;
+
+	ret.reserve(threads.size());
+	eips.reserve(threads.size());
+	requests.reserve(threads.size());
+
+	for (auto& thread : threads)
+	{
+		auto context = thread.ContextSize >= MIN_CONTEXT_SIZE ? _dump.at(thread.ContextRva, thread.ContextSize) : nullptr;
+
+		if (!context)
+		{
+			_logger->Log("Context of thread %x not found.\n", thread.ThreadId);
+
+			continue;
+		}
+
+		PartialStackFrame frame;
+
+		frame.thread_id = thread.ThreadId;
+		frame.child_ebp = MinidumpFile::read_u32(context + CONTEXT_EBP_OFFSET);
+
+		// Return address, three arguments and one more slot in case the frame is shifted.
+		requests.push_back(MemoryReadRequest(MinidumpFile::read_u32(context + CONTEXT_ESP_OFFSET), 5 * sizeof(unsigned int), &stacks[5 * ret.size()]));
+		eips.push_back(MinidumpFile::read_u32(context + CONTEXT_EIP_OFFSET));
+		ret.push_back(frame);
+	}
+
+	// Stacks of all threads are read with a single vectored read.
+	_memory_reader->ReadMany(requests);
+
+	for (size_t i = 0; i < ret.size(); i++)
+	{
+		auto& frame = ret[i];
+		auto stack = &stacks[5 * i];
+
+		if (!requests[i].succeeded)
+		{
+			frame._is_valid = false;
+
+			continue;
+		}
+
+		resolve_symbol(eips[i], frame.symbol_name, frame.symbol_offset);
+
+		if (frame.symbol_name == "ntdll!KiFastSystemCallRet")
+		{
+			resolve_symbol(stack[0], frame.symbol_name, frame.symbol_offset);
+
+			stack++;
+		}
+
+		frame.ret_address = stack[0];
+		frame.arg1 = stack[1];
+		frame.arg2 = stack[2];
+		frame.arg3 = stack[3];
+	}
+
+	ret.erase(std::remove_if(ret.begin(), ret.end(), [](PartialStackFrame& frame){ return !frame.isValid(); }), ret.end());
+
+	// Without module images in the dump no wait API can be recognized.
+	if (std::none_of(ret.begin(), ret.end(), [](const PartialStackFrame& frame){ return frame.symbol_name.find('!') != std::string::npos; }))
+	{
+		ret.clear();
+	}
+
+	return ret;
+}
+
+/**
+Finds the module containing an address.
+
+\param address Target address.
+\return Module or nullptr.
+*/
+const MinidumpModule* MinidumpStackReader::find_module(unsigned long address) const
+{
+	auto it = std::upper_bound(_modules.begin(), _modules.end(), address, [](unsigned long long value, const MinidumpModule& module){ return value < module.BaseOfImage; });
+
+	if (it == _modules.begin())
+	{
+		return nullptr;
+	}
+
+	--it;
+
+	if (address - it->BaseOfImage >= it->SizeOfImage)
+	{
+		return nullptr;
+	}
+
+	return &*it;
+}
+
+/**
+Gets the exports of a module, reading its export table on first use.
+
+\param module Module.
+\return Exports sorted by RVA.
+*/
+const MinidumpStackReader::ExportList& MinidumpStackReader::get_exports(const MinidumpModule& module)
+{
+	auto it = _exports.find(module.BaseOfImage);
+
+	if (it != _exports.end())
+	{
+		return it->second;
+	}
+
+	auto& exports = _exports[module.BaseOfImage];
+
+	if (!read_exports(module, exports))
+	{
+		_logger->Log("Cannot read exports of %s.\n", module.Name.c_str());
+	}
+
+	return exports;
+}
+
+/**
+Reads the export table of a module from the dump memory.
+
+\param module Module.
+\param exports Exports sorted by RVA, Nt names are preferred over their Zw aliases.
+*/
+bool MinidumpStackReader::read_exports(const MinidumpModule& module, ExportList& exports)
+{
+	auto base = static_cast<unsigned long>(module.BaseOfImage);
+
+	unsigned long read;
+	unsigned int e_lfanew = 0;
+
+	if (!_memory_reader->ReadMemory(base + 0x3c, &e_lfanew, sizeof(e_lfanew), &read) || e_lfanew >= module.SizeOfImage)
+	{
+		return false;
+	}
+
+	// Signature, IMAGE_FILE_HEADER, IMAGE_OPTIONAL_HEADER up to the export data directory.
+	unsigned char headers[24 + 112 + 8];
+
+	if (!_memory_reader->ReadMemory(base + e_lfanew, headers, sizeof(headers), &read) || MinidumpFile::read_u32(headers) != 0x4550)
+	{
+		return false;
+	}
+
+	auto magic = MinidumpFile::read_u16(headers + 24);
+	auto data_directory = headers + 24 + (magic == 0x20b ? 112 : 96);
+
+	auto export_rva = MinidumpFile::read_u32(data_directory);
+	auto export_size = MinidumpFile::read_u32(data_directory + 4);
+
+	if (export_rva == 0 || export_size < 40 || export_size > module.SizeOfImage || export_rva > module.SizeOfImage - export_size)
+	{
+		return false;
+	}
+
+	// Directory, address tables and names are laid out in the export section.
+	std::vector<unsigned char> section(export_size);
+
+	if (!_memory_reader->ReadMemory(base + export_rva, section.data(), export_size, &read))
+	{
+		return false;
+	}
+
+	auto at = [&](unsigned long rva, unsigned long size) -> const unsigned char*
+	{
+		return rva >= export_rva && rva - export_rva <= export_size && size <= export_size - (rva - export_rva) ? section.data() + (rva - export_rva) : nullptr;
+	};
+
+	auto number_of_functions = std::min(MinidumpFile::read_u32(section.data() + 0x14), MAX_EXPORT_COUNT);
+	auto number_of_names = std::min(MinidumpFile::read_u32(section.data() + 0x18), MAX_EXPORT_COUNT);
+
+	auto functions = at(MinidumpFile::read_u32(section.data() + 0x1c), 4 * number_of_functions);
+	auto names = at(MinidumpFile::read_u32(section.data() + 0x20), 4 * number_of_names);
+	auto ordinals = at(MinidumpFile::read_u32(section.data() + 0x24), 2 * number_of_names);
+
+	if (!functions || !names || !ordinals)
+	{
+		return false;
+	}
+
+	exports.reserve(number_of_names);
+
+	for (unsigned long i = 0; i < number_of_names; i++)
+	{
+		auto ordinal = MinidumpFile::read_u16(ordinals + 2 * i);
+		auto name_rva = MinidumpFile::read_u32(names + 4 * i);
+		auto name = at(name_rva, 1);
+
+		if (ordinal >= number_of_functions || !name)
+		{
+			continue;
+		}
+
+		auto function_rva = MinidumpFile::read_u32(functions + 4 * ordinal);
+
+		// Forwarders point into the export section.
+		if (function_rva >= export_rva && function_rva - export_rva < export_size)
+		{
+			continue;
+		}
+
+		auto name_length = strnlen(reinterpret_cast<const char*>(name), export_size - (name_rva - export_rva));
+
+		exports.push_back(std::make_pair(function_rva, module.Name + "!" + std::string(reinterpret_cast<const char*>(name), name_length)));
+	}
+
+	auto is_zw = [&](const std::string& name){ return name.compare(module.Name.size() + 1, 2, "Zw") == 0; };
+
+	std::sort(exports.begin(), exports.end(), [&](const std::pair<unsigned long, std::string>& a, const std::pair<unsigned long, std::string>& b){ return a.first != b.first ? a.first < b.first : is_zw(b.second) && !is_zw(a.second); });
+
+	exports.erase(std::unique(exports.begin(), exports.end(), [](const std::pair<unsigned long, std::string>& a, const std::pair<unsigned long, std::string>& b){ return a.first == b.first; }), exports.end());
+
+	return true;
+}
+
+/**
+Resolves an address to the nearest preceding export of its module.
+
+\param address Target address.
+\param symbol_name Symbol name as module!export, module or empty if the address is not in a module.
+\param symbol_offset Offset from the symbol.
+\return true if an export is found.
+*/
+bool MinidumpStackReader::resolve_symbol(unsigned long address, std::string& symbol_name, unsigned long& symbol_offset)
+{
+	symbol_name.clear();
+	symbol_offset = address;
+
+	auto module = find_module(address);
+
+	if (!module)
+	{
+		return false;
+	}
+
+	auto rva = static_cast<unsigned long>(address - module->BaseOfImage);
+
+	auto& exports = get_exports(*module);
+
+	auto it = std::upper_bound(exports.begin(), exports.end(), rva, [](unsigned long value, const std::pair<unsigned long, std::string>& item){ return value < item.first; });
+
+	if (it == exports.begin())
+	{
+		symbol_name = module->Name;
+		symbol_offset = rva;
+
+		return false;
+	}
+
+	--it;
+
+	symbol_name = it->second;
+	symbol_offset = rva - it->first;
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,361 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file ParallelGCHeapWalker.cpp
+
+Implements ParallelGCHeapWalker class that walks GC heap segments on multiple threads.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "BufferedLogger.h"
+#include "ParallelGCHeapWalker.h"
+
+const unsigned long ParallelGCHeapWalker::SPLIT_SIZE;
+
+/**
+Keeps boundaries of a segment, replacing boundaries found by a previous walk.
+
+\param segment Segment range.
+\param boundaries Sorted object addresses inside the segment.
+*/
+void GCHeapBoundaryIndex::add(const MemoryRange& segment, const std::vector<unsigned long>& boundaries)
+{
+	_segments[segment.Address] = std::make_pair(segment.Size, boundaries);
+}
+
+/**
+Finds boundaries of a segment.
+
+\param segment Segment range.
+\return Boundaries, or nullptr if the segment is not known or its allocated size changed.
+*/
+const std::vector<unsigned long>* GCHeapBoundaryIndex::find(const MemoryRange& segment) const
+{
+	auto it = _segments.find(segment.Address);
+
+	if (it == _segments.end() || it->second.first != segment.Size)
+	{
+		return nullptr;
+	}
+
+	return &it->second.second;
+}
+
+/**
+Checks if two !eeheap -gc outputs have the same segments with the same allocated sizes, so results of a walk of one are valid for the other.
+
+\param a Segment ranges.
+\param b Segment ranges.
+*/
+bool ParallelGCHeapWalker::is_same_heap(RangeList a, RangeList b)
+{
+	if (!a || !b || a->size() != b->size())
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < a->size(); i++)
+	{
+		if (a->at(i).Address != b->at(i).Address || a->at(i).Size != b->at(i).Size || a->at(i).Usage != b->at(i).Usage)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+Constructs an instance of the ParallelGCHeapWalker class and splits segments into work items.
+
+\param segments Segment ranges from !eeheap -gc.
+\param memory_reader Memory reader, walks run on one thread unless it is thread-safe.
+\param method_table_cache MethodTable cache.
+\param boundary_index Boundaries to split segments at, filled by the walk. Can be nullptr.
+\param logger Logger, only called from the thread calling walk.
+\param thread_count Number of threads, zero for the number of processors.
+\param split_size Distance of boundaries recorded for later walks.
+*/
+ParallelGCHeapWalker::ParallelGCHeapWalker(RangeList segments, IMemoryReader* memory_reader, MethodTableCache* method_table_cache, GCHeapBoundaryIndex* boundary_index, ILogger* logger, unsigned int thread_count, unsigned long split_size)
+	: _segments(segments), _memory_reader(memory_reader), _method_table_cache(method_table_cache), _boundary_index(boundary_index), _logger(logger), _thread_count(thread_count), _split_size(split_size)
+{
+	if (_thread_count == 0)
+	{
+		_thread_count = std::max(1U, std::thread::hardware_concurrency());
+	}
+
+	if (!_memory_reader->IsThreadSafe())
+	{
+		_thread_count = 1;
+	}
+
+	plan();
+}
+
+/**
+Creates a work item per segment, or per part of a segment between known boundaries.
+*/
+void ParallelGCHeapWalker::plan()
+{
+	if (!_segments)
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < _segments->size(); i++)
+	{
+		auto& segment = _segments->at(i);
+
+		if ((segment.Usage != Usage::GCHeap && segment.Usage != Usage::GCLOHeap) || segment.Size == 0)
+		{
+			continue;
+		}
+
+		auto boundaries = _boundary_index ? _boundary_index->find(segment) : nullptr;
+
+		auto start = segment.Address;
+		auto end = segment.Address + segment.Size;
+
+		if (boundaries)
+		{
+			for (auto boundary : *boundaries)
+			{
+				if (boundary <= start || boundary >= end)
+				{
+					continue;
+				}
+
+				_work_items.push_back(MemoryRange(start, boundary - start, segment.State, segment.Usage));
+				_work_item_segments.push_back(i);
+
+				start = boundary;
+			}
+		}
+
+		_work_items.push_back(MemoryRange(start, end - start, segment.State, segment.Usage));
+		_work_item_segments.push_back(i);
+	}
+}
+
+/**
+Walks all work items. Each thread takes work items from its own queue, largest first, and steals from the back of other queues when it runs out.
+A work item is walked by one thread, so the callback can keep results per work item without locking.
+
+\param callback Invoked for each object with the index of its work item, returns false to stop the walk.
+\return false if a work item could not be walked to its end.
+*/
+bool ParallelGCHeapWalker::walk(const GCHeapWorkItemCallback& callback)
+{
+	return walk_items([&](size_t item, const GCHeapObject& object, GCHeapWalker&){ return callback(item, object); });
+}
+
+/**
+Walks all work items like walk, passing the bytes of each object too. Objects are read from the window the walker reads headers from.
+
+\param callback Invoked for each object with the index of its work item and its bytes, nullptr if they cannot be read. Returns false to stop the walk.
+\return false if a work item could not be walked to its end.
+*/
+bool ParallelGCHeapWalker::walk_contents(const GCHeapWorkItemContentCallback& callback)
+{
+	return walk_items([&](size_t item, const GCHeapObject& object, GCHeapWalker& walker){ return callback(item, object, walker.read_object(object)); });
+}
+
+/**
+Walks all work items on the threads of this walker.
+
+\param callback Invoked for each object with the index of its work item and the walker of the thread.
+\return false if a work item could not be walked to its end.
+*/
+bool ParallelGCHeapWalker::walk_items(const std::function<bool(size_t, const GCHeapObject&, GCHeapWalker&)>& callback)
+{
+	auto item_count = _work_items.size();
+
+	std::vector<std::deque<size_t>> queues(_thread_count);
+	std::vector<std::mutex> queue_mutexes(_thread_count);
+
+	std::vector<size_t> order(item_count);
+
+	for (size_t i = 0; i < item_count; i++)
+	{
+		order[i] = i;
+	}
+
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b){ return _work_items[a].Size > _work_items[b].Size; });
+
+	for (size_t i = 0; i < item_count; i++)
+	{
+		queues[i % _thread_count].push_back(order[i]);
+	}
+
+	std::vector<std::vector<std::string>> item_logs(item_count);
+	std::vector<std::vector<unsigned long>> item_boundaries(item_count);
+	std::vector<char> item_walked(item_count, 0);
+	std::vector<char> item_complete(item_count, 0);
+	std::vector<unsigned long> worker_objects(_thread_count, 0);
+
+	std::atomic<bool> is_stopped(false);
+
+	auto pop = [&](unsigned int worker, size_t& item)
+	{
+		for (unsigned int i = 0; i < _thread_count; i++)
+		{
+			auto victim = (worker + i) % _thread_count;
+
+			std::lock_guard<std::mutex> lock(queue_mutexes[victim]);
+
+			if (queues[victim].empty())
+			{
+				continue;
+			}
+
+			if (victim == worker)
+			{
+				item = queues[victim].front();
+				queues[victim].pop_front();
+			}
+			else
+			{
+				item = queues[victim].back();
+				queues[victim].pop_back();
+			}
+
+			return true;
+		}
+
+		return false;
+	};
+
+	auto work = [&](unsigned int worker)
+	{
+		BufferedLogger worker_logger;
+
+		GCHeapWalker walker(_segments, _memory_reader, _method_table_cache, &worker_logger);
+
+		size_t item;
+
+		while (!is_stopped && pop(worker, item))
+		{
+			auto& boundaries = item_boundaries[item];
+			auto next_boundary = _work_items[item].Address + _split_size;
+
+			auto is_complete = walker.walk_segment(_work_items[item], [&](const GCHeapObject& object)
+			{
+				if (object.Address >= next_boundary)
+				{
+					boundaries.push_back(object.Address);
+
+					next_boundary = object.Address + _split_size;
+				}
+
+				if (is_stopped || !callback(item, object, walker))
+				{
+					is_stopped = true;
+
+					return false;
+				}
+
+				return true;
+			});
+
+			item_walked[item] = 1;
+			item_complete[item] = is_complete;
+			item_logs[item] = worker_logger.get_messages();
+
+			worker_logger.clear();
+		}
+
+		worker_objects[worker] = walker.get_objects();
+	};
+
+	std::vector<std::thread> threads;
+
+	for (unsigned int worker = 1; worker < _thread_count; worker++)
+	{
+		threads.push_back(std::thread(work, worker));
+	}
+
+	work(0);
+
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	// Merge in address order.
+	auto is_complete = true;
+
+	_objects = 0;
+
+	for (auto objects : worker_objects)
+	{
+		_objects += objects;
+	}
+
+	for (size_t i = 0; i < item_count; i++)
+	{
+		for (auto& message : item_logs[i])
+		{
+			_logger->Log("%s", message.c_str());
+		}
+
+		// Work items left after a stop are not walked.
+		is_complete = is_complete && (item_complete[i] != 0 || (is_stopped && item_walked[i] == 0));
+	}
+
+	if (_boundary_index && !is_stopped)
+	{
+		for (size_t first = 0, last = 0; first < item_count; first = last)
+		{
+			std::vector<unsigned long> boundaries;
+
+			auto is_segment_complete = true;
+
+			for (last = first; last < item_count && _work_item_segments[last] == _work_item_segments[first]; last++)
+			{
+				if (last != first)
+				{
+					boundaries.push_back(_work_items[last].Address);
+				}
+
+				boundaries.insert(boundaries.end(), item_boundaries[last].begin(), item_boundaries[last].end());
+
+				is_segment_complete = is_segment_complete && item_complete[last] != 0;
+			}
+
+			if (is_segment_complete)
+			{
+				_boundary_index->add(_segments->at(_work_item_segments[first]), boundaries);
+			}
+		}
+	}
+
+	return is_complete;
+}
\ No newline at end of file
@@ -0,0 +1,503 @@
+// Copyright (c) 2015 Kerem KAT 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files(the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and / or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// 
+// Do not hesisate to contact me about usage of the code or to make comments 
+// about the code. Your feedback will be appreciated.
+//
+// http://dissipatedheat.com/
+// http://github.com/krk/
+
+/**
+\file ReferenceGraph.cpp
+
+Implements ReferenceGraph class that builds and queries references between managed objects.
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <unordered_map>
+
+#include "ReferenceGraph.h"
+#include "ParallelFor.h"
+
+const unsigned int ReferenceGraph::NOT_FOUND;
+const unsigned int ReferenceGraph::FILE_VERSION;
+
+static const char FILE_MAGIC[8] = { 'C', 'O', 'S', 'O', 'S', 'R', 'E', 'F' };
+
+/**
+\class ReferenceGraphItem
+
+Represents objects and raw pointer fields found in one work item of a heap walk.
+*/
+class ReferenceGraphItem
+{
+public:
+	std::vector<unsigned int> Addresses;
+	std::vector<unsigned int> MethodTables;
+	std::vector<unsigned int> Sizes;
+	std::vector<unsigned int> Counts;
+	std::vector<unsigned int> Targets;
+	std::unordered_map<unsigned long, GCDesc> Descriptors;
+};
+
+ReferenceGraph::ReferenceGraph(RangeList segments)
+	: _segments(segments)
+{
+
+}
+
+/**
+Walks the heap and builds the graph.
+Each work item keeps its objects and pointer fields, then items are placed in address order, targets are resolved to node ids and copied to the adjacency arrays on the threads of the walker.
+
+\param walker Walker of the segments this instance was constructed with.
+\param method_table_cache MethodTable cache for GC descriptors.
+\return false if the heap could not be walked to its end, the graph is kept for the walked part.
+*/
+bool ReferenceGraph::build(ParallelGCHeapWalker& walker, MethodTableCache* method_table_cache)
+{
+	auto& work_items = walker.get_work_items();
+
+	_thread_count = std::max(1u, walker.get_thread_count());
+
+	std::vector<ReferenceGraphItem> items(work_items.size());
+
+	_is_complete = walker.walk_contents([&](size_t item, const GCHeapObject& object, const unsigned char* bytes)
+	{
+		auto& nodes = items[item];
+
+		nodes.Addresses.push_back(object.Address);
+		nodes.MethodTables.push_back(object.MethodTable);
+		nodes.Sizes.push_back(object.Size);
+
+		auto targets = nodes.Targets.size();
+
+		if (bytes)
+		{
+			auto it = nodes.Descriptors.find(object.MethodTable);
+
+			if (it == nodes.Descriptors.end())
+			{
+				GCDesc gc_desc;
+
+				if (!method_table_cache->get_gc_desc(object.MethodTable, gc_desc))
+				{
+					gc_desc = GCDesc();
+				}
+
+				it = nodes.Descriptors.insert(std::make_pair(object.MethodTable, gc_desc)).first;
+			}
+
+			it->second.for_each_reference(bytes, object.Size, [&](unsigned long target)
+			{
+				nodes.Targets.push_back(target);
+			});
+		}
+
+		nodes.Counts.push_back(static_cast<unsigned int>(nodes.Targets.size() - targets));
+
+		return true;
+	});
+
+	// Segments are not sorted by address.
+	std::vector<size_t> order(items.size());
+
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		order[i] = i;
+	}
+
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b){ return work_items[a].Address < work_items[b].Address; });
+
+	std::vector<size_t> node_bases(items.size());
+
+	size_t node_count = 0;
+
+	for (auto i : order)
+	{
+		items[i].Descriptors.clear();
+
+		node_bases[i] = node_count;
+		node_count += items[i].Addresses.size();
+	}
+
+	_addresses.resize(node_count);
+	_method_tables.resize(node_count);
+	_sizes.resize(node_count);
+
+	parallel_for(_thread_count, items.size(), [&](size_t i)
+	{
+		std::copy(items[i].Addresses.begin(), items[i].Addresses.end(), _addresses.begin() + node_bases[i]);
+		std::copy(items[i].MethodTables.begin(), items[i].MethodTables.end(), _method_tables.begin() + node_bases[i]);
+		std::copy(items[i].Sizes.begin(), items[i].Sizes.end(), _sizes.begin() + node_bases[i]);
+
+		// Walked nodes are not needed anymore, freeing them lowers the peak before the adjacency arrays are allocated.
+		std::vector<unsigned int>().swap(items[i].Addresses);
+		std::vector<unsigned int>().swap(items[i].MethodTables);
+		std::vector<unsigned int>().swap(items[i].Sizes);
+	});
+
+	// Pointers to objects that were not walked are dropped.
+	parallel_for(_thread_count, items.size(), [&](size_t i)
+	{
+		auto& nodes = items[i];
+
+		size_t read = 0;
+		size_t written = 0;
+
+		for (auto& count : nodes.Counts)
+		{
+			auto first = written;
+
+			for (auto end = read + count; read < end; read++)
+			{
+				auto node = find_node(nodes.Targets[read]);
+
+				if (node != NOT_FOUND && _addresses[node] == nodes.Targets[read])
+				{
+					nodes.Targets[written++] = node;
+				}
+			}
+
+			count = static_cast<unsigned int>(written - first);
+		}
+
+		nodes.Targets.resize(written);
+	});
+
+	_reference_offsets.assign(node_count + 1, 0);
+
+	for (auto i : order)
+	{
+		auto base = node_bases[i];
+
+		for (size_t j = 0; j < items[i].Counts.size(); j++)
+		{
+			_reference_offsets[base + j + 1] = items[i].Counts[j];
+		}
+	}
+
+	for (size_t i = 0; i < node_count; i++)
+	{
+		_reference_offsets[i + 1] += _reference_offsets[i];
+	}
+
+	_references.resize(_reference_offsets[node_count]);
+
+	parallel_for(_thread_count, items.size(), [&](size_t i)
+	{
+		std::copy(items[i].Targets.begin(), items[i].Targets.end(), _references.begin() + _reference_offsets[node_bases[i]]);
+
+		std::vector<unsigned int>().swap(items[i].Targets);
+	});
+
+	build_referrers();
+
+	return _is_complete;
+}
+
+/**
+Builds the reverse adjacency arrays. Sources are split into one range of about the same number of edges per thread,
+each thread counts the targets of its range, then counts are turned into write positions so that referrers of a node from earlier ranges come first,
+and each thread writes the referrers of its range. Referrers of a node are in ascending order without sorting or atomics.
+Counts take one integer per node and thread, so threads are limited to keep them no larger than the reverse arrays.
+*/
+void ReferenceGraph::build_referrers()
+{
+	auto node_count = _addresses.size();
+	auto edge_count = _references.size();
+
+	size_t partition_count = _thread_count;
+
+	if (node_count > 0)
+	{
+		partition_count = std::max<size_t>(1, std::min<size_t>(partition_count, 1 + edge_count / node_count));
+	}
+
+	std::vector<size_t> sources(partition_count + 1, node_count);
+
+	for (size_t partition = 0; partition < partition_count; partition++)
+	{
+		auto first_edge = edge_count * partition / partition_count;
+
+		sources[partition] = std::lower_bound(_reference_offsets.begin(), _reference_offsets.begin() + node_count, first_edge) - _reference_offsets.begin();
+	}
+
+	std::vector<std::vector<unsigned int>> positions(partition_count);
+
+	parallel_for(_thread_count, partition_count, [&](size_t partition)
+	{
+		auto& counts = positions[partition];
+
+		counts.assign(node_count, 0);
+
+		for (auto i = _reference_offsets[sources[partition]]; i < _reference_offsets[sources[partition + 1]]; i++)
+		{
+			counts[_references[i]]++;
+		}
+	});
+
+	// Targets are split into ranges, each range sums its counts, then ranges are offset by the sums of earlier ranges.
+	auto target_range_size = (node_count + partition_count - 1) / partition_count;
+
+	std::vector<unsigned int> range_offsets(partition_count + 1, 0);
+
+	parallel_for(_thread_count, partition_count, [&](size_t range)
+	{
+		auto first = std::min(node_count, range * target_range_size);
+		auto last = std::min(node_count, first + target_range_size);
+
+		unsigned int sum = 0;
+
+		for (auto& counts : positions)
+		{
+			for (auto target = first; target < last; target++)
+			{
+				sum += counts[target];
+			}
+		}
+
+		range_offsets[range + 1] = sum;
+	});
+
+	for (size_t range = 0; range < partition_count; range++)
+	{
+		range_offsets[range + 1] += range_offsets[range];
+	}
+
+	_referrer_offsets.resize(node_count + 1);
+	_referrer_offsets[node_count] = static_cast<unsigned int>(edge_count);
+
+	parallel_for(_thread_count, partition_count, [&](size_t range)
+	{
+		auto first = std::min(node_count, range * target_range_size);
+		auto last = std::min(node_count, first + target_range_size);
+
+		auto offset = range_offsets[range];
+
+		for (auto target = first; target < last; target++)
+		{
+			_referrer_offsets[target] = offset;
+
+			for (auto& counts : positions)
+			{
+				auto count = counts[target];
+
+				counts[target] = offset;
+				offset += count;
+			}
+		}
+	});
+
+	_referrers.resize(edge_count);
+
+	parallel_for(_thread_count, partition_count, [&](size_t partition)
+	{
+		auto& cursors = positions[partition];
+
+		for (auto source = sources[partition]; source < sources[partition + 1]; source++)
+		{
+			for (auto i = _reference_offsets[source]; i < _reference_offsets[source + 1]; i++)
+			{
+				_referrers[cursors[_references[i]]++] = static_cast<unsigned int>(source);
+			}
+		}
+
+		std::vector<unsigned int>().swap(cursors);
+	});
+}
+
+/**
+Checks if the graph was built from the same segments.
+
+\param segments GC heap segments.
+*/
+bool ReferenceGraph::matches(RangeList segments) const
+{
+	return _segments && ParallelGCHeapWalker::is_same_heap(_segments, segments);
+}
+
+/**
+Finds the object containing an address.
+
+\param address Address.
+\return Node id, or NOT_FOUND if no object contains the address.
+*/
+unsigned int ReferenceGraph::find_node(unsigned long address) const
+{
+	auto it = std::upper_bound(_addresses.begin(), _addresses.end(), address);
+
+	if (it == _addresses.begin())
+	{
+		return NOT_FOUND;
+	}
+
+	auto node = static_cast<unsigned int>(it - _addresses.begin() - 1);
+
+	return address - _addresses[node] < _sizes[node] ? node : NOT_FOUND;
+}
+
+/**
+Gets the objects referenced by the pointer fields of an object, in field order.
+
+\param node Node id.
+*/
+ReferenceNodeRange ReferenceGraph::get_references(unsigned int node) const
+{
+	return ReferenceNodeRange(_references.data() + _reference_offsets[node], _references.data() + _reference_offsets[node + 1]);
+}
+
+/**
+Gets the objects that have pointer fields to an object, in address order. An object is listed once for each field.
+
+\param node Node id.
+*/
+ReferenceNodeRange ReferenceGraph::get_referrers(unsigned int node) const
+{
+	return ReferenceNodeRange(_referrers.data() + _referrer_offsets[node], _referrers.data() + _referrer_offsets[node + 1]);
+}
+
+/**
+Returns the number of bytes used by the arrays of the graph.
+*/
+size_t ReferenceGraph::memory_size() const
+{
+	return sizeof(unsigned int) * (_addresses.capacity() + _method_tables.capacity() + _sizes.capacity()
+		+ _reference_offsets.capacity() + _references.capacity() + _referrer_offsets.capacity() + _referrers.capacity());
+}
+
+template <typename T>
+static void write_values(std::ofstream& stream, const T* values, size_t count)
+{
+	stream.write(reinterpret_cast<const char*>(values), count * sizeof(T));
+}
+
+template <typename T>
+static bool read_values(std::ifstream& stream, T* values, size_t count)
+{
+	return count == 0 || stream.read(reinterpret_cast<char*>(values), count * sizeof(T)).good();
+}
+
+/**
+Saves the graph to a little-endian binary file: magic, version, flags, node count, edge count, then addresses, MethodTables, sizes,
+forward offsets and forward targets as 32-bit integers. Referrers are not saved, they are rebuilt on load.
+
+\param path File path.
+\return false if the file cannot be written.
+*/
+bool ReferenceGraph::save(const std::string& path) const
+{
+	std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+
+	if (!stream)
+	{
+		return false;
+	}
+
+	unsigned int header[4] = { FILE_VERSION, _is_complete ? 1u : 0u, static_cast<unsigned int>(_addresses.size()), static_cast<unsigned int>(_references.size()) };
+
+	write_values(stream, FILE_MAGIC, sizeof(FILE_MAGIC));
+	write_values(stream, header, 4);
+	write_values(stream, _addresses.data(), _addresses.size());
+	write_values(stream, _method_tables.data(), _method_tables.size());
+	write_values(stream, _sizes.data(), _sizes.size());
+	write_values(stream, _reference_offsets.data(), _reference_offsets.size());
+	write_values(stream, _references.data(), _references.size());
+
+	return stream.good();
+}
+
+/**
+Loads a graph saved by save. The loaded graph does not match any segments.
+
+\param path File path.
+\return false if the file cannot be read or is not valid, the graph is left empty.
+*/
+bool ReferenceGraph::load(const std::string& path)
+{
+	*this = ReferenceGraph();
+
+	std::ifstream stream(path, std::ios::binary);
+
+	char magic[sizeof(FILE_MAGIC)];
+	unsigned int header[4];
+
+	if (!stream || !read_values(stream, magic, sizeof(magic)) || memcmp(magic, FILE_MAGIC, sizeof(magic)) != 0
+		|| !read_values(stream, header, 4) || header[0] != FILE_VERSION)
+	{
+		return false;
+	}
+
+	auto node_count = header[2];
+	auto edge_count = header[3];
+
+	// Sizes are checked against the file before allocating.
+	auto position = stream.tellg();
+
+	stream.seekg(0, std::ios::end);
+
+	auto remaining = static_cast<unsigned long long>(stream.tellg() - position);
+
+	stream.seekg(position);
+
+	if (remaining != sizeof(unsigned int) * (4ULL * node_count + 1 + edge_count))
+	{
+		return false;
+	}
+
+	_addresses.resize(node_count);
+	_method_tables.resize(node_count);
+	_sizes.resize(node_count);
+	_reference_offsets.resize(node_count + 1);
+	_references.resize(edge_count);
+
+	auto is_valid = read_values(stream, _addresses.data(), node_count)
+		&& read_values(stream, _method_tables.data(), node_count)
+		&& read_values(stream, _sizes.data(), node_count)
+		&& read_values(stream, _reference_offsets.data(), node_count + 1)
+		&& read_values(stream, _references.data(), edge_count)
+		&& _reference_offsets[0] == 0 && _reference_offsets[node_count] == edge_count;
+
+	for (size_t i = 0; is_valid && i < node_count; i++)
+	{
+		is_valid = _reference_offsets[i] <= _reference_offsets[i + 1] && (i == 0 || _addresses[i - 1] < _addresses[i]);
+	}
+
+	for (size_t i = 0; is_valid && i < edge_count; i++)
+	{
+		is_valid = _references[i] < node_count;
+	}
+
+	if (!is_valid)
+	{
+		*this = ReferenceGraph();
+
+		return false;
+	}
+
+	_is_complete = header[1] != 0;
+	_thread_count = std::max(1u, std::thread::hardware_concurrency());
+
+	build_referrers();
+
+	return true;
+}
\ No newline at end of file
@@ -32,6 +32,9 @@ Implements HandleCommandParser class that parses the output of the !handle comma
 #include "SafeWaitHandleParser.h"
 #include "SafeWaitHandleOutput.h"
 
+// Used when the runtime is not known.
+static const ManagedObjectReader<Clr4X86> DefaultObjectReader(ClrVersion::Clr4);
+
 /**
 Executes a htrace command and parses the output.
 
@@ -44,7 +47,7 @@ SafeWaitHandleOutput SafeWaitHandleParser::execute(const DumpHeapCommandOutput&
 		return SafeWaitHandleOutput();
 	}
 
-	auto map = parse(*dump_heap_output.get_addresses());
+	auto map = parse(dump_heap_output.get_addresses());
 
 	auto handle_addresses = std::shared_ptr<std::map<unsigned long, unsigned long>>(map);
 
@@ -53,31 +56,40 @@ SafeWaitHandleOutput SafeWaitHandleParser::execute(const DumpHeapCommandOutput&
 
 /**
 Build a map of SafeWaitHandle values to SafeWaitHandle object addresses.
+
+Handle fields of all objects are read with a single vectored read, at the offset of the target runtime.
 */
-std::map<unsigned long, unsigned long>* SafeWaitHandleParser::parse(const std::vector<unsigned long>& object_addresses)
+std::map<unsigned long, unsigned long>* SafeWaitHandleParser::parse(const CompressedAddressSet& object_addresses)
 {
 	auto ret = new std::map<unsigned long, unsigned long>();
 
+	std::vector<unsigned long> addresses;
+
+	addresses.reserve(object_addresses.size());
+
 	for (auto address : object_addresses)
 	{
-		if (address == 0)
+		if (address != 0)
 		{
-			continue;
+			addresses.push_back(address);
 		}
+	}
 
-		unsigned long handle_value = 0;
+	std::vector<unsigned long long> handle_values;
+	std::vector<char> is_read;
 
-		unsigned long bytes_read = 0;
+	auto object_reader = _object_reader ? _object_reader : &DefaultObjectReader;
 
-		// read memory.
-		_reader->ReadMemory(address + 4, &handle_value, sizeof(unsigned long), &bytes_read);
+	object_reader->read_safe_handles(_reader, addresses, handle_values, is_read);
 
-		if (!bytes_read)
+	for (size_t i = 0; i < addresses.size(); i++)
+	{
+		if (!is_read[i])
 		{
 			continue;
 		}
 
-		(*ret)[handle_value] = address;
+		(*ret)[static_cast<unsigned long>(handle_values[i])] = addresses[i];
 	}
 
 	return ret;